@@ -308,6 +308,7 @@ class BMessage {
 		class Private;
 		struct message_header;
 		struct field_header;
+		struct field_index;
 
 	private:
 		friend class Private;
@@ -333,6 +334,10 @@ class BMessage {
 							bool isFixedSize, field_header** _result);
 		status_t		_RemoveField(field_header* field);
 
+		void			_BuildFieldIndex();
+		void			_AddToFieldIndex(uint32 hash, int32 index);
+		void			_FreeFieldIndex();
+
 		void			_PrintToStream(const char* indent) const;
 
 	private:
@@ -350,7 +355,12 @@ class BMessage {
 
 		void*			fArchivingPointer;
 
-		uint32			fReserved[8];
+		field_index*	fFieldIndex;
+#ifdef B_HAIKU_64_BIT
+		uint32			fReserved[6];
+#else
+		uint32			fReserved[7];
+#endif
 
 						// deprecated
 						BMessage(BMessage *message);
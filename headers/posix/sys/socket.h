@@ -12,6 +12,8 @@
 #include <sys/uio.h>
 
 
+struct timespec;
+
 typedef uint32_t socklen_t;
 
 /* Address families */
@@ -71,6 +73,7 @@ typedef uint32_t socklen_t;
 #define SO_NONBLOCK		0x40000009
 #define SO_BINDTODEVICE	0x4000000a	/* binds the socket to a specific device index */
 #define SO_PEERCRED		0x4000000b	/* get peer credentials, param: ucred */
+#define SO_ZEROCOPY		0x4000000c	/* number of completed MSG_ZEROCOPY sends */
 
 /* Shutdown options */
 #define SHUT_RD			0
@@ -108,6 +111,11 @@ struct msghdr {
 	int			msg_flags;		/* flags */
 };
 
+struct mmsghdr {
+	struct msghdr	msg_hdr;	/* the message */
+	unsigned int	msg_len;	/* bytes received or sent */
+};
+
 /* Flags for the msghdr.msg_flags field */
 #define MSG_OOB			0x0001	/* process out-of-band data */
 #define MSG_PEEK		0x0002	/* peek at incoming message */
@@ -120,6 +128,8 @@ struct msghdr {
 #define MSG_BCAST		0x0100	/* this message rec'd as broadcast */
 #define MSG_MCAST		0x0200	/* this message rec'd as multicast */
 #define	MSG_EOF			0x0400	/* data completes connection */
+#define MSG_ZEROCOPY	0x0800	/* send without copying, see SO_ZEROCOPY */
+#define MSG_WAITFORONE	0x1000	/* recvmmsg() only waits for the first one */
 
 struct cmsghdr {
 	socklen_t	cmsg_len;
@@ -176,8 +186,12 @@ ssize_t recv(int socket, void *buffer, size_t length, int flags);
 ssize_t recvfrom(int socket, void *buffer, size_t bufferLength, int flags,
 			struct sockaddr *address, socklen_t *_addressLength);
 ssize_t recvmsg(int socket, struct msghdr *message, int flags);
+int		recvmmsg(int socket, struct mmsghdr *messages, unsigned int count,
+			int flags, struct timespec *timeout);
 ssize_t send(int socket, const void *buffer, size_t length, int flags);
 ssize_t	sendmsg(int socket, const struct msghdr *message, int flags);
+int		sendmmsg(int socket, struct mmsghdr *messages, unsigned int count,
+			int flags);
 ssize_t sendto(int socket, const void *message, size_t length, int flags,
 			const struct sockaddr *address, socklen_t addressLength);
 int     setsockopt(int socket, int level, int option, const void *value,
@@ -17,6 +17,7 @@
 #define MESSAGE_BODY_HASH_TABLE_SIZE	5
 #define MAX_DATA_PREALLOCATION			B_PAGE_SIZE * 10
 #define MAX_FIELD_PREALLOCATION			50
+#define MIN_INDEXED_FIELD_COUNT			16
 
 
 static const int32 kPortMessageCode = 'pjpp';
@@ -80,6 +81,25 @@ struct BMessage::message_header {
 } _PACKED;
 
 
+/*	The hash table in the message header has to stay as it is, as it is part
+	of the flattened format. With only five buckets, it degenerates into a
+	linear search for messages with many fields, though, so those get an
+	additional open addressed index that is only kept in memory. It maps the
+	full hash of a name to its index in the field list, is always at most half
+	full, and is rebuilt whenever fields are removed or renamed.
+*/
+struct BMessage::field_index {
+	uint32		size;
+		// the number of slots, always a power of two
+
+	struct slot {
+		uint32	hash;
+		int32	field;
+			// -1 for an empty slot
+	} slots[0];
+};
+
+
 class BMessage::Private {
 	public:
 		Private(BMessage *msg)
@@ -220,6 +220,14 @@ enum {
 	AS_SET_SUBPIXEL_ORDERING,
 	AS_GET_SUBPIXEL_ORDERING,
 
+	// Parallel rendering
+	AS_SET_RENDER_THREAD_COUNT,
+	AS_GET_RENDER_THREAD_COUNT,
+
+	// Retained window contents
+	AS_SET_RETAIN_WINDOW_CONTENTS,
+	AS_GET_RETAIN_WINDOW_CONTENTS,
+
 	// Graphics calls
 	AS_SET_HIGH_COLOR,
 	AS_SET_LOW_COLOR,
@@ -260,6 +268,7 @@ enum {
 	AS_DRAW_STRING_WITH_OFFSETS,
 
 	AS_SYNC,
+	AS_SYNC_WITH_SEMAPHORE,
 
 	AS_VIEW_CREATE,
 	AS_VIEW_DELETE,
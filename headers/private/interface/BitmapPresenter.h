@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _BITMAP_PRESENTER_H
+#define _BITMAP_PRESENTER_H
+
+
+#include <GraphicsDefs.h>
+#include <OS.h>
+#include <Rect.h>
+
+
+class BBitmap;
+class BView;
+
+
+namespace BPrivate {
+
+
+/*!	Cycles through a number of bitmaps that a client renders frames into,
+	and that are drawn into a view one after the other. The bitmaps are
+	shared with the app_server, so presenting a frame does not copy it, and
+	the client only has to wait for the app_server when it has run out of
+	buffers that are not being drawn anymore.
+*/
+class BitmapPresenter {
+public:
+								BitmapPresenter(BView* view, BRect bounds,
+									color_space colorSpace,
+									int32 bufferCount = 3);
+								~BitmapPresenter();
+
+			status_t			InitCheck() const;
+
+			int32				CountBuffers() const
+									{ return fBufferCount; }
+
+			BBitmap*			NextBuffer(
+									bigtime_t timeout = B_INFINITE_TIMEOUT);
+			status_t			Present(BRect viewRect, uint32 options = 0);
+			status_t			Present(BPoint where);
+
+			status_t			WaitForAll(
+									bigtime_t timeout = B_INFINITE_TIMEOUT);
+
+private:
+			status_t			_WaitFor(int32 index, bigtime_t timeout);
+
+private:
+	struct buffer {
+		BBitmap*				bitmap;
+		sem_id					drawn;
+		bool					pending;
+	};
+
+			BView*				fView;
+			buffer*				fBuffers;
+			int32				fBufferCount;
+			int32				fNext;
+			int32				fCurrent;
+			status_t			fInitStatus;
+};
+
+
+}	// namespace BPrivate
+
+
+using BPrivate::BitmapPresenter;
+
+
+#endif	// _BITMAP_PRESENTER_H
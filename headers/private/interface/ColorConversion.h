@@ -19,6 +19,18 @@ status_t ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
 	BPoint dstOffset, int32 width, int32 height);
 
 
+// The optimized code paths ConvertBits() may use, when the CPU supports
+// them. Changing them is meant for testing and benchmarking.
+enum {
+	COLOR_CONVERSION_SSE2		= 0x01,
+	COLOR_CONVERSION_SSSE3		= 0x02,
+	COLOR_CONVERSION_THREADS	= 0x04
+};
+
+uint32 ColorConversionFlags();
+uint32 SetColorConversionFlags(uint32 flags);
+
+
 /*!	\brief Helper class for conversion between RGB and palette colors.
 */
 class PaletteConverter {
@@ -65,6 +65,7 @@ public:
 	// defined in View.cpp
 	bool	WillLayout();
 	bool	MinMaxValid();
+	void	ReleaseWhenDrawn(sem_id semaphore);
 
 	BView* fView;
 };
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_FS_IO_RING_H
+#define _KERNEL_FS_IO_RING_H
+
+
+#include <io_ring_defs.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int			_user_io_ring_create(uint32 entryCount, int openFlags,
+				io_ring_header** _header);
+ssize_t		_user_io_ring_enter(int ring, uint32 submitCount,
+				uint32 waitCount, uint32 flags, bigtime_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/* _KERNEL_FS_IO_RING_H */
@@ -104,6 +104,8 @@ status_t	vfs_write_pages(struct vnode *vnode, void *cookie, off_t pos,
 				generic_size_t *_numBytes);
 status_t	vfs_vnode_io(struct vnode* vnode, void* cookie,
 				io_request* request);
+bool		vfs_can_do_uncached_io(struct file_descriptor* descriptor);
+bool		vfs_is_seekable(struct file_descriptor* descriptor);
 status_t	vfs_synchronous_io(io_request* request,
 				status_t (*doIO)(void* cookie, off_t offset, void* buffer,
 					size_t* length),
@@ -177,6 +179,9 @@ status_t	_user_read_stat(int fd, const char *path, bool traverseLink,
 				struct stat *stat, size_t statSize);
 status_t	_user_write_stat(int fd, const char *path, bool traverseLink,
 				const struct stat *stat, size_t statSize, int statMask);
+ssize_t		_user_read_dir_stat(int fd, struct dirent *buffer,
+				size_t bufferSize, uint32 maxCount, struct stat *stats,
+				size_t statSize);
 off_t		_user_seek(int fd, off_t pos, int seekType);
 status_t	_user_create_dir_entry_ref(dev_t device, ino_t inode,
 				const char *name, int perms);
@@ -253,10 +258,15 @@ ssize_t		_user_recv(int socket, void *data, size_t length, int flags);
 ssize_t		_user_recvfrom(int socket, void *data, size_t length, int flags,
 				struct sockaddr *address, socklen_t *_addressLength);
 ssize_t		_user_recvmsg(int socket, struct msghdr *message, int flags);
+ssize_t		_user_recvmmsg(int socket, struct mmsghdr *messages,
+				unsigned int count, int flags, bigtime_t timeout);
 ssize_t		_user_send(int socket, const void *data, size_t length, int flags);
 ssize_t		_user_sendto(int socket, const void *data, size_t length, int flags,
 				const struct sockaddr *address, socklen_t addressLength);
 ssize_t		_user_sendmsg(int socket, const struct msghdr *message, int flags);
+ssize_t		_user_send_file(int socket, int fd, off_t *_offset, size_t count);
+ssize_t		_user_sendmmsg(int socket, struct mmsghdr *messages,
+				unsigned int count, int flags);
 status_t	_user_getsockopt(int socket, int level, int option, void *value,
 				socklen_t *_length);
 status_t	_user_setsockopt(int socket, int level, int option,
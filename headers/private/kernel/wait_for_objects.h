@@ -26,6 +26,9 @@ typedef struct select_sync {
 	sem_id				sem;
 	uint32				count;
 	struct select_info*	set;
+	void				(*notify)(struct select_info* info);
+		// if not NULL, called instead of releasing sem when a selected event
+		// occurs
 } select_sync;
 
 #define SELECT_FLAG(type) (1L << (type - 1))
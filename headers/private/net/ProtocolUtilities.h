@@ -117,6 +117,8 @@ public:
 
 			status_t			Dequeue(uint32 flags, net_buffer** _buffer);
 			net_buffer*			Dequeue(bool clone);
+			status_t			DequeueMultiple(uint32 flags,
+									net_buffer** _buffers, uint32* _count);
 			status_t			BlockingDequeue(bool peek, bigtime_t timeout,
 									net_buffer** _buffer);
 
@@ -224,6 +226,36 @@ DECL_DATAGRAM_SOCKET(inline net_buffer*)::Dequeue(bool peek)
 }
 
 
+/*!	Waits for the first buffer like Dequeue() does, and then removes as many
+	of the queued buffers as there is room for in \a _buffers, up to
+	\a _count, in one go.
+*/
+DECL_DATAGRAM_SOCKET(inline status_t)::DequeueMultiple(uint32 flags,
+	net_buffer** _buffers, uint32* _count)
+{
+	bigtime_t timeout = _SocketTimeout(flags);
+
+	AutoLocker _(fLock);
+
+	while (fBuffers.IsEmpty()) {
+		status_t status = SocketStatus(false);
+		if (status != B_OK)
+			return status;
+
+		status = _Wait(timeout);
+		if (status != B_OK)
+			return status;
+	}
+
+	uint32 count = 0;
+	while (count < *_count && !fBuffers.IsEmpty())
+		_buffers[count++] = _Dequeue(false);
+
+	*_count = count;
+	return B_OK;
+}
+
+
 DECL_DATAGRAM_SOCKET(inline status_t)::BlockingDequeue(bool peek,
 	bigtime_t timeout, net_buffer** _buffer)
 {
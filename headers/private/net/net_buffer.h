@@ -15,6 +15,10 @@
 
 #define NET_BUFFER_MODULE_NAME "network/stack/buffer/v1"
 
+// net_buffer flags, in addition to the MSG_* flags
+#define NET_BUFFER_CHECKSUM_VALID	0x80000000
+	// the transport protocol checksum has already been verified
+
 
 typedef struct net_buffer {
 	struct list_link		link;
@@ -35,10 +39,18 @@ typedef struct net_buffer {
 	uint32					flags;
 	uint32					size;
 	uint8					protocol;
+	uint16					segment_size;
+		// if non-zero, this is a TCP segment that is to be sent as a
+		// series of segments of this payload size (segmentation offload)
+	uint32					sent_size;
+		// if sending such a segment failed, this is the number of payload
+		// bytes that have been sent before the failure
 } net_buffer;
 
 struct ancillary_data_container;
 
+typedef void (*net_buffer_release_func)(void* cookie);
+
 struct net_buffer_module_info {
 	module_info info;
 
@@ -67,6 +79,9 @@ struct net_buffer_module_info {
 	status_t		(*trim)(net_buffer* buffer, size_t newSize);
 	status_t		(*append_cloned)(net_buffer* buffer, net_buffer* source,
 						uint32 offset, size_t bytes);
+	status_t		(*append_external)(net_buffer* buffer, const void* data,
+						size_t bytes, net_buffer_release_func release,
+						void* cookie);
 
 	status_t		(*associate_data)(net_buffer* buffer, void* data);
 
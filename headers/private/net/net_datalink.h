@@ -175,6 +175,9 @@ struct net_address_module_info {
 						const struct sockaddr* address);
 
 	void			(*get_loopback_address)(struct sockaddr* result);
+
+	const uint8*	(*get_route_key)(const struct sockaddr* address,
+						size_t* _bits);
 };
 
 
@@ -14,6 +14,15 @@
 typedef struct net_buffer net_buffer;
 
 
+// net_device::offload
+#define NET_DEVICE_SEGMENTATION_OFFLOAD	0x01
+	// the device splits TCP segments larger than its MTU itself, according
+	// to net_buffer::segment_size
+
+// the maximum number of hardware receive queues the stack will read from
+#define NET_DEVICE_MAX_RECEIVE_QUEUES	16
+
+
 struct net_hardware_address {
 	uint8	data[64];
 	uint8	length;
@@ -25,6 +34,10 @@ typedef struct net_device {
 	char	name[IF_NAMESIZE];
 	uint32	index;
 	uint32	flags;		// IFF_LOOPBACK, ...
+	uint32	offload;	// NET_DEVICE_SEGMENTATION_OFFLOAD, ...
+	uint32	receive_queue_count;
+		// the number of hardware receive queues that spread the flows
+		// (RSS); if more than one, receive_queue_data() is used
 	uint32	type;		// IFT_ETHER, ...
 	size_t	mtu;
 	uint32	media;
@@ -61,6 +74,9 @@ struct net_device_module_info {
 					const struct sockaddr* address);
 	status_t	(*remove_multicast)(net_device* device,
 					const struct sockaddr* address);
+
+	status_t	(*receive_queue_data)(net_device* device, uint32 queue,
+					net_buffer** _buffer);
 };
 
 
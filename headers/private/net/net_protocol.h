@@ -112,6 +112,9 @@ struct net_protocol_module_info {
 	ssize_t		(*read_data_no_buffer)(net_protocol* self, const iovec* vecs,
 					size_t vecCount, ancillary_data_container** _ancillaryData,
 					struct sockaddr* _address, socklen_t* _addressLength);
+
+	status_t	(*read_data_multiple)(net_protocol* self, uint32 flags,
+					net_buffer** _buffers, uint32* _count);
 };
 
 
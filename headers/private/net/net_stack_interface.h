@@ -8,6 +8,8 @@
 
 #include <sys/socket.h>
 
+#include <net_buffer.h>
+
 
 // name of the kernel stack interface
 #define NET_STACK_INTERFACE_MODULE_NAME "network/stack/kernel_interface/v1"
@@ -42,6 +44,8 @@ struct net_stack_interface_module_info {
 					int flags, struct sockaddr* address,
 					socklen_t* _addressLength);
 	ssize_t (*recvmsg)(net_socket* socket, struct msghdr* message, int flags);
+	ssize_t (*recvmmsg)(net_socket* socket, struct mmsghdr* messages,
+					uint32 count, int flags);
 
 	ssize_t (*send)(net_socket* socket, const void* data, size_t length,
 					int flags);
@@ -50,6 +54,11 @@ struct net_stack_interface_module_info {
 					socklen_t addressLength);
 	ssize_t (*sendmsg)(net_socket* socket, const struct msghdr* message,
 					int flags);
+	ssize_t (*send_external)(net_socket* socket, const void* data,
+					size_t length, int flags, net_buffer_release_func release,
+					void* cookie);
+	ssize_t (*sendmmsg)(net_socket* socket, struct mmsghdr* messages,
+					uint32 count, int flags);
 
 	status_t (*getsockopt)(net_socket* socket, int level, int option,
 					void* value, socklen_t* _length);
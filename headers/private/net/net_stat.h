@@ -25,6 +25,9 @@ typedef struct net_stat {
 	struct	sockaddr_storage peer;
 	size_t	receive_queue_size;
 	size_t	send_queue_size;
+	size_t	receive_buffer_size;
+	size_t	send_buffer_size;
+	bigtime_t round_trip_time;
 } net_stat;
 
 #endif	// NET_STAT_H
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_EVENT_QUEUE_DEFS_H
+#define _SYSTEM_EVENT_QUEUE_DEFS_H
+
+
+#include <OS.h>
+
+
+typedef struct event_wait_info {
+	int32		object;						/* ID of the object */
+	uint16		type;						/* type of the object */
+	int32		events;						/* events mask and mode flags */
+	void*		user_data;					/* passed back on wait */
+} event_wait_info;
+
+/* _kern_event_queue_select() mode flags, or-ed into event_wait_info::events.
+   By default objects are level-triggered, i.e. they are reported by every
+   _kern_event_queue_wait() call as long as the selected condition holds.
+   Selecting an object with no events removes it from the queue. */
+#define B_EVENT_EDGE_TRIGGERED		0x00100000
+	/* only report an object again after a new event occurred */
+#define B_EVENT_ONE_SHOT			0x00200000
+	/* stop reporting the object after the first event, until it is selected
+	   again */
+
+#define B_EVENT_QUEUE_MODE_FLAGS	(B_EVENT_EDGE_TRIGGERED | B_EVENT_ONE_SHOT)
+
+
+#endif	/* _SYSTEM_EVENT_QUEUE_DEFS_H */
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_IO_RING_DEFS_H
+#define _SYSTEM_IO_RING_DEFS_H
+
+
+#include <OS.h>
+
+
+/* io_ring_submission::op */
+#define B_IO_RING_READ		1
+#define B_IO_RING_WRITE		2
+
+
+typedef struct io_ring_submission {
+	int32		fd;
+	uint32		op;
+	off_t		offset;
+	void*		buffer;
+	size_t		length;
+	void*		user_data;						/* passed back on completion */
+} io_ring_submission;
+
+typedef struct io_ring_completion {
+	void*		user_data;
+	ssize_t		result;							/* bytes transferred or error */
+} io_ring_completion;
+
+/* The header at the beginning of the area shared between kernel and
+   userland. Both rings have entry_count entries; the indices run freely and
+   are masked with (entry_count - 1). Userland adds submissions at
+   submission_tail and consumes completions at completion_head. */
+typedef struct io_ring_header {
+	uint32		entry_count;
+	uint32		submissions_offset;				/* relative to the header */
+	uint32		completions_offset;				/* relative to the header */
+	vuint32		submission_head;				/* advanced by the kernel */
+	vuint32		submission_tail;				/* advanced by userland */
+	vuint32		completion_head;				/* advanced by userland */
+	vuint32		completion_tail;				/* advanced by the kernel */
+} io_ring_header;
+
+
+#endif	/* _SYSTEM_IO_RING_DEFS_H */
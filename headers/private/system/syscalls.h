@@ -22,9 +22,11 @@ extern "C" {
 struct attr_info;
 struct dirent;
 struct Elf32_Sym;
+struct event_wait_info;
 struct fd_info;
 struct fd_set;
 struct fs_info;
+struct io_ring_header;
 struct iovec;
 struct msqid_ds;
 struct net_stat;
@@ -73,12 +75,20 @@ extern status_t		_kern_get_safemode_option(const char *parameter,
 extern ssize_t		_kern_wait_for_objects(object_wait_info* infos, int numInfos,
 						uint32 flags, bigtime_t timeout);
 
+extern int			_kern_event_queue_create(int openFlags);
+extern status_t		_kern_event_queue_select(int queue,
+						struct event_wait_info* infos, int numInfos);
+extern ssize_t		_kern_event_queue_wait(int queue,
+						struct event_wait_info* infos, int numInfos,
+						uint32 flags, bigtime_t timeout);
+
 /* user mutex functions */
 extern status_t		_kern_mutex_lock(int32* mutex, const char* name,
 						uint32 flags, bigtime_t timeout);
 extern status_t		_kern_mutex_unlock(int32* mutex, uint32 flags);
 extern status_t		_kern_mutex_switch_lock(int32* fromMutex, int32* toMutex,
 						const char* name, uint32 flags, bigtime_t timeout);
+extern status_t		_kern_mutex_requeue(int32* fromMutex, int32* toMutex);
 
 /* sem functions */
 extern sem_id		_kern_create_sem(int count, const char *name);
@@ -319,6 +329,13 @@ extern ssize_t		_kern_read_dir(int fd, struct dirent *buffer,
 extern status_t		_kern_rewind_dir(int fd);
 extern status_t		_kern_read_stat(int fd, const char *path, bool traverseLink,
 						struct stat *stat, size_t statSize);
+extern ssize_t		_kern_read_dir_stat(int fd, struct dirent *buffer,
+						size_t bufferSize, uint32 maxCount, struct stat *stats,
+						size_t statSize);
+extern int			_kern_io_ring_create(uint32 entryCount, int openFlags,
+						struct io_ring_header **_header);
+extern ssize_t		_kern_io_ring_enter(int ring, uint32 submitCount,
+						uint32 waitCount, uint32 flags, bigtime_t timeout);
 extern status_t		_kern_write_stat(int fd, const char *path,
 						bool traverseLink, const struct stat *stat,
 						size_t statSize, int statMask);
@@ -347,6 +364,8 @@ extern ssize_t		_kern_recvfrom(int socket, void *data, size_t length,
 						socklen_t *_addressLength);
 extern ssize_t		_kern_recvmsg(int socket, struct msghdr *message,
 						int flags);
+extern ssize_t		_kern_recvmmsg(int socket, struct mmsghdr *messages,
+						unsigned int count, int flags, bigtime_t timeout);
 extern ssize_t		_kern_send(int socket, const void *data, size_t length,
 						int flags);
 extern ssize_t		_kern_sendto(int socket, const void *data, size_t length,
@@ -354,6 +373,10 @@ extern ssize_t		_kern_sendto(int socket, const void *data, size_t length,
 						socklen_t addressLength);
 extern ssize_t		_kern_sendmsg(int socket, const struct msghdr *message,
 						int flags);
+extern ssize_t		_kern_sendmmsg(int socket, struct mmsghdr *messages,
+						unsigned int count, int flags);
+extern ssize_t		_kern_send_file(int socket, int fd, off_t *_offset,
+						size_t count);
 extern status_t		_kern_getsockopt(int socket, int level, int option,
 						void *value, socklen_t *_length);
 extern status_t		_kern_setsockopt(int socket, int level, int option,
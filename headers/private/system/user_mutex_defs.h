@@ -12,6 +12,12 @@
 	// state will be locked.
 
 
+// special (non-error) return value of _kern_mutex_switch_lock()
+#define B_USER_MUTEX_REQUEUED		1
+	// The waiting thread has been requeued by _kern_mutex_requeue() to the
+	// mutex it had released (fromMutex) and owns that mutex now.
+
+
 // mutex value flags
 #define B_USER_MUTEX_LOCKED		0x01
 #define B_USER_MUTEX_WAITING	0x02
@@ -58,6 +58,8 @@ loopback_init(const char *name, net_device **_device)
 
 	strcpy(device->name, name);
 	device->flags = IFF_LOOPBACK | IFF_LINK;
+	device->offload = NET_DEVICE_SEGMENTATION_OFFLOAD;
+		// segments are delivered as is, there is no need to split them
 	device->type = IFT_LOOP;
 	device->mtu = 16384;
 	device->media = IFM_ACTIVE;
@@ -1449,8 +1449,9 @@ ipv4_send_routed_data(net_protocol* _protocol, struct net_route* route,
 	TRACE_SK(protocol, "  SendRoutedData(): destination: %08x",
 		ntohl(destination.sin_addr.s_addr));
 
+	// TCP segments with a segment size are split by the datalink layer
 	uint32 mtu = route->mtu ? route->mtu : interface->mtu;
-	if (buffer->size > mtu) {
+	if (buffer->size > mtu && buffer->segment_size == 0) {
 		// we need to fragment the packet
 		return send_fragments(protocol, route, buffer, mtu);
 	}
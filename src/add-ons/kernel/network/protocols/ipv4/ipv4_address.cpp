@@ -520,6 +520,17 @@ ipv4_get_loopback_address(sockaddr *_address)
 }
 
 
+/*!	Returns the bits of the \a address in network byte order, as used for
+	route lookups.
+*/
+static const uint8*
+ipv4_get_route_key(const sockaddr *address, size_t *_bits)
+{
+	*_bits = 32;
+	return (const uint8 *)&((const sockaddr_in *)address)->sin_addr;
+}
+
+
 net_address_module_info gIPv4AddressModule = {
 	{
 		NULL,
@@ -548,5 +559,6 @@ net_address_module_info gIPv4AddressModule = {
 	ipv4_hash_address,
 	ipv4_hash_address_pair,
 	ipv4_checksum_address,
-	ipv4_get_loopback_address
+	ipv4_get_loopback_address,
+	ipv4_get_route_key
 };
@@ -540,6 +540,16 @@ ipv6_get_loopback_address(sockaddr *_address)
 }
 
 
+/*!	Returns the bits of the \a address, as used for route lookups.
+*/
+static const uint8 *
+ipv6_get_route_key(const sockaddr *address, size_t *_bits)
+{
+	*_bits = 128;
+	return ((const sockaddr_in6 *)address)->sin6_addr.s6_addr;
+}
+
+
 net_address_module_info gIPv6AddressModule = {
 	{
 		NULL,
@@ -568,5 +578,6 @@ net_address_module_info gIPv6AddressModule = {
 	ipv6_hash_address,
 	ipv6_hash_address_pair,
 	ipv6_checksum_address,
-	ipv6_get_loopback_address
+	ipv6_get_loopback_address,
+	ipv6_get_route_key
 };
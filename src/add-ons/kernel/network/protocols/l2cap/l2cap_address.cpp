@@ -437,5 +437,6 @@ net_address_module_info gL2cap4AddressModule = {
 	l2cap_hash_address,
 	l2cap_hash_address_pair,
 	l2cap_checksum_address,
-	NULL	// get_loopback_address
+	NULL,	// get_loopback_address
+	NULL	// get_route_key
 };
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	The global memory budget for automatically grown socket buffers.
+
+	Endpoints may grow their send and receive buffers beyond the size the
+	socket was created with, but the additional space has to be reserved
+	here first. The budget is a fraction of the physical memory, and no
+	reservations are granted while the system is running low on memory; the
+	endpoints then shrink their buffers again as soon as they are empty.
+*/
+
+
+#include "BufferBudget.h"
+
+#include "BufferQueue.h"
+
+#include <KernelExport.h>
+#include <OS.h>
+
+#include <low_resource_manager.h>
+
+
+// the budget is 1/32 of the physical memory, but at least this much
+static const size_t kMinBudget = 8 * 1024 * 1024;
+
+// the low resource manager only notifies us as long as the system is
+// running low on memory, so we forget about it after a while
+static const bigtime_t kPressureTimeout = 10000000;
+
+static size_t sBudget;
+static vint64 sReserved;
+static vint32 sPressure;
+static vint64 sPressureTime;
+
+
+static void
+low_resource_handler(void* /*data*/, uint32 resources, int32 level)
+{
+	atomic_set64(&sPressureTime, system_time());
+	atomic_set(&sPressure, level);
+}
+
+
+status_t
+init_buffer_budget()
+{
+	system_info info;
+	get_system_info(&info);
+
+	sBudget = max_c((size_t)info.max_pages * (B_PAGE_SIZE / 32), kMinBudget);
+	sReserved = 0;
+	sPressure = B_NO_LOW_RESOURCE;
+
+	return register_low_resource_handler(&low_resource_handler, NULL,
+		B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY, 0);
+}
+
+
+void
+uninit_buffer_budget()
+{
+	unregister_low_resource_handler(&low_resource_handler, NULL);
+}
+
+
+/*!	Tries to reserve \a bytes of the budget, and returns whether or not
+	that was possible.
+*/
+bool
+reserve_buffer_budget(size_t bytes)
+{
+	if (buffer_budget_pressure() != B_NO_LOW_RESOURCE)
+		return false;
+
+	int64 reserved = atomic_add64(&sReserved, bytes);
+	if (reserved + bytes > sBudget) {
+		atomic_add64(&sReserved, -(int64)bytes);
+		return false;
+	}
+
+	return true;
+}
+
+
+void
+unreserve_buffer_budget(size_t bytes)
+{
+	atomic_add64(&sReserved, -(int64)bytes);
+}
+
+
+/*!	Returns the current memory pressure as one of the low resource levels. */
+int32
+buffer_budget_pressure()
+{
+	int32 pressure = atomic_get(&sPressure);
+	if (pressure != B_NO_LOW_RESOURCE
+		&& system_time() - atomic_get64(&sPressureTime) > kPressureTimeout) {
+		atomic_test_and_set(&sPressure, B_NO_LOW_RESOURCE, pressure);
+		return B_NO_LOW_RESOURCE;
+	}
+
+	return pressure;
+}
+
+
+size_t
+buffer_budget_reserved()
+{
+	return atomic_get64(&sReserved);
+}
+
+
+/*!	Grows \a queue to \a size bytes, if the budget allows it.
+	\a reserved is the amount of the budget the queue is currently using.
+*/
+bool
+grow_buffer(BufferQueue& queue, size_t& reserved, size_t size)
+{
+	size_t increase = size - queue.Size();
+	if (!reserve_buffer_budget(increase))
+		return false;
+
+	reserved += increase;
+	queue.SetMaxBytes(size);
+	return true;
+}
+
+
+/*!	Returns whether the system is at least at the warning level of memory
+	pressure. If it is, and \a queue is empty, the part of the budget it is
+	using is given back, and the queue returns to its initial size.
+*/
+bool
+shrink_buffer_on_pressure(BufferQueue& queue, size_t& reserved)
+{
+	if (buffer_budget_pressure() < B_LOW_RESOURCE_WARNING)
+		return false;
+
+	if (reserved == 0 || queue.Used() > 0)
+		return true;
+
+	queue.SetMaxBytes(queue.Size() - reserved);
+	unreserve_buffer_budget(reserved);
+	reserved = 0;
+	return true;
+}
+
+
+void
+dump_buffer_budget()
+{
+	kprintf("buffer budget: %lld of %lu bytes reserved, pressure %ld\n",
+		sReserved, sBudget, sPressure);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BUFFER_BUDGET_H
+#define BUFFER_BUDGET_H
+
+
+#include <SupportDefs.h>
+
+
+class BufferQueue;
+
+
+status_t init_buffer_budget();
+void uninit_buffer_budget();
+
+bool reserve_buffer_budget(size_t bytes);
+void unreserve_buffer_budget(size_t bytes);
+int32 buffer_budget_pressure();
+size_t buffer_budget_reserved();
+
+bool grow_buffer(BufferQueue& queue, size_t& reserved, size_t size);
+bool shrink_buffer_on_pressure(BufferQueue& queue, size_t& reserved);
+
+void dump_buffer_budget();
+
+
+#endif	// BUFFER_BUDGET_H
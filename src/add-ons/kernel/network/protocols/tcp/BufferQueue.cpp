@@ -9,6 +9,8 @@
 
 #include "BufferQueue.h"
 
+#include <string.h>
+
 #include <KernelExport.h>
 
 
@@ -427,6 +429,57 @@ BufferQueue::Available(tcp_sequence sequence) const
 }
 
 
+/*!	Fills \a blocks with the ranges of data that have been received out of
+	order, ie. those that follow the first hole in the queue, and returns
+	their number. As required by RFC 2018, the block containing \a recent,
+	the start of the most recently received segment, is always the first
+	one.
+*/
+int32
+BufferQueue::GetSackBlocks(tcp_sack* blocks, int32 maxBlocks,
+	tcp_sequence recent) const
+{
+	if (IsContiguous() || maxBlocks <= 0)
+		return 0;
+
+	tcp_sequence next = NextSequence();
+	int32 count = 0;
+
+	SegmentList::ConstIterator iterator = fList.GetIterator();
+	net_buffer* buffer = iterator.Next();
+	while (buffer != NULL) {
+		if (tcp_sequence(buffer->sequence) < next) {
+			buffer = iterator.Next();
+			continue;
+		}
+
+		// join all adjacent buffers to a single block
+		tcp_sequence start = buffer->sequence;
+		tcp_sequence end = start + buffer->size;
+		while ((buffer = iterator.Next()) != NULL
+			&& tcp_sequence(buffer->sequence) == end) {
+			end += buffer->size;
+		}
+
+		if (recent >= start && recent < end) {
+			// put this block first
+			if (count == maxBlocks)
+				count--;
+			memmove(&blocks[1], &blocks[0], count * sizeof(tcp_sack));
+			blocks[0].left_edge = start.Number();
+			blocks[0].right_edge = end.Number();
+			count++;
+		} else if (count < maxBlocks) {
+			blocks[count].left_edge = start.Number();
+			blocks[count].right_edge = end.Number();
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
 void
 BufferQueue::SetPushPointer()
 {
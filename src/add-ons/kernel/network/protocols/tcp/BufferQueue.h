@@ -40,6 +40,9 @@ public:
 			size_t				Available() const { return fContiguousBytes; }
 			size_t				Available(tcp_sequence sequence) const;
 
+			int32				GetSackBlocks(tcp_sack* blocks,
+									int32 maxBlocks, tcp_sequence recent) const;
+
 	inline	size_t				PushedData() const;
 			void				SetPushPointer();
 
@@ -0,0 +1,467 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "CongestionControl.h"
+
+#include <new>
+#include <string.h>
+
+#include <KernelExport.h>
+#include <OS.h>
+
+
+//#define TRACE_CONGESTION_CONTROL
+#ifdef TRACE_CONGESTION_CONTROL
+#	define TRACE(x...) dprintf(x)
+#else
+#	define TRACE(x...) ;
+#endif
+
+
+// CUBIC constants (RFC 9438), scaled by 1024
+static const uint64 kCubicBeta = 717;
+	// multiplicative window decrease factor, 0.7
+static const uint64 kCubicC = 410;
+	// window growth scaling factor, 0.4 segments/s^3
+static const uint64 kCubicAlpha = 542;
+	// Reno friendly additive increase, 3 * (1 - beta) / (1 + beta)
+
+// CUBIC computes time in units of 1/1024 seconds; this limits the
+// time the cubic function is evaluated at, so that it cannot overflow
+static const uint64 kCubicMaxTime = 1 << 17;
+
+
+struct congestion_control_algorithm {
+	const char*			name;
+	CongestionControl*	(*create)();
+};
+
+
+template<typename Algorithm> static CongestionControl*
+create_algorithm()
+{
+	return new(std::nothrow) Algorithm;
+}
+
+
+static const congestion_control_algorithm kAlgorithms[] = {
+	{"cubic", &create_algorithm<CubicCongestionControl>},
+	{"reno", &create_algorithm<RenoCongestionControl>},
+};
+static const int32 kAlgorithmCount
+	= sizeof(kAlgorithms) / sizeof(kAlgorithms[0]);
+
+static const congestion_control_algorithm* sDefaultAlgorithm = &kAlgorithms[0];
+
+
+static const congestion_control_algorithm*
+find_algorithm(const char* name)
+{
+	for (int32 i = 0; i < kAlgorithmCount; i++) {
+		if (!strcmp(kAlgorithms[i].name, name))
+			return &kAlgorithms[i];
+	}
+
+	return NULL;
+}
+
+
+/*!	Returns the integer cube root of \a value (from "Hacker's Delight"). */
+static uint64
+cube_root(uint64 value)
+{
+	uint64 root = 0;
+
+	for (int32 shift = 63; shift >= 0; shift -= 3) {
+		root += root;
+		uint64 bit = 3 * root * (root + 1) + 1;
+		if ((value >> shift) >= bit) {
+			value -= bit << shift;
+			root++;
+		}
+	}
+
+	return root;
+}
+
+
+//	#pragma mark - CongestionControl
+
+
+CongestionControl::CongestionControl()
+	:
+	fWindow(0),
+	fSlowStartThreshold(0),
+	fMaxSegmentSize(536)
+{
+}
+
+
+CongestionControl::~CongestionControl()
+{
+}
+
+
+void
+CongestionControl::Init(uint32 maxSegmentSize, uint32 slowStartThreshold)
+{
+	fMaxSegmentSize = maxSegmentSize;
+	fWindow = 2 * maxSegmentSize;
+	fSlowStartThreshold = slowStartThreshold;
+}
+
+
+/*!	Is called for every acknowledgement that acknowledges new data, outside
+	of loss recovery. \a flightSize is the amount of data that was in flight
+	before the acknowledgement arrived, and \a roundTripTime the smoothed
+	round trip time, or zero, if it is not known yet.
+*/
+void
+CongestionControl::Acknowledged(uint32 bytes, uint32 flightSize,
+	bigtime_t roundTripTime)
+{
+	if (InSlowStart())
+		fWindow += _SlowStart(bytes);
+}
+
+
+/*!	Is called when all data that was in flight when a loss was detected has
+	been acknowledged.
+*/
+void
+CongestionControl::RecoveryFinished()
+{
+	fWindow = fSlowStartThreshold;
+}
+
+
+/*!	Is called when the retransmit timer expired; the connection starts over
+	with slow start.
+*/
+void
+CongestionControl::Timeout(uint32 flightSize)
+{
+	Lost(flightSize);
+	fWindow = fMaxSegmentSize;
+}
+
+
+/*!	Returns the rate in bytes per second the endpoint should spread the
+	transmission of its data over, or zero if it should send as fast as the
+	windows allow.
+	By default, the window is sent over one round trip time, with some room
+	for growth: twice the rate in slow start, and 1.2 times the rate in
+	congestion avoidance.
+*/
+uint64
+CongestionControl::PacingRate(bigtime_t roundTripTime) const
+{
+	if (roundTripTime <= 0)
+		return 0;
+
+	uint64 rate = (uint64)fWindow * 1000000 / roundTripTime;
+	if (InSlowStart())
+		return rate * 2;
+
+	return rate + rate / 5;
+}
+
+
+/*!	Continues where \a other left off, when the algorithm of a connection is
+	changed.
+*/
+void
+CongestionControl::TakeOver(const CongestionControl& other)
+{
+	fWindow = other.fWindow;
+	fSlowStartThreshold = other.fSlowStartThreshold;
+	fMaxSegmentSize = other.fMaxSegmentSize;
+}
+
+
+void
+CongestionControl::SetMaxSegmentSize(uint32 maxSegmentSize)
+{
+	fMaxSegmentSize = maxSegmentSize;
+}
+
+
+/*!	Temporarily grows the window during fast recovery, as every duplicate
+	acknowledgement tells us that another segment has left the network
+	(RFC 5681, section 3.2).
+*/
+void
+CongestionControl::InflateWindow(uint32 bytes)
+{
+	fWindow += bytes;
+}
+
+
+/*!	Creates an instance of the algorithm with the given \a name, or of the
+	default algorithm if \a name is \c NULL.
+*/
+/*static*/ CongestionControl*
+CongestionControl::Create(const char* name)
+{
+	const congestion_control_algorithm* algorithm = sDefaultAlgorithm;
+	if (name != NULL) {
+		algorithm = find_algorithm(name);
+		if (algorithm == NULL)
+			return NULL;
+	}
+
+	return algorithm->create();
+}
+
+
+/*static*/ status_t
+CongestionControl::SetDefault(const char* name)
+{
+	const congestion_control_algorithm* algorithm = find_algorithm(name);
+	if (algorithm == NULL)
+		return B_NAME_NOT_FOUND;
+
+	TRACE("tcp: default congestion control is now %s\n", name);
+	sDefaultAlgorithm = algorithm;
+	return B_OK;
+}
+
+
+/*static*/ const char*
+CongestionControl::Default()
+{
+	return sDefaultAlgorithm->name;
+}
+
+
+/*static*/ bool
+CongestionControl::Exists(const char* name)
+{
+	return find_algorithm(name) != NULL;
+}
+
+
+/*!	Returns by how much the window grows in slow start when \a bytes have
+	been acknowledged; this uses appropriate byte counting with a limit of
+	two segments per acknowledgement (RFC 3465), so that delayed
+	acknowledgements don't slow down the growth.
+*/
+uint32
+CongestionControl::_SlowStart(uint32 bytes)
+{
+	return min_c(bytes, 2 * fMaxSegmentSize);
+}
+
+
+//	#pragma mark - Reno
+
+
+RenoCongestionControl::RenoCongestionControl()
+	:
+	fAcknowledgedCredit(0)
+{
+}
+
+
+const char*
+RenoCongestionControl::Name() const
+{
+	return "reno";
+}
+
+
+void
+RenoCongestionControl::Acknowledged(uint32 bytes, uint32 flightSize,
+	bigtime_t roundTripTime)
+{
+	if (InSlowStart()) {
+		fWindow += _SlowStart(bytes);
+		return;
+	}
+
+	// grow by one segment per window of acknowledged data
+	fAcknowledgedCredit += (uint64)bytes * fMaxSegmentSize;
+	if (fAcknowledgedCredit >= fWindow) {
+		uint32 increment = fAcknowledgedCredit / fWindow;
+		fAcknowledgedCredit -= (uint64)increment * fWindow;
+		fWindow += increment;
+	}
+}
+
+
+void
+RenoCongestionControl::Lost(uint32 flightSize)
+{
+	fSlowStartThreshold = max_c(flightSize / 2, 2 * fMaxSegmentSize);
+	fWindow = fSlowStartThreshold;
+	fAcknowledgedCredit = 0;
+}
+
+
+/*!	Reno relies on the acknowledgements alone to clock out its data. */
+uint64
+RenoCongestionControl::PacingRate(bigtime_t roundTripTime) const
+{
+	return 0;
+}
+
+
+//	#pragma mark - CUBIC
+
+
+CubicCongestionControl::CubicCongestionControl()
+	:
+	fEpochStart(0),
+	fMaxWindow(0),
+	fOriginWindow(0),
+	fEstimatedWindow(0),
+	fTimeToOrigin(0),
+	fAcknowledgedCredit(0),
+	fEstimateCredit(0)
+{
+}
+
+
+const char*
+CubicCongestionControl::Name() const
+{
+	return "cubic";
+}
+
+
+void
+CubicCongestionControl::Init(uint32 maxSegmentSize, uint32 slowStartThreshold)
+{
+	CongestionControl::Init(maxSegmentSize, slowStartThreshold);
+
+	fEpochStart = 0;
+	fMaxWindow = 0;
+}
+
+
+void
+CubicCongestionControl::Acknowledged(uint32 bytes, uint32 flightSize,
+	bigtime_t roundTripTime)
+{
+	if (InSlowStart()) {
+		fWindow += _SlowStart(bytes);
+		return;
+	}
+
+	bigtime_t now = system_time();
+	if (fEpochStart == 0) {
+		// start a new congestion avoidance epoch
+		fEpochStart = now;
+		fEstimatedWindow = fWindow;
+		fAcknowledgedCredit = 0;
+		fEstimateCredit = 0;
+
+		if (fWindow < fMaxWindow) {
+			// K = cbrt((W_max - cwnd) / C), in 1/1024 seconds
+			uint64 segments = (fMaxWindow - fWindow) / fMaxSegmentSize;
+			fTimeToOrigin = cube_root((segments << 40) / kCubicC)
+				* 1000000 / 1024;
+			fOriginWindow = fMaxWindow;
+		} else {
+			fTimeToOrigin = 0;
+			fOriginWindow = fWindow;
+		}
+	}
+
+	// the window should reach W_cubic(t + RTT) one round trip from now,
+	// but never grow faster than by half of itself per round trip
+	uint32 target = _CubicWindow(now - fEpochStart + roundTripTime);
+	if (target > fWindow + fWindow / 2)
+		target = fWindow + fWindow / 2;
+
+	if (target > fWindow)
+		fAcknowledgedCredit += (uint64)(target - fWindow) * bytes;
+	else
+		fAcknowledgedCredit += (uint64)bytes * fMaxSegmentSize / 100;
+
+	// Reno friendly region: estimate what Reno would have achieved
+	uint64 alpha = fEstimatedWindow >= fOriginWindow ? 1024 : kCubicAlpha;
+	fEstimateCredit += (uint64)bytes * fMaxSegmentSize * alpha / 1024;
+	if (fEstimateCredit >= fWindow) {
+		uint32 increment = fEstimateCredit / fWindow;
+		fEstimateCredit -= (uint64)increment * fWindow;
+		fEstimatedWindow += increment;
+	}
+
+	if (fAcknowledgedCredit >= fWindow) {
+		uint32 increment = fAcknowledgedCredit / fWindow;
+		fAcknowledgedCredit -= (uint64)increment * fWindow;
+		fWindow += increment;
+	}
+
+	if (fEstimatedWindow > fWindow)
+		fWindow = fEstimatedWindow;
+
+	TRACE("cubic: cwnd %lu, target %lu, W_max %lu, W_est %lu\n", fWindow,
+		target, fMaxWindow, fEstimatedWindow);
+}
+
+
+void
+CubicCongestionControl::Lost(uint32 flightSize)
+{
+	_Reduce();
+}
+
+
+void
+CubicCongestionControl::Timeout(uint32 flightSize)
+{
+	// Further timeouts for the same data must not reduce W_max again
+	if (fWindow > fMaxSegmentSize)
+		_Reduce();
+
+	fWindow = fMaxSegmentSize;
+}
+
+
+void
+CubicCongestionControl::_Reduce()
+{
+	fEpochStart = 0;
+
+	// fast convergence: if the window did not reach the previous maximum,
+	// release bandwidth for other flows
+	if (fWindow < fMaxWindow)
+		fMaxWindow = fWindow * (1024 + kCubicBeta) / 2048;
+	else
+		fMaxWindow = fWindow;
+
+	fSlowStartThreshold = max_c((uint32)(fWindow * kCubicBeta / 1024),
+		2 * fMaxSegmentSize);
+	fWindow = fSlowStartThreshold;
+}
+
+
+/*!	Returns W_cubic(t) = C * (t - K)^3 + W_max in bytes, with \a time being
+	the time since the start of the current epoch.
+*/
+uint32
+CubicCongestionControl::_CubicWindow(bigtime_t time) const
+{
+	bool beforeOrigin = time < fTimeToOrigin;
+	uint64 delta = beforeOrigin ? fTimeToOrigin - time : time - fTimeToOrigin;
+	delta = delta * 1024 / 1000000;
+	if (delta > kCubicMaxTime)
+		delta = kCubicMaxTime;
+
+	uint64 offset = (((kCubicC * delta * delta * delta) >> 20)
+		* fMaxSegmentSize) >> 20;
+
+	if (beforeOrigin) {
+		if (offset + fMaxSegmentSize >= fOriginWindow)
+			return fMaxSegmentSize;
+		return fOriginWindow - offset;
+	}
+
+	offset += fOriginWindow;
+	return offset < 0xffffffffUL ? offset : 0xffffffffUL;
+}
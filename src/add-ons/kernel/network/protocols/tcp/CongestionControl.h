@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef CONGESTION_CONTROL_H
+#define CONGESTION_CONTROL_H
+
+
+#include <SupportDefs.h>
+
+
+/*!	Base class of the congestion control algorithms a TCPEndpoint can use.
+	It owns the congestion window and the slow start threshold; the endpoint
+	reports the events that may change them, and uses Window() to limit the
+	amount of data in flight.
+	The base class implements standard slow start (RFC 5681, with the
+	appropriate byte counting of RFC 3465), while the subclasses implement
+	the congestion avoidance phase, and the reaction to loss.
+*/
+class CongestionControl {
+public:
+								CongestionControl();
+	virtual						~CongestionControl();
+
+	virtual	const char*			Name() const = 0;
+
+	virtual	void				Init(uint32 maxSegmentSize,
+									uint32 slowStartThreshold);
+	virtual	void				Acknowledged(uint32 bytes, uint32 flightSize,
+									bigtime_t roundTripTime);
+	virtual	void				Lost(uint32 flightSize) = 0;
+	virtual	void				RecoveryFinished();
+	virtual	void				Timeout(uint32 flightSize);
+	virtual	uint64				PacingRate(bigtime_t roundTripTime) const;
+
+			void				TakeOver(const CongestionControl& other);
+			void				SetMaxSegmentSize(uint32 maxSegmentSize);
+			void				InflateWindow(uint32 bytes);
+
+			uint32				Window() const { return fWindow; }
+			uint32				SlowStartThreshold() const
+									{ return fSlowStartThreshold; }
+			bool				InSlowStart() const
+									{ return fWindow < fSlowStartThreshold; }
+
+	static	CongestionControl*	Create(const char* name);
+	static	status_t			SetDefault(const char* name);
+	static	const char*			Default();
+	static	bool				Exists(const char* name);
+
+protected:
+			uint32				_SlowStart(uint32 bytes);
+
+protected:
+			uint32				fWindow;
+			uint32				fSlowStartThreshold;
+			uint32				fMaxSegmentSize;
+};
+
+
+/*!	The classic additive increase, multiplicative decrease algorithm of
+	RFC 5681: the window grows by one segment per round trip, and is halved
+	on loss.
+*/
+class RenoCongestionControl : public CongestionControl {
+public:
+								RenoCongestionControl();
+
+	virtual	const char*			Name() const;
+
+	virtual	void				Acknowledged(uint32 bytes, uint32 flightSize,
+									bigtime_t roundTripTime);
+	virtual	void				Lost(uint32 flightSize);
+	virtual	uint64				PacingRate(bigtime_t roundTripTime) const;
+
+private:
+			uint64				fAcknowledgedCredit;
+};
+
+
+/*!	CUBIC (RFC 9438): after a loss, the window grows along a cubic function
+	of the time since the loss, which quickly gets back close to the window
+	at which the loss occurred, and then probes carefully beyond it. As the
+	growth does not depend on the round trip time, it makes much better use
+	of long, fast links than Reno does.
+*/
+class CubicCongestionControl : public CongestionControl {
+public:
+								CubicCongestionControl();
+
+	virtual	const char*			Name() const;
+
+	virtual	void				Init(uint32 maxSegmentSize,
+									uint32 slowStartThreshold);
+	virtual	void				Acknowledged(uint32 bytes, uint32 flightSize,
+									bigtime_t roundTripTime);
+	virtual	void				Lost(uint32 flightSize);
+	virtual	void				Timeout(uint32 flightSize);
+
+private:
+			void				_Reduce();
+			uint32				_CubicWindow(bigtime_t time) const;
+
+private:
+			bigtime_t			fEpochStart;
+			uint32				fMaxWindow;
+			uint32				fOriginWindow;
+			uint32				fEstimatedWindow;
+			bigtime_t			fTimeToOrigin;
+			uint64				fAcknowledgedCredit;
+			uint64				fEstimateCredit;
+};
+
+
+#endif	// CONGESTION_CONTROL_H
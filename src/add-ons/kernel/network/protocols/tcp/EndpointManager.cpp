@@ -255,6 +255,60 @@ EndpointManager::_LookupConnection(const sockaddr* local, const sockaddr* peer)
 }
 
 
+/*!	If other listeners share the address of \a listener via SO_REUSEPORT,
+	this chooses one of them by the hash of the connection, so that all
+	segments of a connection end up at the same listener.
+	You must hold the manager's lock when calling this method (either read or
+	write).
+*/
+TCPEndpoint*
+EndpointManager::_SelectListener(TCPEndpoint* listener, const sockaddr* local,
+	const sockaddr* peer)
+{
+	if (listener->fReusePortNext == NULL)
+		return listener;
+
+	uint32 count = 1;
+	for (TCPEndpoint* next = listener->fReusePortNext; next != listener;
+			next = next->fReusePortNext) {
+		count++;
+	}
+
+	uint32 hash = AddressModule()->hash_address_pair(local, peer);
+	uint32 index = (hash ^ (hash >> 16)) % count;
+
+	while (index-- > 0)
+		listener = listener->fReusePortNext;
+
+	return listener;
+}
+
+
+/*!	Removes the passive \a endpoint from the connection hash, or from the
+	listeners sharing its address.
+	You must have fLock write locked when calling this method.
+*/
+void
+EndpointManager::_RemoveListener(TCPEndpoint* endpoint)
+{
+	TCPEndpoint* previous = endpoint;
+	while (previous->fReusePortNext != endpoint)
+		previous = previous->fReusePortNext;
+
+	previous->fReusePortNext = endpoint->fReusePortNext;
+	if (previous->fReusePortNext == previous)
+		previous->fReusePortNext = NULL;
+	endpoint->fReusePortNext = NULL;
+
+	if (_LookupConnection(*endpoint->LocalAddress(), *endpoint->PeerAddress())
+			== endpoint) {
+		// another listener now represents the group in the hash
+		fConnectionHash.Remove(endpoint);
+		fConnectionHash.Insert(previous);
+	}
+}
+
+
 status_t
 EndpointManager::SetConnection(TCPEndpoint* endpoint, const sockaddr* _local,
 	const sockaddr* peer, const sockaddr* interfaceLocal)
@@ -294,6 +348,7 @@ EndpointManager::SetPassive(TCPEndpoint* endpoint)
 		SocketAddressStorage local(AddressModule());
 		local.SetToEmpty();
 
+		endpoint->fOwner = geteuid();
 		status_t status = _BindToEphemeral(endpoint, *local);
 		if (status < B_OK)
 			return status;
@@ -302,8 +357,22 @@ EndpointManager::SetPassive(TCPEndpoint* endpoint)
 	SocketAddressStorage passive(AddressModule());
 	passive.SetToEmpty();
 
-	if (_LookupConnection(*endpoint->LocalAddress(), *passive))
-		return EADDRINUSE;
+	TCPEndpoint* listener = _LookupConnection(*endpoint->LocalAddress(),
+		*passive);
+	if (listener != NULL) {
+		if ((endpoint->socket->options & SO_REUSEPORT) == 0
+			|| (listener->socket->options & SO_REUSEPORT) == 0
+			|| endpoint->fOwner != listener->fOwner)
+			return EADDRINUSE;
+
+		// join the listeners sharing this address
+		endpoint->PeerAddress().SetTo(*passive);
+		if (listener->fReusePortNext == NULL)
+			listener->fReusePortNext = listener;
+		endpoint->fReusePortNext = listener->fReusePortNext;
+		listener->fReusePortNext = endpoint;
+		return B_OK;
+	}
 
 	endpoint->PeerAddress().SetTo(*passive);
 	fConnectionHash.Insert(endpoint);
@@ -331,6 +400,7 @@ EndpointManager::FindConnection(sockaddr* local, sockaddr* peer)
 
 	endpoint = _LookupConnection(local, *wildcard);
 	if (endpoint != NULL) {
+		endpoint = _SelectListener(endpoint, local, peer);
 		TRACE(("TCP: Received packet corresponds to wildcard endpoint %p\n",
 			endpoint));
 		if (gSocketModule->acquire_socket(endpoint->socket))
@@ -343,6 +413,7 @@ EndpointManager::FindConnection(sockaddr* local, sockaddr* peer)
 
 	endpoint = _LookupConnection(*localWildcard, *wildcard);
 	if (endpoint != NULL) {
+		endpoint = _SelectListener(endpoint, local, peer);
 		TRACE(("TCP: Received packet corresponds to local wildcard endpoint "
 			"%p\n", endpoint));
 		if (gSocketModule->acquire_socket(endpoint->socket))
@@ -368,6 +439,8 @@ EndpointManager::Bind(TCPEndpoint* endpoint, const sockaddr* address)
 
 	WriteLocker locker(fLock);
 
+	endpoint->fOwner = geteuid();
+
 	if (AddressModule()->get_port(address) == 0)
 		return _BindToEphemeral(endpoint, address);
 
@@ -431,6 +504,13 @@ EndpointManager::_BindToAddress(WriteLocker& locker, TCPEndpoint* endpoint,
 					break;
 				}
 
+				if ((endpoint->socket->options & SO_REUSEPORT) != 0
+					&& (user->socket->options & SO_REUSEPORT) != 0
+					&& endpoint->fOwner == user->fOwner) {
+					// both want to share the address, ie. to listen on it
+					continue;
+				}
+
 				if ((endpoint->socket->options & SO_REUSEADDR) == 0)
 					return EADDRINUSE;
 
@@ -520,7 +600,10 @@ EndpointManager::Unbind(TCPEndpoint* endpoint)
 	if (!fEndpointHash.Remove(endpoint))
 		panic("bound endpoint %p not in hash!", endpoint);
 
-	fConnectionHash.Remove(endpoint);
+	if (endpoint->fReusePortNext != NULL)
+		_RemoveListener(endpoint);
+	else
+		fConnectionHash.Remove(endpoint);
 
 	(*endpoint->LocalAddress())->sa_len = 0;
 
@@ -97,6 +97,9 @@ public:
 private:
 			TCPEndpoint*	_LookupConnection(const sockaddr* local,
 								const sockaddr* peer);
+			TCPEndpoint*	_SelectListener(TCPEndpoint* listener,
+								const sockaddr* local, const sockaddr* peer);
+			void			_RemoveListener(TCPEndpoint* endpoint);
 			status_t		_Bind(TCPEndpoint* endpoint,
 								const sockaddr* address);
 			status_t		_BindToAddress(WriteLocker& locker,
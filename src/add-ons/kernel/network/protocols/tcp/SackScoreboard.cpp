@@ -0,0 +1,268 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SackScoreboard.h"
+
+#include <string.h>
+
+#include <KernelExport.h>
+
+
+SackScoreboard::SackScoreboard()
+{
+	Reset(0);
+}
+
+
+/*!	Forgets everything, and starts over with \a sequence as the first
+	unacknowledged sequence number.
+*/
+void
+SackScoreboard::Reset(tcp_sequence sequence)
+{
+	fSackedCount = 0;
+	fSackedBytes = 0;
+	fHighestSacked = sequence;
+	fRecordCount = 0;
+	fRecordStart = sequence;
+}
+
+
+/*!	Removes all information about data up to \a sequence, as it has been
+	cumulatively acknowledged.
+*/
+void
+SackScoreboard::RemoveUntil(tcp_sequence sequence)
+{
+	int32 removed = 0;
+	while (removed < fSackedCount && fSacked[removed].end <= sequence) {
+		fSackedBytes -= (fSacked[removed].end - fSacked[removed].start)
+			.Number();
+		removed++;
+	}
+	if (removed > 0) {
+		fSackedCount -= removed;
+		memmove(&fSacked[0], &fSacked[removed],
+			fSackedCount * sizeof(sacked_range));
+	}
+	if (fSackedCount > 0 && fSacked[0].start < sequence) {
+		fSackedBytes -= (sequence - fSacked[0].start).Number();
+		fSacked[0].start = sequence;
+	}
+	if (fHighestSacked < sequence)
+		fHighestSacked = sequence;
+
+	if (fRecordCount == 0 || sequence <= fRecordStart) {
+		fRecordStart = sequence;
+		return;
+	}
+
+	removed = 0;
+	while (removed < fRecordCount && fRecords[removed].end <= sequence)
+		removed++;
+	if (removed > 0) {
+		fRecordCount -= removed;
+		memmove(&fRecords[0], &fRecords[removed],
+			fRecordCount * sizeof(transmit_record));
+	}
+	fRecordStart = sequence;
+}
+
+
+/*!	Marks the range from \a start to \a end as having been received by the
+	peer. The caller is responsible for only passing in ranges that are
+	within the data currently in flight.
+*/
+void
+SackScoreboard::AddSacked(tcp_sequence start, tcp_sequence end)
+{
+	if (start >= end)
+		return;
+
+	if (fHighestSacked < end)
+		fHighestSacked = end;
+
+	// find the first range that overlaps with or follows the new one
+	int32 index = 0;
+	while (index < fSackedCount && fSacked[index].end < start)
+		index++;
+
+	// merge all ranges the new one touches
+	int32 last = index;
+	while (last < fSackedCount && fSacked[last].start <= end) {
+		if (fSacked[last].start < start)
+			start = fSacked[last].start;
+		if (fSacked[last].end > end)
+			end = fSacked[last].end;
+
+		fSackedBytes -= (fSacked[last].end - fSacked[last].start).Number();
+		last++;
+	}
+
+	int32 merged = last - index;
+	if (merged == 0) {
+		if (fSackedCount == kMaxSackedRanges) {
+			// We're out of space: forgetting about a range only means we
+			// retransmit more than needed, so we drop the highest one
+			if (index == fSackedCount)
+				return;
+
+			fSackedCount--;
+			fSackedBytes -= (fSacked[fSackedCount].end
+				- fSacked[fSackedCount].start).Number();
+		}
+
+		memmove(&fSacked[index + 1], &fSacked[index],
+			(fSackedCount - index) * sizeof(sacked_range));
+		fSackedCount++;
+	} else if (merged > 1) {
+		memmove(&fSacked[index + 1], &fSacked[last],
+			(fSackedCount - last) * sizeof(sacked_range));
+		fSackedCount -= merged - 1;
+	}
+
+	fSacked[index].start = start;
+	fSacked[index].end = end;
+	fSackedBytes += (end - start).Number();
+}
+
+
+/*!	Forgets all selective acknowledgements, as the peer is allowed to discard
+	data it has selectively acknowledged before (RFC 2018, section 8).
+*/
+void
+SackScoreboard::ClearSacked()
+{
+	fSackedCount = 0;
+	fSackedBytes = 0;
+	fHighestSacked = fRecordStart;
+}
+
+
+/*!	Moves \a sequence past any selectively acknowledged data, and returns the
+	number of bytes from there that are missing at the peer, up to \a end.
+*/
+uint32
+SackScoreboard::NextUnsacked(tcp_sequence& sequence, tcp_sequence end) const
+{
+	for (int32 i = 0; i < fSackedCount; i++) {
+		const sacked_range& range = fSacked[i];
+		if (range.end <= sequence)
+			continue;
+		if (range.start <= sequence) {
+			sequence = range.end;
+			continue;
+		}
+
+		tcp_sequence holeEnd = range.start < end ? range.start : end;
+		return sequence < holeEnd ? (holeEnd - sequence).Number() : 0;
+	}
+
+	return sequence < end ? (end - sequence).Number() : 0;
+}
+
+
+/*!	Returns the number of bytes between \a start and \a end that have not
+	been selectively acknowledged.
+*/
+uint32
+SackScoreboard::UnsackedBytes(tcp_sequence start, tcp_sequence end) const
+{
+	if (start >= end)
+		return 0;
+
+	uint32 bytes = (end - start).Number();
+
+	for (int32 i = 0; i < fSackedCount; i++) {
+		const sacked_range& range = fSacked[i];
+		tcp_sequence overlapStart = range.start > start ? range.start : start;
+		tcp_sequence overlapEnd = range.end < end ? range.end : end;
+		if (overlapStart < overlapEnd)
+			bytes -= (overlapEnd - overlapStart).Number();
+	}
+
+	return bytes;
+}
+
+
+/*!	Records that the range from \a start to \a end has been (re)transmitted
+	at \a when.
+*/
+void
+SackScoreboard::Sent(tcp_sequence start, tcp_sequence end, bigtime_t when)
+{
+	if (start >= end)
+		return;
+
+	if (fRecordCount == 0)
+		fRecordStart = start;
+
+	tcp_sequence recordEnd = fRecordCount > 0
+		? fRecords[fRecordCount - 1].end : fRecordStart;
+
+	if (start < recordEnd) {
+		// this is a retransmission - update all records it touches
+		tcp_sequence recordStart = fRecordStart;
+		for (int32 i = 0; i < fRecordCount; i++) {
+			if (fRecords[i].end > start && recordStart < end)
+				fRecords[i].time = when;
+			recordStart = fRecords[i].end;
+		}
+
+		if (end <= recordEnd)
+			return;
+	}
+
+	if (fRecordCount == kMaxTransmitRecords) {
+		// Halve the resolution of the newer half by merging neighbouring
+		// records, as the oldest data is the most likely to be lost; using
+		// the later time of the two can only delay loss detection.
+		const int32 kFirst = kMaxTransmitRecords / 2;
+		for (int32 i = 0; i < kMaxTransmitRecords / 4; i++) {
+			transmit_record& first = fRecords[kFirst + i * 2];
+			transmit_record& second = fRecords[kFirst + i * 2 + 1];
+			fRecords[kFirst + i].end = second.end;
+			fRecords[kFirst + i].time = max_c(first.time, second.time);
+		}
+		fRecordCount = kFirst + kMaxTransmitRecords / 4;
+	}
+
+	fRecords[fRecordCount].end = end;
+	fRecords[fRecordCount].time = when;
+	fRecordCount++;
+}
+
+
+/*!	Returns when the data at \a sequence has last been transmitted, or zero
+	if that is not known.
+*/
+bigtime_t
+SackScoreboard::SentTime(tcp_sequence sequence) const
+{
+	if (fRecordCount == 0 || sequence < fRecordStart)
+		return 0;
+
+	for (int32 i = 0; i < fRecordCount; i++) {
+		if (sequence < fRecords[i].end)
+			return fRecords[i].time;
+	}
+
+	return 0;
+}
+
+
+void
+SackScoreboard::Dump() const
+{
+	kprintf("    sacked: %lu bytes, highest %lu\n", fSackedBytes,
+		fHighestSacked.Number());
+	for (int32 i = 0; i < fSackedCount; i++) {
+		kprintf("      %lu - %lu\n", fSacked[i].start.Number(),
+			fSacked[i].end.Number());
+	}
+	kprintf("    transmit records: %ld from %lu\n", fRecordCount,
+		fRecordStart.Number());
+}
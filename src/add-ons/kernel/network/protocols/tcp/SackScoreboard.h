@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SACK_SCOREBOARD_H
+#define SACK_SCOREBOARD_H
+
+
+#include "tcp.h"
+
+
+/*!	Keeps track of the state of the data in the send queue that has been
+	sent, but not yet cumulatively acknowledged: which ranges the peer has
+	selectively acknowledged (RFC 2018, RFC 6675), and when each range has
+	last been transmitted (for RACK style loss detection).
+	Both lists are of fixed size; when they run full, information is merged
+	or dropped in a way that can only cause additional retransmissions, but
+	never lose data.
+*/
+class SackScoreboard {
+public:
+								SackScoreboard();
+
+			void				Reset(tcp_sequence sequence);
+			void				RemoveUntil(tcp_sequence sequence);
+
+			void				AddSacked(tcp_sequence start,
+									tcp_sequence end);
+			void				ClearSacked();
+
+			size_t				SackedBytes() const { return fSackedBytes; }
+			tcp_sequence		HighestSacked() const
+									{ return fHighestSacked; }
+			bool				HasSacked() const { return fSackedCount > 0; }
+
+			uint32				NextUnsacked(tcp_sequence& sequence,
+									tcp_sequence end) const;
+			uint32				UnsackedBytes(tcp_sequence start,
+									tcp_sequence end) const;
+
+			void				Sent(tcp_sequence start, tcp_sequence end,
+									bigtime_t when);
+			bigtime_t			SentTime(tcp_sequence sequence) const;
+
+			void				Dump() const;
+
+private:
+	enum {
+		kMaxSackedRanges		= 8,
+		kMaxTransmitRecords		= 32
+	};
+
+	struct sacked_range {
+		tcp_sequence	start;
+		tcp_sequence	end;
+	};
+
+	struct transmit_record {
+		tcp_sequence	end;
+		bigtime_t		time;
+	};
+
+			sacked_range		fSacked[kMaxSackedRanges];
+			int32				fSackedCount;
+			size_t				fSackedBytes;
+			tcp_sequence		fHighestSacked;
+
+			transmit_record		fRecords[kMaxTransmitRecords];
+			int32				fRecordCount;
+			tcp_sequence		fRecordStart;
+};
+
+
+#endif	// SACK_SCOREBOARD_H
@@ -34,6 +34,7 @@
 #include <util/khash.h>
 #include <util/list.h>
 
+#include "BufferBudget.h"
 #include "EndpointManager.h"
 
 
@@ -41,6 +42,10 @@
 //  - RFC 793 - Transmission Control Protocol
 //  - RFC 813 - Window and Acknowledgement Strategy in TCP
 //	- RFC 1337 - TIME_WAIT Assassination Hazards in TCP
+//	- RFC 2018 - TCP Selective Acknowledgment Options
+//	- RFC 6675 - A Conservative Loss Recovery Algorithm Based on Selective
+//	  Acknowledgment (SACK) for TCP
+//	- RFC 8985 - The RACK-TLP Loss Detection Algorithm for TCP (RACK part only)
 //
 // Things this implementation currently doesn't implement:
 //	- TCP Slow Start, Congestion Avoidance, Fast Retransmit, and Fast Recovery,
@@ -49,7 +54,7 @@
 //	- Explicit Congestion Notification (ECN), RFC 3168
 //	- SYN-Cache
 //	- TCP Extensions for High Performance, RFC 1323
-//	- SACK, Selective Acknowledgment - RFC 2018, RFC 2883, RFC 3517
+//	- Duplicate SACK, RFC 2883
 //	- Forward RTO-Recovery, RFC 4138
 //	- Time-Wait hash instead of keeping sockets alive
 
@@ -73,7 +78,8 @@
 	dprintf("TCP PROBE %llu %s %s %ld snxt %lu suna %lu cw %lu sst %lu win %lu swin %lu smax-suna %lu savail %lu sqused %lu rto %llu\n", \
 		system_time(), PrintAddress(buffer->source), \
 		PrintAddress(buffer->destination), buffer->size, fSendNext.Number(), \
-		fSendUnacknowledged.Number(), fCongestionWindow, fSlowStartThreshold, \
+		fSendUnacknowledged.Number(), fCongestionControl->Window(), \
+		fCongestionControl->SlowStartThreshold(), \
 		window, fSendWindow, (fSendMax - fSendUnacknowledged).Number(), \
 		fSendQueue.Available(fSendNext), fSendQueue.Used(), fRetransmitTimeout)
 #else
@@ -265,12 +271,30 @@ enum {
 	FLAG_NO_RECEIVE				= 0x04,
 	FLAG_CLOSED					= 0x08,
 	FLAG_DELETE_ON_CLOSE		= 0x10,
-	FLAG_LOCAL					= 0x20
+	FLAG_LOCAL					= 0x20,
+	FLAG_OPTION_SACK_PERMITTED	= 0x40,
+	FLAG_RECOVERY				= 0x80,
+	FLAG_ROUND_TRIP_MEASURED	= 0x100,
+	FLAG_FIXED_SEND_BUFFER		= 0x200,
+	FLAG_FIXED_RECEIVE_BUFFER	= 0x400
 };
 
 
 static const int kTimestampFactor = 1024;
 
+// Pacing still allows sending bursts of this duration at once
+static const bigtime_t kPacingBurstTime = 1000;
+
+// The send and receive buffers grow automatically up to this size, unless
+// they have been set explicitly via SO_SNDBUF, or SO_RCVBUF
+static const size_t kMaxAutoSendBufferSize = 4 * 1024 * 1024;
+static const size_t kMaxAutoReceiveBufferSize = 4 * 1024 * 1024;
+
+// Segments may be sent in chunks of up to this size, and are split into
+// segments of the maximum segment size by the stack (segmentation offload);
+// this leaves room for the IP and TCP headers in a 64 KB IP packet.
+static const uint32 kMaxOffloadSize = 65535 - 128;
+
 
 static inline bigtime_t
 absolute_timeout(bigtime_t timeout)
@@ -429,6 +453,9 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	fSendQueue(socket->send.buffer_size),
 	fInitialSendSequence(0),
 	fDuplicateAcknowledgeCount(0),
+	fRecoveryPoint(0),
+	fRetransmitNext(0),
+	fDeliveredSentTime(0),
 	fRoute(NULL),
 	fReceiveNext(0),
 	fReceiveMaxAdvertised(0),
@@ -439,15 +466,25 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	fRoundTripDeviation(TCP_INITIAL_RTT / kTimestampFactor),
 	fRetransmitTimeout(TCP_INITIAL_RTT),
 	fReceivedTimestamp(0),
-	fCongestionWindow(0),
-	fSlowStartThreshold(0),
+	fCongestionControl(CongestionControl::Create(NULL)),
+	fPacingNextSend(0),
+	fSendBufferReserved(0),
+	fReceiveBufferReserved(0),
+	fReceiveRoundTripTime(0),
+	fReadMeasureStart(0),
+	fReadMeasureBytes(0),
 	fState(CLOSED),
-	fFlags(FLAG_OPTION_WINDOW_SCALE | FLAG_OPTION_TIMESTAMP)
+	fFlags(FLAG_OPTION_WINDOW_SCALE | FLAG_OPTION_TIMESTAMP
+		| FLAG_OPTION_SACK_PERMITTED)
 {
 	// TODO: to be replaced with a real read/write locking strategy!
 	mutex_init(&fLock, "tcp lock");
 
+	fReusePortNext = NULL;
+	fOwner = (uid_t)-1;
+
 	gStackModule->init_timer(&fPersistTimer, TCPEndpoint::_PersistTimer, this);
+	gStackModule->init_timer(&fPacingTimer, TCPEndpoint::_PacingTimer, this);
 	gStackModule->init_timer(&fRetransmitTimer, TCPEndpoint::_RetransmitTimer,
 		this);
 	gStackModule->init_timer(&fDelayedAcknowledgeTimer,
@@ -474,10 +511,14 @@ TCPEndpoint::~TCPEndpoint()
 	// we need to wait for all timers to return
 	gStackModule->wait_for_timer(&fRetransmitTimer);
 	gStackModule->wait_for_timer(&fPersistTimer);
+	gStackModule->wait_for_timer(&fPacingTimer);
 	gStackModule->wait_for_timer(&fDelayedAcknowledgeTimer);
 	gStackModule->wait_for_timer(&fTimeWaitTimer);
 
 	gDatalinkModule->put_route(Domain(), fRoute);
+
+	_ReleaseBuffers();
+	delete fCongestionControl;
 }
 
 
@@ -490,6 +531,9 @@ TCPEndpoint::InitCheck() const
 	if (fSendList.InitCheck() < B_OK)
 		return fSendList.InitCheck();
 
+	if (fCongestionControl == NULL)
+		return B_NO_MEMORY;
+
 	return B_OK;
 }
 
@@ -888,6 +932,11 @@ TCPEndpoint::FillStat(net_stat *stat)
 	strlcpy(stat->state, name_for_state(fState), sizeof(stat->state));
 	stat->receive_queue_size = fReceiveQueue.Available();
 	stat->send_queue_size = fSendQueue.Used();
+	stat->receive_buffer_size = fReceiveQueue.Size();
+	stat->send_buffer_size = fSendQueue.Size();
+	stat->round_trip_time = _RoundTripTime();
+	if (stat->round_trip_time == 0)
+		stat->round_trip_time = fReceiveRoundTripTime;
 
 	return B_OK;
 }
@@ -978,6 +1027,9 @@ TCPEndpoint::ReadData(size_t numBytes, uint32 flags, net_buffer** _buffer)
 
 	TRACE("  ReadData(): %lu bytes kept.", fReceiveQueue.Available());
 
+	if (!clone && receivedBytes > 0)
+		_TuneReceiveBuffer(receivedBytes);
+
 	// if we are opening the window, check if we should send an ACK
 	if (!clone)
 		SendAcknowledge(false);
@@ -1002,6 +1054,10 @@ TCPEndpoint::SetSendBufferSize(size_t length)
 {
 	MutexLocker _(fLock);
 	fSendQueue.SetMaxBytes(length);
+	fFlags |= FLAG_FIXED_SEND_BUFFER;
+
+	unreserve_buffer_budget(fSendBufferReserved);
+	fSendBufferReserved = 0;
 	return B_OK;
 }
 
@@ -1011,6 +1067,10 @@ TCPEndpoint::SetReceiveBufferSize(size_t length)
 {
 	MutexLocker _(fLock);
 	fReceiveQueue.SetMaxBytes(length);
+	fFlags |= FLAG_FIXED_RECEIVE_BUFFER;
+
+	unreserve_buffer_budget(fReceiveBufferReserved);
+	fReceiveBufferReserved = 0;
 	return B_OK;
 }
 
@@ -1018,6 +1078,18 @@ TCPEndpoint::SetReceiveBufferSize(size_t length)
 status_t
 TCPEndpoint::GetOption(int option, void* _value, int* _length)
 {
+	if (option == TCP_CONGESTION) {
+		MutexLocker _(fLock);
+
+		const char* name = fCongestionControl->Name();
+		if (*_length <= (int)strlen(name))
+			return B_BAD_VALUE;
+
+		strcpy((char*)_value, name);
+		*_length = strlen(name) + 1;
+		return B_OK;
+	}
+
 	if (*_length != sizeof(int))
 		return B_BAD_VALUE;
 
@@ -1044,6 +1116,26 @@ TCPEndpoint::GetOption(int option, void* _value, int* _length)
 status_t
 TCPEndpoint::SetOption(int option, const void* _value, int length)
 {
+	if (option == TCP_CONGESTION) {
+		if (length <= 0)
+			return B_BAD_VALUE;
+
+		char name[TCP_CA_NAME_MAX];
+		size_t nameLength = min_c((size_t)length, sizeof(name) - 1);
+		memcpy(name, _value, nameLength);
+		name[nameLength] = '\0';
+
+		CongestionControl* control = CongestionControl::Create(name);
+		if (control == NULL)
+			return CongestionControl::Exists(name) ? B_NO_MEMORY : ENOENT;
+
+		MutexLocker _(fLock);
+		control->TakeOver(*fCongestionControl);
+		delete fCongestionControl;
+		fCongestionControl = control;
+		return B_OK;
+	}
+
 	if (option != TCP_NODELAY)
 		return B_BAD_VALUE;
 
@@ -1137,6 +1229,7 @@ TCPEndpoint::_CancelConnectionTimers()
 {
 	gStackModule->cancel_timer(&fRetransmitTimer);
 	gStackModule->cancel_timer(&fPersistTimer);
+	gStackModule->cancel_timer(&fPacingTimer);
 	gStackModule->cancel_timer(&fDelayedAcknowledgeTimer);
 }
 
@@ -1240,16 +1333,25 @@ TCPEndpoint::_HandleReset(status_t error)
 void
 TCPEndpoint::_DuplicateAcknowledge(tcp_segment_header &segment)
 {
+	if ((fFlags & FLAG_OPTION_SACK_PERMITTED) != 0) {
+		// the scoreboard decides what needs to be retransmitted
+		if (++fDuplicateAcknowledgeCount >= 3
+			&& (fFlags & FLAG_RECOVERY) == 0)
+			_EnterRecovery();
+		if ((fFlags & FLAG_RECOVERY) != 0)
+			_SendQueued();
+		return;
+	}
+
 	if (++fDuplicateAcknowledgeCount < 3)
 		return;
 
 	if (fDuplicateAcknowledgeCount == 3) {
-		_ResetSlowStart();
-		fCongestionWindow = fSlowStartThreshold + 3
-			* fSendMaxSegmentSize;
+		fCongestionControl->Lost((fSendMax - fSendUnacknowledged).Number());
+		fCongestionControl->InflateWindow(3 * fSendMaxSegmentSize);
 		fSendNext = segment.acknowledge;
 	} else if (fDuplicateAcknowledgeCount > 3)
-		fCongestionWindow += fSendMaxSegmentSize;
+		fCongestionControl->InflateWindow(fSendMaxSegmentSize);
 
 	_SendQueued();
 }
@@ -1265,6 +1367,22 @@ TCPEndpoint::_UpdateTimestamps(tcp_segment_header& segment,
 		if (fLastAcknowledgeSent >= sequence
 			&& fLastAcknowledgeSent < (sequence + segmentLength))
 			fReceivedTimestamp = segment.timestamp_value;
+
+		if (segmentLength > 0 && (segment.options & TCP_HAS_TIMESTAMPS) != 0
+			&& segment.timestamp_reply != 0) {
+			// The peer echoes the time stamp of our last acknowledgement,
+			// which lets us estimate the round trip time on the receiving
+			// end as well
+			bigtime_t roundTripTime = (bigtime_t)max_c(
+				tcp_diff_timestamp(segment.timestamp_reply), 1)
+				* kTimestampFactor;
+			if (fReceiveRoundTripTime == 0)
+				fReceiveRoundTripTime = roundTripTime;
+			else {
+				fReceiveRoundTripTime
+					= (7 * fReceiveRoundTripTime + roundTripTime) / 8;
+			}
+		}
 	}
 }
 
@@ -1306,6 +1424,9 @@ TCPEndpoint::_AddData(tcp_segment_header& segment, net_buffer* buffer)
 		fFinishReceivedAt = segment.sequence + buffer->size;
 	}
 
+	if (fReceiveNext != segment.sequence)
+		fLastOutOfOrderSequence = segment.sequence;
+
 	fReceiveQueue.Add(buffer, segment.sequence);
 	fReceiveNext = fReceiveQueue.NextSequence();
 
@@ -1356,10 +1477,16 @@ TCPEndpoint::_PrepareReceivePath(tcp_segment_header& segment)
 			fReceivedTimestamp = segment.timestamp_value;
 		} else
 			fFlags &= ~FLAG_OPTION_TIMESTAMP;
-	}
 
-	fCongestionWindow = 2 * fSendMaxSegmentSize;
-	fSlowStartThreshold = (uint32)segment.advertised_window << fSendWindowShift;
+		if (segment.options & TCP_SACK_PERMITTED)
+			fFlags |= FLAG_OPTION_SACK_PERMITTED;
+		else
+			fFlags &= ~FLAG_OPTION_SACK_PERMITTED;
+	} else
+		fFlags &= ~FLAG_OPTION_SACK_PERMITTED;
+
+	fCongestionControl->Init(fSendMaxSegmentSize,
+		(uint32)segment.advertised_window << fSendWindowShift);
 }
 
 
@@ -1387,6 +1514,7 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 	T(Spawn(parent, this));
 
 	fManager = parent->fManager;
+	fOwner = parent->fOwner;
 
 	LocalAddress().SetTo(buffer->destination);
 	PeerAddress().SetTo(buffer->source);
@@ -1405,6 +1533,19 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 
 	fOptions = parent->fOptions;
 	fAcceptSemaphore = parent->fAcceptSemaphore;
+	fFlags |= parent->fFlags
+		& (FLAG_FIXED_SEND_BUFFER | FLAG_FIXED_RECEIVE_BUFFER);
+
+	if (strcmp(parent->fCongestionControl->Name(),
+			fCongestionControl->Name()) != 0) {
+		// use the same algorithm as the listening socket
+		CongestionControl* control
+			= CongestionControl::Create(parent->fCongestionControl->Name());
+		if (control != NULL) {
+			delete fCongestionControl;
+			fCongestionControl = control;
+		}
+	}
 
 	_PrepareReceivePath(segment);
 
@@ -1499,6 +1640,7 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 
 	if (fState == ESTABLISHED
 		&& segment.AcknowledgeOnly()
+		&& segment.sack_count == 0
 		&& fReceiveNext == segment.sequence
 		&& advertisedWindow > 0 && advertisedWindow == fSendWindow
 		&& fSendNext == fSendMax) {
@@ -1642,21 +1784,27 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 		if (fSendMax < segment.acknowledge)
 			return DROP | IMMEDIATE_ACKNOWLEDGE;
 
-		if (segment.acknowledge < fSendUnacknowledged) {
-			if (buffer->size == 0 && advertisedWindow == fSendWindow
-				&& (segment.flags & TCP_FLAG_FINISH) == 0) {
-				TRACE("Receive(): duplicate ack!");
+		if (segment.sack_count > 0
+			&& (fFlags & FLAG_OPTION_SACK_PERMITTED) != 0)
+			_ProcessSack(segment);
 
-				_DuplicateAcknowledge(segment);
-			}
+		if (segment.acknowledge == fSendUnacknowledged
+			&& fSendMax != fSendUnacknowledged
+			&& buffer->size == 0 && advertisedWindow == fSendWindow
+			&& (segment.flags & TCP_FLAG_FINISH) == 0) {
+			TRACE("Receive(): duplicate ack!");
 
+			_DuplicateAcknowledge(segment);
+			return DROP;
+		} else if (segment.acknowledge < fSendUnacknowledged) {
 			return DROP;
 		} else {
 			// this segment acknowledges in flight data
 
-			if (fDuplicateAcknowledgeCount >= 3) {
+			if (fDuplicateAcknowledgeCount >= 3
+				&& (fFlags & FLAG_OPTION_SACK_PERMITTED) == 0) {
 				// deflate the window.
-				fCongestionWindow = fSlowStartThreshold;
+				fCongestionControl->RecoveryFinished();
 			}
 
 			fDuplicateAcknowledgeCount = 0;
@@ -1704,9 +1852,15 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 	bool notify = false;
 
 	if ((buffer->size > 0 || (segment.flags & TCP_FLAG_FINISH) != 0)
-		&& _ShouldReceive())
+		&& _ShouldReceive()) {
+		bool hadHole = !fReceiveQueue.IsContiguous();
 		notify = _AddData(segment, buffer);
-	else {
+
+		// Out of order data, and data that fills a hole are acknowledged
+		// immediately, so that the sender learns about it (RFC 5681, 4.2)
+		if (hadHole || !fReceiveQueue.IsContiguous())
+			action |= IMMEDIATE_ACKNOWLEDGE;
+	} else {
 		if ((fFlags & FLAG_NO_RECEIVE) != 0)
 			fReceiveNext += buffer->size;
 
@@ -1866,7 +2020,7 @@ TCPEndpoint::_ShouldSendSegment(tcp_segment_header& segment, uint32 length,
 		// - the buffer is at least larger than half of the maximum send window,
 		//   or
 		// - we're retransmitting data
-		if (length == segmentMaxSize
+		if (length >= segmentMaxSize
 			|| (fOptions & TCP_NODELAY) != 0
 			|| tcp_sequence(fSendNext + length) == fSendQueue.LastSequence()
 			|| (fSendMaxWindow > 0 && length >= fSendMaxWindow / 2))
@@ -1936,6 +2090,14 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 				segment.options |= TCP_HAS_WINDOW_SCALE;
 				segment.window_shift = fReceiveWindowShift;
 			}
+			if (fFlags & FLAG_OPTION_SACK_PERMITTED)
+				segment.options |= TCP_SACK_PERMITTED;
+		}
+
+		if ((fFlags & FLAG_OPTION_SACK_PERMITTED) != 0
+			&& !fReceiveQueue.IsContiguous()) {
+			segment.sack_count = fReceiveQueue.GetSackBlocks(segment.sacks,
+				TCP_MAX_SACK_BLOCKS, fLastOutOfOrderSequence);
 		}
 	}
 
@@ -1958,8 +2120,23 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 		segment.urgent_offset = 0;
 	}
 
-	if (fCongestionWindow > 0 && fCongestionWindow < sendWindow)
-		sendWindow = fCongestionWindow;
+	bool inRecovery = (fFlags & FLAG_RECOVERY) != 0 && sendWindow > 0;
+	uint32 recoveryWindow = 0;
+
+	if (inRecovery) {
+		// During loss recovery, the congestion window limits the estimated
+		// amount of data still in the network (RFC 6675, section 5), and the
+		// holes reported by the peer are filled before new data is sent.
+		uint32 pipe = _Pipe();
+		if (fCongestionControl->Window() > pipe)
+			recoveryWindow = fCongestionControl->Window() - pipe;
+
+		status_t status = _SendLost(segment, recoveryWindow);
+		if (status != B_OK)
+			return status;
+	} else if (fCongestionControl->Window() > 0
+		&& fCongestionControl->Window() < sendWindow)
+		sendWindow = fCongestionControl->Window();
 
 	// fSendUnacknowledged
 	//  |    fSendNext      fSendMax
@@ -1984,6 +2161,9 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 	} else
 		sendWindow -= consumedWindow;
 
+	if (inRecovery && recoveryWindow < sendWindow)
+		sendWindow = recoveryWindow;
+
 	if (force && sendWindow == 0 && fSendNext <= fSendQueue.LastSequence()) {
 		// send one byte of data to ask for a window update
 		// (triggered by the persist timer)
@@ -1993,11 +2173,28 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 	uint32 length = min_c(fSendQueue.Available(fSendNext), sendWindow);
 	tcp_sequence previousSendNext = fSendNext;
 
+	uint64 pacingRate = 0;
+	if (!force && length > 0) {
+		pacingRate = fCongestionControl->PacingRate(_RoundTripTime());
+		if (pacingRate > 0)
+			length = _PacedLength(segment, length, pacingRate);
+	}
+
+	bool offload = gSegmentationOffload && Domain()->family == AF_INET
+		&& (segment.flags & (TCP_FLAG_SYNCHRONIZE | TCP_FLAG_URGENT)) == 0;
+	status_t sendStatus = B_OK;
+
 	do {
 		uint32 segmentMaxSize = fSendMaxSegmentSize
 			- tcp_options_length(segment);
 		uint32 segmentLength = min_c(length, segmentMaxSize);
 
+		if (offload && length > segmentMaxSize) {
+			// send as many full segments at once as possible
+			segmentLength = min_c(length, kMaxOffloadSize);
+			segmentLength -= segmentLength % segmentMaxSize;
+		}
+
 		if (fSendNext + segmentLength == fSendQueue.LastSequence()) {
 			if (state_needs_finish(fState))
 				segment.flags |= TCP_FLAG_FINISH;
@@ -2027,6 +2224,9 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 			return status;
 		}
 
+		if (segmentLength > segmentMaxSize)
+			buffer->segment_size = segmentMaxSize;
+
 		LocalAddress().CopyTo(buffer->source);
 		PeerAddress().CopyTo(buffer->destination);
 
@@ -2039,7 +2239,8 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 			buffer, buffer->size, PrintAddress(buffer->source),
 			PrintAddress(buffer->destination), segment.flags, segment.sequence,
 			segment.acknowledge, segment.advertised_window,
-			fCongestionWindow, fSlowStartThreshold, segmentLength,
+			fCongestionControl->Window(),
+			fCongestionControl->SlowStartThreshold(), segmentLength,
 			fSendQueue.FirstSequence().Number(),
 			fSendQueue.LastSequence().Number());
 		T(Send(this, segment, buffer, fSendQueue.FirstSequence(),
@@ -2058,7 +2259,7 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 		// for local connections as the answer is directly handled
 
 		if (segment.flags & TCP_FLAG_SYNCHRONIZE) {
-			segment.options &= ~TCP_HAS_WINDOW_SCALE;
+			segment.options &= ~(TCP_HAS_WINDOW_SCALE | TCP_SACK_PERMITTED);
 			segment.max_segment_size = 0;
 			size++;
 		}
@@ -2076,17 +2277,41 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 
 		status = next->module->send_routed_data(next, fRoute, buffer);
 		if (status < B_OK) {
+			// If the buffer had to be split into several segments, some of
+			// them may have been sent nonetheless.
+			uint32 sentSize = buffer->sent_size;
 			gBufferModule->free(buffer);
 
-			fSendNext = segment.sequence;
+			// restore send status for anything that has not been sent
+			fSendNext = segment.sequence + sentSize;
 			fSendMax = sendMax;
-				// restore send status
-			return status;
+			if (fSendMax < fSendNext)
+				fSendMax = fSendNext;
+
+			if (sentSize == 0)
+				return status;
+
+			size = sentSize;
+			segmentLength = sentSize;
 		}
 
 		if (segment.flags & TCP_FLAG_ACKNOWLEDGE)
 			fLastAcknowledgeSent = segment.acknowledge;
 
+		if ((fFlags & FLAG_OPTION_SACK_PERMITTED) != 0) {
+			fScoreboard.Sent(segment.sequence,
+				tcp_sequence(segment.sequence) + size, system_time());
+		}
+
+		if (pacingRate > 0)
+			fPacingNextSend += segmentLength * 1000000LL / pacingRate;
+
+		if (status < B_OK) {
+			// only part of the segment has been sent
+			sendStatus = status;
+			break;
+		}
+
 		length -= segmentLength;
 		segment.flags &= ~(TCP_FLAG_SYNCHRONIZE | TCP_FLAG_RESET
 			| TCP_FLAG_FINISH);
@@ -2102,7 +2327,7 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 		gStackModule->set_timer(&fRetransmitTimer, fRetransmitTimeout);
 	}
 
-	return B_OK;
+	return sendStatus;
 }
 
 
@@ -2136,6 +2361,7 @@ TCPEndpoint::_PrepareSendPath(const sockaddr* peer)
 	fSendUnacknowledged = fInitialSendSequence;
 	fSendMax = fInitialSendSequence;
 	fSendUrgentOffset = fInitialSendSequence;
+	fScoreboard.Reset(fInitialSendSequence);
 
 	// we are counting the SYN here
 	fSendQueue.SetInitialSequence(fSendNext + 1);
@@ -2143,10 +2369,13 @@ TCPEndpoint::_PrepareSendPath(const sockaddr* peer)
 	fReceiveMaxSegmentSize = _MaxSegmentSize(peer);
 
 	// Compute the window shift we advertise to our peer - if it doesn't support
-	// this option, this will be reset to 0 (when its SYN is received)
+	// this option, this will be reset to 0 (when its SYN is received).
+	// As it cannot be changed later on, leave room for larger windows.
+	size_t maxWindow = max_c(socket->receive.buffer_size,
+		kMaxAutoReceiveBufferSize);
 	fReceiveWindowShift = 0;
 	while (fReceiveWindowShift < TCP_MAX_WINDOW_SHIFT
-		&& (0xffffUL << fReceiveWindowShift) < socket->receive.buffer_size) {
+		&& (0xffffUL << fReceiveWindowShift) < maxWindow) {
 		fReceiveWindowShift++;
 	}
 
@@ -2158,6 +2387,28 @@ void
 TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 {
 	size_t previouslyUsed = fSendQueue.Used();
+	uint32 flightSize = (fSendMax - fSendUnacknowledged).Number();
+
+	if ((fFlags & FLAG_OPTION_SACK_PERMITTED) != 0) {
+		if (fSendUnacknowledged < segment.acknowledge) {
+			bigtime_t sentTime
+				= fScoreboard.SentTime(tcp_sequence(segment.acknowledge) - 1);
+			if (sentTime > fDeliveredSentTime)
+				fDeliveredSentTime = sentTime;
+		}
+
+		fScoreboard.RemoveUntil(segment.acknowledge);
+		if (fRetransmitNext < segment.acknowledge)
+			fRetransmitNext = segment.acknowledge;
+
+		if ((fFlags & FLAG_RECOVERY) != 0
+			&& fRecoveryPoint <= segment.acknowledge) {
+			// all data that was in flight when we detected the loss has
+			// arrived now
+			fFlags &= ~FLAG_RECOVERY;
+			fCongestionControl->RecoveryFinished();
+		}
+	}
 
 	fSendQueue.RemoveUntil(segment.acknowledge);
 	fSendUnacknowledged = segment.acknowledge;
@@ -2183,19 +2434,12 @@ TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 			gSocketModule->notify(socket, B_SELECT_WRITE, fSendQueue.Used());
 		}
 
-		if (fCongestionWindow < fSlowStartThreshold)
-			fCongestionWindow += fSendMaxSegmentSize;
-	}
-
-	if (fCongestionWindow >= fSlowStartThreshold) {
-		uint32 increment = fSendMaxSegmentSize * fSendMaxSegmentSize;
-
-		if (increment < fCongestionWindow)
-			increment = 1;
-		else
-			increment /= fCongestionWindow;
-
-		fCongestionWindow += increment;
+		if ((fFlags & FLAG_RECOVERY) == 0) {
+			fCongestionControl->Acknowledged(
+				previouslyUsed - fSendQueue.Used(), flightSize,
+				_RoundTripTime());
+			_GrowSendBuffer();
+		}
 	}
 
 	// if there is data left to be send, send it now
@@ -2208,7 +2452,13 @@ void
 TCPEndpoint::_Retransmit()
 {
 	TRACE("Retransmit()");
-	_ResetSlowStart();
+	fCongestionControl->Timeout((fSendMax - fSendUnacknowledged).Number());
+
+	// The peer may have discarded data it selectively acknowledged before,
+	// so we start over from the first unacknowledged byte.
+	fFlags &= ~FLAG_RECOVERY;
+	fScoreboard.ClearSacked();
+
 	fSendNext = fSendUnacknowledged;
 	_SendQueued();
 }
@@ -2229,18 +2479,330 @@ TCPEndpoint::_UpdateRoundTripTime(int32 roundTripTime)
 
 	fRetransmitTimeout = ((fRoundTripTime / 4 + fRoundTripDeviation) / 2)
 		* kTimestampFactor;
+	fFlags |= FLAG_ROUND_TRIP_MEASURED;
 
 	TRACE("  RTO is now %llu (after rtt %ldms)", fRetransmitTimeout,
 		roundTripTime);
 }
 
 
+/*!	Returns the smoothed round trip time, or zero if it has not been
+	measured yet.
+*/
+bigtime_t
+TCPEndpoint::_RoundTripTime() const
+{
+	if ((fFlags & FLAG_ROUND_TRIP_MEASURED) == 0)
+		return 0;
+
+	return (bigtime_t)(fRoundTripTime / 8) * kTimestampFactor;
+}
+
+
+/*!	Limits \a length to what may be sent right now at the given pacing
+	\a rate, and starts the pacing timer to send the rest later.
+*/
+uint32
+TCPEndpoint::_PacedLength(tcp_segment_header& segment, uint32 length,
+	uint64 rate)
+{
+	bigtime_t now = system_time();
+	if (fPacingNextSend < now)
+		fPacingNextSend = now;
+
+	uint32 segmentSize = fSendMaxSegmentSize - tcp_options_length(segment);
+	uint64 burst = max_c(rate * kPacingBurstTime / 1000000,
+		(uint64)2 * segmentSize);
+	uint64 backlog = (fPacingNextSend - now) * rate / 1000000;
+	uint64 allowed = burst > backlog ? burst - backlog : 0;
+	if (allowed >= length)
+		return length;
+
+	allowed -= allowed % segmentSize;
+
+	if (!gStackModule->is_timer_active(&fPacingTimer)) {
+		// continue as soon as there is room for another segment
+		bigtime_t delay = (backlog + allowed + segmentSize - burst) * 1000000
+			/ rate;
+		gStackModule->set_timer(&fPacingTimer, max_c(delay, 1));
+	}
+
+	return allowed;
+}
+
+
+/*!	Makes sure the send buffer can hold twice the congestion window, so
+	that the application can keep the pipe filled.
+*/
+void
+TCPEndpoint::_GrowSendBuffer()
+{
+	if ((fFlags & FLAG_FIXED_SEND_BUFFER) != 0)
+		return;
+
+	if (shrink_buffer_on_pressure(fSendQueue, fSendBufferReserved)) {
+		socket->send.buffer_size = fSendQueue.Size();
+		return;
+	}
+
+	size_t size = min_c((size_t)fCongestionControl->Window() * 2,
+		kMaxAutoSendBufferSize);
+	if (size <= fSendQueue.Size()
+		|| !grow_buffer(fSendQueue, fSendBufferReserved, size))
+		return;
+
+	socket->send.buffer_size = size;
+
+	if (is_writable(fState)) {
+		fSendList.Signal();
+		gSocketModule->notify(socket, B_SELECT_WRITE, fSendQueue.Free());
+	}
+}
+
+
+/*!	Dynamic right-sizing of the receive buffer: it should be able to hold
+	twice the amount of data the application reads within a round trip, so
+	that the peer's window is never limited by our buffer, unless the
+	application cannot keep up.
+*/
+void
+TCPEndpoint::_TuneReceiveBuffer(size_t bytesRead)
+{
+	if ((fFlags & FLAG_FIXED_RECEIVE_BUFFER) != 0)
+		return;
+
+	if (shrink_buffer_on_pressure(fReceiveQueue, fReceiveBufferReserved)) {
+		socket->receive.buffer_size = fReceiveQueue.Size();
+		return;
+	}
+
+	bigtime_t roundTripTime = _ReceiveRoundTripTime();
+	if (roundTripTime == 0)
+		return;
+
+	bigtime_t now = system_time();
+	if (fReadMeasureStart == 0)
+		fReadMeasureStart = now;
+
+	fReadMeasureBytes += bytesRead;
+	if (now - fReadMeasureStart < roundTripTime)
+		return;
+
+	size_t size = min_c(2 * fReadMeasureBytes, kMaxAutoReceiveBufferSize);
+	fReadMeasureStart = now;
+	fReadMeasureBytes = 0;
+
+	if (size > fReceiveQueue.Size()
+		&& grow_buffer(fReceiveQueue, fReceiveBufferReserved, size)) {
+		TRACE("TuneReceiveBuffer(): grown to %lu bytes (rtt %lld)", size,
+			roundTripTime);
+		socket->receive.buffer_size = size;
+	}
+}
+
+
+/*!	Returns the round trip time as seen from the receiving side, or zero, if
+	it is not known yet.
+*/
+bigtime_t
+TCPEndpoint::_ReceiveRoundTripTime() const
+{
+	if (fReceiveRoundTripTime != 0)
+		return fReceiveRoundTripTime;
+
+	return _RoundTripTime();
+}
+
+
+void
+TCPEndpoint::_ReleaseBuffers()
+{
+	unreserve_buffer_budget(fSendBufferReserved + fReceiveBufferReserved);
+	fSendBufferReserved = 0;
+	fReceiveBufferReserved = 0;
+}
+
+
+/*!	Adds the blocks of a received SACK option to the scoreboard, and looks
+	for lost segments.
+*/
+void
+TCPEndpoint::_ProcessSack(tcp_segment_header& segment)
+{
+	tcp_sequence acknowledge = segment.acknowledge;
+	if (acknowledge < fSendUnacknowledged)
+		acknowledge = fSendUnacknowledged;
+
+	for (int i = 0; i < segment.sack_count; i++) {
+		tcp_sequence start = segment.sacks[i].left_edge;
+		tcp_sequence end = segment.sacks[i].right_edge;
+
+		// ignore duplicate SACKs (RFC 2883), and bogus blocks
+		if (start >= end || start < acknowledge || end > fSendMax)
+			continue;
+
+		fScoreboard.AddSacked(start, end);
+
+		bigtime_t sentTime = fScoreboard.SentTime(end - 1);
+		if (sentTime > fDeliveredSentTime)
+			fDeliveredSentTime = sentTime;
+	}
+
+	if (!fScoreboard.HasSacked())
+		return;
+
+	if ((fFlags & FLAG_RECOVERY) == 0) {
+		// RACK lets us start the recovery without waiting for three
+		// duplicate acknowledgements
+		if (_IsLost(acknowledge))
+			_EnterRecovery();
+		return;
+	}
+
+	// check if any of our retransmissions got lost again
+	tcp_sequence sequence = acknowledge;
+	while (sequence < fRetransmitNext) {
+		uint32 length = fScoreboard.NextUnsacked(sequence, fRetransmitNext);
+		if (length == 0)
+			break;
+
+		if (_IsLost(sequence)) {
+			TRACE("  ProcessSack(): retransmission at %lu got lost",
+				sequence.Number());
+			fRetransmitNext = sequence;
+			break;
+		}
+
+		sequence += length;
+	}
+}
+
+
+/*!	Implements the RACK loss detection: data is considered lost when data
+	that was sent after it has already been delivered, and it has been in
+	flight for longer than a round trip time plus a reordering window of a
+	quarter round trip time.
+	Unlike RFC 8985, the smoothed round trip time is used instead of the one
+	of the most recently delivered segment.
+*/
+bool
+TCPEndpoint::_IsLost(tcp_sequence sequence) const
+{
+	bigtime_t sentTime = fScoreboard.SentTime(sequence);
+	if (sentTime == 0 || sentTime >= fDeliveredSentTime)
+		return false;
+
+	bigtime_t roundTripTime = (bigtime_t)(fRoundTripTime / 8)
+		* kTimestampFactor;
+	return sentTime + roundTripTime + roundTripTime / 4 <= system_time();
+}
+
+
 void
-TCPEndpoint::_ResetSlowStart()
+TCPEndpoint::_EnterRecovery()
+{
+	TRACE("EnterRecovery(): una %lu, max %lu", fSendUnacknowledged.Number(),
+		fSendMax.Number());
+
+	fFlags |= FLAG_RECOVERY;
+	fRecoveryPoint = fSendMax;
+	fRetransmitNext = fSendUnacknowledged;
+
+	fCongestionControl->Lost((fSendMax - fSendUnacknowledged).Number());
+}
+
+
+/*!	Returns an estimate of the amount of data that is still in the network,
+	ie. the flight size, minus the data that the peer has selectively
+	acknowledged, and minus the holes considered lost that we have not
+	retransmitted yet (RFC 6675, section 4).
+*/
+uint32
+TCPEndpoint::_Pipe() const
+{
+	tcp_sequence retransmitNext = fRetransmitNext;
+	if (retransmitNext < fSendUnacknowledged)
+		retransmitNext = fSendUnacknowledged;
+
+	uint32 flightSize = (fSendMax - fSendUnacknowledged).Number();
+	uint32 notInFlight = fScoreboard.SackedBytes()
+		+ fScoreboard.UnsackedBytes(retransmitNext,
+			fScoreboard.HighestSacked());
+
+	return flightSize > notInFlight ? flightSize - notInFlight : 0;
+}
+
+
+/*!	Retransmits the holes below the highest selectively acknowledged
+	sequence, as far as \a sendWindow allows; the latter is reduced by the
+	amount of data sent.
+*/
+status_t
+TCPEndpoint::_SendLost(tcp_segment_header& segment, uint32& sendWindow)
 {
-	fSlowStartThreshold = max_c((fSendMax - fSendUnacknowledged).Number() / 2,
-		2 * fSendMaxSegmentSize);
-	fCongestionWindow = fSendMaxSegmentSize;
+	tcp_sequence highestSacked = fScoreboard.HighestSacked();
+	if (fSendQueue.LastSequence() < highestSacked)
+		highestSacked = fSendQueue.LastSequence();
+
+	while (fRetransmitNext < highestSacked) {
+		tcp_sequence sequence = fRetransmitNext;
+		uint32 length = fScoreboard.NextUnsacked(sequence, highestSacked);
+		if (length == 0) {
+			fRetransmitNext = highestSacked;
+			break;
+		}
+
+		uint32 segmentMaxSize = fSendMaxSegmentSize
+			- tcp_options_length(segment);
+		if (length > segmentMaxSize)
+			length = segmentMaxSize;
+		if (length > sendWindow)
+			break;
+
+		net_buffer* buffer = gBufferModule->create(256);
+		if (buffer == NULL)
+			return B_NO_MEMORY;
+
+		status_t status = fSendQueue.Get(buffer, sequence, length);
+		if (status != B_OK) {
+			gBufferModule->free(buffer);
+			return status;
+		}
+
+		LocalAddress().CopyTo(buffer->source);
+		PeerAddress().CopyTo(buffer->destination);
+
+		segment.sequence = sequence.Number();
+
+		TRACE("SendLost(): retransmit %lu bytes at %lu", length,
+			segment.sequence);
+		T(Send(this, segment, buffer, fSendQueue.FirstSequence(),
+			fSendQueue.LastSequence()));
+
+		status = add_tcp_header(AddressModule(), segment, buffer);
+		if (status != B_OK) {
+			gBufferModule->free(buffer);
+			return status;
+		}
+
+		status = next->module->send_routed_data(next, fRoute, buffer);
+		if (status < B_OK) {
+			gBufferModule->free(buffer);
+			return status;
+		}
+
+		if (segment.flags & TCP_FLAG_ACKNOWLEDGE)
+			fLastAcknowledgeSent = segment.acknowledge;
+
+		fScoreboard.Sent(sequence, sequence + length, system_time());
+		fRetransmitNext = sequence + length;
+		sendWindow -= length;
+
+		if (!gStackModule->is_timer_active(&fRetransmitTimer))
+			gStackModule->set_timer(&fRetransmitTimer, fRetransmitTimeout);
+	}
+
+	return B_OK;
 }
 
 
@@ -2279,6 +2841,24 @@ TCPEndpoint::_PersistTimer(net_timer* timer, void* _endpoint)
 }
 
 
+/*static*/ void
+TCPEndpoint::_PacingTimer(net_timer* timer, void* _endpoint)
+{
+	TCPEndpoint* endpoint = (TCPEndpoint*)_endpoint;
+	T(Timer(endpoint, "pacing"));
+
+	MutexLocker locker(endpoint->fLock);
+	if (!locker.IsLocked())
+		return;
+
+	// the timer might not have been canceled early enough
+	if (endpoint->State() == CLOSED)
+		return;
+
+	endpoint->_SendQueued();
+}
+
+
 /*static*/ void
 TCPEndpoint::_DelayedAcknowledgeTimer(net_timer* timer, void* _endpoint)
 {
@@ -2361,10 +2941,22 @@ TCPEndpoint::Dump() const
 	kprintf("    initial sequence: %lu\n", fInitialReceiveSequence.Number());
 	kprintf("    duplicate acknowledge count: %lu\n",
 		fDuplicateAcknowledgeCount);
+	if ((fFlags & FLAG_RECOVERY) != 0) {
+		kprintf("    recovery point: %lu\n", fRecoveryPoint.Number());
+		kprintf("    retransmit next: %lu\n", fRetransmitNext.Number());
+	}
+	if ((fFlags & FLAG_OPTION_SACK_PERMITTED) != 0)
+		fScoreboard.Dump();
 	kprintf("  round trip time: %ld (deviation %ld)\n", fRoundTripTime,
 		fRoundTripDeviation);
 	kprintf("  retransmit timeout: %lld\n", fRetransmitTimeout);
-	kprintf("  congestion window: %lu\n", fCongestionWindow);
-	kprintf("  slow start threshold: %lu\n", fSlowStartThreshold);
+	kprintf("  buffers reserved: send %lu, receive %lu, receive rtt %lld\n",
+		fSendBufferReserved, fReceiveBufferReserved, fReceiveRoundTripTime);
+	kprintf("  congestion control: %s\n", fCongestionControl->Name());
+	kprintf("    window: %lu\n", fCongestionControl->Window());
+	kprintf("    slow start threshold: %lu\n",
+		fCongestionControl->SlowStartThreshold());
+	kprintf("    pacing rate: %llu\n",
+		fCongestionControl->PacingRate(_RoundTripTime()));
 }
 
@@ -12,7 +12,9 @@
 
 
 #include "BufferQueue.h"
+#include "CongestionControl.h"
 #include "EndpointManager.h"
+#include "SackScoreboard.h"
 #include "tcp.h"
 
 #include <ProtocolUtilities.h>
@@ -123,18 +125,36 @@ private:
 			void		_Acknowledged(tcp_segment_header& segment);
 			void		_Retransmit();
 			void		_UpdateRoundTripTime(int32 roundTripTime);
-			void		_ResetSlowStart();
+			bigtime_t	_RoundTripTime() const;
+			uint32		_PacedLength(tcp_segment_header& segment,
+							uint32 length, uint64 rate);
+			void		_GrowSendBuffer();
+			void		_TuneReceiveBuffer(size_t bytesRead);
+			bigtime_t	_ReceiveRoundTripTime() const;
+			void		_ReleaseBuffers();
 			void		_DuplicateAcknowledge(tcp_segment_header& segment);
+			void		_ProcessSack(tcp_segment_header& segment);
+			bool		_IsLost(tcp_sequence sequence) const;
+			void		_EnterRecovery();
+			uint32		_Pipe() const;
+			status_t	_SendLost(tcp_segment_header& segment,
+							uint32& sendWindow);
 
 	static	void		_TimeWaitTimer(net_timer* timer, void* _endpoint);
 	static	void		_RetransmitTimer(net_timer* timer, void* _endpoint);
 	static	void		_PersistTimer(net_timer* timer, void* _endpoint);
+	static	void		_PacingTimer(net_timer* timer, void* _endpoint);
 	static	void		_DelayedAcknowledgeTimer(net_timer* timer,
 							void* _endpoint);
 
 private:
 	TCPEndpoint*	fConnectionHashLink;
 	TCPEndpoint*	fEndpointHashLink;
+	TCPEndpoint*	fReusePortNext;
+		// ring of the listeners sharing an address via SO_REUSEPORT
+	uid_t			fOwner;
+		// effective user that bound the endpoint, only endpoints of the
+		// same user may share an address via SO_REUSEPORT
 	friend class EndpointManager;
 	friend class ConnectionHashDefinition;
 	friend class EndpointHashDefinition;
@@ -161,6 +181,12 @@ private:
 	tcp_sequence	fInitialSendSequence;
 	uint32			fDuplicateAcknowledgeCount;
 
+	// SACK based loss recovery (RFC 6675) and RACK
+	SackScoreboard	fScoreboard;
+	tcp_sequence	fRecoveryPoint;
+	tcp_sequence	fRetransmitNext;
+	bigtime_t		fDeliveredSentTime;
+
 	net_route 		*fRoute;
 		// TODO: don't use a net_route, but a net_route_info!!!
 		// (the latter will automatically adapt to routing changes)
@@ -173,6 +199,7 @@ private:
 	bool			fFinishReceived;
 	tcp_sequence	fFinishReceivedAt;
 	tcp_sequence	fInitialReceiveSequence;
+	tcp_sequence	fLastOutOfOrderSequence;
 
 	// round trip time and retransmit timeout computation
 	int32			fRoundTripTime;
@@ -181,8 +208,15 @@ private:
 
 	uint32			fReceivedTimestamp;
 
-	uint32			fCongestionWindow;
-	uint32			fSlowStartThreshold;
+	CongestionControl* fCongestionControl;
+	bigtime_t		fPacingNextSend;
+
+	// buffer auto-tuning
+	size_t			fSendBufferReserved;
+	size_t			fReceiveBufferReserved;
+	bigtime_t		fReceiveRoundTripTime;
+	bigtime_t		fReadMeasureStart;
+	size_t			fReadMeasureBytes;
 
 	tcp_state		fState;
 	uint32			fFlags;
@@ -190,6 +224,7 @@ private:
 	// timer
 	net_timer		fRetransmitTimer;
 	net_timer		fPersistTimer;
+	net_timer		fPacingTimer;
 	net_timer		fDelayedAcknowledgeTimer;
 	net_timer		fTimeWaitTimer;
 };
@@ -9,6 +9,7 @@
  */
 
 
+#include "BufferBudget.h"
 #include "EndpointManager.h"
 #include "TCPEndpoint.h"
 
@@ -16,6 +17,7 @@
 #include <net_stat.h>
 
 #include <KernelExport.h>
+#include <driver_settings.h>
 #include <util/list.h>
 
 #include <netinet/in.h>
@@ -49,6 +51,8 @@ net_datalink_module_info *gDatalinkModule;
 net_socket_module_info *gSocketModule;
 net_stack_module_info *gStackModule;
 
+bool gSegmentationOffload = true;
+
 
 static EndpointManager* sEndpointManagers[AF_MAX];
 static rw_lock sEndpointManagersLock;
@@ -153,7 +157,11 @@ add_options(tcp_segment_header &segment, uint8 *buffer, size_t bufferSize)
 			bump_option(option, length);
 			option->kind = TCP_OPTION_SACK;
 			option->length = 2 + sackCount * sizeof(tcp_sack);
-			memcpy(option->sack, segment.sacks, sackCount * sizeof(tcp_sack));
+			for (int i = 0; i < sackCount; i++) {
+				option->sack[i].left_edge = htonl(segment.sacks[i].left_edge);
+				option->sack[i].right_edge
+					= htonl(segment.sacks[i].right_edge);
+			}
 			bump_option(option, length);
 		}
 	}
@@ -219,6 +227,22 @@ process_options(tcp_segment_header &segment, net_buffer *buffer, size_t size)
 				if (option->length == 2 && size >= 2)
 					segment.options |= TCP_SACK_PERMITTED;
 				break;
+			case TCP_OPTION_SACK:
+				if (option->length >= 2 + sizeof(tcp_sack)
+					&& (option->length - 2) % sizeof(tcp_sack) == 0
+					&& size >= option->length) {
+					int count = min_c(
+						(int)((option->length - 2) / sizeof(tcp_sack)),
+						TCP_MAX_SACK_BLOCKS);
+					for (int i = 0; i < count; i++) {
+						segment.sacks[i].left_edge
+							= ntohl(option->sack[i].left_edge);
+						segment.sacks[i].right_edge
+							= ntohl(option->sack[i].right_edge);
+					}
+					segment.sack_count = count;
+				}
+				break;
 		}
 
 		if (length < 0) {
@@ -262,6 +286,7 @@ dump_endpoints(int argc, char** argv)
 			manager->Dump();
 	}
 
+	dump_buffer_budget();
 	return 0;
 }
 
@@ -678,7 +703,8 @@ tcp_receive_data(net_buffer* buffer)
 	if (headerLength < sizeof(tcp_header))
 		return B_BAD_DATA;
 
-	if (Checksum::PseudoHeader(addressModule, gBufferModule, buffer,
+	if ((buffer->flags & NET_BUFFER_CHECKSUM_VALID) == 0
+		&& Checksum::PseudoHeader(addressModule, gBufferModule, buffer,
 			IPPROTO_TCP) != 0)
 		return B_BAD_DATA;
 
@@ -751,7 +777,11 @@ tcp_init()
 {
 	rw_lock_init(&sEndpointManagersLock, "endpoint managers");
 
-	status_t status = gStackModule->register_domain_protocols(AF_INET,
+	status_t status = init_buffer_budget();
+	if (status < B_OK)
+		return status;
+
+	status = gStackModule->register_domain_protocols(AF_INET,
 		SOCK_STREAM, 0,
 		"network/protocols/tcp/v1",
 		"network/protocols/ipv4/v1",
@@ -790,6 +820,22 @@ tcp_init()
 	if (status < B_OK)
 		return status;
 
+	// the system wide default congestion control algorithm, and whether or
+	// not segmentation offload is used can be chosen in the "tcp" driver
+	// settings file
+	void* settings = load_driver_settings("tcp");
+	if (settings != NULL) {
+		const char* name = get_driver_parameter(settings, "congestion_control",
+			NULL, NULL);
+		if (name != NULL && CongestionControl::SetDefault(name) != B_OK)
+			dprintf("tcp: unknown congestion control \"%s\"\n", name);
+
+		gSegmentationOffload = get_driver_boolean_parameter(settings,
+			"segmentation_offload", true, true);
+
+		unload_driver_settings(settings);
+	}
+
 	add_debugger_command("tcp_endpoints", dump_endpoints,
 		"lists all open TCP endpoints");
 	add_debugger_command("tcp_endpoint", dump_endpoint,
@@ -806,6 +852,7 @@ tcp_uninit()
 	remove_debugger_command("tcp_endpoints", dump_endpoints);
 
 	rw_lock_destroy(&sEndpointManagersLock);
+	uninit_buffer_budget();
 
 	for (int i = 0; i < AF_MAX; i++) {
 		delete sEndpointManagers[i];
@@ -218,6 +218,7 @@ enum tcp_option_kind {
 };
 
 #define TCP_MAX_WINDOW_SHIFT	14
+#define TCP_MAX_SACK_BLOCKS		4
 
 enum {
 	TCP_HAS_WINDOW_SCALE	= 1 << 0,
@@ -246,7 +247,8 @@ struct tcp_segment_header {
 	uint32	timestamp_value;
 	uint32	timestamp_reply;
 
-	tcp_sack	*sacks;
+	tcp_sack	sacks[TCP_MAX_SACK_BLOCKS];
+		// in host byte order
 	int			sack_count;
 
 	uint32	options;
@@ -272,6 +274,7 @@ extern net_buffer_module_info* gBufferModule;
 extern net_datalink_module_info* gDatalinkModule;
 extern net_socket_module_info* gSocketModule;
 extern net_stack_module_info* gStackModule;
+extern bool gSegmentationOffload;
 
 
 EndpointManager* get_endpoint_manager(net_domain* domain);
@@ -30,6 +30,7 @@
 #include <new>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <utility>
 
 
@@ -90,6 +91,8 @@ public:
 			ssize_t				BytesAvailable();
 			status_t			FetchData(size_t numBytes, uint32 flags,
 									net_buffer** _buffer);
+			status_t			FetchMultiple(uint32 flags,
+									net_buffer** _buffers, uint32* _count);
 
 			status_t			StoreData(net_buffer* buffer);
 			status_t			DeliverData(net_buffer* buffer);
@@ -101,6 +104,9 @@ public:
 
 			UdpEndpoint*&		HashTableLink() { return fLink; }
 
+			uid_t				Owner() const { return fOwner; }
+			void				SetOwner(uid_t owner) { fOwner = owner; }
+
 			void				Dump() const;
 
 private:
@@ -111,6 +117,11 @@ private:
 									// optionally connected)
 
 			UdpEndpoint*		fLink;
+			uid_t				fOwner;
+									// effective user that bound the
+									// endpoint, only endpoints of the same
+									// user may share an address via
+									// SO_REUSEPORT
 };
 
 
@@ -187,7 +198,10 @@ private:
 	status_t _FinishBind(UdpEndpoint *endpoint, const sockaddr *address);
 
 	UdpEndpoint *_FindActiveEndpoint(const sockaddr *ourAddress,
-		const sockaddr *peerAddress, uint32 index = 0);
+		const sockaddr *peerAddress, uint32 index = 0, uint32 flowHash = 0);
+	bool _IsMatchingEndpoint(UdpEndpoint *endpoint,
+		const sockaddr *ourAddress, const sockaddr *peerAddress,
+		uint32 index) const;
 	status_t _DemuxBroadcast(net_buffer *buffer);
 	status_t _DemuxUnicast(net_buffer *buffer);
 
@@ -446,10 +460,12 @@ UdpDomainSupport::_Bind(UdpEndpoint *endpoint, const sockaddr *address)
 				|| (socketOptions & (SO_REUSEADDR | SO_REUSEPORT)) == 0)
 				return EADDRINUSE;
 
-			// if both addresses are the same, SO_REUSEPORT is required:
+			// if both addresses are the same, SO_REUSEPORT is required, and
+			// both endpoints must belong to the same user:
 			if (otherEndpoint->LocalAddress().EqualTo(address, false)
 				&& ((otherEndpoint->Socket()->options & SO_REUSEPORT) == 0
-					|| (socketOptions & SO_REUSEPORT) == 0))
+					|| (socketOptions & SO_REUSEPORT) == 0
+					|| otherEndpoint->Owner() != geteuid()))
 				return EADDRINUSE;
 		}
 	}
@@ -486,14 +502,34 @@ UdpDomainSupport::_FinishBind(UdpEndpoint *endpoint, const sockaddr *address)
 
 	fActiveEndpoints.Insert(endpoint);
 	endpoint->SetActive(true);
+	endpoint->SetOwner(geteuid());
 
 	return B_OK;
 }
 
 
+bool
+UdpDomainSupport::_IsMatchingEndpoint(UdpEndpoint *endpoint,
+	const sockaddr *ourAddress, const sockaddr *peerAddress,
+	uint32 index) const
+{
+	// Make sure the bound_to_device constraint is fulfilled
+	if (endpoint->socket->bound_to_device != 0 && index != 0
+		&& endpoint->socket->bound_to_device != index)
+		return false;
+
+	return endpoint->LocalAddress().EqualTo(ourAddress, true)
+		&& endpoint->PeerAddress().EqualTo(peerAddress, true);
+}
+
+
+/*!	Returns the endpoint for the given addresses. If several endpoints share
+	them via SO_REUSEPORT, the \a flowHash chooses between them, so that all
+	datagrams of a flow are received by the same endpoint.
+*/
 UdpEndpoint *
 UdpDomainSupport::_FindActiveEndpoint(const sockaddr *ourAddress,
-	const sockaddr *peerAddress, uint32 index)
+	const sockaddr *peerAddress, uint32 index, uint32 flowHash)
 {
 	ASSERT_LOCKED_MUTEX(&fLock);
 
@@ -504,14 +540,32 @@ UdpDomainSupport::_FindActiveEndpoint(const sockaddr *ourAddress,
 	UdpEndpoint* endpoint = fActiveEndpoints.Lookup(
 		std::make_pair(ourAddress, peerAddress));
 
-	// Make sure the bound_to_device constraint is fulfilled
-	while (endpoint != NULL && endpoint->socket->bound_to_device != 0
-		&& index != 0 && endpoint->socket->bound_to_device != index) {
+	while (endpoint != NULL
+		&& !_IsMatchingEndpoint(endpoint, ourAddress, peerAddress, index)) {
 		endpoint = endpoint->HashTableLink();
-		if (endpoint != NULL
-			&& (!endpoint->LocalAddress().EqualTo(ourAddress, true)
-				|| !endpoint->PeerAddress().EqualTo(peerAddress, true)))
-			return NULL;
+	}
+
+	if (endpoint == NULL || (endpoint->Socket()->options & SO_REUSEPORT) == 0)
+		return endpoint;
+
+	// the other endpoints sharing the addresses follow in the same bucket;
+	// binding makes sure they all belong to the same user, this just
+	// doesn't rely on it
+	uid_t owner = endpoint->Owner();
+	uint32 count = 0;
+	for (UdpEndpoint* other = endpoint; other != NULL;
+			other = other->HashTableLink()) {
+		if (other->Owner() == owner
+			&& _IsMatchingEndpoint(other, ourAddress, peerAddress, index))
+			count++;
+	}
+
+	uint32 selected = (flowHash ^ (flowHash >> 16)) % count;
+	for (; endpoint != NULL; endpoint = endpoint->HashTableLink()) {
+		if (endpoint->Owner() == owner
+			&& _IsMatchingEndpoint(endpoint, ourAddress, peerAddress, index)
+			&& selected-- == 0)
+			break;
 	}
 
 	return endpoint;
@@ -574,22 +628,27 @@ UdpDomainSupport::_DemuxUnicast(net_buffer* buffer)
 
 	const sockaddr* localAddress = buffer->destination;
 	const sockaddr* peerAddress = buffer->source;
+	uint32 flowHash = AddressModule()->hash_address_pair(localAddress,
+		peerAddress);
 
 	// look for full (most special) match:
 	UdpEndpoint* endpoint = _FindActiveEndpoint(localAddress, peerAddress,
-		buffer->index);
+		buffer->index, flowHash);
 	if (endpoint == NULL) {
 		// look for endpoint matching local address & port:
-		endpoint = _FindActiveEndpoint(localAddress, NULL, buffer->index);
+		endpoint = _FindActiveEndpoint(localAddress, NULL, buffer->index,
+			flowHash);
 		if (endpoint == NULL) {
 			// look for endpoint matching peer address & port and local port:
 			SocketAddressStorage local(AddressModule());
 			local.SetToEmpty();
 			local.SetPort(AddressModule()->get_port(localAddress));
-			endpoint = _FindActiveEndpoint(*local, peerAddress, buffer->index);
+			endpoint = _FindActiveEndpoint(*local, peerAddress, buffer->index,
+				flowHash);
 			if (endpoint == NULL) {
 				// last chance: look for endpoint matching local port only:
-				endpoint = _FindActiveEndpoint(*local, NULL, buffer->index);
+				endpoint = _FindActiveEndpoint(*local, NULL, buffer->index,
+					flowHash);
 			}
 		}
 	}
@@ -907,7 +966,8 @@ UdpEndpointManager::_GetDomainSupport(net_buffer* buffer)
 UdpEndpoint::UdpEndpoint(net_socket *socket)
 	:
 	DatagramSocket<>("udp endpoint", socket),
-	fActive(false)
+	fActive(false),
+	fOwner((uid_t)-1)
 {
 }
 
@@ -1048,6 +1108,18 @@ UdpEndpoint::FetchData(size_t numBytes, uint32 flags, net_buffer **_buffer)
 }
 
 
+status_t
+UdpEndpoint::FetchMultiple(uint32 flags, net_buffer **_buffers, uint32 *_count)
+{
+	TRACE_EP("FetchMultiple(0x%lx, %lu)", flags, *_count);
+
+	status_t status = DequeueMultiple(flags, _buffers, _count);
+	TRACE_EP("  FetchMultiple(): returned %lu buffers, status: %s", *_count,
+		strerror(status));
+	return status;
+}
+
+
 status_t
 UdpEndpoint::StoreData(net_buffer *buffer)
 {
@@ -1234,6 +1306,14 @@ udp_read_data(net_protocol *protocol, size_t numBytes, uint32 flags,
 }
 
 
+status_t
+udp_read_data_multiple(net_protocol *protocol, uint32 flags,
+	net_buffer **_buffers, uint32 *_count)
+{
+	return ((UdpEndpoint *)protocol)->FetchMultiple(flags, _buffers, _count);
+}
+
+
 ssize_t
 udp_read_avail(net_protocol *protocol)
 {
@@ -1457,7 +1537,8 @@ net_protocol_module_info sUDPModule = {
 	NULL,		// process_ancillary_data()
 	udp_process_ancillary_data_no_container,
 	NULL,		// send_data_no_buffer()
-	NULL		// read_data_no_buffer()
+	NULL,		// read_data_no_buffer()
+	udp_read_data_multiple
 };
 
 module_dependency module_dependencies[] = {
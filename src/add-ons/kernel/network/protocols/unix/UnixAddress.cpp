@@ -317,5 +317,6 @@ net_address_module_info gAddressModule = {
 	unix_hash_address,
 	unix_hash_address_pair,
 	unix_checksum_address,
-	NULL	// get_loopback_address
+	NULL,	// get_loopback_address
+	NULL	// get_route_key
 };
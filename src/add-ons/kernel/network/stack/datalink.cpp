@@ -27,6 +27,7 @@
 #include "device_interfaces.h"
 #include "domains.h"
 #include "interfaces.h"
+#include "offload.h"
 #include "routes.h"
 #include "stack_private.h"
 #include "utility.h"
@@ -365,13 +366,16 @@ datalink_send_routed_data(struct net_route* route, net_buffer* buffer)
 		TRACE("  local route\n");
 
 		// We set the interface address here, so the buffer is delivered
-		// directly to the domain in interfaces.cpp:device_consumer_thread()
+		// directly to the domain in device_consumer_thread()
 		address->AcquireReference();
 		set_interface_address(buffer->interface_address, address);
 
+		// local segments never need to be split
+		buffer->segment_size = 0;
+
 		// this one goes back to the domain directly
-		return fifo_enqueue_buffer(
-			&interface->DeviceInterface()->receive_queue, buffer);
+		return device_interface_enqueue_buffer(interface->DeviceInterface(),
+			buffer);
 	}
 
 	if ((route->flags & RTF_GATEWAY) != 0) {
@@ -669,11 +673,8 @@ interface_protocol_uninit(net_datalink_protocol* protocol)
 
 
 static status_t
-interface_protocol_send_data(net_datalink_protocol* _protocol,
-	net_buffer* buffer)
+interface_protocol_send_to_device(void* _protocol, net_buffer* buffer)
 {
-	TRACE("%s(%p, buffer %p)\n", __FUNCTION__, _protocol, buffer);
-
 	interface_protocol* protocol = (interface_protocol*)_protocol;
 	Interface* interface = (Interface*)protocol->interface;
 
@@ -684,6 +685,25 @@ interface_protocol_send_data(net_datalink_protocol* _protocol,
 }
 
 
+static status_t
+interface_protocol_send_data(net_datalink_protocol* _protocol,
+	net_buffer* buffer)
+{
+	TRACE("%s(%p, buffer %p)\n", __FUNCTION__, _protocol, buffer);
+
+	interface_protocol* protocol = (interface_protocol*)_protocol;
+
+	if (buffer->segment_size != 0
+		&& (protocol->device->offload & NET_DEVICE_SEGMENTATION_OFFLOAD) == 0) {
+		// this is the last chance to split the segment for the device
+		return send_segmented(buffer, protocol->device->header_length,
+			&interface_protocol_send_to_device, protocol);
+	}
+
+	return interface_protocol_send_to_device(protocol, buffer);
+}
+
+
 static status_t
 interface_protocol_up(net_datalink_protocol* protocol)
 {
@@ -10,17 +10,20 @@
 #include "device_interfaces.h"
 #include "domains.h"
 #include "interfaces.h"
+#include "offload.h"
 #include "stack_private.h"
 #include "utility.h"
 
 #include <net_device.h>
 
 #include <lock.h>
+#include <smp.h>
 #include <util/AutoLock.h>
 
 #include <KernelExport.h>
 
 #include <net/if_dl.h>
+#include <net/if_types.h>
 #include <netinet/in.h>
 #include <new>
 #include <stdio.h>
@@ -41,20 +44,105 @@ static DeviceInterfaceList sInterfaces;
 static uint32 sDeviceIndex;
 
 
-/*!	A service thread for each device interface. It just reads as many packets
-	as availabe, deframes them, and puts them into the receive queue of the
-	device interface.
+/*!	Computes a hash of the flow \a buffer belongs to, that is its addresses,
+	protocol and ports, so that all buffers of a flow end up in the same
+	receive queue. Buffers that are not IP are all put into the first queue.
+*/
+static uint32
+receive_flow_hash(net_device_interface* interface, net_buffer* buffer)
+{
+	if (buffer->interface_address == NULL
+		&& buffer->type != B_NET_FRAME_TYPE_IPV4
+		&& buffer->type != B_NET_FRAME_TYPE_IPV6
+		&& interface->device->type != IFT_LOOP)
+		return 0;
+
+	uint8 header[64];
+	size_t length = min_c(buffer->size, sizeof(header));
+	if (length < 20 || gNetBufferModule.read(buffer, 0, header, length) != B_OK)
+		return 0;
+
+	const uint8* addresses;
+	size_t addressesLength;
+	uint8 protocol;
+	size_t portOffset = 0;
+
+	switch (header[0] >> 4) {
+		case 4:
+			protocol = header[9];
+			addresses = header + 12;
+			addressesLength = 8;
+			// fragments don't have the ports in them
+			if ((((header[6] << 8) | header[7]) & 0x3fff) == 0)
+				portOffset = (header[0] & 0xf) * 4;
+			break;
+
+		case 6:
+			if (length < 40)
+				return 0;
+			protocol = header[6];
+			addresses = header + 8;
+			addressesLength = 32;
+			portOffset = 40;
+			break;
+
+		default:
+			return 0;
+	}
+
+	uint32 hash = protocol;
+	for (size_t i = 0; i < addressesLength; i += 4) {
+		hash = (hash ^ (addresses[i] << 24 | addresses[i + 1] << 16
+			| addresses[i + 2] << 8 | addresses[i + 3])) * 0x9e3779b1;
+	}
+
+	if ((protocol == IPPROTO_TCP || protocol == IPPROTO_UDP)
+		&& portOffset != 0 && portOffset + 4 <= length) {
+		hash = (hash ^ (header[portOffset] << 24 | header[portOffset + 1] << 16
+			| header[portOffset + 2] << 8 | header[portOffset + 3]))
+				* 0x9e3779b1;
+	}
+
+	return hash ^ (hash >> 16);
+}
+
+
+/*!	Puts the received \a buffer into the receive queue of the given \a index,
+	or, if \a index is negative, into the one its flow hashes to.
 */
 static status_t
-device_reader_thread(void* _interface)
+enqueue_received_buffer(net_device_interface* interface, net_buffer* buffer,
+	int32 index = -1)
+{
+	if (index < 0) {
+		index = interface->receive_queue_count > 1
+			? receive_flow_hash(interface, buffer)
+				% interface->receive_queue_count
+			: 0;
+	}
+
+	return fifo_enqueue_buffer(&interface->receive_queues[index].fifo, buffer);
+}
+
+
+/*!	Receives buffers from \a device, and puts them into the receive queues.
+	If \a queue is negative, the device has a single receive queue, and the
+	buffers are spread by their flow.
+*/
+static status_t
+read_device(net_device_interface* interface, int32 queue)
 {
-	net_device_interface* interface = (net_device_interface*)_interface;
 	net_device* device = interface->device;
 	status_t status = B_OK;
 
 	while ((device->flags & IFF_UP) != 0) {
 		net_buffer* buffer;
-		status = device->module->receive_data(device, &buffer);
+		if (queue < 0)
+			status = device->module->receive_data(device, &buffer);
+		else {
+			status = device->module->receive_queue_data(device, queue,
+				&buffer);
+		}
 		if (status == B_OK) {
 			// feed device monitors
 			if (atomic_get(&interface->monitor_count) > 0)
@@ -67,7 +155,7 @@ device_reader_thread(void* _interface)
 				continue;
 			}
 
-			fifo_enqueue_buffer(&interface->receive_queue, buffer);
+			enqueue_received_buffer(interface, buffer, queue);
 		} else if (status == B_DEVICE_NOT_FOUND) {
 				device_removed(device);
 		} else {
@@ -81,20 +169,62 @@ device_reader_thread(void* _interface)
 }
 
 
+/*!	A service thread for each device interface. It just reads as many packets
+	as availabe, deframes them, and puts them into the receive queues of the
+	device interface.
+*/
+static status_t
+device_reader_thread(void* _interface)
+{
+	return read_device((net_device_interface*)_interface, -1);
+}
+
+
+/*!	Like device_reader_thread(), but for devices with several hardware
+	receive queues. There is one for each of them; since the device already
+	spread the flows, the buffers go to the receive queue of the same index.
+*/
+static status_t
+device_queue_reader_thread(void* _queue)
+{
+	net_receive_queue* queue = (net_receive_queue*)_queue;
+	net_device_interface* interface = queue->interface;
+
+	return read_device(interface, queue - interface->receive_queues);
+}
+
+
 static status_t
-device_consumer_thread(void* _interface)
+device_consumer_thread(void* _queue)
 {
-	net_device_interface* interface = (net_device_interface*)_interface;
+	net_receive_queue* queue = (net_receive_queue*)_queue;
+	net_device_interface* interface = queue->interface;
 	net_device* device = interface->device;
 	net_buffer* buffer;
+	net_buffer* next = NULL;
 
 	while (true) {
-		ssize_t status = fifo_dequeue_buffer(&interface->receive_queue, 0,
-			B_INFINITE_TIMEOUT, &buffer);
-		if (status != B_OK) {
-			if (status == B_INTERRUPTED)
-				continue;
-			break;
+		if (next != NULL) {
+			buffer = next;
+			next = NULL;
+		} else {
+			ssize_t status = fifo_dequeue_buffer(&queue->fifo, 0,
+				B_INFINITE_TIMEOUT, &buffer);
+			if (status != B_OK) {
+				if (status == B_INTERRUPTED)
+					continue;
+				break;
+			}
+		}
+
+		// Merge the segments of a TCP connection that are already waiting
+		// in the queue, so that they only need to be processed once
+		while (fifo_dequeue_buffer(&queue->fifo, MSG_DONTWAIT, 0, &next)
+				== B_OK) {
+			if (!coalesce_received(buffer, next))
+				break;
+
+			next = NULL;
 		}
 
 		if (buffer->interface_address != NULL) {
@@ -113,7 +243,7 @@ device_consumer_thread(void* _interface)
 
 			// Find handler for this packet
 
-			RecursiveLocker locker(interface->receive_lock);
+			ReadLocker locker(interface->receive_funcs_lock);
 
 			DeviceHandlerList::Iterator iterator
 				= interface->receive_funcs.GetIterator();
@@ -171,28 +301,69 @@ allocate_device_interface(net_device* device, net_device_module_info* module)
 		return NULL;
 
 	recursive_lock_init(&interface->receive_lock, "device interface receive");
+	rw_lock_init(&interface->receive_funcs_lock, "device interface handlers");
 	mutex_init(&interface->monitor_lock, "device interface monitors");
 
-	char name[128];
-	snprintf(name, sizeof(name), "%s receive queue", device->name);
-
-	if (init_fifo(&interface->receive_queue, name, 16 * 1024 * 1024) < B_OK)
-		goto error1;
-
 	interface->device = device;
 	interface->up_count = 0;
 	interface->ref_count = 1;
 	interface->deframe_func = NULL;
 	interface->deframe_ref_count = 0;
+	interface->reader_thread = -1;
+
+	// Use a receive queue per CPU, and at least as many as the device has
+	// hardware queues
+	interface->hardware_queue_count = 0;
+	if (device->receive_queue_count > 1
+		&& module->receive_queue_data != NULL) {
+		interface->hardware_queue_count = min_c(device->receive_queue_count,
+			MAX_RECEIVE_QUEUES);
+	}
+	interface->receive_queue_count = max_c(interface->hardware_queue_count,
+		min_c((uint32)smp_get_num_cpus(), MAX_RECEIVE_QUEUES));
+
+	uint32 count = 0;
+	for (; count < interface->receive_queue_count; count++) {
+		net_receive_queue& queue = interface->receive_queues[count];
+		queue.interface = interface;
+		queue.reader_thread = -1;
+
+		char name[128];
+		snprintf(name, sizeof(name), "%s receive queue %" B_PRIu32,
+			device->name, count);
+
+		if (init_fifo(&queue.fifo, name,
+				16 * 1024 * 1024 / interface->receive_queue_count) < B_OK)
+			break;
+
+		snprintf(name, sizeof(name), "%s consumer %" B_PRIu32, device->name,
+			count);
+
+		queue.consumer_thread = spawn_kernel_thread(device_consumer_thread,
+			name, B_DISPLAY_PRIORITY, &queue);
+		if (queue.consumer_thread < B_OK) {
+			uninit_fifo(&queue.fifo);
+			break;
+		}
+		resume_thread(queue.consumer_thread);
+	}
+
+	if (count < interface->receive_queue_count) {
+		for (uint32 i = 0; i < count; i++) {
+			net_receive_queue& queue = interface->receive_queues[i];
+			uninit_fifo(&queue.fifo);
+
+			status_t status;
+			wait_for_thread(queue.consumer_thread, &status);
+		}
 
-	snprintf(name, sizeof(name), "%s consumer", device->name);
+		recursive_lock_destroy(&interface->receive_lock);
+		rw_lock_destroy(&interface->receive_funcs_lock);
+		mutex_destroy(&interface->monitor_lock);
+		delete interface;
 
-	interface->reader_thread   = -1;
-	interface->consumer_thread = spawn_kernel_thread(device_consumer_thread,
-		name, B_DISPLAY_PRIORITY, interface);
-	if (interface->consumer_thread < B_OK)
-		goto error2;
-	resume_thread(interface->consumer_thread);
+		return NULL;
+	}
 
 	// TODO: proper interface index allocation
 	device->index = ++sDeviceIndex;
@@ -200,15 +371,6 @@ allocate_device_interface(net_device* device, net_device_module_info* module)
 
 	sInterfaces.Add(interface);
 	return interface;
-
-error2:
-	uninit_fifo(&interface->receive_queue);
-error1:
-	recursive_lock_destroy(&interface->receive_lock);
-	mutex_destroy(&interface->monitor_lock);
-	delete interface;
-
-	return NULL;
 }
 
 
@@ -246,7 +408,6 @@ dump_device_interface(int argc, char** argv)
 	kprintf("ref_count:         %" B_PRId32 "\n", interface->ref_count);
 	kprintf("deframe_func:      %p\n", interface->deframe_func);
 	kprintf("deframe_ref_count: %" B_PRId32 "\n", interface->ref_count);
-	kprintf("consumer_thread:   %ld\n", interface->consumer_thread);
 
 	kprintf("monitor_count:     %" B_PRId32 "\n", interface->monitor_count);
 	kprintf("monitor_lock:      %p\n", &interface->monitor_lock);
@@ -257,7 +418,14 @@ dump_device_interface(int argc, char** argv)
 		kprintf("  %p\n", monitorIterator.Next());
 
 	kprintf("receive_lock:      %p\n", &interface->receive_lock);
-	kprintf("receive_queue:     %p\n", &interface->receive_queue);
+	kprintf("receive_queues:    %" B_PRIu32 " (%" B_PRIu32 " in hardware)\n",
+		interface->receive_queue_count, interface->hardware_queue_count);
+	for (uint32 i = 0; i < interface->receive_queue_count; i++) {
+		net_receive_queue& queue = interface->receive_queues[i];
+		kprintf("  %p  reader %ld, consumer %ld, %" B_PRIuSIZE " bytes\n",
+			&queue.fifo, queue.reader_thread, queue.consumer_thread,
+			queue.fifo.current_bytes);
+	}
 	kprintf("receive_funcs:\n");
 	DeviceHandlerList::Iterator handlerIterator
 		= interface->receive_funcs.GetIterator();
@@ -381,9 +549,13 @@ put_device_interface(struct net_device_interface* interface)
 	sInterfaces.Remove(interface);
 	locker.Unlock();
 
-	uninit_fifo(&interface->receive_queue);
-	status_t status;
-	wait_for_thread(interface->consumer_thread, &status);
+	for (uint32 i = 0; i < interface->receive_queue_count; i++) {
+		net_receive_queue& queue = interface->receive_queues[i];
+		uninit_fifo(&queue.fifo);
+
+		status_t status;
+		wait_for_thread(queue.consumer_thread, &status);
+	}
 
 	net_device* device = interface->device;
 	const char* moduleName = device->module->info.name;
@@ -392,6 +564,7 @@ put_device_interface(struct net_device_interface* interface)
 	put_module(moduleName);
 
 	mutex_destroy(&interface->monitor_lock);
+	rw_lock_destroy(&interface->receive_funcs_lock);
 	recursive_lock_destroy(&interface->receive_lock);
 	delete interface;
 }
@@ -486,6 +659,17 @@ device_interface_monitor_receive(net_device_interface* interface,
 }
 
 
+/*!	Puts a buffer that has already been deframed into the receive queue of
+	its flow.
+*/
+status_t
+device_interface_enqueue_buffer(net_device_interface* interface,
+	net_buffer* buffer)
+{
+	return enqueue_received_buffer(interface, buffer);
+}
+
+
 status_t
 up_device_interface(net_device_interface* interface)
 {
@@ -502,7 +686,29 @@ up_device_interface(net_device_interface* interface)
 	if (status != B_OK)
 		return status;
 
-	if (device->module->receive_data != NULL) {
+	if (interface->hardware_queue_count > 0) {
+		for (uint32 i = 0; i < interface->hardware_queue_count; i++) {
+			net_receive_queue& queue = interface->receive_queues[i];
+
+			// give the thread a nice name
+			char name[B_OS_NAME_LENGTH];
+			snprintf(name, sizeof(name), "%s reader %" B_PRIu32, device->name,
+				i);
+
+			queue.reader_thread = spawn_kernel_thread(
+				device_queue_reader_thread, name,
+				B_REAL_TIME_DISPLAY_PRIORITY - 10, &queue);
+			if (queue.reader_thread < B_OK) {
+				status = queue.reader_thread;
+				while (i-- > 0) {
+					kill_thread(interface->receive_queues[i].reader_thread);
+					interface->receive_queues[i].reader_thread = -1;
+				}
+				device->module->down(device);
+				return status;
+			}
+		}
+	} else if (device->module->receive_data != NULL) {
 		// give the thread a nice name
 		char name[B_OS_NAME_LENGTH];
 		snprintf(name, sizeof(name), "%s reader", device->name);
@@ -515,7 +721,10 @@ up_device_interface(net_device_interface* interface)
 
 	device->flags |= IFF_UP;
 
-	if (device->module->receive_data != NULL)
+	if (interface->hardware_queue_count > 0) {
+		for (uint32 i = 0; i < interface->hardware_queue_count; i++)
+			resume_thread(interface->receive_queues[i].reader_thread);
+	} else if (device->module->receive_data != NULL)
 		resume_thread(interface->reader_thread);
 
 	interface->up_count = 1;
@@ -546,10 +755,18 @@ down_device_interface(net_device_interface* interface)
 
 	notify_device_monitors(interface, B_DEVICE_GOING_DOWN);
 
-	if (device->module->receive_data != NULL) {
+	// make sure the reader threads are gone before shutting down the interface
+	if (interface->hardware_queue_count > 0) {
+		for (uint32 i = 0; i < interface->hardware_queue_count; i++) {
+			net_receive_queue& queue = interface->receive_queues[i];
+
+			status_t status;
+			wait_for_thread(queue.reader_thread, &status);
+			queue.reader_thread = -1;
+		}
+	} else if (device->module->receive_data != NULL) {
 		thread_id readerThread = interface->reader_thread;
 
-		// make sure the reader thread is gone before shutting down the interface
 		status_t status;
 		wait_for_thread(readerThread, &status);
 	}
@@ -635,6 +852,7 @@ register_device_handler(struct net_device* device, int32 type,
 		return B_DEVICE_NOT_FOUND;
 
 	RecursiveLocker _(interface->receive_lock);
+	WriteLocker handlerLocker(interface->receive_funcs_lock);
 
 	// see if such a handler already for this device
 
@@ -671,6 +889,7 @@ unregister_device_handler(struct net_device* device, int32 type)
 		return B_DEVICE_NOT_FOUND;
 
 	RecursiveLocker _(interface->receive_lock);
+	WriteLocker handlerLocker(interface->receive_funcs_lock);
 
 	// search for the handler
 
@@ -793,7 +1012,7 @@ device_enqueue_buffer(net_device* device, net_buffer* buffer)
 	if (interface == NULL)
 		return B_DEVICE_NOT_FOUND;
 
-	status_t status = fifo_enqueue_buffer(&interface->receive_queue, buffer);
+	status_t status = enqueue_received_buffer(interface, buffer);
 
 	put_device_interface(interface);
 	return status;
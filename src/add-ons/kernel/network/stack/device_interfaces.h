@@ -10,11 +10,16 @@
 
 
 #include <net_datalink.h>
+#include <net_device.h>
 #include <net_stack.h>
 
+#include <lock.h>
 #include <util/DoublyLinkedList.h>
 
 
+#define MAX_RECEIVE_QUEUES		NET_DEVICE_MAX_RECEIVE_QUEUES
+
+
 struct net_device_handler : DoublyLinkedListLinkImpl<net_device_handler> {
 	net_receive_func	func;
 	int32				type;
@@ -26,6 +31,20 @@ typedef DoublyLinkedList<net_device_handler> DeviceHandlerList;
 typedef DoublyLinkedList<net_device_monitor,
 	DoublyLinkedListCLink<net_device_monitor> > DeviceMonitorList;
 
+struct net_device_interface;
+
+/*!	Received buffers are spread over several of these queues by their flow,
+	so that they can be processed on several CPUs, while the buffers of a
+	single flow stay in order.
+*/
+struct net_receive_queue {
+	net_device_interface* interface;
+	thread_id			reader_thread;
+		// reads the hardware queue of the same index, if any
+	thread_id			consumer_thread;
+	net_fifo			fifo;
+};
+
 struct net_device_interface : DoublyLinkedListLinkImpl<net_device_interface> {
 	struct net_device*	device;
 	thread_id			reader_thread;
@@ -41,10 +60,13 @@ struct net_device_interface : DoublyLinkedListLinkImpl<net_device_interface> {
 	DeviceMonitorList	monitor_funcs;
 
 	DeviceHandlerList	receive_funcs;
+	rw_lock				receive_funcs_lock;
+		// read locked while the received buffers are handed out
 	recursive_lock		receive_lock;
 
-	thread_id			consumer_thread;
-	net_fifo			receive_queue;
+	uint32				receive_queue_count;
+	uint32				hardware_queue_count;
+	net_receive_queue	receive_queues[MAX_RECEIVE_QUEUES];
 };
 
 typedef DoublyLinkedList<net_device_interface> DeviceInterfaceList;
@@ -62,6 +84,8 @@ struct net_device_interface* get_device_interface(const char* name,
 	bool create = true);
 void device_interface_monitor_receive(net_device_interface* interface,
 	net_buffer* buffer);
+status_t device_interface_enqueue_buffer(net_device_interface* interface,
+	net_buffer* buffer);
 status_t up_device_interface(net_device_interface* interface);
 void down_device_interface(net_device_interface* interface);
 
@@ -139,6 +139,13 @@ register_domain(int family, const char* name,
 	domain->module = module;
 	domain->address_module = addressModule;
 
+	status_t status = init_route_caches(domain);
+	if (status != B_OK) {
+		recursive_lock_destroy(&domain->lock);
+		delete domain;
+		return status;
+	}
+
 	sDomains.Add(domain);
 
 	*_domain = domain;
@@ -157,6 +164,7 @@ unregister_domain(net_domain* _domain)
 
 	sDomains.Remove(domain);
 
+	uninit_route_caches(domain);
 	recursive_lock_destroy(&domain->lock);
 	delete domain;
 	return B_OK;
@@ -25,6 +25,9 @@ struct net_domain_private : net_domain,
 
 	RouteList			routes;
 	RouteInfoList		route_infos;
+	RouteTrie			route_trie;
+	route_cache*		route_caches;
+		// one per CPU, NULL if the address module has no route keys
 };
 
 
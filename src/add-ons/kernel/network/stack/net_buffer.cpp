@@ -19,6 +19,8 @@
 #include <debug.h>
 #include <kernel.h>
 #include <KernelExport.h>
+#include <smp.h>
+#include <util/AutoLock.h>
 #include <util/DoublyLinkedList.h>
 
 #include <algorithm>
@@ -43,6 +45,11 @@
 #define BUFFER_SIZE 2048
 	// maximum implementation derived buffer size is 65536
 
+#define CPU_POOL_SIZE		64
+#define CPU_POOL_BATCH		16
+	// every CPU keeps up to CPU_POOL_SIZE free objects of each kind, and
+	// exchanges them with the object caches CPU_POOL_BATCH at a time
+
 #define ENABLE_DEBUGGER_COMMANDS	1
 #define ENABLE_STATS				1
 #define PARANOID_BUFFER_CHECK		NET_BUFFER_PARANOIA
@@ -70,6 +77,10 @@ struct data_header {
 	uint8*			data_end;
 	header_space	space;
 	uint16			tail_space;
+	net_buffer_release_func release;
+		// if set, the header's nodes refer to external memory that is
+		// given back via this function once the header is freed
+	void*			release_cookie;
 };
 
 struct data_node {
@@ -151,8 +162,31 @@ struct net_buffer_private : net_buffer {
 #define MAX_FREE_BUFFER_SIZE			(BUFFER_SIZE - DATA_HEADER_SIZE)
 
 
+enum {
+	NET_BUFFER_POOL = 0,
+	DATA_HEADER_POOL,
+	POOL_COUNT
+};
+
+struct cpu_pool {
+	void*			objects[CPU_POOL_SIZE];
+	int32			count;
+#if ENABLE_STATS
+	int32			allocated;
+		// may become negative when objects are freed on another CPU
+	int32			ever_allocated;
+#endif
+};
+
+struct net_buffer_cpu {
+	cpu_pool		pools[POOL_COUNT];
+};
+
+
 static object_cache* sNetBufferCache;
 static object_cache* sDataNodeCache;
+static net_buffer_cpu* sCPUPools;
+static int32 sCPUCount;
 
 
 static status_t append_data(net_buffer* buffer, const void* data, size_t size);
@@ -161,17 +195,16 @@ static status_t remove_header(net_buffer* _buffer, size_t bytes);
 static status_t remove_trailer(net_buffer* _buffer, size_t bytes);
 static status_t append_cloned_data(net_buffer* _buffer, net_buffer* _source,
 					uint32 offset, size_t bytes);
+static status_t append_external_data(net_buffer* _buffer, const void* data,
+					size_t bytes, net_buffer_release_func release,
+					void* cookie);
 static status_t read_data(net_buffer* _buffer, size_t offset, void* data,
 					size_t size);
 
 
 #if ENABLE_STATS
-static vint32 sAllocatedDataHeaderCount = 0;
-static vint32 sAllocatedNetBufferCount = 0;
-static vint32 sEverAllocatedDataHeaderCount = 0;
-static vint32 sEverAllocatedNetBufferCount = 0;
-static vint32 sMaxAllocatedDataHeaderCount = 0;
-static vint32 sMaxAllocatedNetBufferCount = 0;
+static vint32 sMaxAllocatedCount[POOL_COUNT];
+	// only sampled whenever a CPU pool needs to be refilled
 #endif
 
 
@@ -649,15 +682,38 @@ dump_net_buffer(int argc, char** argv)
 
 #if ENABLE_STATS
 
+static void
+sum_pool_stats(int32 type, int32& allocated, int32& everAllocated,
+	int32& pooled)
+{
+	allocated = 0;
+	everAllocated = 0;
+	pooled = 0;
+
+	for (int32 i = 0; i < sCPUCount; i++) {
+		cpu_pool& pool = sCPUPools[i].pools[type];
+		allocated += pool.allocated;
+		everAllocated += pool.ever_allocated;
+		pooled += pool.count;
+	}
+}
+
+
 static int
 dump_net_buffer_stats(int argc, char** argv)
 {
-	kprintf("allocated data headers: %7ld / %7ld, peak %7ld\n",
-		sAllocatedDataHeaderCount, sEverAllocatedDataHeaderCount,
-		sMaxAllocatedDataHeaderCount);
-	kprintf("allocated net buffers:  %7ld / %7ld, peak %7ld\n",
-		sAllocatedNetBufferCount, sEverAllocatedNetBufferCount,
-		sMaxAllocatedNetBufferCount);
+	int32 allocated;
+	int32 everAllocated;
+	int32 pooled;
+
+	sum_pool_stats(DATA_HEADER_POOL, allocated, everAllocated, pooled);
+	kprintf("allocated data headers: %7ld / %7ld, peak %7ld, %ld pooled\n",
+		allocated, everAllocated, sMaxAllocatedCount[DATA_HEADER_POOL],
+		pooled);
+	sum_pool_stats(NET_BUFFER_POOL, allocated, everAllocated, pooled);
+	kprintf("allocated net buffers:  %7ld / %7ld, peak %7ld, %ld pooled\n",
+		allocated, everAllocated, sMaxAllocatedCount[NET_BUFFER_POOL],
+		pooled);
 	return 0;
 }
 
@@ -745,55 +801,169 @@ check_buffer_contents(net_buffer* buffer, size_t offset, net_buffer* source,
 #endif	// !PARANOID_BUFFER_CHECK
 
 
-static inline data_header*
-allocate_data_header()
+static inline object_cache*
+pool_cache(int32 type)
 {
+	return type == NET_BUFFER_POOL ? sNetBufferCache : sDataNodeCache;
+}
+
+
 #if ENABLE_STATS
-	int32 current = atomic_add(&sAllocatedDataHeaderCount, 1) + 1;
-	int32 max = atomic_get(&sMaxAllocatedDataHeaderCount);
-	if (current > max)
-		atomic_test_and_set(&sMaxAllocatedDataHeaderCount, current, max);
 
-	atomic_add(&sEverAllocatedDataHeaderCount, 1);
-#endif
-	return (data_header*)object_cache_alloc(sDataNodeCache, 0);
+static void
+update_peak_stats(int32 type)
+{
+	int32 allocated;
+	int32 everAllocated;
+	int32 pooled;
+	sum_pool_stats(type, allocated, everAllocated, pooled);
+
+	int32 max = atomic_get(&sMaxAllocatedCount[type]);
+	if (allocated > max)
+		atomic_test_and_set(&sMaxAllocatedCount[type], allocated, max);
 }
 
+#endif	// ENABLE_STATS
 
-static inline net_buffer_private*
-allocate_net_buffer()
+
+/*!	Allocates an object of the given kind from the current CPU's pool. Only
+	when the pool is empty, a batch of objects is retrieved from the object
+	cache; all other allocations don't touch any shared state.
+*/
+static void*
+pool_alloc(int32 type)
 {
+	InterruptsLocker locker;
+	cpu_pool* pool = &sCPUPools[smp_get_current_cpu()].pools[type];
+
+	void* object;
+	if (pool->count > 0)
+		object = pool->objects[--pool->count];
+	else {
+		// refill the pool - we must not talk to the slab allocator with
+		// interrupts disabled
+		locker.Unlock();
+
 #if ENABLE_STATS
-	int32 current = atomic_add(&sAllocatedNetBufferCount, 1) + 1;
-	int32 max = atomic_get(&sMaxAllocatedNetBufferCount);
-	if (current > max)
-		atomic_test_and_set(&sMaxAllocatedNetBufferCount, current, max);
+		update_peak_stats(type);
+#endif
+
+		object_cache* cache = pool_cache(type);
+		void* objects[CPU_POOL_BATCH];
+		int32 count = 0;
+		for (; count < CPU_POOL_BATCH; count++) {
+			objects[count] = object_cache_alloc(cache, 0);
+			if (objects[count] == NULL)
+				break;
+		}
+		if (count == 0)
+			return NULL;
+
+		object = objects[--count];
 
-	atomic_add(&sEverAllocatedNetBufferCount, 1);
+		// we might be running on another CPU now, which doesn't matter
+		locker.Lock();
+		pool = &sCPUPools[smp_get_current_cpu()].pools[type];
+
+		while (count > 0 && pool->count < CPU_POOL_SIZE)
+			pool->objects[pool->count++] = objects[--count];
+
+		if (count > 0) {
+			// someone else filled the pool in the mean time
+			locker.Unlock();
+			while (count > 0)
+				object_cache_free(cache, objects[--count], 0);
+			locker.Lock();
+			pool = &sCPUPools[smp_get_current_cpu()].pools[type];
+		}
+	}
+
+#if ENABLE_STATS
+	pool->allocated++;
+	pool->ever_allocated++;
 #endif
-	return (net_buffer_private*)object_cache_alloc(sNetBufferCache, 0);
+	return object;
 }
 
 
-static inline void
-free_data_header(data_header* header)
+/*!	Returns the object to the current CPU's pool. If that is full, a batch
+	of objects is handed back to the object cache.
+*/
+static void
+pool_free(int32 type, void* object)
 {
+	if (object == NULL)
+		return;
+
+	InterruptsLocker locker;
+	cpu_pool* pool = &sCPUPools[smp_get_current_cpu()].pools[type];
+
 #if ENABLE_STATS
-	if (header != NULL)
-		atomic_add(&sAllocatedDataHeaderCount, -1);
+	pool->allocated--;
 #endif
-	object_cache_free(sDataNodeCache, header, 0);
+
+	if (pool->count < CPU_POOL_SIZE) {
+		pool->objects[pool->count++] = object;
+		return;
+	}
+
+	void* objects[CPU_POOL_BATCH];
+	objects[0] = object;
+	int32 count = 1;
+	while (count < CPU_POOL_BATCH)
+		objects[count++] = pool->objects[--pool->count];
+
+	locker.Unlock();
+
+	object_cache* cache = pool_cache(type);
+	while (count > 0)
+		object_cache_free(cache, objects[--count], 0);
+}
+
+
+/*!	Returns all pooled objects to their object caches. Must only be called
+	when the buffer module is no longer in use.
+*/
+static void
+empty_pools()
+{
+	for (int32 i = 0; i < sCPUCount; i++) {
+		for (int32 type = 0; type < POOL_COUNT; type++) {
+			cpu_pool& pool = sCPUPools[i].pools[type];
+			object_cache* cache = pool_cache(type);
+
+			while (pool.count > 0)
+				object_cache_free(cache, pool.objects[--pool.count], 0);
+		}
+	}
+}
+
+
+static inline data_header*
+allocate_data_header()
+{
+	return (data_header*)pool_alloc(DATA_HEADER_POOL);
+}
+
+
+static inline net_buffer_private*
+allocate_net_buffer()
+{
+	return (net_buffer_private*)pool_alloc(NET_BUFFER_POOL);
+}
+
+
+static inline void
+free_data_header(data_header* header)
+{
+	pool_free(DATA_HEADER_POOL, header);
 }
 
 
 static inline void
 free_net_buffer(net_buffer_private* buffer)
 {
-#if ENABLE_STATS
-	if (buffer != NULL)
-		atomic_add(&sAllocatedNetBufferCount, -1);
-#endif
-	object_cache_free(sNetBufferCache, buffer, 0);
+	pool_free(NET_BUFFER_POOL, buffer);
 }
 
 
@@ -813,6 +983,8 @@ create_data_header(size_t headerSpace)
 	header->tail_space = (uint8*)header + BUFFER_SIZE - header->data_end
 		- headerSpace;
 	header->first_free = NULL;
+	header->release = NULL;
+	header->release_cookie = NULL;
 
 	TRACE(("%ld:   create new data header %p\n", find_thread(NULL), header));
 	T2(CreateDataHeader(header));
@@ -829,6 +1001,8 @@ release_data_header(data_header* header)
 		return;
 
 	TRACE(("%ld:   free header %p\n", find_thread(NULL), header));
+	if (header->release != NULL)
+		header->release(header->release_cookie);
 	free_data_header(header);
 }
 
@@ -1081,6 +1255,7 @@ copy_metadata(net_buffer* destination, const net_buffer* source)
 	destination->offset = source->offset;
 	destination->protocol = source->protocol;
 	destination->type = source->type;
+	destination->segment_size = source->segment_size;
 }
 
 
@@ -1128,6 +1303,8 @@ create_buffer(size_t headerSpace)
 	buffer->offset = 0;
 	buffer->flags = 0;
 	buffer->size = 0;
+	buffer->segment_size = 0;
+	buffer->sent_size = 0;
 
 	CHECK_BUFFER(buffer);
 	CREATE_PARANOIA_CHECK_SET(buffer, "net_buffer");
@@ -2008,6 +2185,70 @@ append_cloned_data(net_buffer* _buffer, net_buffer* _source, uint32 offset,
 }
 
 
+/*!	Appends \a bytes of external memory at \a data to the buffer without
+	copying it. The memory must stay valid and unchanged until \a release
+	is called with \a cookie, which happens once the last buffer referring
+	to it (this one, or any clone of it) has been freed.
+	\a release is called exactly once, even if this function fails.
+*/
+static status_t
+append_external_data(net_buffer* _buffer, const void* data, size_t bytes,
+	net_buffer_release_func release, void* cookie)
+{
+	net_buffer_private* buffer = (net_buffer_private*)_buffer;
+	TRACE(("%ld: append_external_data(buffer %p, data %p, bytes = %ld)\n",
+		find_thread(NULL), buffer, data, bytes));
+
+	data_header* header = create_data_header(0);
+	if (header == NULL) {
+		release(cookie);
+		return B_NO_MEMORY;
+	}
+
+	// the external memory is not part of the header, there is no space left
+	header->tail_space = 0;
+	header->release = release;
+	header->release_cookie = cookie;
+
+	ParanoiaChecker _(buffer);
+
+	const uint8* start = (const uint8*)data;
+	size_t sizeAppended = 0;
+	status_t status = B_OK;
+
+	while (bytes > 0) {
+		data_node* node = add_data_node(buffer, header);
+		if (node == NULL) {
+			remove_trailer(buffer, sizeAppended);
+			status = ENOBUFS;
+			break;
+		}
+
+		// data_node::used is only 16 bit wide
+		node->offset = buffer->size;
+		node->start = (uint8*)start;
+		node->used = min_c(bytes, 32768);
+		node->flags = DATA_NODE_READ_ONLY;
+
+		list_add_item(&buffer->buffers, node);
+
+		start += node->used;
+		bytes -= node->used;
+		buffer->size += node->used;
+		sizeAppended += node->used;
+	}
+
+	// drop our reference; the nodes keep the header alive
+	release_data_header(header);
+
+	CHECK_BUFFER(buffer);
+	SET_PARANOIA_CHECK(PARANOIA_SUSPICIOUS, buffer, &buffer->size,
+		sizeof(buffer->size));
+
+	return status;
+}
+
+
 void
 set_ancillary_data(net_buffer* buffer, ancillary_data_container* container)
 {
@@ -2324,6 +2565,15 @@ std_ops(int32 op, ...)
 				return B_NO_MEMORY;
 			}
 
+			sCPUCount = smp_get_num_cpus();
+			sCPUPools = (net_buffer_cpu*)calloc(sCPUCount,
+				sizeof(net_buffer_cpu));
+			if (sCPUPools == NULL) {
+				delete_object_cache(sNetBufferCache);
+				delete_object_cache(sDataNodeCache);
+				return B_NO_MEMORY;
+			}
+
 #if ENABLE_STATS
 			add_debugger_command_etc("net_buffer_stats", &dump_net_buffer_stats,
 				"Print net buffer statistics",
@@ -2343,6 +2593,9 @@ std_ops(int32 op, ...)
 #if ENABLE_DEBUGGER_COMMANDS
 			remove_debugger_command("net_buffer", &dump_net_buffer);
 #endif
+			empty_pools();
+			free(sCPUPools);
+
 			delete_object_cache(sNetBufferCache);
 			delete_object_cache(sDataNodeCache);
 			return B_OK;
@@ -2377,6 +2630,7 @@ net_buffer_module_info gNetBufferModule = {
 	remove_trailer,
 	trim_data,
 	append_cloned_data,
+	append_external_data,
 
 	NULL,	// associate_data
 
@@ -45,9 +45,42 @@
 #endif
 
 
+// the number of buffers socket_receive_multiple() takes from a protocol at once
+#define RECEIVE_BATCH_SIZE	32
+
+
 struct net_socket_private;
 typedef DoublyLinkedList<net_socket_private> SocketList;
 
+struct zero_copy_state;
+
+/*!	Keeps external memory that is referenced by the buffers of a single send
+	call alive, and tells the sender once the last of them is gone.
+	Sends done with MSG_ZEROCOPY are also put into the socket's list of
+	pending sends, so that their completion can be reported in order.
+*/
+struct zero_copy_send : DoublyLinkedListLinkImpl<zero_copy_send> {
+	zero_copy_state*			state;
+	int32						ref_count;
+	net_buffer_release_func		release;
+	void*						cookie;
+};
+
+typedef DoublyLinkedList<zero_copy_send> ZeroCopySendList;
+
+/*!	The MSG_ZEROCOPY bookkeeping of a socket. Since the buffers may outlive
+	their socket, this is reference counted separately: the socket, and each
+	pending send hold a reference.
+*/
+struct zero_copy_state {
+	mutex						lock;
+	int32						ref_count;
+	net_socket_private*			socket;
+	ZeroCopySendList			pending;
+	uint32						sent;
+	uint32						completed;
+};
+
 struct net_socket_private : net_socket,
 		DoublyLinkedListLinkImpl<net_socket_private>,
 		WeakReferenceable<net_socket_private> {
@@ -66,6 +99,8 @@ struct net_socket_private : net_socket,
 	struct select_sync_pool*	select_pool;
 	mutex						lock;
 
+	zero_copy_state*			zero_copy;
+
 	bool						is_connected;
 	bool						is_in_socket_list;
 };
@@ -73,6 +108,7 @@ struct net_socket_private : net_socket,
 
 int socket_bind(net_socket* socket, const struct sockaddr* address,
 	socklen_t addressLength);
+static void put_zero_copy_state(zero_copy_state* state, int32 count = 1);
 int socket_setsockopt(net_socket* socket, int level, int option,
 	const void* value, int length);
 ssize_t socket_read_avail(net_socket* socket);
@@ -88,6 +124,7 @@ net_socket_private::net_socket_private()
 	max_backlog(0),
 	child_count(0),
 	select_pool(NULL),
+	zero_copy(NULL),
 	is_connected(false),
 	is_in_socket_list(false)
 {
@@ -137,6 +174,15 @@ net_socket_private::~net_socket_private()
 
 	mutex_unlock(&lock);
 
+	if (zero_copy != NULL) {
+		// pending sends must no longer notify us
+		mutex_lock(&zero_copy->lock);
+		zero_copy->socket = NULL;
+		mutex_unlock(&zero_copy->lock);
+
+		put_zero_copy_state(zero_copy);
+	}
+
 	put_domain_protocols(this);
 
 	mutex_destroy(&lock);
@@ -161,6 +207,144 @@ net_socket_private::RemoveFromParent()
 }
 
 
+//	#pragma mark - zero copy
+
+
+static void
+put_zero_copy_state(zero_copy_state* state, int32 count)
+{
+	if (atomic_add(&state->ref_count, -count) != count)
+		return;
+
+	mutex_destroy(&state->lock);
+	delete state;
+}
+
+
+static zero_copy_state*
+get_zero_copy_state(net_socket_private* socket)
+{
+	MutexLocker locker(socket->lock);
+
+	if (socket->zero_copy == NULL) {
+		zero_copy_state* state = new(std::nothrow) zero_copy_state;
+		if (state == NULL)
+			return NULL;
+
+		mutex_init(&state->lock, "socket zero copy");
+		state->ref_count = 1;
+		state->socket = socket;
+		state->sent = 0;
+		state->completed = 0;
+
+		socket->zero_copy = state;
+	}
+
+	return socket->zero_copy;
+}
+
+
+/*!	Creates a new zero copy send for \a socket. If \a ordered is \c true,
+	it is counted as a MSG_ZEROCOPY send.
+	\a release, if given, is called with \a cookie once the last buffer
+	referring to the send is gone. Like append_external(), this calls
+	\a release even if it fails.
+*/
+static zero_copy_send*
+create_zero_copy_send(net_socket_private* socket, bool ordered,
+	net_buffer_release_func release, void* cookie)
+{
+	zero_copy_state* state = NULL;
+	if (ordered) {
+		state = get_zero_copy_state(socket);
+		if (state == NULL) {
+			if (release != NULL)
+				release(cookie);
+			return NULL;
+		}
+	}
+
+	zero_copy_send* send = new(std::nothrow) zero_copy_send;
+	if (send == NULL) {
+		if (release != NULL)
+			release(cookie);
+		return NULL;
+	}
+
+	send->state = state;
+	send->ref_count = 1;
+	send->release = release;
+	send->cookie = cookie;
+
+	if (state != NULL) {
+		atomic_add(&state->ref_count, 1);
+
+		MutexLocker _(state->lock);
+		state->pending.Add(send);
+		state->sent++;
+	}
+
+	return send;
+}
+
+
+inline void
+acquire_zero_copy_send(zero_copy_send* send)
+{
+	atomic_add(&send->ref_count, 1);
+}
+
+
+/*!	Releases a reference to the zero copy send. Once the last one is gone,
+	the memory is given back to its owner. The sends of a socket complete in
+	the order they have been issued; a waiting writer is notified whenever
+	more of them are done.
+*/
+static void
+release_zero_copy_send(void* _send)
+{
+	zero_copy_send* send = (zero_copy_send*)_send;
+	if (atomic_add(&send->ref_count, -1) != 1)
+		return;
+
+	if (send->release != NULL)
+		send->release(send->cookie);
+
+	zero_copy_state* state = send->state;
+	if (state == NULL) {
+		delete send;
+		return;
+	}
+
+	MutexLocker locker(state->lock);
+
+	int32 completed = 0;
+	while (zero_copy_send* first = state->pending.Head()) {
+		if (first->ref_count != 0)
+			break;
+
+		state->pending.Remove(first);
+		delete first;
+		completed++;
+	}
+
+	state->completed += completed;
+
+	if (completed > 0 && state->socket != NULL) {
+		net_socket_private* socket = state->socket;
+
+		MutexLocker _(socket->lock);
+		if (socket->select_pool != NULL)
+			notify_select_event_pool(socket->select_pool, B_SELECT_WRITE);
+	}
+
+	locker.Unlock();
+
+	if (completed > 0)
+		put_zero_copy_state(state, completed);
+}
+
+
 //	#pragma mark -
 
 
@@ -649,6 +833,9 @@ socket_get_next_stat(uint32* _cookie, int family, struct net_stat* stat)
 	memcpy(&stat->peer, &socket->peer, sizeof(struct sockaddr_storage));
 	stat->receive_queue_size = 0;
 	stat->send_queue_size = 0;
+	stat->receive_buffer_size = socket->receive.buffer_size;
+	stat->send_buffer_size = socket->send.buffer_size;
+	stat->round_trip_time = 0;
 
 	// fill in protocol specific data (if supported by the protocol)
 	size_t length = sizeof(net_stat);
@@ -1170,6 +1357,20 @@ socket_get_option(net_socket* socket, int level, int option, void* value,
 			return B_OK;
 		}
 
+		case SO_ZEROCOPY:
+		{
+			uint32* completed = (uint32*)value;
+			*completed = 0;
+			*_length = sizeof(uint32);
+
+			zero_copy_state* state = ((net_socket_private*)socket)->zero_copy;
+			if (state != NULL) {
+				MutexLocker _(state->lock);
+				*completed = state->completed;
+			}
+			return B_OK;
+		}
+
 		default:
 			break;
 	}
@@ -1200,36 +1401,20 @@ socket_listen(net_socket* socket, int backlog)
 }
 
 
-ssize_t
-socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
-	int flags)
+/*!	Copies the received \a buffer, which may be \c NULL, into \a data, and
+	the other iovecs, source address, and ancillary data of the \a header,
+	if any. The buffer is freed in any case.
+*/
+static ssize_t
+copy_received_buffer(net_socket* socket, msghdr* header, void* data,
+	size_t length, int flags, net_buffer* buffer)
 {
-	// If the protocol sports read_data_no_buffer() we use it.
-	if (socket->first_info->read_data_no_buffer != NULL)
-		return socket_receive_no_buffer(socket, header, data, length, flags);
-
-	size_t totalLength = length;
-	net_buffer* buffer;
 	int i;
 
-	// the convention to this function is that have header been
-	// present, { data, length } would have been iovec[0] and is
-	// always considered like that
-
-	if (header) {
-		// calculate the length considering all of the extra buffers
-		for (i = 1; i < header->msg_iovlen; i++)
-			totalLength += header->msg_iov[i].iov_len;
-	}
-
-	status_t status = socket->first_info->read_data(
-		socket->first_protocol, totalLength, flags, &buffer);
-	if (status != B_OK)
-		return status;
-
 	// process ancillary data
 	if (header != NULL) {
 		if (buffer != NULL && header->msg_control != NULL) {
+			status_t status;
 			ancillary_data_container* container
 				= gNetBufferModule.get_ancillary_data(buffer);
 			if (container != NULL)
@@ -1307,13 +1492,139 @@ socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
 
 
 ssize_t
-socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
+socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
+	int flags)
+{
+	// If the protocol sports read_data_no_buffer() we use it.
+	if (socket->first_info->read_data_no_buffer != NULL)
+		return socket_receive_no_buffer(socket, header, data, length, flags);
+
+	size_t totalLength = length;
+	net_buffer* buffer;
+
+	// the convention to this function is that have header been
+	// present, { data, length } would have been iovec[0] and is
+	// always considered like that
+
+	if (header) {
+		// calculate the length considering all of the extra buffers
+		for (int i = 1; i < header->msg_iovlen; i++)
+			totalLength += header->msg_iov[i].iov_len;
+	}
+
+	status_t status = socket->first_info->read_data(
+		socket->first_protocol, totalLength, flags, &buffer);
+	if (status != B_OK)
+		return status;
+
+	return copy_received_buffer(socket, header, data, length, flags, buffer);
+}
+
+
+/*!	Receives up to \a count messages. Only waiting for the first one may
+	block, the call returns as soon as there are no more messages queued.
+	Protocols that implement read_data_multiple() hand out all queued
+	messages at once, instead of one per call.
+	Returns the number of messages received, or an error if there was none.
+*/
+ssize_t
+socket_receive_multiple(net_socket* socket, mmsghdr* messages, uint32 count,
 	int flags)
 {
+	net_protocol_module_info* info = socket->first_info;
+	uint32 received = 0;
+
+	if (info->read_data_multiple == NULL || info->read_data_no_buffer != NULL
+		|| (flags & MSG_PEEK) != 0) {
+		// receive them one by one
+		for (; received < count; received++) {
+			msghdr& header = messages[received].msg_hdr;
+			void* data = NULL;
+			size_t length = 0;
+			if (header.msg_iovlen > 0) {
+				data = header.msg_iov[0].iov_base;
+				length = header.msg_iov[0].iov_len;
+			}
+
+			ssize_t bytesReceived = socket_receive(socket, &header, data,
+				length, flags);
+			if (bytesReceived < 0)
+				return received > 0 ? (ssize_t)received : bytesReceived;
+
+			messages[received].msg_len = bytesReceived;
+			flags |= MSG_DONTWAIT;
+		}
+
+		return received;
+	}
+
+	net_buffer* buffers[RECEIVE_BATCH_SIZE];
+
+	while (received < count) {
+		uint32 requested = min_c(count - received, RECEIVE_BATCH_SIZE);
+		uint32 fetched = requested;
+		status_t status = info->read_data_multiple(socket->first_protocol,
+			flags, buffers, &fetched);
+		if (status != B_OK)
+			return received > 0 ? (ssize_t)received : status;
+
+		for (uint32 i = 0; i < fetched; i++) {
+			msghdr& header = messages[received].msg_hdr;
+			void* data = NULL;
+			size_t length = 0;
+			if (header.msg_iovlen > 0) {
+				data = header.msg_iov[0].iov_base;
+				length = header.msg_iov[0].iov_len;
+			}
+
+			ssize_t bytesReceived = copy_received_buffer(socket, &header, data,
+				length, flags, buffers[i]);
+			if (bytesReceived < 0) {
+				// the rest of the batch is lost, as with a full queue
+				while (++i < fetched)
+					gNetBufferModule.free(buffers[i]);
+
+				return received > 0 ? (ssize_t)received : bytesReceived;
+			}
+
+			messages[received++].msg_len = bytesReceived;
+		}
+
+		if (fetched < requested)
+			break;
+
+		flags |= MSG_DONTWAIT;
+	}
+
+	return received;
+}
+
+
+/*!	Sends the data given by \a header, and \a data. If \a release is
+	given, \a data is external memory that is referenced by the buffers
+	instead of being copied into them; \a release is called with \a cookie
+	once the last of them is gone.
+*/
+static ssize_t
+common_send(net_socket* _socket, msghdr* header, const void* data,
+	size_t length, int flags, net_buffer_release_func release, void* cookie)
+{
+	net_socket_private* socket = (net_socket_private*)_socket;
 	const sockaddr* address = NULL;
 	socklen_t addressLength = 0;
 	size_t bytesLeft = length;
 
+	zero_copy_send* zeroCopy = NULL;
+	if ((flags & MSG_ZEROCOPY) != 0 || release != NULL) {
+		zeroCopy = create_zero_copy_send(socket, (flags & MSG_ZEROCOPY) != 0,
+			release, cookie);
+		if (zeroCopy == NULL)
+			return B_NO_MEMORY;
+
+		flags &= ~MSG_ZEROCOPY;
+	}
+	CObjectDeleter<void> zeroCopyReleaser(zeroCopy, &release_zero_copy_send);
+
 	if (length > SSIZE_MAX)
 		return B_BAD_VALUE;
 
@@ -1425,7 +1736,14 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 			if (buffer->size + bytes > socket->send.buffer_size)
 				bytes = socket->send.buffer_size - buffer->size;
 
-			if (gNetBufferModule.append(buffer, data, bytes) < B_OK) {
+			status_t status;
+			if (release != NULL) {
+				acquire_zero_copy_send(zeroCopy);
+				status = gNetBufferModule.append_external(buffer, data, bytes,
+					&release_zero_copy_send, zeroCopy);
+			} else
+				status = gNetBufferModule.append(buffer, data, bytes);
+			if (status < B_OK) {
 				gNetBufferModule.free(buffer);
 				return ENOBUFS;
 			}
@@ -1483,6 +1801,26 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 }
 
 
+ssize_t
+socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
+	int flags)
+{
+	return common_send(socket, header, data, length, flags, NULL, NULL);
+}
+
+
+/*!	Sends \a length bytes of kernel memory at \a data without copying
+	them. The memory must not be changed until \a release has been called
+	with \a cookie, which happens exactly once, even if sending fails.
+*/
+ssize_t
+socket_send_external(net_socket* socket, const void* data, size_t length,
+	int flags, net_buffer_release_func release, void* cookie)
+{
+	return common_send(socket, NULL, data, length, flags, release, cookie);
+}
+
+
 status_t
 socket_set_option(net_socket* socket, int level, int option, const void* value,
 	int length)
@@ -1759,7 +2097,9 @@ net_socket_module_info gNetSocketModule = {
 	socket_getsockopt,
 	socket_listen,
 	socket_receive,
+	socket_receive_multiple,
 	socket_send,
+	socket_send_external,
 	socket_setsockopt,
 	socket_shutdown,
 	socket_socketpair
@@ -0,0 +1,317 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Generic segmentation and receive offload for TCP over IPv4.
+
+	Instead of passing every MSS sized segment through the whole stack, TCP
+	may send segments of up to 64 KB, and mark them with the segment size
+	they are to be sent with (net_buffer::segment_size). They are only split
+	right before they are handed to the device - unless the device is able
+	to do that itself.
+
+	On reception, consecutive in-order segments of the same connection are
+	merged into one larger segment before they enter the protocol layers.
+*/
+
+
+#include "offload.h"
+
+#include "stack_private.h"
+#include "utility.h"
+
+#include <net_datalink.h>
+#include <NetUtilities.h>
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <string.h>
+
+
+//#define TRACE_OFFLOAD
+#ifdef TRACE_OFFLOAD
+#	define TRACE(x...) dprintf("offload: " x)
+#else
+#	define TRACE(x...) ;
+#endif
+
+
+struct offload_tcp_header {
+	uint16	source_port;
+	uint16	destination_port;
+	uint32	sequence;
+	uint32	acknowledge;
+	uint8	header_length;
+	uint8	flags;
+	uint16	advertised_window;
+	uint16	checksum;
+	uint16	urgent_offset;
+
+	size_t HeaderLength() const { return (header_length >> 4) << 2; }
+} _PACKED;
+
+static const size_t kMaxTCPOptionsLength = 40;
+
+struct offload_segment {
+	struct ip			ip;
+	offload_tcp_header	tcp;
+	uint8				options[kMaxTCPOptionsLength];
+} _PACKED;
+
+static const uint8 kTCPFlagFinish = 0x01;
+static const uint8 kTCPFlagPush = 0x08;
+static const uint8 kTCPFlagAcknowledge = 0x10;
+
+static const size_t kMaxHeaderLength = 256;
+
+
+static uint16
+tcp_checksum(const struct ip& ipHeader, uint16 tcpLength, uint32 sum)
+{
+	Checksum checksum;
+	checksum << (uint32)ipHeader.ip_src.s_addr
+		<< (uint32)ipHeader.ip_dst.s_addr
+		<< (uint16)htons(IPPROTO_TCP) << (uint16)htons(tcpLength) << sum;
+	return checksum;
+}
+
+
+static bool
+is_ipv4(net_buffer* buffer)
+{
+	if (buffer->interface_address != NULL) {
+		return buffer->interface_address->domain != NULL
+			&& buffer->interface_address->domain->family == AF_INET;
+	}
+
+	return buffer->type == B_NET_FRAME_TYPE_IPV4;
+}
+
+
+/*!	Reads the headers of a received segment, and checks if it could be
+	coalesced at all: only pure data segments (that may have the push flag
+	set) without IP options or fragmentation qualify.
+	Returns the length of the payload, or zero if the segment cannot be
+	coalesced.
+*/
+static size_t
+read_received_segment(net_buffer* buffer, offload_segment& segment)
+{
+	if (buffer->size <= sizeof(struct ip) + sizeof(offload_tcp_header))
+		return 0;
+
+	size_t length = min_c(buffer->size, sizeof(offload_segment));
+	if (gNetBufferModule.read(buffer, 0, &segment, length) != B_OK)
+		return 0;
+
+	if (segment.ip.ip_v != IPVERSION
+		|| segment.ip.ip_hl != sizeof(struct ip) / 4
+		|| segment.ip.ip_p != IPPROTO_TCP
+		|| (ntohs(segment.ip.ip_off) & (IP_MF | IP_OFFMASK)) != 0
+		|| ntohs(segment.ip.ip_len) != buffer->size
+		|| checksum((uint8*)&segment.ip, sizeof(struct ip)) != 0)
+		return 0;
+
+	size_t headerLength = sizeof(struct ip) + segment.tcp.HeaderLength();
+	if (segment.tcp.HeaderLength() < sizeof(offload_tcp_header)
+		|| headerLength >= buffer->size
+		|| (segment.tcp.flags & ~kTCPFlagPush) != kTCPFlagAcknowledge)
+		return 0;
+
+	return buffer->size - headerLength;
+}
+
+
+static bool
+received_checksum_valid(net_buffer* buffer, const offload_segment& segment)
+{
+	uint16 tcpLength = buffer->size - sizeof(struct ip);
+	return tcp_checksum(segment.ip, tcpLength,
+		gNetBufferModule.checksum(buffer, sizeof(struct ip), tcpLength,
+			false)) == 0;
+}
+
+
+/*!	Splits the TCP segment in \a buffer into segments of
+	net_buffer::segment_size bytes, and passes each of them to \a send.
+	The \a buffer starts with a link layer header of \a linkHeaderLength
+	bytes that is copied to each segment, as are the IP and TCP headers.
+	Like a send function, this only takes over \a buffer if it succeeds; if
+	sending a segment fails, the segments following it are not sent, and
+	net_buffer::sent_size reports how many payload bytes have been sent.
+*/
+status_t
+send_segmented(net_buffer* buffer, size_t linkHeaderLength,
+	offload_send_func send, void* cookie)
+{
+	uint32 segmentSize = buffer->segment_size;
+	buffer->segment_size = 0;
+	buffer->sent_size = 0;
+
+	uint8 header[kMaxHeaderLength];
+	size_t length = min_c(buffer->size, sizeof(header));
+	if (linkHeaderLength + sizeof(struct ip) > length
+		|| gNetBufferModule.read(buffer, 0, header, length) != B_OK)
+		return B_BAD_VALUE;
+
+	struct ip* ipHeader = (struct ip*)(header + linkHeaderLength);
+	size_t ipHeaderLength = ipHeader->ip_hl << 2;
+	size_t tcpOffset = linkHeaderLength + ipHeaderLength;
+	if (ipHeader->ip_v != IPVERSION || ipHeader->ip_p != IPPROTO_TCP
+		|| ipHeaderLength < sizeof(struct ip)
+		|| tcpOffset + sizeof(offload_tcp_header) > length)
+		return B_BAD_VALUE;
+
+	offload_tcp_header* tcpHeader = (offload_tcp_header*)(header + tcpOffset);
+	size_t tcpHeaderLength = tcpHeader->HeaderLength();
+	size_t headerLength = tcpOffset + tcpHeaderLength;
+	if (tcpHeaderLength < sizeof(offload_tcp_header) || headerLength > length)
+		return B_BAD_VALUE;
+
+	status_t status = gNetBufferModule.remove_header(buffer, headerLength);
+	if (status != B_OK)
+		return status;
+
+	TRACE("split %lu bytes into segments of %lu\n", buffer->size,
+		segmentSize);
+
+	uint32 bytesLeft = buffer->size;
+	uint32 firstSequence = ntohl(tcpHeader->sequence);
+	uint32 sequence = firstSequence;
+	uint16 id = ntohs(ipHeader->ip_id);
+	uint8 flags = tcpHeader->flags;
+
+	while (true) {
+		uint32 segmentLength = min_c(bytesLeft, segmentSize);
+		bytesLeft -= segmentLength;
+		bool lastSegment = bytesLeft == 0;
+
+		net_buffer* segment;
+		if (!lastSegment)
+			segment = gNetBufferModule.split(buffer, segmentLength);
+		else
+			segment = buffer;
+
+		if (segment == NULL) {
+			status = B_NO_MEMORY;
+			break;
+		}
+
+		ipHeader->ip_len = htons(ipHeaderLength + tcpHeaderLength
+			+ segmentLength);
+		ipHeader->ip_id = htons(id++);
+		ipHeader->ip_sum = 0;
+		ipHeader->ip_sum = checksum((uint8*)ipHeader, ipHeaderLength);
+
+		// only the last segment finishes the connection, or pushes the data
+		tcpHeader->sequence = htonl(sequence);
+		tcpHeader->flags = lastSegment
+			? flags : flags & ~(kTCPFlagFinish | kTCPFlagPush);
+		tcpHeader->checksum = 0;
+
+		uint32 sum = compute_checksum((uint8*)tcpHeader, tcpHeaderLength);
+		if (segmentLength > 0) {
+			sum += (uint16)gNetBufferModule.checksum(segment, 0, segmentLength,
+				false);
+		}
+		tcpHeader->checksum = tcp_checksum(*ipHeader,
+			tcpHeaderLength + segmentLength, sum);
+
+		status = gNetBufferModule.prepend(segment, header, headerLength);
+		if (status == B_OK)
+			status = send(cookie, segment);
+
+		if (lastSegment) {
+			// we don't own the last buffer, so we don't have to free it
+			break;
+		}
+
+		if (status != B_OK) {
+			gNetBufferModule.free(segment);
+			break;
+		}
+
+		sequence += segmentLength;
+	}
+
+	if (status != B_OK) {
+		// the caller still owns the buffer, and needs to know what to resend
+		buffer->sent_size = sequence - firstSequence;
+	}
+
+	return status;
+}
+
+
+/*!	Tries to append the TCP segment in \a next to the one in \a buffer.
+	Both must be IPv4 buffers as they are received by the domain, that is,
+	starting with the IP header. They are only merged if \a next directly
+	follows \a buffer in the same connection, and all of their headers but
+	the sequence number match.
+	If this function returns \c true, \a next has been consumed, and
+	\a buffer carries a TCP checksum that is no longer valid, but has been
+	verified for both segments (NET_BUFFER_CHECKSUM_VALID).
+*/
+bool
+coalesce_received(net_buffer* buffer, net_buffer* next)
+{
+	if (buffer->interface_address != next->interface_address
+		|| (buffer->interface_address == NULL && buffer->type != next->type)
+		|| ((buffer->flags | next->flags) & (MSG_BCAST | MSG_MCAST)) != 0
+		|| !is_ipv4(buffer))
+		return false;
+
+	offload_segment first;
+	offload_segment second;
+	size_t firstLength = read_received_segment(buffer, first);
+	if (firstLength == 0 || (first.tcp.flags & kTCPFlagPush) != 0)
+		return false;
+	size_t secondLength = read_received_segment(next, second);
+	if (secondLength == 0)
+		return false;
+
+	size_t tcpHeaderLength = first.tcp.HeaderLength();
+	if (first.ip.ip_src.s_addr != second.ip.ip_src.s_addr
+		|| first.ip.ip_dst.s_addr != second.ip.ip_dst.s_addr
+		|| first.ip.ip_tos != second.ip.ip_tos
+		|| first.ip.ip_ttl != second.ip.ip_ttl
+		|| first.ip.ip_off != second.ip.ip_off
+		|| first.tcp.source_port != second.tcp.source_port
+		|| first.tcp.destination_port != second.tcp.destination_port
+		|| first.tcp.acknowledge != second.tcp.acknowledge
+		|| first.tcp.advertised_window != second.tcp.advertised_window
+		|| tcpHeaderLength != second.tcp.HeaderLength()
+		|| memcmp(first.options, second.options,
+			tcpHeaderLength - sizeof(offload_tcp_header)) != 0
+		|| ntohl(first.tcp.sequence) + firstLength
+			!= ntohl(second.tcp.sequence)
+		|| buffer->size + secondLength > IP_MAXPACKET)
+		return false;
+
+	if (((buffer->flags & NET_BUFFER_CHECKSUM_VALID) == 0
+			&& !received_checksum_valid(buffer, first))
+		|| !received_checksum_valid(next, second))
+		return false;
+
+	if (gNetBufferModule.remove_header(next, sizeof(struct ip)
+			+ tcpHeaderLength) != B_OK)
+		return false;
+	if (gNetBufferModule.merge(buffer, next, true) != B_OK) {
+		// we already removed its headers, so all we can do is to drop it;
+		// TCP will have to retransmit it
+		gNetBufferModule.free(next);
+		return true;
+	}
+
+	first.ip.ip_len = htons(buffer->size);
+	first.ip.ip_sum = 0;
+	first.ip.ip_sum = checksum((uint8*)&first.ip, sizeof(struct ip));
+	first.tcp.flags |= second.tcp.flags & kTCPFlagPush;
+
+	gNetBufferModule.write(buffer, 0, &first,
+		sizeof(struct ip) + sizeof(offload_tcp_header));
+	buffer->flags |= NET_BUFFER_CHECKSUM_VALID;
+	return true;
+}
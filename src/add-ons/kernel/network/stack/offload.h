@@ -0,0 +1,20 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef OFFLOAD_H
+#define OFFLOAD_H
+
+
+#include <net_buffer.h>
+
+
+typedef status_t (*offload_send_func)(void* cookie, net_buffer* buffer);
+
+
+status_t send_segmented(net_buffer* buffer, size_t linkHeaderLength,
+	offload_send_func send, void* cookie);
+bool coalesce_received(net_buffer* buffer, net_buffer* next);
+
+
+#endif	// OFFLOAD_H
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "route_trie.h"
+
+#include <new>
+#include <string.h>
+
+
+static inline int
+key_bit(const uint8* key, size_t bit)
+{
+	return (key[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+
+/*!	Returns the number of leading bits \a a and \a b have in common, up to
+	\a length. The first \a from bits are known to be equal already.
+*/
+static size_t
+common_prefix_length(const uint8* a, const uint8* b, size_t from,
+	size_t length)
+{
+	for (size_t i = from / 8; i * 8 < length; i++) {
+		uint8 difference = a[i] ^ b[i];
+		if (i == from / 8)
+			difference &= 0xff >> (from % 8);
+
+		if (difference != 0) {
+			size_t bit = i * 8;
+			while ((difference & 0x80) == 0) {
+				difference <<= 1;
+				bit++;
+			}
+			return bit < length ? bit : length;
+		}
+	}
+
+	return length;
+}
+
+
+// #pragma mark -
+
+
+RouteTrie::RouteTrie()
+	:
+	fRoot(NULL),
+	fNodeCount(0)
+{
+}
+
+
+RouteTrie::~RouteTrie()
+{
+	_DeleteNodes(fRoot);
+}
+
+
+/*!	Returns the node for the given prefix, and creates it if it doesn't
+	exist yet. Returns \c NULL if there is not enough memory.
+*/
+RouteTrieNode*
+RouteTrie::Add(const uint8* key, size_t prefixLength)
+{
+	if (prefixLength > ROUTE_TRIE_MAX_KEY_LENGTH * 8)
+		return NULL;
+
+	RouteTrieNode* parent = NULL;
+	RouteTrieNode** link = &fRoot;
+	size_t from = 0;
+
+	while (*link != NULL) {
+		RouteTrieNode* node = *link;
+		size_t length = node->prefix_length < prefixLength
+			? node->prefix_length : prefixLength;
+		size_t common = common_prefix_length(node->prefix, key, from, length);
+
+		if (common == node->prefix_length) {
+			if (common == prefixLength)
+				return node;
+
+			parent = node;
+			from = common;
+			link = &node->children[key_bit(key, common)];
+			continue;
+		}
+
+		// The prefix of the node diverges from ours, we need to insert a new
+		// node above it.
+		RouteTrieNode* above = _CreateNode(key, common);
+		if (above == NULL)
+			return NULL;
+
+		RouteTrieNode* added = above;
+		if (common < prefixLength) {
+			// the new node is only needed for branching
+			added = _CreateNode(key, prefixLength);
+			if (added == NULL) {
+				delete above;
+				fNodeCount--;
+				return NULL;
+			}
+
+			added->parent = above;
+			above->children[key_bit(key, common)] = added;
+		}
+
+		above->children[key_bit(node->prefix, common)] = node;
+		above->parent = parent;
+		node->parent = above;
+		*link = above;
+		return added;
+	}
+
+	RouteTrieNode* added = _CreateNode(key, prefixLength);
+	if (added == NULL)
+		return NULL;
+
+	added->parent = parent;
+	*link = added;
+	return added;
+}
+
+
+/*!	Must be called after the last route of the \a node has been removed. The
+	node will be deleted, unless it's still needed for branching.
+*/
+void
+RouteTrie::Remove(RouteTrieNode* node)
+{
+	while (node != NULL && node->routes == NULL) {
+		if (node->children[0] != NULL && node->children[1] != NULL)
+			return;
+
+		RouteTrieNode* parent = node->parent;
+		RouteTrieNode* child = node->children[0] != NULL
+			? node->children[0] : node->children[1];
+		if (child != NULL)
+			child->parent = parent;
+
+		_ReplaceChild(parent, node, child);
+		delete node;
+		fNodeCount--;
+
+		if (child != NULL) {
+			// the parent still has two children
+			return;
+		}
+
+		node = parent;
+	}
+}
+
+
+/*!	Returns the most specific node with routes whose prefix matches the
+	\a key, or \c NULL if there is none.
+*/
+RouteTrieNode*
+RouteTrie::Lookup(const uint8* key, size_t keyLength) const
+{
+	RouteTrieNode* node = fRoot;
+	RouteTrieNode* match = NULL;
+	size_t from = 0;
+
+	while (node != NULL && node->prefix_length <= keyLength) {
+		if (common_prefix_length(node->prefix, key, from, node->prefix_length)
+				!= node->prefix_length)
+			break;
+
+		if (node->routes != NULL)
+			match = node;
+
+		from = node->prefix_length;
+		if (from == keyLength)
+			break;
+
+		node = node->children[key_bit(key, from)];
+	}
+
+	return match;
+}
+
+
+RouteTrieNode*
+RouteTrie::_CreateNode(const uint8* key, size_t prefixLength)
+{
+	RouteTrieNode* node = new(std::nothrow) RouteTrieNode;
+	if (node == NULL)
+		return NULL;
+
+	node->parent = NULL;
+	node->children[0] = NULL;
+	node->children[1] = NULL;
+	node->routes = NULL;
+	node->prefix_length = prefixLength;
+
+	memset(node->prefix, 0, sizeof(node->prefix));
+	memcpy(node->prefix, key, (prefixLength + 7) / 8);
+	if (prefixLength % 8 != 0)
+		node->prefix[prefixLength / 8] &= 0xff << (8 - prefixLength % 8);
+
+	fNodeCount++;
+	return node;
+}
+
+
+void
+RouteTrie::_DeleteNodes(RouteTrieNode* node)
+{
+	if (node == NULL)
+		return;
+
+	_DeleteNodes(node->children[0]);
+	_DeleteNodes(node->children[1]);
+	delete node;
+}
+
+
+void
+RouteTrie::_ReplaceChild(RouteTrieNode* parent, RouteTrieNode* node,
+	RouteTrieNode* replacement)
+{
+	if (parent == NULL)
+		fRoot = replacement;
+	else if (parent->children[0] == node)
+		parent->children[0] = replacement;
+	else
+		parent->children[1] = replacement;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef ROUTE_TRIE_H
+#define ROUTE_TRIE_H
+
+
+#include <SupportDefs.h>
+
+
+#define ROUTE_TRIE_MAX_KEY_LENGTH	16
+	// in bytes, enough for IPv6 addresses
+
+
+struct RouteTrieNode {
+	RouteTrieNode*	parent;
+	RouteTrieNode*	children[2];
+	void*			routes;
+		// NULL for nodes that only exist to branch
+	uint16			prefix_length;
+	uint8			prefix[ROUTE_TRIE_MAX_KEY_LENGTH];
+};
+
+
+/*!	A path compressed binary trie that maps address prefixes to the routes
+	using them. Every node either has routes, or two children, so that a
+	lookup needs at most one step per prefix length in use.
+	The less specific matches of a lookup can be found by following the
+	parent links, and skipping the nodes without routes.
+	The trie does no locking on its own.
+*/
+class RouteTrie {
+public:
+								RouteTrie();
+								~RouteTrie();
+
+			RouteTrieNode*		Add(const uint8* key, size_t prefixLength);
+			void				Remove(RouteTrieNode* node);
+
+			RouteTrieNode*		Lookup(const uint8* key,
+									size_t keyLength) const;
+
+			size_t				CountNodes() const { return fNodeCount; }
+
+private:
+			RouteTrieNode*		_CreateNode(const uint8* key,
+									size_t prefixLength);
+			void				_DeleteNodes(RouteTrieNode* node);
+			void				_ReplaceChild(RouteTrieNode* parent,
+									RouteTrieNode* node,
+									RouteTrieNode* replacement);
+
+private:
+			RouteTrieNode*		fRoot;
+			size_t				fNodeCount;
+};
+
+
+#endif	// ROUTE_TRIE_H
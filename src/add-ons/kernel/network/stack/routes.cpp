@@ -17,6 +17,7 @@
 #include <NetUtilities.h>
 
 #include <lock.h>
+#include <smp.h>
 #include <util/AutoLock.h>
 
 #include <KernelExport.h>
@@ -37,9 +38,29 @@
 #endif
 
 
+#define ROUTE_CACHE_SIZE	64
+
+
+struct route_cache_entry {
+	net_route_private*	route;
+	uint8				key[ROUTE_TRIE_MAX_KEY_LENGTH];
+};
+
+/*!	Remembers the results of recent route lookups on one CPU, so that
+	these don't need to acquire the domain lock. Only the flush after a
+	route change touches the caches of other CPUs.
+*/
+struct route_cache {
+	spinlock			lock;
+	route_cache_entry	entries[ROUTE_CACHE_SIZE];
+};
+
+
 net_route_private::net_route_private()
 {
 	destination = mask = gateway = NULL;
+	trie_node = NULL;
+	trie_next = NULL;
 }
 
 
@@ -100,6 +121,252 @@ user_copy_address(const sockaddr* from, sockaddr_storage* to)
 }
 
 
+static inline bool
+route_has_link(net_route_private* route)
+{
+	return (route->interface_address->interface->device->flags & IFF_LINK)
+		!= 0;
+}
+
+
+/*!	Returns whether the routes of the \a domain are kept in its trie, and
+	the \a address can be looked up there.
+*/
+static inline bool
+uses_route_trie(net_domain_private* domain, const sockaddr* address)
+{
+	return domain->address_module->get_route_key != NULL
+		&& address->sa_family == domain->family;
+}
+
+
+/*!	Returns the number of leading bits set in the \a mask; no mask means that
+	all \a bits of the address are used.
+*/
+static size_t
+prefix_length(net_domain_private* domain, const sockaddr* mask, size_t bits)
+{
+	if (mask == NULL)
+		return bits;
+
+	size_t maskBits;
+	const uint8* key = domain->address_module->get_route_key(mask, &maskBits);
+	if (maskBits < bits)
+		bits = maskBits;
+
+	size_t length = 0;
+	while (length < bits && (key[length / 8] & (0x80 >> (length % 8))) != 0)
+		length++;
+
+	return length;
+}
+
+
+static status_t
+add_to_route_trie(net_domain_private* domain, net_route_private* route)
+{
+	if (domain->address_module->get_route_key == NULL)
+		return B_OK;
+
+	size_t bits;
+	const uint8* key = domain->address_module->get_route_key(
+		route->destination, &bits);
+
+	RouteTrieNode* node = domain->route_trie.Add(key,
+		prefix_length(domain, route->mask, bits));
+	if (node == NULL)
+		return B_NO_MEMORY;
+
+	// keep the routes with the same prefix in the order of the route list
+	net_route_private** link = (net_route_private**)&node->routes;
+	while (*link != NULL) {
+		net_route_private* before = *link;
+		if ((route->flags & RTF_DEFAULT) != 0
+			&& (before->flags & RTF_DEFAULT) != 0
+			&& before->interface_address->interface->device->link_speed
+				< route->interface_address->interface->device->link_speed)
+			break;
+
+		link = &before->trie_next;
+	}
+
+	route->trie_next = *link;
+	route->trie_node = node;
+	*link = route;
+	return B_OK;
+}
+
+
+static void
+remove_from_route_trie(net_domain_private* domain, net_route_private* route)
+{
+	RouteTrieNode* node = route->trie_node;
+	if (node == NULL)
+		return;
+
+	net_route_private** link = (net_route_private**)&node->routes;
+	while (*link != route)
+		link = &(*link)->trie_next;
+
+	*link = route->trie_next;
+	route->trie_next = NULL;
+	route->trie_node = NULL;
+
+	if (node->routes == NULL)
+		domain->route_trie.Remove(node);
+}
+
+
+/*!	Finds the most specific route for \a address in the domain's trie,
+	preferring routes whose device has a link, like the route list does.
+	The walk starts at the most specific matching prefix, and continues
+	through its parents, that is, towards less specific prefixes.
+	\a _cacheable is set when the result does not depend on the link state
+	of any other route.
+*/
+static net_route_private*
+find_trie_route(net_domain_private* domain, const sockaddr* address,
+	bool& _cacheable)
+{
+	size_t bits;
+	const uint8* key = domain->address_module->get_route_key(address, &bits);
+
+	net_route_private* candidate = NULL;
+
+	for (RouteTrieNode* node = domain->route_trie.Lookup(key, bits);
+			node != NULL; node = node->parent) {
+		net_route_private* route = (net_route_private*)node->routes;
+		for (; route != NULL; route = route->trie_next) {
+			// neglect routes that point to devices that have no link
+			if (route_has_link(route)) {
+				_cacheable = candidate == NULL;
+				return route;
+			}
+
+			if (candidate == NULL)
+				candidate = route;
+		}
+	}
+
+	_cacheable = false;
+	return candidate;
+}
+
+
+static inline route_cache_entry&
+route_cache_entry_for(net_domain_private* domain, route_cache& cache,
+	const sockaddr* address)
+{
+	return cache.entries[domain->address_module->hash_address(address, false)
+		% ROUTE_CACHE_SIZE];
+}
+
+
+/*!	Looks up the \a address in the current CPU's route cache, and returns a
+	reference to the route if it could be found. Does not need the domain
+	lock.
+*/
+static net_route_private*
+lookup_route_cache(net_domain_private* domain, const sockaddr* address)
+{
+	if (domain->route_caches == NULL || !uses_route_trie(domain, address))
+		return NULL;
+
+	size_t bits;
+	const uint8* key = domain->address_module->get_route_key(address, &bits);
+
+	InterruptsLocker interruptsLocker;
+	route_cache& cache = domain->route_caches[smp_get_current_cpu()];
+	SpinLocker locker(cache.lock);
+
+	route_cache_entry& entry = route_cache_entry_for(domain, cache, address);
+	net_route_private* route = entry.route;
+	if (route == NULL || memcmp(entry.key, key, (bits + 7) / 8) != 0
+		|| !route_has_link(route))
+		return NULL;
+
+	// the cache owns a reference, so the route cannot go away
+	atomic_add(&route->ref_count, 1);
+	return route;
+}
+
+
+static void
+release_route(net_route_private* route)
+{
+	if (route == NULL || atomic_add(&route->ref_count, -1) != 1)
+		return;
+
+	// delete route - it must already have been removed at this point
+	if (route->interface_address != NULL)
+		((InterfaceAddress*)route->interface_address)->ReleaseReference();
+
+	delete route;
+}
+
+
+static void
+update_route_cache(net_domain_private* domain, const sockaddr* address,
+	net_route_private* route)
+{
+	ASSERT_LOCKED_RECURSIVE(&domain->lock);
+
+	if (domain->route_caches == NULL)
+		return;
+
+	size_t bits;
+	const uint8* key = domain->address_module->get_route_key(address, &bits);
+
+	// the cache gets its own reference
+	atomic_add(&route->ref_count, 1);
+
+	InterruptsLocker interruptsLocker;
+	route_cache& cache = domain->route_caches[smp_get_current_cpu()];
+	SpinLocker locker(cache.lock);
+
+	route_cache_entry& entry = route_cache_entry_for(domain, cache, address);
+	net_route_private* previous = entry.route;
+	entry.route = route;
+	memcpy(entry.key, key, (bits + 7) / 8);
+
+	locker.Unlock();
+	interruptsLocker.Unlock();
+
+	release_route(previous);
+}
+
+
+/*!	Empties the route caches of all CPUs; must be called whenever the routes
+	change.
+*/
+static void
+flush_route_caches(net_domain_private* domain)
+{
+	ASSERT_LOCKED_RECURSIVE(&domain->lock);
+
+	if (domain->route_caches == NULL)
+		return;
+
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 cpu = 0; cpu < cpuCount; cpu++) {
+		route_cache& cache = domain->route_caches[cpu];
+		net_route_private* routes[ROUTE_CACHE_SIZE];
+
+		InterruptsSpinLocker locker(cache.lock);
+
+		for (int32 i = 0; i < ROUTE_CACHE_SIZE; i++) {
+			routes[i] = cache.entries[i].route;
+			cache.entries[i].route = NULL;
+		}
+
+		locker.Unlock();
+
+		for (int32 i = 0; i < ROUTE_CACHE_SIZE; i++)
+			release_route(routes[i]);
+	}
+}
+
+
 static net_route_private*
 find_route(struct net_domain* _domain, const net_route* description)
 {
@@ -142,6 +409,11 @@ find_route(net_domain* _domain, const sockaddr* address)
 {
 	net_domain_private* domain = (net_domain_private*)_domain;
 
+	if (uses_route_trie(domain, address)) {
+		bool cacheable;
+		return find_trie_route(domain, address, cacheable);
+	}
+
 	// find last matching route
 
 	RouteList::Iterator iterator = domain->routes.GetIterator();
@@ -192,15 +464,7 @@ put_route_internal(struct net_domain_private* domain, net_route* _route)
 {
 	ASSERT_LOCKED_RECURSIVE(&domain->lock);
 
-	net_route_private* route = (net_route_private*)_route;
-	if (route == NULL || atomic_add(&route->ref_count, -1) != 1)
-		return;
-
-	// delete route - it must already have been removed at this point
-	if (route->interface_address != NULL)
-		((InterfaceAddress*)route->interface_address)->ReleaseReference();
-
-	delete route;
+	release_route((net_route_private*)_route);
 }
 
 
@@ -229,6 +493,11 @@ get_route_internal(struct net_domain_private* domain,
 							device->address.length)))
 				break;
 		}
+	} else if (uses_route_trie(domain, address)) {
+		bool cacheable;
+		route = find_trie_route(domain, address, cacheable);
+		if (route != NULL && cacheable)
+			update_route_cache(domain, address, route);
 	} else
 		route = find_route(domain, address);
 
@@ -287,6 +556,37 @@ fill_route_entry(route_entry* target, void* _buffer, size_t bufferSize,
 //	#pragma mark - exported functions
 
 
+status_t
+init_route_caches(net_domain_private* domain)
+{
+	domain->route_caches = NULL;
+	if (domain->address_module->get_route_key == NULL)
+		return B_OK;
+
+	domain->route_caches = (route_cache*)calloc(smp_get_num_cpus(),
+		sizeof(route_cache));
+	if (domain->route_caches == NULL)
+		return B_NO_MEMORY;
+
+	return B_OK;
+}
+
+
+void
+uninit_route_caches(net_domain_private* domain)
+{
+	if (domain->route_caches == NULL)
+		return;
+
+	RecursiveLocker locker(domain->lock);
+	flush_route_caches(domain);
+	locker.Unlock();
+
+	free(domain->route_caches);
+	domain->route_caches = NULL;
+}
+
+
 /*!	Determines the size of a buffer large enough to contain the whole
 	routing table.
 */
@@ -488,6 +788,11 @@ add_route(struct net_domain* _domain, const struct net_route* newRoute)
 	route->mtu = 0;
 	route->ref_count = 1;
 
+	if (add_to_route_trie(domain, route) != B_OK) {
+		release_route(route);
+		return B_NO_MEMORY;
+	}
+
 	// Insert the route sorted by completeness of its mask
 
 	RouteList::Iterator iterator = domain->routes.GetIterator();
@@ -511,6 +816,7 @@ add_route(struct net_domain* _domain, const struct net_route* newRoute)
 	}
 
 	domain->routes.Insert(before, route);
+	flush_route_caches(domain);
 	update_route_infos(domain);
 
 	return B_OK;
@@ -539,6 +845,8 @@ remove_route(struct net_domain* _domain, const struct net_route* removeRoute)
 		return B_ENTRY_NOT_FOUND;
 
 	domain->routes.Remove(route);
+	remove_from_route_trie(domain, route);
+	flush_route_caches(domain);
 
 	put_route_internal(domain, route);
 	update_route_infos(domain);
@@ -620,6 +928,11 @@ struct net_route*
 get_route(struct net_domain* _domain, const struct sockaddr* address)
 {
 	struct net_domain_private* domain = (net_domain_private*)_domain;
+
+	net_route* route = lookup_route_cache(domain, address);
+	if (route != NULL)
+		return route;
+
 	RecursiveLocker locker(domain->lock);
 
 	return get_route_internal(domain, address);
@@ -649,11 +962,15 @@ get_buffer_route(net_domain* _domain, net_buffer* buffer, net_route** _route)
 {
 	net_domain_private* domain = (net_domain_private*)_domain;
 
-	RecursiveLocker _(domain->lock);
+	RecursiveLocker locker(domain->lock, false, false);
 
-	net_route* route = get_route_internal(domain, buffer->destination);
-	if (route == NULL)
-		return ENETUNREACH;
+	net_route* route = lookup_route_cache(domain, buffer->destination);
+	if (route == NULL) {
+		locker.Lock();
+		route = get_route_internal(domain, buffer->destination);
+		if (route == NULL)
+			return ENETUNREACH;
+	}
 
 	status_t status = B_OK;
 	sockaddr* source = buffer->source;
@@ -668,7 +985,7 @@ get_buffer_route(net_domain* _domain, net_buffer* buffer, net_route** _route)
 	}
 
 	if (status != B_OK)
-		put_route_internal(domain, route);
+		release_route((net_route_private*)route);
 	else
 		*_route = route;
 
@@ -679,13 +996,12 @@ get_buffer_route(net_domain* _domain, net_buffer* buffer, net_route** _route)
 void
 put_route(struct net_domain* _domain, net_route* route)
 {
-	struct net_domain_private* domain = (net_domain_private*)_domain;
-	if (domain == NULL || route == NULL)
+	if (_domain == NULL || route == NULL)
 		return;
 
-	RecursiveLocker locker(domain->lock);
-
-	put_route_internal(domain, (net_route*)route);
+	// Routes are only deleted once they have been removed from the domain,
+	// so this doesn't need the domain lock.
+	release_route((net_route_private*)route);
 }
 
 
@@ -14,13 +14,19 @@
 
 #include <util/DoublyLinkedList.h>
 
+#include "route_trie.h"
+
 
 class InterfaceAddress;
+struct route_cache;
 
 
 struct net_route_private
 	: net_route, DoublyLinkedListLinkImpl<net_route_private> {
-	int32	ref_count;
+	int32				ref_count;
+	RouteTrieNode*		trie_node;
+	net_route_private*	trie_next;
+		// the next route with the same prefix
 
 	net_route_private();
 	~net_route_private();
@@ -31,6 +37,9 @@ typedef DoublyLinkedList<net_route_info,
 	DoublyLinkedListCLink<net_route_info> > RouteInfoList;
 
 
+status_t init_route_caches(struct net_domain_private* domain);
+void uninit_route_caches(struct net_domain_private* domain);
+
 uint32 route_table_size(struct net_domain_private* domain);
 status_t list_routes(struct net_domain_private* domain, void* buffer,
 				size_t size);
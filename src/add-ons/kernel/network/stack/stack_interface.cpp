@@ -119,6 +119,14 @@ stack_interface_recvmsg(net_socket* socket, struct msghdr* message, int flags)
 }
 
 
+static ssize_t
+stack_interface_recvmmsg(net_socket* socket, struct mmsghdr* messages,
+	uint32 count, int flags)
+{
+	return gNetSocketModule.receive_multiple(socket, messages, count, flags);
+}
+
+
 static ssize_t
 stack_interface_send(net_socket* socket, const void* data, size_t length,
 	int flags)
@@ -161,6 +169,33 @@ stack_interface_sendmsg(net_socket* socket, const struct msghdr* message,
 }
 
 
+static ssize_t
+stack_interface_send_external(net_socket* socket, const void* data,
+	size_t length, int flags, net_buffer_release_func release, void* cookie)
+{
+	return gNetSocketModule.send_external(socket, data, length, flags, release,
+		cookie);
+}
+
+
+static ssize_t
+stack_interface_sendmmsg(net_socket* socket, struct mmsghdr* messages,
+	uint32 count, int flags)
+{
+	uint32 sent = 0;
+	for (; sent < count; sent++) {
+		ssize_t bytesSent = stack_interface_sendmsg(socket,
+			&messages[sent].msg_hdr, flags);
+		if (bytesSent < 0)
+			return sent > 0 ? (ssize_t)sent : bytesSent;
+
+		messages[sent].msg_len = bytesSent;
+	}
+
+	return sent;
+}
+
+
 static status_t
 stack_interface_getsockopt(net_socket* socket, int level, int option,
 	void* value, socklen_t* _length)
@@ -279,10 +314,13 @@ net_stack_interface_module_info gNetStackInterfaceModule = {
 	&stack_interface_recv,
 	&stack_interface_recvfrom,
 	&stack_interface_recvmsg,
+	&stack_interface_recvmmsg,
 
 	&stack_interface_send,
 	&stack_interface_sendto,
 	&stack_interface_sendmsg,
+	&stack_interface_send_external,
+	&stack_interface_sendmmsg,
 
 	&stack_interface_getsockopt,
 	&stack_interface_setsockopt,
@@ -9,6 +9,7 @@
 #include "NetReceiver.h"
 #include "NetSender.h"
 #include "RemoteMessage.h"
+#include "RemoteTileCache.h"
 #include "RemoteView.h"
 #include "StreamingRingBuffer.h"
 
@@ -65,6 +66,7 @@ RemoteView::RemoteView(BRect frame, uint16 listenPort)
 	fSendEndpoint(NULL),
 	fReceiver(NULL),
 	fSender(NULL),
+	fTileStore(NULL),
 	fStopThread(false),
 	fOffscreenBitmap(NULL),
 	fOffscreen(NULL),
@@ -72,7 +74,7 @@ RemoteView::RemoteView(BRect frame, uint16 listenPort)
 	fCursorBitmap(NULL),
 	fCursorVisible(false)
 {
-	fReceiveBuffer = new(std::nothrow) StreamingRingBuffer(16 * 1024);
+	fReceiveBuffer = new(std::nothrow) StreamingRingBuffer(128 * 1024);
 	if (fReceiveBuffer == NULL) {
 		fInitStatus = B_NO_MEMORY;
 		return;
@@ -120,6 +122,12 @@ RemoteView::RemoteView(BRect frame, uint16 listenPort)
 		return;
 	}
 
+	fTileStore = new(std::nothrow) RemoteTileStore();
+	if (fTileStore == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		return;
+	}
+
 	BRect bounds = frame.OffsetToCopy(0, 0);
 	fOffscreenBitmap = new(std::nothrow) BBitmap(bounds, B_BITMAP_ACCEPTS_VIEWS,
 		B_RGB32);
@@ -167,6 +175,8 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	delete fTileStore;
 }
 
 
@@ -460,6 +470,10 @@ RemoteView::_DrawThread()
 					continue;
 				}
 
+				// older servers don't send their protocol version at all
+				uint32 protocolVersion = 0;
+				message.Read(protocolVersion);
+
 				BNetEndpoint *endpoint = fReceiver->Endpoint();
 				if (endpoint == NULL) {
 					TRACE_ERROR("receiver not connected anymore\n");
@@ -481,6 +495,14 @@ RemoteView::_DrawThread()
 					continue;
 				}
 
+				if (protocolVersion != kRemoteProtocolVersion) {
+					TRACE_ERROR("unsupported remote protocol version %lu\n",
+						protocolVersion);
+					reply.Start(RP_CLOSE_CONNECTION);
+					reply.Flush();
+					continue;
+				}
+
 				BRect bounds = fOffscreenBitmap->Bounds();
 				reply.Start(RP_UPDATE_DISPLAY_MODE);
 				reply.Add(bounds.IntegerWidth() + 1);
@@ -764,8 +786,10 @@ RemoteView::_DrawThread()
 				message.Read(bitmapRect);
 				message.Read(viewRect);
 				message.Read(options);
-				if (message.ReadBitmap(&bitmap) != B_OK || bitmap == NULL)
+				if (message.ReadBitmap(&bitmap, false, B_RGB32, 0,
+						fTileStore) != B_OK || bitmap == NULL) {
 					continue;
+				}
 
 				offscreen->DrawBitmap(bitmap, bitmapRect, viewRect, options);
 				invalidRegion.Include(viewRect);
@@ -789,7 +813,7 @@ RemoteView::_DrawThread()
 
 					message.Read(viewRect);
 					if (message.ReadBitmap(&bitmap, true, colorSpace,
-							flags) != B_OK || bitmap == NULL) {
+							flags, fTileStore) != B_OK || bitmap == NULL) {
 						continue;
 					}
 
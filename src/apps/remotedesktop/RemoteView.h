@@ -16,6 +16,7 @@
 class BBitmap;
 class NetReceiver;
 class NetSender;
+class RemoteTileStore;
 class StreamingRingBuffer;
 
 struct engine_state;
@@ -69,6 +70,8 @@ static	int32						_DrawEntry(void *data);
 		NetReceiver *				fReceiver;
 		NetSender *					fSender;
 
+		RemoteTileStore *			fTileStore;
+
 		bool						fStopThread;
 		thread_id					fDrawThread;
 
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A small fio-like tool measuring IOPS and latency of random reads or
+	writes on a file or device, either issued synchronously, or kept in
+	flight via an I/O ring.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Drivers.h>
+#include <OS.h>
+
+#include <io_ring_defs.h>
+#include <syscalls.h>
+
+
+static struct option const kLongOptions[] = {
+	{"block-size", required_argument, 0, 'b'},
+	{"count", required_argument, 0, 'c'},
+	{"depth", required_argument, 0, 'q'},
+	{"direct", no_argument, 0, 'd'},
+	{"size", required_argument, 0, 's'},
+	{"sync", no_argument, 0, 'S'},
+	{"write", no_argument, 0, 'w'},
+	{"help", no_argument, 0, 'h'},
+	{NULL}
+};
+
+extern const char *__progname;
+static const char *kProgramName = __progname;
+
+
+struct benchmark {
+	int			fd;
+	bool		write;
+	size_t		block_size;
+	off_t		block_count;
+	uint32		count;
+	uint32		depth;
+	bigtime_t*	latencies;
+};
+
+
+void
+usage(int status)
+{
+	fprintf(stderr, "usage: %s [options] <file or device>\n"
+		"Measures random I/O performance.\n\n"
+		" -b,--block-size <size>\tSize of each I/O in bytes (default 4096).\n"
+		" -c,--count <count>\tNumber of I/Os to issue (default 100000).\n"
+		" -q,--depth <depth>\tNumber of I/Os kept in flight (default 32).\n"
+		" -d,--direct\t\tBypass the file cache (O_NOCACHE).\n"
+		" -s,--size <size>\tSize of the range to access in bytes (default:\n"
+		"\t\t\tthe size of the file or device).\n"
+		" -S,--sync\t\tUse synchronous I/O instead of an I/O ring.\n"
+		" -w,--write\t\tWrite instead of read.\n",
+		kProgramName);
+
+	exit(status);
+}
+
+
+static off_t
+random_offset(const benchmark& bench)
+{
+	off_t block = (((off_t)rand() << 31) ^ rand()) % bench.block_count;
+	return block * bench.block_size;
+}
+
+
+static int
+compare_latencies(const void* _a, const void* _b)
+{
+	bigtime_t a = *(const bigtime_t*)_a;
+	bigtime_t b = *(const bigtime_t*)_b;
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+
+static status_t
+run_synchronous(benchmark& bench)
+{
+	void* buffer = malloc(bench.block_size);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	memset(buffer, 0x55, bench.block_size);
+
+	for (uint32 i = 0; i < bench.count; i++) {
+		off_t offset = random_offset(bench);
+		bigtime_t startTime = system_time();
+
+		ssize_t bytes = bench.write
+			? write_pos(bench.fd, offset, buffer, bench.block_size)
+			: read_pos(bench.fd, offset, buffer, bench.block_size);
+		if (bytes < 0) {
+			free(buffer);
+			return errno;
+		}
+
+		bench.latencies[i] = system_time() - startTime;
+	}
+
+	free(buffer);
+	return B_OK;
+}
+
+
+static status_t
+run_ring(benchmark& bench)
+{
+	uint32 entryCount = 1;
+	while (entryCount < bench.depth)
+		entryCount <<= 1;
+
+	io_ring_header* header;
+	int ring = _kern_io_ring_create(entryCount, O_CLOEXEC, &header);
+	if (ring < 0)
+		return ring;
+
+	io_ring_submission* submissions = (io_ring_submission*)
+		((uint8*)header + header->submissions_offset);
+	io_ring_completion* completions = (io_ring_completion*)
+		((uint8*)header + header->completions_offset);
+	uint32 mask = header->entry_count - 1;
+
+	// every I/O in flight gets its own buffer slot
+	uint8* buffers = (uint8*)malloc(bench.block_size * bench.depth);
+	bigtime_t* startTimes
+		= (bigtime_t*)malloc(sizeof(bigtime_t) * bench.depth);
+	uint32* freeSlots = (uint32*)malloc(sizeof(uint32) * bench.depth);
+	if (buffers == NULL || startTimes == NULL || freeSlots == NULL) {
+		free(buffers);
+		free(startTimes);
+		free(freeSlots);
+		close(ring);
+		return B_NO_MEMORY;
+	}
+
+	memset(buffers, 0x55, bench.block_size * bench.depth);
+	for (uint32 i = 0; i < bench.depth; i++)
+		freeSlots[i] = i;
+	uint32 freeSlotCount = bench.depth;
+
+	status_t status = B_OK;
+	uint32 issued = 0;
+	uint32 completed = 0;
+	uint32 submissionTail = 0;
+	uint32 completionHead = 0;
+
+	while (completed < bench.count) {
+		// queue new I/Os for all free slots
+		while (freeSlotCount > 0 && issued < bench.count) {
+			uint32 slot = freeSlots[--freeSlotCount];
+
+			io_ring_submission& submission
+				= submissions[submissionTail++ & mask];
+			submission.fd = bench.fd;
+			submission.op = bench.write ? B_IO_RING_WRITE : B_IO_RING_READ;
+			submission.offset = random_offset(bench);
+			submission.buffer = buffers + slot * bench.block_size;
+			submission.length = bench.block_size;
+			submission.user_data = (void*)(addr_t)slot;
+
+			startTimes[slot] = system_time();
+			issued++;
+		}
+
+		// publish the entries, then submit and wait for a completion
+		atomic_set((int32*)&header->submission_tail, submissionTail);
+
+		uint32 queued = submissionTail
+			- atomic_get((int32*)&header->submission_head);
+		ssize_t result = _kern_io_ring_enter(ring, queued, 1, 0, 0);
+		if (result < 0 && result != B_INTERRUPTED) {
+			status = result;
+			break;
+		}
+
+		// reap the completions
+		uint32 completionTail = atomic_get((int32*)&header->completion_tail);
+		while (completionHead != completionTail) {
+			const io_ring_completion& completion
+				= completions[completionHead++ & mask];
+			uint32 slot = (addr_t)completion.user_data;
+
+			if (completion.result < 0 && status == B_OK)
+				status = completion.result;
+
+			bench.latencies[completed++] = system_time() - startTimes[slot];
+			freeSlots[freeSlotCount++] = slot;
+		}
+
+		atomic_set((int32*)&header->completion_head, completionHead);
+
+		if (status != B_OK)
+			break;
+	}
+
+	free(buffers);
+	free(startTimes);
+	free(freeSlots);
+	close(ring);
+	return status;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	benchmark bench;
+	bench.write = false;
+	bench.block_size = 4096;
+	bench.count = 100000;
+	bench.depth = 32;
+
+	off_t size = 0;
+	bool direct = false;
+	bool synchronous = false;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "b:c:q:ds:Swh", kLongOptions, NULL))
+			!= -1) {
+		switch (c) {
+			case 0:
+				break;
+			case 'b':
+				bench.block_size = strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				bench.count = strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				bench.depth = strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				direct = true;
+				break;
+			case 's':
+				size = strtoll(optarg, NULL, 0);
+				break;
+			case 'S':
+				synchronous = true;
+				break;
+			case 'w':
+				bench.write = true;
+				break;
+			case 'h':
+				usage(0);
+				break;
+			default:
+				usage(1);
+				break;
+		}
+	}
+
+	if (optind + 1 != argc || bench.block_size == 0 || bench.count == 0
+		|| bench.depth == 0 || bench.depth > 4096) {
+		usage(1);
+	}
+
+	const char* path = argv[optind];
+	bench.fd = open(path, (bench.write ? O_RDWR : O_RDONLY)
+		| (direct ? O_NOCACHE : 0));
+	if (bench.fd < 0) {
+		fprintf(stderr, "%s: could not open \"%s\": %s\n", kProgramName, path,
+			strerror(errno));
+		return 1;
+	}
+
+	if (size == 0) {
+		struct stat st;
+		device_geometry geometry;
+		if (ioctl(bench.fd, B_GET_GEOMETRY, &geometry,
+				sizeof(geometry)) == 0) {
+			size = (off_t)geometry.bytes_per_sector
+				* geometry.sectors_per_track * geometry.cylinder_count
+				* geometry.head_count;
+		} else if (fstat(bench.fd, &st) == 0)
+			size = st.st_size;
+	}
+
+	bench.block_count = size / bench.block_size;
+	if (bench.block_count == 0) {
+		fprintf(stderr, "%s: \"%s\" is smaller than one block.\n",
+			kProgramName, path);
+		return 1;
+	}
+
+	bench.latencies = (bigtime_t*)malloc(sizeof(bigtime_t) * bench.count);
+	if (bench.latencies == NULL) {
+		fprintf(stderr, "%s: out of memory\n", kProgramName);
+		return 1;
+	}
+
+	bigtime_t startTime = system_time();
+	status_t status = synchronous ? run_synchronous(bench) : run_ring(bench);
+	bigtime_t runTime = system_time() - startTime;
+
+	close(bench.fd);
+
+	if (status != B_OK) {
+		fprintf(stderr, "%s: I/O failed: %s\n", kProgramName,
+			strerror(status));
+		return 1;
+	}
+
+	qsort(bench.latencies, bench.count, sizeof(bigtime_t), &compare_latencies);
+
+	bigtime_t totalLatency = 0;
+	for (uint32 i = 0; i < bench.count; i++)
+		totalLatency += bench.latencies[i];
+
+	printf("%s %s, %lu bytes, depth %lu: %lu I/Os in %g s\n",
+		synchronous ? "synchronous" : "ring", bench.write ? "write" : "read",
+		bench.block_size, synchronous ? 1 : bench.depth, bench.count,
+		runTime / 1000000.0);
+	printf("  IOPS: %.0f, bandwidth: %.2f MB/s\n",
+		bench.count * 1000000.0 / runTime,
+		1.0 * bench.count * bench.block_size / runTime);
+	printf("  latency (usecs): min %lld, avg %lld, 50%% %lld, 99%% %lld, "
+		"max %lld\n", bench.latencies[0], totalLatency / bench.count,
+		bench.latencies[bench.count / 2],
+		bench.latencies[(uint64)bench.count * 99 / 100],
+		bench.latencies[bench.count - 1]);
+
+	free(bench.latencies);
+	return 0;
+}
@@ -28,6 +28,7 @@ extern const char* __progname;
 const char* kProgramName = __progname;
 
 static int sResolveNames = 1;
+static int sExtended = 0;
 
 struct address_family {
 	int			family;
@@ -99,9 +100,10 @@ inet_print_address(sockaddr* _address)
 void
 usage(int status)
 {
-	printf("usage: %s [-nh]\n", kProgramName);
+	printf("usage: %s [-neh]\n", kProgramName);
 	printf("options:\n");
 	printf("	-n	don't resolve names\n");
+	printf("	-e	show buffer sizes and round trip times\n");
 	printf("	-h	this help\n");
 
 	exit(status);
@@ -138,11 +140,12 @@ main(int argc, char** argv)
 	static struct option longOptions[] = {
 		{"help", no_argument, 0, 'h'},
 		{"numeric", no_argument, 0, 'n'},
+		{"extended", no_argument, 0, 'e'},
 		{0, 0, 0, 0}
 	};
 
 	do {
-		opt = getopt_long(argc, argv, "hn", longOptions, &optionIndex);
+		opt = getopt_long(argc, argv, "hne", longOptions, &optionIndex);
 		switch (opt) {
 			case -1:
 				// end of arguments, do nothing
@@ -152,6 +155,10 @@ main(int argc, char** argv)
 				sResolveNames = 0;
 				break;
 
+			case 'e':
+				sExtended = 1;
+				break;
+
 			case 'h':
 			default:
 				usage(0);
@@ -163,7 +170,10 @@ main(int argc, char** argv)
 		// TODO: add some more program options... :-)
 
 	printf("Proto  Recv-Q Send-Q Local Address         Foreign Address       "
-		"State        Program\n");
+		"State        ");
+	if (sExtended)
+		printf("Recv-Buf Send-Buf RTT(ms) ");
+	printf("Program\n");
 
 	uint32 cookie = 0;
 	int family = -1;
@@ -182,6 +192,15 @@ main(int argc, char** argv)
 		inet_print_address((sockaddr*)&stat.peer);
 		printf("%-12s ", stat.state);
 
+		if (sExtended) {
+			printf("%8lu %8lu ", stat.receive_buffer_size,
+				stat.send_buffer_size);
+			if (stat.round_trip_time > 0)
+				printf("%7.1f ", stat.round_trip_time / 1000.0);
+			else
+				printf("%7s ", "-");
+		}
+
 		team_info info;
 		if (printProgram && get_team_info(stat.owner, &info) == B_OK) {
 			// remove arguments
@@ -230,6 +230,7 @@ BMessage::operator=(const BMessage &other)
 	fFieldsAvailable = 0;
 	fDataAvailable = 0;
 
+	_BuildFieldIndex();
 	return *this;
 }
 
@@ -333,6 +334,8 @@ BMessage::_InitCommon(bool initHeader)
 	fFieldsAvailable = 0;
 	fDataAvailable = 0;
 
+	fFieldIndex = NULL;
+
 	fOriginal = NULL;
 	fQueueLink = NULL;
 
@@ -399,6 +402,8 @@ BMessage::_Clear()
 	free(fData);
 	fData = NULL;
 
+	_FreeFieldIndex();
+
 	fArchivingPointer = NULL;
 
 	fFieldsAvailable = 0;
@@ -760,6 +765,8 @@ BMessage::Rename(const char *oldEntry, const char *newEntry)
 
 			memcpy(fData + field->offset, newEntry, newLength);
 			field->name_length = newLength;
+
+			_BuildFieldIndex();
 			return B_OK;
 		}
 
@@ -1199,6 +1206,7 @@ BMessage::_ValidateMessage()
 		}
 	}
 
+	_BuildFieldIndex();
 	return B_OK;
 }
 
@@ -1590,8 +1598,30 @@ BMessage::_FindField(const char *name, type_code type, field_header **result) co
 	if (fHeader == NULL || fFields == NULL || fData == NULL)
 		return B_NAME_NOT_FOUND;
 
-	uint32 hash = _HashName(name) % fHeader->hash_table_size;
-	int32 nextField = fHeader->hash_table[hash];
+	uint32 hash = _HashName(name);
+
+	if (fFieldIndex != NULL) {
+		uint32 mask = fFieldIndex->size - 1;
+		for (uint32 i = hash & mask;; i = (i + 1) & mask) {
+			const field_index::slot& slot = fFieldIndex->slots[i];
+			if (slot.field < 0)
+				return B_NAME_NOT_FOUND;
+			if (slot.hash != hash)
+				continue;
+
+			field_header *field = &fFields[slot.field];
+			if (strncmp((const char *)(fData + field->offset), name,
+				field->name_length) == 0) {
+				if (type != B_ANY_TYPE && field->type != type)
+					return B_BAD_TYPE;
+
+				*result = field;
+				return B_OK;
+			}
+		}
+	}
+
+	int32 nextField = fHeader->hash_table[hash % fHeader->hash_table_size];
 
 	while (nextField >= 0) {
 		field_header *field = &fFields[nextField];
@@ -1634,17 +1664,10 @@ BMessage::_AddField(const char *name, type_code type, bool isFixedSize,
 		fFieldsAvailable = count - fHeader->field_count;
 	}
 
-	uint32 hash = _HashName(name) % fHeader->hash_table_size;
-	int32 *nextField = &fHeader->hash_table[hash];
-	while (*nextField >= 0)
-		nextField = &fFields[*nextField].next_field;
-	*nextField = fHeader->field_count;
-
 	field_header *field = &fFields[fHeader->field_count];
 	field->type = type;
 	field->count = 0;
 	field->data_size = 0;
-	field->next_field = -1;
 	field->offset = fHeader->data_size;
 	field->name_length = strlen(name) + 1;
 	status_t status = _ResizeData(field->offset, field->name_length);
@@ -1656,8 +1679,18 @@ BMessage::_AddField(const char *name, type_code type, bool isFixedSize,
 	if (isFixedSize)
 		field->flags |= FIELD_FLAG_FIXED_SIZE;
 
+	// The order within a bucket doesn't matter, so the field is put in front
+	// instead of walking the whole chain to append it.
+	uint32 hash = _HashName(name);
+	int32 *bucket = &fHeader->hash_table[hash % fHeader->hash_table_size];
+	field->next_field = *bucket;
+	*bucket = fHeader->field_count;
+
 	fFieldsAvailable--;
 	fHeader->field_count++;
+
+	_AddToFieldIndex(hash, fHeader->field_count - 1);
+
 	*result = field;
 	return B_OK;
 }
@@ -1697,6 +1730,9 @@ BMessage::_RemoveField(field_header *field)
 	fHeader->field_count--;
 	fFieldsAvailable++;
 
+	// all fields after the removed one changed their index
+	_BuildFieldIndex();
+
 	if (fFieldsAvailable > MAX_FIELD_PREALLOCATION) {
 		ssize_t available = MAX_FIELD_PREALLOCATION / 2;
 		size = (fHeader->field_count + available) * sizeof(field_header);
@@ -1714,6 +1750,78 @@ BMessage::_RemoveField(field_header *field)
 }
 
 
+/*!	(Re-)builds the in-memory index of the fields, or frees it if the message
+	has too few fields for it to pay off. If there is not enough memory or a
+	field name isn't properly terminated, the message is left without an
+	index, and lookups fall back to the hash table in the header.
+*/
+void
+BMessage::_BuildFieldIndex()
+{
+	_FreeFieldIndex();
+
+	uint32 count = fHeader != NULL ? fHeader->field_count : 0;
+	if (count < MIN_INDEXED_FIELD_COUNT || fFields == NULL || fData == NULL)
+		return;
+
+	uint32 size = MIN_INDEXED_FIELD_COUNT;
+	while (size < count * 2)
+		size *= 2;
+
+	field_index *index = (field_index *)malloc(sizeof(field_index)
+		+ size * sizeof(field_index::slot));
+	if (index == NULL)
+		return;
+
+	index->size = size;
+	memset(index->slots, 0xff, size * sizeof(field_index::slot));
+	fFieldIndex = index;
+
+	for (uint32 i = 0; i < count; i++) {
+		field_header *field = &fFields[i];
+		if (field->name_length == 0
+			|| fData[field->offset + field->name_length - 1] != '\0') {
+			_FreeFieldIndex();
+			return;
+		}
+
+		_AddToFieldIndex(_HashName((const char *)(fData + field->offset)), i);
+	}
+}
+
+
+/*!	Adds the field at \a index to the field index, if there is one; it is
+	resized when it would become more than half full. If the message doesn't
+	have an index yet, it is built once it has enough fields.
+*/
+void
+BMessage::_AddToFieldIndex(uint32 hash, int32 index)
+{
+	if (fFieldIndex == NULL || fHeader->field_count * 2 > fFieldIndex->size) {
+		if (fFieldIndex != NULL
+			|| fHeader->field_count >= MIN_INDEXED_FIELD_COUNT)
+			_BuildFieldIndex();
+		return;
+	}
+
+	uint32 mask = fFieldIndex->size - 1;
+	uint32 i = hash & mask;
+	while (fFieldIndex->slots[i].field >= 0)
+		i = (i + 1) & mask;
+
+	fFieldIndex->slots[i].hash = hash;
+	fFieldIndex->slots[i].field = index;
+}
+
+
+void
+BMessage::_FreeFieldIndex()
+{
+	free(fFieldIndex);
+	fFieldIndex = NULL;
+}
+
+
 status_t
 BMessage::AddData(const char *name, type_code type, const void *data,
 	ssize_t numBytes, bool isFixedSize, int32 count)
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <BitmapPresenter.h>
+
+#include <new>
+
+#include <Bitmap.h>
+#include <View.h>
+
+#include <ViewPrivate.h>
+
+
+namespace BPrivate {
+
+
+/*!	Creates \a bufferCount bitmaps of the given size and color space for
+	the \a view. Frames in the same color space as the screen can be drawn
+	directly from the bitmaps, others are converted while being drawn.
+*/
+BitmapPresenter::BitmapPresenter(BView* view, BRect bounds,
+	color_space colorSpace, int32 bufferCount)
+	:
+	fView(view),
+	fBuffers(NULL),
+	fBufferCount(0),
+	fNext(0),
+	fCurrent(-1),
+	fInitStatus(B_NO_INIT)
+{
+	if (view == NULL || bufferCount < 1) {
+		fInitStatus = B_BAD_VALUE;
+		return;
+	}
+
+	fBuffers = new(std::nothrow) buffer[bufferCount];
+	if (fBuffers == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		return;
+	}
+
+	for (; fBufferCount < bufferCount; fBufferCount++) {
+		buffer& current = fBuffers[fBufferCount];
+		current.pending = false;
+		current.drawn = create_sem(0, "bitmap drawn");
+		if (current.drawn < 0) {
+			fInitStatus = current.drawn;
+			return;
+		}
+
+		current.bitmap = new(std::nothrow) BBitmap(bounds, 0, colorSpace);
+		if (current.bitmap == NULL) {
+			delete_sem(current.drawn);
+			fInitStatus = B_NO_MEMORY;
+			return;
+		}
+		if (current.bitmap->InitCheck() != B_OK) {
+			fInitStatus = current.bitmap->InitCheck();
+			delete current.bitmap;
+			delete_sem(current.drawn);
+			return;
+		}
+	}
+
+	fInitStatus = B_OK;
+}
+
+
+BitmapPresenter::~BitmapPresenter()
+{
+	// Frames that are still pending are either drawn from the app_server's
+	// own reference to their bitmap, or skipped, so there is no need to
+	// wait for them.
+	for (int32 i = 0; i < fBufferCount; i++) {
+		delete_sem(fBuffers[i].drawn);
+		delete fBuffers[i].bitmap;
+	}
+
+	delete[] fBuffers;
+}
+
+
+status_t
+BitmapPresenter::InitCheck() const
+{
+	return fInitStatus;
+}
+
+
+/*!	Returns the bitmap the next frame should be rendered into. If the
+	app_server did not draw it yet since it has been presented last, this
+	waits up to \a timeout for it to do so, and returns \c NULL if it
+	didn't.
+*/
+BBitmap*
+BitmapPresenter::NextBuffer(bigtime_t timeout)
+{
+	if (fInitStatus != B_OK)
+		return NULL;
+
+	if (_WaitFor(fNext, timeout) != B_OK)
+		return NULL;
+
+	fCurrent = fNext;
+	return fBuffers[fCurrent].bitmap;
+}
+
+
+/*!	Draws the bitmap last returned by NextBuffer() into \a viewRect of the
+	view. This does not wait for the app_server to draw it; it must not be
+	changed until it is returned by NextBuffer() again.
+	The view's window must be locked.
+*/
+status_t
+BitmapPresenter::Present(BRect viewRect, uint32 options)
+{
+	if (fInitStatus != B_OK)
+		return fInitStatus;
+	if (fCurrent < 0)
+		return B_BAD_VALUE;
+
+	buffer& current = fBuffers[fCurrent];
+	fView->DrawBitmapAsync(current.bitmap, current.bitmap->Bounds(),
+		viewRect, options);
+
+	current.pending = true;
+	BView::Private(fView).ReleaseWhenDrawn(current.drawn);
+
+	fNext = (fCurrent + 1) % fBufferCount;
+	fCurrent = -1;
+	return B_OK;
+}
+
+
+status_t
+BitmapPresenter::Present(BPoint where)
+{
+	if (fInitStatus != B_OK)
+		return fInitStatus;
+	if (fCurrent < 0)
+		return B_BAD_VALUE;
+
+	BRect viewRect = fBuffers[fCurrent].bitmap->Bounds();
+	viewRect.OffsetTo(where);
+	return Present(viewRect, 0);
+}
+
+
+/*!	Waits until the app_server has drawn all presented frames.
+*/
+status_t
+BitmapPresenter::WaitForAll(bigtime_t timeout)
+{
+	if (fInitStatus != B_OK)
+		return fInitStatus;
+
+	for (int32 i = 0; i < fBufferCount; i++) {
+		status_t status = _WaitFor(i, timeout);
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+BitmapPresenter::_WaitFor(int32 index, bigtime_t timeout)
+{
+	buffer& current = fBuffers[index];
+	if (!current.pending)
+		return B_OK;
+
+	status_t status;
+	do {
+		status = acquire_sem_etc(current.drawn, 1, B_RELATIVE_TIMEOUT,
+			timeout);
+	} while (status == B_INTERRUPTED);
+
+	if (status != B_OK)
+		return status;
+
+	current.pending = false;
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
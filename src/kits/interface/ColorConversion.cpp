@@ -15,6 +15,7 @@
 
 #include <InterfaceDefs.h>
 #include <Locker.h>
+#include <OS.h>
 #include <Point.h>
 
 #include <Palette.h>
@@ -22,6 +23,14 @@
 #include <new>
 #include <string.h>
 
+#ifdef COLOR_CONVERSION_SIMD
+#	include "ColorConversionSIMD.h"
+#	ifndef __INTEL__
+		// get_cpuid() is only available on x86
+#		include <cpuid.h>
+#	endif
+#endif
+
 
 using std::nothrow;
 
@@ -896,33 +905,12 @@ ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
 }
 
 
-/*!	\brief Converts a source buffer in one colorspace into a destination
-		   buffer of another colorspace.
-
-	\param srcBits The raw source buffer.
-	\param dstBits The raw destination buffer.
-	\param srcBytesPerRow How many bytes per row the source buffer has got.
-	\param dstBytesPerRow How many bytes per row the destination buffer has got.
-	\param srcColorSpace The colorspace the source buffer is in.
-	\param dstColorSpace The colorspace the buffer shall be converted to.
-	\param srcOffset The offset at which to start reading in the source.
-	\param srcOffset The offset at which to start writing in the destination.
-	\param width The width (in pixels) to convert.
-	\param height The height (in pixels) to convert.
-	\return
-	- \c B_OK: Indicates success.
-	- \c B_BAD_VALUE: \c NULL buffer or at least one colorspace is unsupported.
-*/
-status_t
-ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
+static status_t
+convert_bits_generic(const void *srcBits, void *dstBits, int32 srcBitsLength,
 	int32 dstBitsLength, int32 srcBytesPerRow, int32 dstBytesPerRow,
 	color_space srcColorSpace, color_space dstColorSpace, BPoint srcOffset,
 	BPoint dstOffset, int32 width, int32 height)
 {
-	if (!srcBits || !dstBits || srcBitsLength < 0 || dstBitsLength < 0
-		|| width < 0 || height < 0 || srcBytesPerRow < 0 || dstBytesPerRow < 0)
-		return B_BAD_VALUE;
-
 	switch (srcColorSpace) {
 		case B_RGBA32:
 			return ConvertBits((const uint32 *)srcBits, dstBits, srcBitsLength,
@@ -1020,4 +1008,467 @@ ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
 	return B_OK;
 }
 
+
+// #pragma mark - optimized conversions
+
+
+// Bitmaps with less pixels are not worth spreading over several threads.
+static const int64 kMinParallelPixels = 512 * 1024;
+static const int32 kMinRowsPerThread = 64;
+static const int32 kMaxConversionThreads = 8;
+
+
+typedef void (*row_converter)(const uint8* source, uint8* dest, int32 width);
+
+struct row_conversion {
+	color_space		source;
+	color_space		dest;
+	int32			sourcePixelSize;
+	int32			destPixelSize;
+	uint32			requiredFlags;
+	row_converter	convert;
+};
+
+#ifdef COLOR_CONVERSION_SIMD
+static const row_conversion kRowConversions[] = {
+	{ B_RGB32, B_RGBA32, 4, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgba32_sse2 },
+	{ B_RGBA32, B_RGB32, 4, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgba32_sse2 },
+	{ B_RGB32, B_RGB16, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgb16_sse2 },
+	{ B_RGBA32, B_RGB16, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgb16_sse2 },
+	{ B_RGB32, B_RGB15, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgb15_sse2 },
+	{ B_RGBA32, B_RGB15, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgb15_sse2 },
+	{ B_RGB32, B_RGBA15, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_rgba15_sse2 },
+	{ B_RGBA32, B_RGBA15, 4, 2, COLOR_CONVERSION_SSE2,
+		convert_rgba32_to_rgba15_sse2 },
+	{ B_RGB16, B_RGB32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb16_to_rgb32_sse2 },
+	{ B_RGB16, B_RGBA32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb16_to_rgb32_sse2 },
+	{ B_RGB15, B_RGB32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb15_to_rgb32_sse2 },
+	{ B_RGB15, B_RGBA32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb15_to_rgb32_sse2 },
+	{ B_RGBA15, B_RGB32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgb15_to_rgb32_sse2 },
+	{ B_RGBA15, B_RGBA32, 2, 4, COLOR_CONVERSION_SSE2,
+		convert_rgba15_to_rgba32_sse2 },
+	{ B_RGB32, B_GRAY8, 4, 1, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_gray8_sse2 },
+	{ B_RGBA32, B_GRAY8, 4, 1, COLOR_CONVERSION_SSE2,
+		convert_rgb32_to_gray8_sse2 },
+	{ B_RGB24, B_RGB32, 3, 4, COLOR_CONVERSION_SSSE3,
+		convert_rgb24_to_rgb32_ssse3 },
+	{ B_RGB24, B_RGBA32, 3, 4, COLOR_CONVERSION_SSSE3,
+		convert_rgb24_to_rgb32_ssse3 },
+	{ B_RGB32, B_RGB24, 4, 3, COLOR_CONVERSION_SSSE3,
+		convert_rgb32_to_rgb24_ssse3 },
+	{ B_RGBA32, B_RGB24, 4, 3, COLOR_CONVERSION_SSSE3,
+		convert_rgb32_to_rgb24_ssse3 },
+};
+#endif
+
+
+struct conversion_job {
+	const void*		srcBits;
+	void*			dstBits;
+	int32			srcBitsLength;
+	int32			dstBitsLength;
+	int32			srcBytesPerRow;
+	int32			dstBytesPerRow;
+	color_space		srcColorSpace;
+	color_space		dstColorSpace;
+	BPoint			srcOffset;
+	BPoint			dstOffset;
+	int32			width;
+	int32			height;
+};
+
+
+static pthread_once_t sColorConversionInitOnce = PTHREAD_ONCE_INIT;
+static uint32 sSupportedFlags = 0;
+static uint32 sEnabledFlags = 0;
+static int32 sCPUCount = 1;
+
+
+static void
+init_color_conversion()
+{
+	uint32 flags = 0;
+
+	system_info info;
+	if (get_system_info(&info) == B_OK && info.cpu_count > 1) {
+		sCPUCount = info.cpu_count;
+		flags |= COLOR_CONVERSION_THREADS;
+	}
+
+#ifdef COLOR_CONVERSION_SIMD
+	// the Jamfile only defines COLOR_CONVERSION_SIMD for x86 and x86_64
+	bool haveFeatures;
+	uint32 ecx = 0;
+	uint32 edx = 0;
+#	ifdef __INTEL__
+	cpuid_info cpuInfo;
+	haveFeatures = get_cpuid(&cpuInfo, 0, 0) == B_OK && cpuInfo.regs.eax >= 1
+		&& get_cpuid(&cpuInfo, 1, 0) == B_OK;
+	if (haveFeatures) {
+		ecx = cpuInfo.regs.ecx;
+		edx = cpuInfo.regs.edx;
+	}
+#	else
+	unsigned int eax, ebx, cpuECX, cpuEDX;
+	haveFeatures = __get_cpuid(1, &eax, &ebx, &cpuECX, &cpuEDX) != 0;
+	if (haveFeatures) {
+		ecx = cpuECX;
+		edx = cpuEDX;
+	}
+#	endif
+
+	if (haveFeatures && (edx & (1 << 26)) != 0) {
+		flags |= COLOR_CONVERSION_SSE2;
+		if ((ecx & (1 << 9)) != 0)
+			flags |= COLOR_CONVERSION_SSSE3;
+	}
+#endif
+
+	sSupportedFlags = flags;
+	sEnabledFlags = flags;
+}
+
+
+static const row_conversion*
+find_row_conversion(color_space source, color_space dest)
+{
+#ifdef COLOR_CONVERSION_SIMD
+	uint32 flags = ColorConversionFlags();
+	for (size_t i = 0; i < sizeof(kRowConversions) / sizeof(kRowConversions[0]);
+			i++) {
+		const row_conversion& conversion = kRowConversions[i];
+		if (conversion.source == source && conversion.dest == dest
+			&& (conversion.requiredFlags & flags) == conversion.requiredFlags)
+			return &conversion;
+	}
+#endif
+
+	return NULL;
+}
+
+
+/*!	Clips the width of the \a job to the rows of both buffers like the
+	generic conversion does, and returns whether all of the rows to convert
+	are completely within the buffers. If they aren't, or the offsets are
+	negative, only the generic conversion handles the job correctly.
+*/
+static bool
+fit_job(conversion_job& job, int32 sourcePixelSize, int32 destPixelSize)
+{
+	int32 srcX = (int32)job.srcOffset.x;
+	int32 srcY = (int32)job.srcOffset.y;
+	int32 dstX = (int32)job.dstOffset.x;
+	int32 dstY = (int32)job.dstOffset.y;
+	if (srcX < 0 || srcY < 0 || dstX < 0 || dstY < 0)
+		return false;
+
+	int32 width = min_c(job.width,
+		min_c(job.srcBytesPerRow / sourcePixelSize - srcX,
+			job.dstBytesPerRow / destPixelSize - dstX));
+	if (width <= 0 || job.height == 0) {
+		job.width = 0;
+		return true;
+	}
+
+	if ((int64)(srcY + job.height - 1) * job.srcBytesPerRow
+			+ (int64)(srcX + width) * sourcePixelSize > job.srcBitsLength
+		|| (int64)(dstY + job.height - 1) * job.dstBytesPerRow
+			+ (int64)(dstX + width) * destPixelSize > job.dstBitsLength)
+		return false;
+
+	job.width = width;
+	return true;
+}
+
+
+static status_t
+convert(const conversion_job& job)
+{
+	const row_conversion* conversion = find_row_conversion(job.srcColorSpace,
+		job.dstColorSpace);
+	conversion_job fitted = job;
+	if (conversion != NULL && fit_job(fitted, conversion->sourcePixelSize,
+			conversion->destPixelSize)) {
+		const uint8* source = (const uint8*)fitted.srcBits
+			+ (int32)fitted.srcOffset.y * fitted.srcBytesPerRow
+			+ (int32)fitted.srcOffset.x * conversion->sourcePixelSize;
+		uint8* dest = (uint8*)fitted.dstBits
+			+ (int32)fitted.dstOffset.y * fitted.dstBytesPerRow
+			+ (int32)fitted.dstOffset.x * conversion->destPixelSize;
+
+		for (int32 y = 0; y < fitted.height && fitted.width > 0; y++) {
+			conversion->convert(source, dest, fitted.width);
+			source += fitted.srcBytesPerRow;
+			dest += fitted.dstBytesPerRow;
+		}
+		return B_OK;
+	}
+
+	return convert_bits_generic(job.srcBits, job.dstBits, job.srcBitsLength,
+		job.dstBitsLength, job.srcBytesPerRow, job.dstBytesPerRow,
+		job.srcColorSpace, job.dstColorSpace, job.srcOffset, job.dstOffset,
+		job.width, job.height);
+}
+
+
+// A band of rows of a job that is converted by one of the worker threads,
+// unless the calling thread takes it back before any worker got to it.
+struct conversion_band {
+	conversion_band*	next;
+	conversion_job		job;
+	int32				priority;
+	sem_id				done;
+	status_t			status;
+};
+
+static pthread_once_t sConversionWorkersInitOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t sConversionQueueLock = PTHREAD_MUTEX_INITIALIZER;
+static conversion_band* sConversionQueue = NULL;
+static sem_id sConversionWorkSem = -1;
+static int32 sConversionWorkerCount = 0;
+
+
+static status_t
+conversion_worker(void*)
+{
+	thread_id thread = find_thread(NULL);
+	int32 priority = B_NORMAL_PRIORITY;
+
+	while (true) {
+		status_t status;
+		do {
+			status = acquire_sem(sConversionWorkSem);
+		} while (status == B_INTERRUPTED);
+		if (status != B_OK)
+			return status;
+
+		pthread_mutex_lock(&sConversionQueueLock);
+		conversion_band* band = sConversionQueue;
+		if (band != NULL)
+			sConversionQueue = band->next;
+		pthread_mutex_unlock(&sConversionQueueLock);
+
+		if (band == NULL) {
+			// the calling thread converted it itself
+			continue;
+		}
+
+		// work at the priority of the thread that is waiting for the band
+		if (band->priority != priority) {
+			priority = band->priority;
+			set_thread_priority(thread, priority);
+		}
+
+		band->status = convert(band->job);
+		release_sem(band->done);
+	}
+}
+
+
+/*!	Starts the worker threads the first time a job is converted in
+	parallel. They stay around for the lifetime of the team, so that
+	converting a job doesn't have to spawn any threads.
+*/
+static void
+init_conversion_workers()
+{
+	sConversionWorkSem = create_sem(0, "color conversion work");
+	if (sConversionWorkSem < 0)
+		return;
+
+	int32 count = min_c(sCPUCount, kMaxConversionThreads) - 1;
+	for (int32 i = 0; i < count; i++) {
+		thread_id thread = spawn_thread(&conversion_worker,
+			"color conversion", B_NORMAL_PRIORITY, NULL);
+		if (thread < 0)
+			break;
+
+		resume_thread(thread);
+		sConversionWorkerCount++;
+	}
+}
+
+
+/*!	Converts the \a job in bands of rows, one per CPU. This is only done if
+	the bands cannot overlap in any way; otherwise the job is converted in
+	one piece.
+	The calling thread converts the first band, the worker threads the
+	others. Bands no worker has started on when the calling thread is done
+	with its own are converted by the calling thread as well.
+*/
+static status_t
+convert_in_parallel(const conversion_job& job)
+{
+	size_t sourcePixelSize, destPixelSize, sourcePixels, destPixels;
+	if (get_pixel_size_for(job.srcColorSpace, &sourcePixelSize, NULL,
+			&sourcePixels) != B_OK
+		|| get_pixel_size_for(job.dstColorSpace, &destPixelSize, NULL,
+			&destPixels) != B_OK
+		|| sourcePixels != 1 || destPixels != 1)
+		return convert(job);
+
+	conversion_job fitted = job;
+	if (!fit_job(fitted, sourcePixelSize, destPixelSize) || fitted.width == 0)
+		return convert(job);
+
+	pthread_once(&sConversionWorkersInitOnce, &init_conversion_workers);
+
+	int32 bandCount = min_c(sConversionWorkerCount + 1,
+		fitted.height / kMinRowsPerThread);
+	if (bandCount < 2)
+		return convert(job);
+
+	sem_id done = create_sem(0, "color conversion done");
+	if (done < 0)
+		return convert(job);
+
+	thread_info threadInfo;
+	int32 priority = B_NORMAL_PRIORITY;
+	if (get_thread_info(find_thread(NULL), &threadInfo) == B_OK)
+		priority = threadInfo.priority;
+
+	// the first band is converted by the calling thread
+	conversion_job first = fitted;
+	conversion_band bands[kMaxConversionThreads];
+	int32 row = 0;
+	for (int32 i = 0; i < bandCount; i++) {
+		int32 rows = (fitted.height - row) / (bandCount - i);
+		conversion_job& band = i == 0 ? first : bands[i].job;
+		band = fitted;
+		band.srcOffset.y += row;
+		band.dstOffset.y += row;
+		band.height = rows;
+		row += rows;
+	}
+
+	pthread_mutex_lock(&sConversionQueueLock);
+	for (int32 i = 1; i < bandCount; i++) {
+		bands[i].priority = priority;
+		bands[i].done = done;
+		bands[i].status = B_OK;
+		bands[i].next = sConversionQueue;
+		sConversionQueue = &bands[i];
+	}
+	pthread_mutex_unlock(&sConversionQueueLock);
+
+	release_sem_etc(sConversionWorkSem, bandCount - 1, 0);
+
+	status_t status = convert(first);
+
+	// take back the bands no worker has started on yet
+	conversion_band* ownBands = NULL;
+	int32 claimed = bandCount - 1;
+
+	pthread_mutex_lock(&sConversionQueueLock);
+	conversion_band** link = &sConversionQueue;
+	while (*link != NULL) {
+		conversion_band* band = *link;
+		if (band->done != done) {
+			link = &band->next;
+			continue;
+		}
+
+		*link = band->next;
+		band->next = ownBands;
+		ownBands = band;
+		claimed--;
+	}
+	pthread_mutex_unlock(&sConversionQueueLock);
+
+	for (conversion_band* band = ownBands; band != NULL; band = band->next)
+		band->status = convert(band->job);
+
+	// wait for the workers to finish the others
+	if (claimed > 0) {
+		while (acquire_sem_etc(done, claimed, 0, 0) == B_INTERRUPTED)
+			;
+	}
+	delete_sem(done);
+
+	for (int32 i = 1; i < bandCount; i++) {
+		if (bands[i].status != B_OK)
+			status = bands[i].status;
+	}
+
+	return status;
+}
+
+
+/*!	\brief Converts a source buffer in one colorspace into a destination
+		   buffer of another colorspace.
+
+	\param srcBits The raw source buffer.
+	\param dstBits The raw destination buffer.
+	\param srcBytesPerRow How many bytes per row the source buffer has got.
+	\param dstBytesPerRow How many bytes per row the destination buffer has got.
+	\param srcColorSpace The colorspace the source buffer is in.
+	\param dstColorSpace The colorspace the buffer shall be converted to.
+	\param srcOffset The offset at which to start reading in the source.
+	\param srcOffset The offset at which to start writing in the destination.
+	\param width The width (in pixels) to convert.
+	\param height The height (in pixels) to convert.
+	\return
+	- \c B_OK: Indicates success.
+	- \c B_BAD_VALUE: \c NULL buffer or at least one colorspace is unsupported.
+*/
+status_t
+ConvertBits(const void *srcBits, void *dstBits, int32 srcBitsLength,
+	int32 dstBitsLength, int32 srcBytesPerRow, int32 dstBytesPerRow,
+	color_space srcColorSpace, color_space dstColorSpace, BPoint srcOffset,
+	BPoint dstOffset, int32 width, int32 height)
+{
+	if (!srcBits || !dstBits || srcBitsLength < 0 || dstBitsLength < 0
+		|| width < 0 || height < 0 || srcBytesPerRow < 0 || dstBytesPerRow < 0)
+		return B_BAD_VALUE;
+
+	conversion_job job = {
+		srcBits, dstBits, srcBitsLength, dstBitsLength, srcBytesPerRow,
+		dstBytesPerRow, srcColorSpace, dstColorSpace, srcOffset, dstOffset,
+		width, height
+	};
+
+	if ((ColorConversionFlags() & COLOR_CONVERSION_THREADS) != 0
+		&& (int64)width * height >= kMinParallelPixels)
+		return convert_in_parallel(job);
+
+	return convert(job);
+}
+
+
+/*!	\brief Returns the optimized code paths ConvertBits() uses.
+*/
+uint32
+ColorConversionFlags()
+{
+	pthread_once(&sColorConversionInitOnce, &init_color_conversion);
+	return sEnabledFlags;
+}
+
+
+/*!	\brief Chooses the optimized code paths ConvertBits() uses.
+
+	Only those the CPU supports are enabled.
+	\return The code paths that are used from now on.
+*/
+uint32
+SetColorConversionFlags(uint32 flags)
+{
+	pthread_once(&sColorConversionInitOnce, &init_color_conversion);
+	sEnabledFlags = flags & sSupportedFlags;
+	return sEnabledFlags;
+}
+
 } // namespace BPrivate
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SIMD versions of the conversions between the most frequently used color
+ * spaces. Each of them converts a single row of \a width pixels, and gives
+ * exactly the same results as the generic ConvertBits() would.
+ */
+#ifndef COLOR_CONVERSION_SIMD_H
+#define COLOR_CONVERSION_SIMD_H
+
+
+#include <SupportDefs.h>
+
+
+namespace BPrivate {
+
+
+// SSE2
+void convert_rgb32_to_rgba32_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb32_to_rgb16_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb32_to_rgb15_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb32_to_rgba15_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgba32_to_rgba15_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb16_to_rgb32_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb15_to_rgb32_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgba15_to_rgba32_sse2(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb32_to_gray8_sse2(const uint8* source, uint8* dest,
+	int32 width);
+
+// SSSE3
+void convert_rgb24_to_rgb32_ssse3(const uint8* source, uint8* dest,
+	int32 width);
+void convert_rgb32_to_rgb24_ssse3(const uint8* source, uint8* dest,
+	int32 width);
+
+
+}	// namespace BPrivate
+
+
+#endif	// COLOR_CONVERSION_SIMD_H
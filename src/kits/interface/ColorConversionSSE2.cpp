@@ -0,0 +1,332 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the color space conversions, see ColorConversionSIMD.h.
+ * This file has to be compiled with -msse2.
+ *
+ * They use the same shifts and masks as the generic conversion, including
+ * the bits of neighbouring channels that end up in the lower bits when
+ * expanding 15 and 16 bit colors, so that the results are the same.
+ */
+
+
+#include "ColorConversionSIMD.h"
+
+#include <string.h>
+
+#include <emmintrin.h>
+
+
+namespace BPrivate {
+
+
+static inline __m128i
+load(const uint8* source)
+{
+	return _mm_loadu_si128((const __m128i*)source);
+}
+
+
+static inline void
+store(uint8* dest, __m128i value)
+{
+	_mm_storeu_si128((__m128i*)dest, value);
+}
+
+
+static inline uint32
+read32(const uint8* source)
+{
+	uint32 value;
+	memcpy(&value, source, 4);
+	return value;
+}
+
+
+static inline void
+write32(uint8* dest, uint32 value)
+{
+	memcpy(dest, &value, 4);
+}
+
+
+static inline uint16
+read16(const uint8* source)
+{
+	uint16 value;
+	memcpy(&value, source, 2);
+	return value;
+}
+
+
+static inline void
+write16(uint8* dest, uint16 value)
+{
+	memcpy(dest, &value, 2);
+}
+
+
+/*!	Packs the lower 16 bits of each 32 bit lane of \a low and \a high into
+	eight 16 bit values; _mm_packs_epi32() saturates, so they have to be sign
+	extended first.
+*/
+static inline __m128i
+pack_low_words(__m128i low, __m128i high)
+{
+	low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+	high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+	return _mm_packs_epi32(low, high);
+}
+
+
+// #pragma mark - from 32 bit
+
+
+void
+convert_rgb32_to_rgba32_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+	int32 x = 0;
+	for (; x + 4 <= width; x += 4)
+		store(dest + x * 4, _mm_or_si128(load(source + x * 4), alpha));
+
+	for (; x < width; x++)
+		write32(dest + x * 4, read32(source + x * 4) | 0xff000000);
+}
+
+
+static inline __m128i
+rgb32_to_rgb16(__m128i pixels)
+{
+	return _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xf800)),
+			_mm_and_si128(_mm_srli_epi32(pixels, 5), _mm_set1_epi32(0x07e0))),
+		_mm_and_si128(_mm_srli_epi32(pixels, 3), _mm_set1_epi32(0x001f)));
+}
+
+
+void
+convert_rgb32_to_rgb16_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	int32 x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i low = rgb32_to_rgb16(load(source + x * 4));
+		__m128i high = rgb32_to_rgb16(load(source + x * 4 + 16));
+		store(dest + x * 2, pack_low_words(low, high));
+	}
+
+	for (; x < width; x++) {
+		uint32 pixel = read32(source + x * 4);
+		write16(dest + x * 2, ((pixel >> 8) & 0xf800)
+			| ((pixel >> 5) & 0x07e0) | ((pixel >> 3) & 0x001f));
+	}
+}
+
+
+enum alpha_mode {
+	NO_ALPHA,
+	OPAQUE_ALPHA,
+	SOURCE_ALPHA
+};
+
+
+static inline __m128i
+rgb32_to_rgb15(__m128i pixels, alpha_mode mode)
+{
+	__m128i result = _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_srli_epi32(pixels, 9), _mm_set1_epi32(0x7c00)),
+			_mm_and_si128(_mm_srli_epi32(pixels, 6), _mm_set1_epi32(0x03e0))),
+		_mm_and_si128(_mm_srli_epi32(pixels, 3), _mm_set1_epi32(0x001f)));
+
+	if (mode == OPAQUE_ALPHA)
+		result = _mm_or_si128(result, _mm_set1_epi32(0x8000));
+	else if (mode == SOURCE_ALPHA) {
+		result = _mm_or_si128(result, _mm_and_si128(
+			_mm_srli_epi32(pixels, 16), _mm_set1_epi32(0x8000)));
+	}
+
+	return result;
+}
+
+
+static inline void
+convert_rgb32_to_rgb15(const uint8* source, uint8* dest, int32 width,
+	alpha_mode mode)
+{
+	int32 x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i low = rgb32_to_rgb15(load(source + x * 4), mode);
+		__m128i high = rgb32_to_rgb15(load(source + x * 4 + 16), mode);
+		store(dest + x * 2, pack_low_words(low, high));
+	}
+
+	for (; x < width; x++) {
+		uint32 pixel = read32(source + x * 4);
+		uint32 result = ((pixel >> 9) & 0x7c00) | ((pixel >> 6) & 0x03e0)
+			| ((pixel >> 3) & 0x001f);
+		if (mode == OPAQUE_ALPHA)
+			result |= 0x8000;
+		else if (mode == SOURCE_ALPHA)
+			result |= (pixel >> 16) & 0x8000;
+
+		write16(dest + x * 2, (uint16)result);
+	}
+}
+
+
+void
+convert_rgb32_to_rgb15_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	convert_rgb32_to_rgb15(source, dest, width, NO_ALPHA);
+}
+
+
+void
+convert_rgb32_to_rgba15_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	convert_rgb32_to_rgb15(source, dest, width, OPAQUE_ALPHA);
+}
+
+
+void
+convert_rgba32_to_rgba15_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	convert_rgb32_to_rgb15(source, dest, width, SOURCE_ALPHA);
+}
+
+
+/*!	Computes (red * 308 + green * 600 + blue * 116) >> 10 for four pixels.
+*/
+static inline __m128i
+rgb32_to_gray(__m128i pixels)
+{
+	// blue in the lower, and red in the upper 16 bits of each lane
+	__m128i blueRed = _mm_and_si128(pixels, _mm_set1_epi32(0x00ff00ff));
+	__m128i green = _mm_and_si128(_mm_srli_epi32(pixels, 8),
+		_mm_set1_epi32(0x000000ff));
+
+	__m128i sum = _mm_add_epi32(
+		_mm_madd_epi16(blueRed, _mm_set1_epi32((308 << 16) | 116)),
+		_mm_madd_epi16(green, _mm_set1_epi32(600)));
+	return _mm_srli_epi32(sum, 10);
+}
+
+
+void
+convert_rgb32_to_gray8_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	int32 x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i words = _mm_packs_epi32(rgb32_to_gray(load(source + x * 4)),
+			rgb32_to_gray(load(source + x * 4 + 16)));
+		_mm_storel_epi64((__m128i*)(dest + x),
+			_mm_packus_epi16(words, words));
+	}
+
+	for (; x < width; x++) {
+		const uint8* pixel = source + x * 4;
+		dest[x] = (pixel[2] * 308 + pixel[1] * 600 + pixel[0] * 116) >> 10;
+	}
+}
+
+
+// #pragma mark - to 32 bit
+
+
+static inline __m128i
+rgb16_to_rgb32(__m128i pixels)
+{
+	return _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(pixels, 8), _mm_set1_epi32(0xff0000)),
+			_mm_and_si128(_mm_slli_epi32(pixels, 5), _mm_set1_epi32(0xff00))),
+		_mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(pixels, 3), _mm_set1_epi32(0xff)),
+			_mm_set1_epi32((int)0xff000000)));
+}
+
+
+void
+convert_rgb16_to_rgb32_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	int32 x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i pixels = load(source + x * 2);
+		store(dest + x * 4, rgb16_to_rgb32(_mm_unpacklo_epi16(pixels, zero)));
+		store(dest + x * 4 + 16,
+			rgb16_to_rgb32(_mm_unpackhi_epi16(pixels, zero)));
+	}
+
+	for (; x < width; x++) {
+		uint32 pixel = read16(source + x * 2);
+		write32(dest + x * 4, ((pixel << 8) & 0xff0000)
+			| ((pixel << 5) & 0xff00) | ((pixel << 3) & 0xff) | 0xff000000);
+	}
+}
+
+
+static inline __m128i
+rgb15_to_rgb32(__m128i pixels, bool sourceAlpha)
+{
+	__m128i result = _mm_or_si128(_mm_or_si128(
+			_mm_and_si128(_mm_slli_epi32(pixels, 9), _mm_set1_epi32(0xff0000)),
+			_mm_and_si128(_mm_slli_epi32(pixels, 6), _mm_set1_epi32(0xff00))),
+		_mm_and_si128(_mm_slli_epi32(pixels, 3), _mm_set1_epi32(0xff)));
+
+	if (!sourceAlpha)
+		return _mm_or_si128(result, _mm_set1_epi32((int)0xff000000));
+
+	// The alpha channel is taken from bits 8 to 15, and set to 255 if any
+	// of them is set.
+	__m128i isTransparent = _mm_cmpeq_epi32(
+		_mm_and_si128(pixels, _mm_set1_epi32(0xff00)), _mm_setzero_si128());
+	return _mm_or_si128(result, _mm_andnot_si128(isTransparent,
+		_mm_set1_epi32((int)0xff000000)));
+}
+
+
+static inline void
+convert_rgb15_to_rgb32(const uint8* source, uint8* dest, int32 width,
+	bool sourceAlpha)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	int32 x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i pixels = load(source + x * 2);
+		store(dest + x * 4,
+			rgb15_to_rgb32(_mm_unpacklo_epi16(pixels, zero), sourceAlpha));
+		store(dest + x * 4 + 16,
+			rgb15_to_rgb32(_mm_unpackhi_epi16(pixels, zero), sourceAlpha));
+	}
+
+	for (; x < width; x++) {
+		uint32 pixel = read16(source + x * 2);
+		uint32 result = ((pixel << 9) & 0xff0000) | ((pixel << 6) & 0xff00)
+			| ((pixel << 3) & 0xff);
+		if (!sourceAlpha || (pixel & 0xff00) != 0)
+			result |= 0xff000000;
+
+		write32(dest + x * 4, result);
+	}
+}
+
+
+void
+convert_rgb15_to_rgb32_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	convert_rgb15_to_rgb32(source, dest, width, false);
+}
+
+
+void
+convert_rgba15_to_rgba32_sse2(const uint8* source, uint8* dest, int32 width)
+{
+	convert_rgb15_to_rgb32(source, dest, width, true);
+}
+
+
+}	// namespace BPrivate
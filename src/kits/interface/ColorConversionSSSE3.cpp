@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSSE3 versions of the color space conversions, see ColorConversionSIMD.h.
+ * This file has to be compiled with -mssse3.
+ *
+ * Converting between 24 and 32 bit pixels moves bytes across the lanes,
+ * which is what _mm_shuffle_epi8() is good at.
+ */
+
+
+#include "ColorConversionSIMD.h"
+
+#include <tmmintrin.h>
+
+
+namespace BPrivate {
+
+
+static inline __m128i
+load(const uint8* source)
+{
+	return _mm_loadu_si128((const __m128i*)source);
+}
+
+
+static inline void
+store(uint8* dest, __m128i value)
+{
+	_mm_storeu_si128((__m128i*)dest, value);
+}
+
+
+void
+convert_rgb24_to_rgb32_ssse3(const uint8* source, uint8* dest, int32 width)
+{
+	// spreads four 24 bit pixels over four 32 bit lanes
+	const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+		6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+	int32 x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8* pixels = source + x * 3;
+		__m128i a = load(pixels);
+		__m128i b = load(pixels + 16);
+		__m128i c = load(pixels + 32);
+
+		uint8* target = dest + x * 4;
+		store(target, _mm_or_si128(_mm_shuffle_epi8(a, spread), alpha));
+		store(target + 16, _mm_or_si128(
+			_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), spread), alpha));
+		store(target + 32, _mm_or_si128(
+			_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), spread), alpha));
+		store(target + 48, _mm_or_si128(
+			_mm_shuffle_epi8(_mm_srli_si128(c, 4), spread), alpha));
+	}
+
+	for (; x < width; x++) {
+		const uint8* pixel = source + x * 3;
+		uint8* target = dest + x * 4;
+		target[0] = pixel[0];
+		target[1] = pixel[1];
+		target[2] = pixel[2];
+		target[3] = 255;
+	}
+}
+
+
+void
+convert_rgb32_to_rgb24_ssse3(const uint8* source, uint8* dest, int32 width)
+{
+	// packs four 32 bit pixels into the lower 12 bytes
+	const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10,
+		12, 13, 14, -1, -1, -1, -1);
+
+	int32 x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8* pixels = source + x * 4;
+		__m128i a = _mm_shuffle_epi8(load(pixels), pack);
+		__m128i b = _mm_shuffle_epi8(load(pixels + 16), pack);
+		__m128i c = _mm_shuffle_epi8(load(pixels + 32), pack);
+		__m128i d = _mm_shuffle_epi8(load(pixels + 48), pack);
+
+		uint8* target = dest + x * 3;
+		store(target, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+		store(target + 16,
+			_mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+		store(target + 32,
+			_mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+	}
+
+	for (; x < width; x++) {
+		const uint8* pixel = source + x * 4;
+		uint8* target = dest + x * 3;
+		target[0] = pixel[0];
+		target[1] = pixel[1];
+		target[2] = pixel[2];
+	}
+}
+
+
+}	// namespace BPrivate
@@ -341,6 +341,56 @@ get_is_subpixel_ordering_regular(bool* subpixelOrdering)
 }
 
 
+void
+set_render_thread_count(int32 count)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_SET_RENDER_THREAD_COUNT);
+	link.Attach<int32>(count);
+	link.Flush();
+}
+
+
+status_t
+get_render_thread_count(int32* count)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_GET_RENDER_THREAD_COUNT);
+	int32 status = B_ERROR;
+	if (link.FlushWithReply(status) != B_OK || status < B_OK)
+		return status;
+	link.Read<int32>(count);
+	return B_OK;
+}
+
+
+void
+set_retain_window_contents(bool retain)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_SET_RETAIN_WINDOW_CONTENTS);
+	link.Attach<bool>(retain);
+	link.Flush();
+}
+
+
+status_t
+get_retain_window_contents(bool* retain)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_GET_RETAIN_WINDOW_CONTENTS);
+	int32 status = B_ERROR;
+	if (link.FlushWithReply(status) != B_OK || status < B_OK)
+		return status;
+	link.Read<bool>(retain);
+	return B_OK;
+}
+
+
 const color_map *
 system_colors()
 {
@@ -22,17 +22,28 @@
 const static int32 kDataBlockSize = 8;
 
 
+// Checks if the two rects in internal format (right and bottom are not
+// part of the rect) have any area in common.
+static inline bool
+internal_rects_intersect(const clipping_rect& a, const clipping_rect& b)
+{
+	return a.left < b.right && b.left < a.right
+		&& a.top < b.bottom && b.top < a.bottom;
+}
+
+
 /*! \brief Initializes a region. The region will have no rects,
 	and its fBounds will be invalid.
+	Like a region containing a single rect, it does not allocate any
+	memory until more rects are added.
 */
 BRegion::BRegion()
 	:
 	fCount(0),
-	fDataSize(0),
+	fDataSize(1),
 	fBounds((clipping_rect){ 0, 0, 0, 0 }),
-	fData(NULL)
+	fData(&fBounds)
 {
-	_SetSize(kDataBlockSize);
 }
 
 
@@ -42,9 +53,9 @@ BRegion::BRegion()
 BRegion::BRegion(const BRegion& region)
 	:
 	fCount(0),
-	fDataSize(0),
+	fDataSize(1),
 	fBounds((clipping_rect){ 0, 0, 0, 0 }),
-	fData(NULL)
+	fData(&fBounds)
 {
 	*this = region;
 }
@@ -105,7 +116,7 @@ BRegion::operator=(const BRegion& region)
 
 	// handle reallocation if we're too small to contain
 	// the other region
-	if (_SetSize(region.fDataSize)) {
+	if (_SetSize(region.fCount)) {
 		memcpy(fData, region.fData, region.fCount * sizeof(clipping_rect));
 
 		fBounds = region.fBounds;
@@ -395,12 +406,39 @@ BRegion::Include(clipping_rect rect)
 	if (!valid_rect(rect))
 		return;
 
-	// convert to internal rect format
-	rect.right ++;
-	rect.bottom ++;
+	clipping_rect internal = _ConvertToInternal(rect);
+
+	if (fCount == 0 || rect_contains(internal, fBounds)) {
+		// the rect covers the whole region
+		Set(rect);
+		return;
+	}
+
+	if (rect_contains(fBounds, internal)
+		&& Support::XRectInRegion(this, internal) == Support::RectangleIn)
+		return;
+
+	if (internal.top >= fBounds.bottom) {
+		// The rect is below all other rects, and forms a band of its own;
+		// it can only be merged with the last band, if that consists of
+		// a single rect of the same width.
+		clipping_rect& last = fData[fCount - 1];
+		if (last.bottom == internal.top && last.left == internal.left
+			&& last.right == internal.right
+			&& (fCount == 1 || fData[fCount - 2].top != last.top)) {
+			last.bottom = internal.bottom;
+		} else {
+			if (fCount == fDataSize && !_SetSize(fDataSize * 2))
+				return;
+			fData[fCount++] = internal;
+		}
+
+		fBounds = union_rect(fBounds, internal);
+		return;
+	}
 
 	// use private clipping_rect constructor which avoids malloc()
-	BRegion t(rect);
+	BRegion t(internal);
 
 	BRegion result;
 	Support::XUnionRegion(this, &t, &result);
@@ -415,6 +453,22 @@ BRegion::Include(clipping_rect rect)
 void
 BRegion::Include(const BRegion* region)
 {
+	if (region->fCount == 0 || region == this)
+		return;
+
+	if (fCount == 0) {
+		*this = *region;
+		return;
+	}
+
+	if (region->fCount == 1) {
+		Include(region->FrameInt());
+		return;
+	}
+
+	if (fCount == 1 && rect_contains(fBounds, region->fBounds))
+		return;
+
 	BRegion result;
 	Support::XUnionRegion(this, region, &result);
 
@@ -448,6 +502,14 @@ BRegion::Exclude(clipping_rect rect)
 	rect.right ++;
 	rect.bottom ++;
 
+	if (fCount == 0 || !internal_rects_intersect(fBounds, rect))
+		return;
+
+	if (rect_contains(rect, fBounds)) {
+		MakeEmpty();
+		return;
+	}
+
 	// use private clipping_rect constructor which avoids malloc()
 	BRegion t(rect);
 
@@ -465,6 +527,15 @@ BRegion::Exclude(clipping_rect rect)
 void
 BRegion::Exclude(const BRegion* region)
 {
+	if (fCount == 0 || region->fCount == 0
+		|| !internal_rects_intersect(fBounds, region->fBounds))
+		return;
+
+	if (region->fCount == 1) {
+		Exclude(region->FrameInt());
+		return;
+	}
+
 	BRegion result;
 	Support::XSubtractRegion(this, region, &result);
 
@@ -482,6 +553,30 @@ BRegion::Exclude(const BRegion* region)
 void
 BRegion::IntersectWith(const BRegion* region)
 {
+	if (fCount == 0)
+		return;
+
+	if (region->fCount == 0
+		|| !internal_rects_intersect(fBounds, region->fBounds)) {
+		MakeEmpty();
+		return;
+	}
+
+	if (region->fCount == 1 && rect_contains(region->fBounds, fBounds))
+		return;
+
+	if (fCount == 1) {
+		if (rect_contains(fBounds, region->fBounds)) {
+			*this = *region;
+			return;
+		}
+		if (region->fCount == 1) {
+			// both regions are single rects that overlap
+			fData[0] = fBounds = sect_rect(fBounds, region->fBounds);
+			return;
+		}
+	}
+
 	BRegion result;
 	Support::XIntersectRegion(this, region, &result);
 
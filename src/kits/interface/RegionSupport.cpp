@@ -1538,20 +1538,43 @@ BRegion::Support::XXorRegion(const BRegion* sra, const BRegion* srb,
 }
 
 
+/*  Returns the index of the first box that ends below y. Since the boxes
+ *  are sorted in bands from top to bottom, their bottoms never decrease,
+ *  and the band that could contain y can be found with a binary search.
+ */
+static int
+first_box_below(const clipping_rect* boxes, int count, int y)
+{
+    int low = 0;
+    int high = count;
+
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (boxes[mid].bottom <= y)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
 int 
 BRegion::Support::XPointInRegion(
     const BRegion* pRegion,
     int x, int y)
 {
-	// TODO: binary search by "y"!
     int i;
 
     if (pRegion->fCount == 0)
         return false;
     if (!INBOX(pRegion->fBounds, x, y))
         return false;
-    for (i=0; i<pRegion->fCount; i++)
+    for (i = first_box_below(pRegion->fData, pRegion->fCount, y);
+         i < pRegion->fCount && pRegion->fData[i].top <= y; i++)
     {
+        /* the boxes of a band are sorted from left to right */
+        if (pRegion->fData[i].left > x)
+            break;
         if (INBOX (pRegion->fData[i], x, y))
 	    return true;
     }
@@ -1579,7 +1602,10 @@ BRegion::Support::XRectInRegion(
     partIn = false;
 
     /* can stop when both partOut and partIn are true, or we reach prect->bottom */
-    for (pbox = region->fData, pboxEnd = pbox + region->fCount;
+    /* the bands above the rectangle are skipped right away */
+    for (pbox = region->fData + first_box_below(region->fData,
+             region->fCount, ry),
+         pboxEnd = region->fData + region->fCount;
 	 pbox < pboxEnd;
 	 pbox++)
     {
@@ -5976,3 +5976,24 @@ BView::Private::WillLayout()
 		return true;
 	return false;
 }
+
+
+/*!	Releases the \a semaphore once the app_server has carried out all
+	drawing commands of the view's window up to now. Unlike Sync(), this
+	doesn't block the caller.
+*/
+void
+BView::Private::ReleaseWhenDrawn(sem_id semaphore)
+{
+	if (fView->fOwner == NULL) {
+		release_sem(semaphore);
+		return;
+	}
+
+	fView->_CheckOwnerLock();
+
+	BPrivate::PortLink* link = fView->fOwner->fLink;
+	link->StartMessage(AS_SYNC_WITH_SEMAPHORE);
+	link->Attach<sem_id>(semaphore);
+	link->Flush();
+}
@@ -16,6 +16,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <syscall_utils.h>
@@ -279,6 +281,27 @@ recvmsg(int socket, struct msghdr *message, int flags)
 }
 
 
+extern "C" int
+recvmmsg(int socket, struct mmsghdr *messages, unsigned int count, int flags,
+	struct timespec *timeout)
+{
+	bigtime_t relativeTimeout = B_INFINITE_TIMEOUT;
+	if (timeout != NULL) {
+		if (timeout->tv_sec < 0 || timeout->tv_nsec < 0
+			|| timeout->tv_nsec >= 1000000000) {
+			errno = B_BAD_VALUE;
+			return -1;
+		}
+
+		relativeTimeout = (bigtime_t)timeout->tv_sec * 1000000
+			+ timeout->tv_nsec / 1000;
+	}
+
+	RETURN_AND_SET_ERRNO_TEST_CANCEL(
+		_kern_recvmmsg(socket, messages, count, flags, relativeTimeout));
+}
+
+
 extern "C" ssize_t
 send(int socket, const void *data, size_t length, int flags)
 {
@@ -310,6 +333,22 @@ sendmsg(int socket, const struct msghdr *message, int flags)
 }
 
 
+extern "C" int
+sendmmsg(int socket, struct mmsghdr *messages, unsigned int count, int flags)
+{
+	RETURN_AND_SET_ERRNO_TEST_CANCEL(
+		_kern_sendmmsg(socket, messages, count, flags));
+}
+
+
+extern "C" ssize_t
+sendfile(int socket, int fd, off_t *offset, size_t count)
+{
+	RETURN_AND_SET_ERRNO_TEST_CANCEL(
+		_kern_send_file(socket, fd, offset, count));
+}
+
+
 extern "C" int
 getsockopt(int socket, int level, int option, void *value, socklen_t *_length)
 {
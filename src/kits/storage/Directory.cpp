@@ -653,6 +653,43 @@ BDirectory::GetNextDirents(dirent* buf, size_t bufSize, int32 count)
 }
 
 
+/*!	\brief Returns the BDirectory's next entries as dirent structures along
+	with the stat data of the nodes they refer to.
+	Works like GetNextDirents(), but additionally fills in the stat data of
+	the returned entries (not traversing symlinks), which saves a
+	GetStatFor() call per entry. If the stat data of an entry could not be
+	read (e.g. because the entry has been removed in the meantime), its
+	\c st_ino field is set to -1.
+	\param buf a pointer to a buffer to be filled with dirent structures of
+		   the found entries
+	\param bufSize the size of \a buf
+	\param stats an array of at least \a count stat structures to be filled
+		   in
+	\param count the maximal number of entries to be returned.
+	\note The iterator used by this method is the same one used by
+		  GetNextEntry(), GetNextRef(), GetNextDirents(), Rewind() and
+		  CountEntries().
+	\return
+	- The number of dirent structures stored in the buffer, 0 when there are
+	  no more entries to be returned.
+	- \c B_BAD_VALUE: \c NULL \a buf or \a stats.
+	- \c B_NO_MEMORY: Insufficient memory for operation.
+	- \c B_FILE_ERROR: A general file error.
+	\see GetNextDirents()
+*/
+int32
+BDirectory::GetNextDirentsWithStat(dirent* buf, size_t bufSize,
+	struct stat* stats, int32 count)
+{
+	if (buf == NULL || stats == NULL || count < 0)
+		return B_BAD_VALUE;
+	if (InitCheck() != B_OK)
+		return B_FILE_ERROR;
+	return _kern_read_dir_stat(fDirFd, buf, bufSize, count, stats,
+		sizeof(struct stat));
+}
+
+
 /*!	\brief Rewinds the directory iterator.
 	\return
 	- \c B_OK: Everything went fine.
@@ -694,12 +731,21 @@ BDirectory::CountEntries()
 	if (error != B_OK)
 		return error;
 	int32 count = 0;
-	BPrivate::Storage::LongDirEntry entry;
+	BPrivate::Storage::LongDirEntry buffer[16];
 	while (error == B_OK) {
-		if (GetNextDirents(&entry, sizeof(entry), 1) != 1)
+		// read as many entries at once as fit into the buffer
+		int32 read = GetNextDirents(buffer, sizeof(buffer));
+		if (read <= 0)
 			break;
-		if (strcmp(entry.d_name, ".") != 0 && strcmp(entry.d_name, "..") != 0)
-			count++;
+
+		dirent* entry = buffer;
+		for (int32 i = 0; i < read; i++) {
+			if (strcmp(entry->d_name, ".") != 0
+				&& strcmp(entry->d_name, "..") != 0) {
+				count++;
+			}
+			entry = (dirent*)((uint8*)entry + entry->d_reclen);
+		}
 	}
 	Rewind();
 	return (error == B_OK ? count : error);
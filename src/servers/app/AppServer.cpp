@@ -91,6 +91,8 @@ detect_simd()
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
@@ -98,7 +100,11 @@ detect_simd()
 		appServerSIMD &= cpuSIMD;
 	}
 	gAppServerSIMDFlags = appServerSIMD;
-#endif	// __INTEL__
+#elif defined(__x86_64__)
+	// SSE2 is part of the x86_64 baseline. The MMX and SSE flags are left
+	// out, as the code using them is only built for x86.
+	gAppServerSIMDFlags = APPSERVER_SIMD_SSE2;
+#endif
 }
 
 
@@ -61,5 +61,6 @@ extern uint32 gAppServerSIMDFlags;
 // Defines for SIMD support. Early implementation, subject to change
 #define APPSERVER_SIMD_MMX	(1 << 0)
 #define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
 
 #endif	/* APP_SERVER_H */
@@ -1365,11 +1365,17 @@ Desktop::MoveWindowBy(Window* window, float x, float y, int32 workspace)
 		direct = true;
 	}
 
+	bool retain = _PrepareRetainedContents();
+
 	window->MoveBy((int32)x, (int32)y);
 
 	BRegion background;
 	_RebuildClippingForAllWindows(background);
 
+	// save what the window now covers before it is copied over
+	if (retain)
+		_RetainHiddenContents();
+
 	// construct the region that is possible to be blitted
 	// to move the contents of the window
 	BRegion copyRegion(window->VisibleRegion());
@@ -1393,6 +1399,13 @@ Desktop::MoveWindowBy(Window* window, float x, float y, int32 workspace)
 	copyRegion.OffsetBy((int32)x, (int32)y);
 	newDirtyRegion.Exclude(&copyRegion);
 
+	// and the parts that could be restored from the retained contents
+	if (retain) {
+		BRegion restored;
+		_RestoreExposedContents(restored);
+		newDirtyRegion.Exclude(&restored);
+	}
+
 	MarkDirty(newDirtyRegion);
 	_SetBackground(background);
 	_WindowChanged(window);
@@ -2043,6 +2056,19 @@ Desktop::RedrawBackground()
 }
 
 
+/*!	Frees the retained contents of all windows. The window lock must be
+	held.
+*/
+void
+Desktop::DiscardRetainedContents()
+{
+	for (Window* window = fAllWindows.FirstWindow(); window != NULL;
+			window = window->NextWindow(kAllWindowList)) {
+		window->DiscardRetainedContents();
+	}
+}
+
+
 bool
 Desktop::ReloadDecor()
 {
@@ -3004,6 +3030,8 @@ Desktop::_BringWindowsToFront(WindowList& windows, int32 list,
 	// visible of the window
 	BRegion clean;
 
+	bool retain = _PrepareRetainedContents();
+
 	for (Window* window = windows.FirstWindow(); window != NULL;
 			window = window->NextWindow(list)) {
 		if (wereVisible)
@@ -3019,6 +3047,11 @@ Desktop::_BringWindowsToFront(WindowList& windows, int32 list,
 	BRegion dummy;
 	_RebuildClippingForAllWindows(dummy);
 
+	if (retain) {
+		_RetainHiddenContents();
+		_RestoreExposedContents(clean);
+	}
+
 	// redraw what became visible of the window(s)
 
 	BRegion dirty;
@@ -3137,6 +3170,69 @@ Desktop::_RebuildClippingForAllWindows(BRegion& stillAvailableOnScreen)
 }
 
 
+/*!	Remembers the visible region of all windows before the clipping is
+	rebuilt, so that the parts that get hidden by the change can be retained
+	afterwards.
+	Returns \c false if the window contents are not retained.
+*/
+bool
+Desktop::_PrepareRetainedContents()
+{
+	DesktopSettings settings(this);
+	if (!settings.RetainWindowContents())
+		return false;
+
+	for (Window* window = CurrentWindows().FirstWindow(); window != NULL;
+			window = window->NextWindow(fCurrentWorkspace)) {
+		if (!window->IsHidden())
+			window->PrepareRetainedContents();
+	}
+
+	return true;
+}
+
+
+/*!	Saves the parts of the windows that got hidden when the clipping was
+	rebuilt. Must be called before anything is drawn with the new clipping.
+*/
+void
+Desktop::_RetainHiddenContents()
+{
+	// NOTE: Having all windows locked should prevent any
+	// problems with locking the drawing engine here.
+	if (!GetDrawingEngine()->LockParallelAccess())
+		return;
+
+	for (Window* window = CurrentWindows().FirstWindow(); window != NULL;
+			window = window->NextWindow(fCurrentWorkspace)) {
+		window->RetainHiddenContents(GetDrawingEngine());
+	}
+
+	GetDrawingEngine()->UnlockParallelAccess();
+}
+
+
+/*!	Puts the retained contents back on screen where windows have been
+	exposed, and adds those parts to the \a restoredRegion, they don't
+	need to be redrawn.
+*/
+void
+Desktop::_RestoreExposedContents(BRegion& restoredRegion)
+{
+	DrawingEngine* engine = GetDrawingEngine();
+	if (!engine->LockParallelAccess())
+		engine = NULL;
+
+	for (Window* window = CurrentWindows().FirstWindow(); window != NULL;
+			window = window->NextWindow(fCurrentWorkspace)) {
+		window->RestoreExposedContents(engine, restoredRegion);
+	}
+
+	if (engine != NULL)
+		engine->UnlockParallelAccess();
+}
+
+
 void
 Desktop::_TriggerWindowRedrawing(BRegion& newDirtyRegion)
 {
@@ -223,6 +223,8 @@ public:
 
 			bool				ReloadDecor();
 
+			void				DiscardRetainedContents();
+
 			BRegion&			BackgroundRegion()
 									{ return fBackgroundRegion; }
 
@@ -282,6 +284,10 @@ private:
 			Screen*				_DetermineScreenFor(BRect frame);
 			void				_RebuildClippingForAllWindows(
 									BRegion& stillAvailableOnScreen);
+			bool				_PrepareRetainedContents();
+			void				_RetainHiddenContents();
+			void				_RestoreExposedContents(
+									BRegion& restoredRegion);
 			void				_TriggerWindowRedrawing(
 									BRegion& newDirtyRegion);
 			void				_SetBackground(BRegion& background);
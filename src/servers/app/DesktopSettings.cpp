@@ -54,6 +54,7 @@ DesktopSettingsPrivate::_SetDefaults()
 	fFocusFollowsMouseMode = B_NORMAL_FOCUS_FOLLOWS_MOUSE;
 	fAcceptFirstClick = false;
 	fShowAllDraggers = true;
+	fRetainWindowContents = false;
 
 	// init scrollbar info
 	fScrollBarInfo.proportional = true;
@@ -271,6 +272,12 @@ DesktopSettingsPrivate::_Load()
 				gSubpixelOrderingRGB = subpixelOrdering;
 			}
 
+			bool retainWindowContents;
+			if (settings.FindBool("retain window contents",
+					&retainWindowContents) == B_OK) {
+				fRetainWindowContents = retainWindowContents;
+			}
+
 			for (int32 i = 0; i < kNumColors; i++) {
 				char colorName[12];
 				snprintf(colorName, sizeof(colorName), "color%ld",
@@ -410,6 +417,7 @@ DesktopSettingsPrivate::Save(uint32 mask)
 			settings.AddBool("subpixel antialiasing", gSubpixelAntialiasing);
 			settings.AddInt8("subpixel average weight", gSubpixelAverageWeight);
 			settings.AddBool("subpixel ordering", gSubpixelOrderingRGB);
+			settings.AddBool("retain window contents", fRetainWindowContents);
 
 			for (int32 i = 0; i < kNumColors; i++) {
 				char colorName[12];
@@ -714,6 +722,21 @@ DesktopSettingsPrivate::IsSubpixelOrderingRegular() const
 }
 
 
+void
+DesktopSettingsPrivate::SetRetainWindowContents(bool retain)
+{
+	fRetainWindowContents = retain;
+	Save(kAppearanceSettings);
+}
+
+
+bool
+DesktopSettingsPrivate::RetainWindowContents() const
+{
+	return fRetainWindowContents;
+}
+
+
 void
 DesktopSettingsPrivate::_ValidateWorkspacesLayout(int32& columns,
 	int32& rows) const
@@ -875,6 +898,13 @@ DesktopSettings::IsSubpixelOrderingRegular() const
 	return fSettings->IsSubpixelOrderingRegular();
 }
 
+
+bool
+DesktopSettings::RetainWindowContents() const
+{
+	return fSettings->RetainWindowContents();
+}
+
 //	#pragma mark - write access
 
 
@@ -995,3 +1025,12 @@ LockedDesktopSettings::SetSubpixelOrderingRegular(bool subpixelOrdering)
 	fSettings->SetSubpixelOrderingRegular(subpixelOrdering);
 }
 
+
+void
+LockedDesktopSettings::SetRetainWindowContents(bool retain)
+{
+	fSettings->SetRetainWindowContents(retain);
+	if (!retain)
+		fDesktop->DiscardRetainedContents();
+}
+
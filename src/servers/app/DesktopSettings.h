@@ -62,6 +62,8 @@ class DesktopSettings {
 		uint8			SubpixelAverageWeight() const;
 		bool			IsSubpixelOrderingRegular() const;
 
+		bool			RetainWindowContents() const;
+
 	protected:
 		DesktopSettingsPrivate*	fSettings;
 };
@@ -92,6 +94,8 @@ class LockedDesktopSettings : public DesktopSettings {
 		void			SetSubpixelAverageWeight(uint8 averageWeight);
 		void			SetSubpixelOrderingRegular(bool subpixelOrdering);
 
+		void			SetRetainWindowContents(bool retain);
+
 	private:
 		Desktop*		fDesktop;
 };
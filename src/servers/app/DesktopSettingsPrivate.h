@@ -78,6 +78,9 @@ public:
 									bool subpixelOrdering);
 			bool				IsSubpixelOrderingRegular() const;
 
+			void				SetRetainWindowContents(bool retain);
+			bool				RetainWindowContents() const;
+
 private:
 			void				_SetDefaults();
 			status_t			_Load();
@@ -95,6 +98,7 @@ private:
 			mode_focus_follows_mouse	fFocusFollowsMouseMode;
 			bool				fAcceptFirstClick;
 			bool				fShowAllDraggers;
+			bool				fRetainWindowContents;
 			int32				fWorkspacesColumns;
 			int32				fWorkspacesRows;
 			BMessage			fWorkspaceMessages[kMaxWorkspaces];
@@ -21,6 +21,10 @@
 using std::nothrow;
 
 
+static const int32 kMaxEntryCount = 30;
+static const size_t kMaxMemoryUsage = 16 * 1024 * 1024;
+
+
 FontCache
 FontCache::sDefaultInstance;
 
@@ -107,11 +111,16 @@ FontCache::Recycle(FontCacheEntry* entry)
 	if (!entry)
 		return;
 	entry->UpdateUsage();
+
+	if (FontCacheEntry::TotalMemoryUsage() > kMaxMemoryUsage) {
+		AutoWriteLocker locker(this);
+		if (locker.IsLocked())
+			_ConstrainMemoryUsage(entry);
+	}
+
 	entry->ReleaseReference();
 }
 
-static const int32 kMaxEntryCount = 30;
-
 static inline double
 usage_index(uint64 useCount, bigtime_t age)
 {
@@ -150,11 +159,53 @@ FontCache::_ConstrainEntryCount()
 		}
 	}
 
-	iterator = fFontCacheEntries.GetIterator();
+	_RemoveEntry(leastUsedEntry);
+}
+
+// _ConstrainMemoryUsage
+void
+FontCache::_ConstrainMemoryUsage(FontCacheEntry* recycledEntry)
+{
+	// this function is only ever called with the WriteLock held
+
+	// NOTE: the entries are not locked, so their memory usage might still
+	// grow while we look at it, but it doesn't need to be exact
+	while (true) {
+		FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
+		FontCacheEntry* leastRecentlyUsedEntry = NULL;
+		size_t memoryUsage = 0;
+
+		while (iterator.HasNext()) {
+			FontCacheEntry* entry = iterator.Next().value;
+			memoryUsage += entry->MemoryUsage();
+
+			// Entries that are being recycled or still in use would only be
+			// built again right away. They may exceed the limit on their own.
+			if (entry == recycledEntry || entry->CountReferences() > 1)
+				continue;
+
+			if (leastRecentlyUsedEntry == NULL
+				|| entry->LastUsed() < leastRecentlyUsedEntry->LastUsed()) {
+				leastRecentlyUsedEntry = entry;
+			}
+		}
+
+		if (memoryUsage <= kMaxMemoryUsage || leastRecentlyUsedEntry == NULL)
+			return;
+
+		_RemoveEntry(leastRecentlyUsedEntry);
+	}
+}
+
+// _RemoveEntry
+void
+FontCache::_RemoveEntry(FontCacheEntry* entry)
+{
+	FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
 	while (iterator.HasNext()) {
-		if (iterator.Next().value == leastUsedEntry) {
+		if (iterator.Next().value == entry) {
 			iterator.Remove();
-			leastUsedEntry->ReleaseReference();
+			entry->ReleaseReference();
 			break;
 		}
 	}
@@ -29,6 +29,9 @@ class FontCache : public MultiLocker {
 
  private:
 			void				_ConstrainEntryCount();
+			void				_ConstrainMemoryUsage(
+									FontCacheEntry* recycledEntry);
+			void				_RemoveEntry(FontCacheEntry* entry);
 
 	static	FontCache			sDefaultInstance;
 
@@ -26,6 +26,7 @@
 
 #include "FontCacheEntry.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <new>
@@ -40,6 +41,11 @@
 
 
 BLocker FontCacheEntry::sUsageUpdateLock("FontCacheEntry usage lock");
+vint32 FontCacheEntry::sTotalMemoryUsage = 0;
+
+// The glyphs are allocated from pages of this size, so that the glyphs of a
+// string lie close together in memory, and a font can be freed at once.
+static const size_t kAtlasPageSize = 32 * 1024;
 
 
 class FontCacheEntry::GlyphCachePool {
@@ -69,19 +75,39 @@ class FontCacheEntry::GlyphCachePool {
 			return value->hash_link;
 		}
 	};
+
+	struct AtlasPage {
+		AtlasPage*	next;
+		size_t		size;
+		size_t		used;
+		size_t		reserved;
+			// keeps the data 8 byte aligned
+
+		uint8* Data()
+		{
+			return (uint8*)(this + 1);
+		}
+	};
 public:
 	GlyphCachePool()
+		:
+		fPages(NULL),
+		fMemoryUsage(0)
 	{
 	}
 
 	~GlyphCachePool()
 	{
-		GlyphCache* glyph = fGlyphTable.Clear(true);
-		while (glyph != NULL) {
-			GlyphCache* next = glyph->hash_link;
-			delete glyph;
-			glyph = next;
+		// The glyphs live in the pages, and don't need to be destructed.
+		fGlyphTable.Clear();
+
+		while (fPages != NULL) {
+			AtlasPage* next = fPages->next;
+			free(fPages);
+			fPages = next;
 		}
+
+		atomic_add(&FontCacheEntry::sTotalMemoryUsage, -(int32)fMemoryUsage);
 	}
 
 	status_t Init()
@@ -102,25 +128,68 @@ public:
 		if (glyph != NULL)
 			return NULL;
 
-		glyph = new(std::nothrow) GlyphCache(glyphIndex, dataSize, dataType,
-			bounds, advanceX, advanceY, insetLeft, insetRight);
-		if (glyph == NULL || glyph->data == NULL) {
-			delete glyph;
+		uint8* buffer = Allocate(sizeof(GlyphCache) + dataSize);
+		if (buffer == NULL)
 			return NULL;
-		}
 
-		// TODO: The HashTable grows without bounds. We should cleanup
-		// older entries from time to time.
+		glyph = new(buffer) GlyphCache(glyphIndex, buffer + sizeof(GlyphCache),
+			dataSize, dataType, bounds, advanceX, advanceY, insetLeft,
+			insetRight);
 
 		fGlyphTable.Insert(glyph);
 
 		return glyph;
 	}
 
+	uint8* Allocate(size_t size)
+	{
+		// keep the glyphs and their coverage runs aligned
+		size = (size + 7) & ~(size_t)7;
+
+		if (fPages != NULL && fPages->size - fPages->used >= size) {
+			uint8* buffer = fPages->Data() + fPages->used;
+			fPages->used += size;
+			return buffer;
+		}
+
+		// Large glyphs get a page of their own, which is put behind the
+		// current one, so that its remaining space can still be used.
+		size_t pageSize = kAtlasPageSize;
+		if (size > kAtlasPageSize / 4)
+			pageSize = size;
+
+		AtlasPage* page = (AtlasPage*)malloc(sizeof(AtlasPage) + pageSize);
+		if (page == NULL)
+			return NULL;
+
+		page->size = pageSize;
+		page->used = size;
+		if (pageSize == size && fPages != NULL) {
+			page->next = fPages->next;
+			fPages->next = page;
+		} else {
+			page->next = fPages;
+			fPages = page;
+		}
+
+		fMemoryUsage += sizeof(AtlasPage) + pageSize;
+		atomic_add(&FontCacheEntry::sTotalMemoryUsage,
+			sizeof(AtlasPage) + pageSize);
+
+		return page->Data();
+	}
+
+	size_t MemoryUsage() const
+	{
+		return fMemoryUsage;
+	}
+
 private:
 	typedef BOpenHashTable<GlyphHashTableDefinition> GlyphTable;
 
 	GlyphTable	fGlyphTable;
+	AtlasPage*	fPages;
+	size_t		fMemoryUsage;
 };
 
 
@@ -312,8 +381,10 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 			engine->AdvanceX(), engine->AdvanceY(),
 			engine->InsetLeft(), engine->InsetRight());
 
-		if (glyph != NULL)
+		if (glyph != NULL) {
 			engine->WriteGlyphTo(glyph->data);
+			_CreateCoverageRuns(glyph);
+		}
 	}
 
 	return glyph;
@@ -392,6 +463,13 @@ FontCacheEntry::UpdateUsage()
 }
 
 
+size_t
+FontCacheEntry::MemoryUsage() const
+{
+	return fGlyphCache->MemoryUsage();
+}
+
+
 /*static*/ glyph_rendering
 FontCacheEntry::_RenderTypeFor(const ServerFont& font)
 {
@@ -408,3 +486,69 @@ FontCacheEntry::_RenderTypeFor(const ServerFont& font)
 
 	return renderingType;
 }
+
+
+void
+FontCacheEntry::_CreateCoverageRuns(GlyphCache* glyph)
+{
+	// Decodes the scanlines of a bitmap glyph once, so that it can be blitted
+	// without going through the scanline adaptors and renderers every time.
+
+	if (glyph->data_type != glyph_data_gray8
+		&& glyph->data_type != glyph_data_subpix) {
+		return;
+	}
+
+	int32 coversPerPixel = glyph->data_type == glyph_data_subpix ? 3 : 1;
+
+	GlyphGray8Adapter adapter;
+	GlyphGray8Scanline scanline;
+
+	// count the runs and covers
+	uint32 runCount = 0;
+	uint32 coverCount = 0;
+	adapter.init(glyph->data, glyph->data_size, 0, 0);
+	if (!adapter.rewind_scanlines())
+		return;
+	while (adapter.sweep_scanline(scanline)) {
+		GlyphGray8Scanline::const_iterator span = scanline.begin();
+		for (unsigned i = scanline.num_spans(); i > 0; i--, span++) {
+			runCount++;
+			coverCount += abs(span->len);
+		}
+	}
+
+	if (runCount == 0)
+		return;
+
+	size_t runsSize = runCount * sizeof(GlyphCoverageRun);
+	uint8* buffer = fGlyphCache->Allocate(runsSize + coverCount);
+	if (buffer == NULL)
+		return;
+
+	GlyphCoverageRun* run = (GlyphCoverageRun*)buffer;
+	uint8* covers = buffer + runsSize;
+
+	glyph->runs = run;
+	glyph->run_count = runCount;
+	glyph->covers = covers;
+
+	adapter.init(glyph->data, glyph->data_size, 0, 0);
+	adapter.rewind_scanlines();
+	while (adapter.sweep_scanline(scanline)) {
+		GlyphGray8Scanline::const_iterator span = scanline.begin();
+		for (unsigned i = scanline.num_spans(); i > 0; i--, span++) {
+			int32 length = abs(span->len);
+			if (span->len < 0)
+				memset(covers, *span->covers, length);
+			else
+				memcpy(covers, span->covers, length);
+
+			run->x = span->x;
+			run->y = scanline.y();
+			run->length = length / coversPerPixel;
+			run++;
+			covers += length;
+		}
+	}
+}
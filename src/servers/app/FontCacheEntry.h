@@ -40,13 +40,23 @@
 #include "Transformable.h"
 
 
+// A horizontal run of coverage values of a bitmap glyph, relative to the
+// glyph origin. The covers of all runs of a glyph are stored one after the
+// other, with one value per pixel, or three for subpixel glyphs.
+struct GlyphCoverageRun {
+	int16			x;
+	int16			y;
+	uint16			length;
+		// in pixels
+};
+
 struct GlyphCache {
-	GlyphCache(uint32 glyphIndex, uint32 dataSize, glyph_data_type dataType,
-			const agg::rect_i& bounds, float advanceX, float advanceY,
-			float insetLeft, float insetRight)
+	GlyphCache(uint32 glyphIndex, uint8* data, uint32 dataSize,
+			glyph_data_type dataType, const agg::rect_i& bounds,
+			float advanceX, float advanceY, float insetLeft, float insetRight)
 		:
 		glyph_index(glyphIndex),
-		data((uint8*)malloc(dataSize)),
+		data(data),
 		data_size(dataSize),
 		data_type(dataType),
 		bounds(bounds),
@@ -54,15 +64,13 @@ struct GlyphCache {
 		advance_y(advanceY),
 		inset_left(insetLeft),
 		inset_right(insetRight),
+		runs(NULL),
+		run_count(0),
+		covers(NULL),
 		hash_link(NULL)
 	{
 	}
 
-	~GlyphCache()
-	{
-		free(data);
-	}
-
 	uint32			glyph_index;
 	uint8*			data;
 	uint32			data_size;
@@ -73,6 +81,12 @@ struct GlyphCache {
 	float			inset_left;
 	float			inset_right;
 
+	// The scanlines of gray8 and subpixel glyphs, already decoded for
+	// blitting them directly. NULL for other glyphs.
+	const GlyphCoverageRun* runs;
+	uint32			run_count;
+	const uint8*	covers;
+
 	GlyphCache*		hash_link;
 };
 
@@ -124,6 +138,9 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 
 	// private to FontCache class:
 			void				UpdateUsage();
+			size_t				MemoryUsage() const;
+	static	size_t				TotalMemoryUsage()
+									{ return sTotalMemoryUsage; }
 			bigtime_t			LastUsed() const
 									{ return fLastUsedTime; }
 			uint64				UsedCount() const
@@ -134,6 +151,7 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 			const FontCacheEntry& operator=(const FontCacheEntry&);
 
 	static	glyph_rendering		_RenderTypeFor(const ServerFont& font);
+			void				_CreateCoverageRuns(GlyphCache* glyph);
 
 			class GlyphCachePool;
 
@@ -143,6 +161,9 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 	static	BLocker				sUsageUpdateLock;
 			bigtime_t			fLastUsedTime;
 			uint64				fUseCounter;
+
+	friend class GlyphCachePool;
+	static	vint32				sTotalMemoryUsage;
 };
 
 #endif // FONT_CACHE_ENTRY_H
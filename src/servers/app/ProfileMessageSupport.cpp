@@ -194,6 +194,14 @@ string_for_message_code(uint32 code, BString& string)
 		CODE(AS_SET_SUBPIXEL_ORDERING);
 		CODE(AS_GET_SUBPIXEL_ORDERING);
 
+		// Parallel rendering
+		CODE(AS_SET_RENDER_THREAD_COUNT);
+		CODE(AS_GET_RENDER_THREAD_COUNT);
+
+		// Retained window contents
+		CODE(AS_SET_RETAIN_WINDOW_CONTENTS);
+		CODE(AS_GET_RETAIN_WINDOW_CONTENTS);
+
 		// Graphics calls
 		CODE(AS_SET_HIGH_COLOR);
 		CODE(AS_SET_LOW_COLOR);
@@ -233,6 +241,7 @@ string_for_message_code(uint32 code, BString& string)
 		CODE(AS_DRAW_STRING_WITH_DELTA);
 
 		CODE(AS_SYNC);
+		CODE(AS_SYNC_WITH_SEMAPHORE);
 
 		CODE(AS_VIEW_CREATE);
 		CODE(AS_VIEW_DELETE);
@@ -54,6 +54,7 @@
 #include "HWInterface.h"
 #include "InputManager.h"
 #include "OffscreenServerWindow.h"
+#include "RenderThreadPool.h"
 #include "Screen.h"
 #include "ServerBitmap.h"
 #include "ServerConfig.h"
@@ -3104,6 +3105,49 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_SET_RENDER_THREAD_COUNT:
+		{
+			int32 count;
+			if (link.Read<int32>(&count) == B_OK)
+				RenderThreadPool::Default().SetThreadCount(count);
+			break;
+		}
+
+		case AS_GET_RENDER_THREAD_COUNT:
+		{
+			fLink.StartMessage(B_OK);
+			fLink.Attach<int32>(RenderThreadPool::Default().ThreadCount());
+			fLink.Flush();
+			break;
+		}
+
+		case AS_SET_RETAIN_WINDOW_CONTENTS:
+		{
+			bool retain;
+			if (link.Read<bool>(&retain) == B_OK) {
+				LockedDesktopSettings settings(fDesktop);
+				if (retain != settings.RetainWindowContents())
+					settings.SetRetainWindowContents(retain);
+			}
+			break;
+		}
+
+		case AS_GET_RETAIN_WINDOW_CONTENTS:
+		{
+			if (fDesktop->LockSingleWindow()) {
+				DesktopSettings settings(fDesktop);
+
+				fLink.StartMessage(B_OK);
+				fLink.Attach<bool>(settings.RetainWindowContents());
+
+				fDesktop->UnlockSingleWindow();
+			} else
+				fLink.StartMessage(B_ERROR);
+
+			fLink.Flush();
+			break;
+		}
+
 		default:
 			printf("ServerApp %s received unhandled message code %ld\n",
 				Signature(), code);
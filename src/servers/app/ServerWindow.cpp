@@ -170,6 +170,8 @@ ServerWindow::ServerWindow(const char* title, ServerApp* app,
 	fCurrentDrawingRegion(),
 	fCurrentDrawingRegionValid(false),
 
+	fLockedDrawingEngine(NULL),
+
 	fDirectWindowInfo(NULL),
 	fIsDirectlyAccessing(false)
 {
@@ -1035,6 +1037,19 @@ ServerWindow::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			fLink.Flush();
 			break;
 
+		case AS_SYNC_WITH_SEMAPHORE:
+		{
+			DTRACE(("ServerWindow %s: Message AS_SYNC_WITH_SEMAPHORE\n",
+				Title()));
+			// Like AS_SYNC, but the client doesn't wait for a reply; it is
+			// told by the semaphore once all drawing commands before this
+			// one have been carried out.
+			sem_id semaphore;
+			if (link.Read<sem_id>(&semaphore) == B_OK)
+				release_sem_etc(semaphore, 1, B_DO_NOT_RESCHEDULE);
+			break;
+		}
+
 		case AS_BEGIN_UPDATE:
 			DTRACE(("ServerWindow %s: Message AS_BEGIN_UPDATE\n", Title()));
 			fWindow->BeginUpdate(fLink);
@@ -2140,46 +2155,64 @@ void
 ServerWindow::_DispatchViewDrawingMessage(int32 code,
 	BPrivate::LinkReceiver &link)
 {
-	if (!fCurrentView->IsVisible() || !fWindow->IsVisible()) {
-		if (link.NeedsReply()) {
-			debug_printf("ServerWindow::DispatchViewDrawingMessage() got "
-				"message %ld that needs a reply!\n", code);
-			// the client is now blocking and waiting for a reply!
-			fLink.StartMessage(B_ERROR);
-			fLink.Flush();
+	DrawingEngine* drawingEngine = fLockedDrawingEngine;
+	if (drawingEngine != NULL) {
+		// The engine is still set up from the previous drawing message
+		// of the view, nothing could have changed in between.
+		// See _MessageContinuesDrawing().
+	} else {
+		if (fWindow->HasRetainedContents()) {
+			// the hidden parts of the view are not up to date anymore
+			IntRect frame = fCurrentView->Bounds();
+			fCurrentView->ConvertToScreen(&frame);
+			fWindow->DiscardRetainedContents(BRegion((BRect)frame));
 		}
-		return;
-	}
 
-	DrawingEngine* drawingEngine = fWindow->GetDrawingEngine();
-	if (!drawingEngine) {
-		// ?!?
-		debug_printf("ServerWindow %s: no drawing engine!!\n", Title());
-		if (link.NeedsReply()) {
-			// the client is now blocking and waiting for a reply!
-			fLink.StartMessage(B_ERROR);
-			fLink.Flush();
+		if (!fCurrentView->IsVisible() || !fWindow->IsVisible()) {
+			if (link.NeedsReply()) {
+				debug_printf("ServerWindow::DispatchViewDrawingMessage() got "
+					"message %ld that needs a reply!\n", code);
+				// the client is now blocking and waiting for a reply!
+				fLink.StartMessage(B_ERROR);
+				fLink.Flush();
+			}
+			return;
 		}
-		return;
-	}
 
-	_UpdateCurrentDrawingRegion();
-	if (fCurrentDrawingRegion.CountRects() <= 0) {
-		DTRACE(("ServerWindow %s: _DispatchViewDrawingMessage(): View: %s, "
-			"INVALID CLIPPING!\n", Title(), fCurrentView->Name()));
-		if (link.NeedsReply()) {
-			// the client is now blocking and waiting for a reply!
-			fLink.StartMessage(B_ERROR);
-			fLink.Flush();
+		drawingEngine = fWindow->GetDrawingEngine();
+		if (!drawingEngine) {
+			// ?!?
+			debug_printf("ServerWindow %s: no drawing engine!!\n", Title());
+			if (link.NeedsReply()) {
+				// the client is now blocking and waiting for a reply!
+				fLink.StartMessage(B_ERROR);
+				fLink.Flush();
+			}
+			return;
 		}
-		return;
-	}
 
-	drawingEngine->LockParallelAccess();
-	// NOTE: the region is not copied, Painter keeps a pointer,
-	// that's why you need to use the clipping only for as long
-	// as you have it locked
-	drawingEngine->ConstrainClippingRegion(&fCurrentDrawingRegion);
+		_UpdateCurrentDrawingRegion();
+		if (fCurrentDrawingRegion.CountRects() <= 0) {
+			DTRACE(("ServerWindow %s: _DispatchViewDrawingMessage(): View: "
+				"%s, INVALID CLIPPING!\n", Title(), fCurrentView->Name()));
+			if (link.NeedsReply()) {
+				// the client is now blocking and waiting for a reply!
+				fLink.StartMessage(B_ERROR);
+				fLink.Flush();
+			}
+			return;
+		}
+
+		// The engine stays locked until a message arrives that is not
+		// a drawing message, see _EndDrawing().
+		drawingEngine->LockParallelAccess();
+		drawingEngine->SuspendAutoSync();
+		// NOTE: the region is not copied, Painter keeps a pointer,
+		// that's why you need to use the clipping only for as long
+		// as you have it locked
+		drawingEngine->ConstrainClippingRegion(&fCurrentDrawingRegion);
+		fLockedDrawingEngine = drawingEngine;
+	}
 
 	switch (code) {
 		case AS_STROKE_LINE:
@@ -2845,7 +2878,8 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 			break;
 	}
 
-	drawingEngine->UnlockParallelAccess();
+	if (!_MessageContinuesDrawing(code))
+		_EndDrawing();
 }
 
 
@@ -3400,6 +3434,9 @@ ServerWindow::_MessageLooper()
 		bool lockedDesktopSingleWindow = false;
 
 		while (true) {
+			if (!_MessageContinuesDrawing(code))
+				_EndDrawing();
+
 			if (code == AS_DELETE_WINDOW || code == kMsgQuitLooper) {
 				// this means the client has been killed
 				DTRACE(("ServerWindow %s received 'AS_DELETE_WINDOW' message "
@@ -3442,6 +3479,7 @@ ServerWindow::_MessageLooper()
 			}
 
 			if (atomic_and(&fRedrawRequested, 0) != 0) {
+				_EndDrawing();
 #ifdef PROFILE_MESSAGE_LOOP
 				bigtime_t redrawStart = system_time();
 #endif
@@ -3485,6 +3523,7 @@ ServerWindow::_MessageLooper()
 			// Desktop locked), but don't hold the lock longer than 10 ms
 			if (!receiver.HasMessages() || ++messagesProcessed > 70
 				|| system_time() - processingStart > 10000) {
+				_EndDrawing();
 				if (lockedDesktopSingleWindow)
 					fDesktop->UnlockSingleWindow();
 				break;
@@ -3495,6 +3534,7 @@ ServerWindow::_MessageLooper()
 			if (status != B_OK) {
 				// that shouldn't happen, it's our port
 				printf("Someone deleted our message port!\n");
+				_EndDrawing();
 				if (lockedDesktopSingleWindow)
 					fDesktop->UnlockSingleWindow();
 
@@ -3675,6 +3715,80 @@ ServerWindow::_MessageNeedsAllWindowsLocked(uint32 code) const
 }
 
 
+/*!	Returns whether the drawing engine may stay locked and set up for the
+	current view when the message with the given \a code is processed next.
+	This is true for the drawing messages, and for the view state changes that
+	only affect how they draw; each of them would otherwise have to lock the
+	engine, and set its clipping again.
+*/
+bool
+ServerWindow::_MessageContinuesDrawing(uint32 code) const
+{
+	switch (code) {
+		case AS_STROKE_LINE:
+		case AS_VIEW_INVERT_RECT:
+		case AS_STROKE_RECT:
+		case AS_FILL_RECT:
+		case AS_FILL_RECT_GRADIENT:
+		case AS_VIEW_DRAW_BITMAP:
+		case AS_STROKE_ARC:
+		case AS_FILL_ARC:
+		case AS_FILL_ARC_GRADIENT:
+		case AS_STROKE_BEZIER:
+		case AS_FILL_BEZIER:
+		case AS_FILL_BEZIER_GRADIENT:
+		case AS_STROKE_ELLIPSE:
+		case AS_FILL_ELLIPSE:
+		case AS_FILL_ELLIPSE_GRADIENT:
+		case AS_STROKE_ROUNDRECT:
+		case AS_FILL_ROUNDRECT:
+		case AS_FILL_ROUNDRECT_GRADIENT:
+		case AS_STROKE_TRIANGLE:
+		case AS_FILL_TRIANGLE:
+		case AS_FILL_TRIANGLE_GRADIENT:
+		case AS_STROKE_POLYGON:
+		case AS_FILL_POLYGON:
+		case AS_FILL_POLYGON_GRADIENT:
+		case AS_STROKE_SHAPE:
+		case AS_FILL_SHAPE:
+		case AS_FILL_SHAPE_GRADIENT:
+		case AS_FILL_REGION:
+		case AS_FILL_REGION_GRADIENT:
+		case AS_STROKE_LINEARRAY:
+		case AS_DRAW_STRING:
+		case AS_DRAW_STRING_WITH_DELTA:
+		case AS_DRAW_STRING_WITH_OFFSETS:
+
+		case AS_VIEW_SET_HIGH_COLOR:
+		case AS_VIEW_SET_LOW_COLOR:
+		case AS_VIEW_SET_PEN_SIZE:
+		case AS_VIEW_SET_PEN_LOC:
+		case AS_VIEW_SET_DRAWING_MODE:
+		case AS_VIEW_SET_BLENDING_MODE:
+		case AS_VIEW_SET_PATTERN:
+		case AS_VIEW_SET_LINE_MODE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+/*!	Unlocks the drawing engine if it has been left locked by the last drawing
+	message.
+*/
+void
+ServerWindow::_EndDrawing()
+{
+	if (fLockedDrawingEngine == NULL)
+		return;
+
+	fLockedDrawingEngine->Sync();
+	fLockedDrawingEngine->UnlockParallelAccess();
+	fLockedDrawingEngine = NULL;
+}
+
+
 void
 ServerWindow::_ResizeToFullScreen()
 {
@@ -37,6 +37,7 @@ class BMessage;
 class Desktop;
 class ServerApp;
 class Decorator;
+class DrawingEngine;
 class Window;
 class Workspace;
 class View;
@@ -146,6 +147,9 @@ private:
 
 			bool				_MessageNeedsAllWindowsLocked(
 									uint32 code) const;
+			bool				_MessageContinuesDrawing(
+									uint32 code) const;
+			void				_EndDrawing();
 
 			// TODO: Move me elsewhere
 			status_t			PictureToRegion(ServerPicture *picture,
@@ -178,6 +182,8 @@ private:
 			BRegion				fCurrentDrawingRegion;
 			bool				fCurrentDrawingRegionValid;
 
+			DrawingEngine*		fLockedDrawingEngine;
+
 			DirectWindowInfo*	fDirectWindowInfo;
 			bool				fIsDirectlyAccessing;
 };
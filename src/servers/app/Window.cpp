@@ -20,6 +20,7 @@
 #include "Desktop.h"
 #include "DrawingEngine.h"
 #include "HWInterface.h"
+#include "MallocBuffer.h"
 #include "MessagePrivate.h"
 #include "PortLink.h"
 #include "ServerApp.h"
@@ -31,6 +32,7 @@
 #include <ViewPrivate.h>
 #include <WindowPrivate.h>
 
+#include <Autolock.h>
 #include <Debug.h>
 #include <DirectWindow.h>
 #include <PortLink.h>
@@ -90,6 +92,14 @@ Window::Window(const BRect& frame, const char *name,
 
 	fRegionPool(),
 
+	fRetainedBuffer(NULL),
+	fRetainedBufferFrame(),
+	fRetainedRegion(),
+	fRetainedLock("retained contents"),
+	fPreviousVisibleRegion(),
+	fPreviousPosition(),
+	fRetainPending(false),
+
 	fWindowBehaviour(NULL),
 	fDecorator(NULL),
 	fTopView(NULL),
@@ -172,6 +182,7 @@ Window::~Window()
 	delete fWindowBehaviour;
 	delete fDecorator;
 	delete fDrawingEngine;
+	delete fRetainedBuffer;
 
 	gDecorManager.CleanupForWindow(this);
 }
@@ -192,13 +203,45 @@ Window::SetClipping(BRegion* stillAvailableOnScreen)
 {
 	// this function is only called from the Desktop thread
 
-	// start from full region (as if the window was fully visible)
-	GetFullRegion(&fVisibleRegion);
-	// clip to region still available on screen
-	fVisibleRegion.IntersectWith(stillAvailableOnScreen);
+	BRegion* visibleRegion = fRegionPool.GetRegion();
+	if (visibleRegion != NULL) {
+		// start from full region (as if the window was fully visible)
+		GetFullRegion(visibleRegion);
+		// clip to region still available on screen
+		visibleRegion->IntersectWith(stillAvailableOnScreen);
+
+		bool unchanged = *visibleRegion == fVisibleRegion;
+		if (!unchanged)
+			fVisibleRegion = *visibleRegion;
+		fRegionPool.Recycle(visibleRegion);
+
+		if (unchanged) {
+			// The change that caused the clipping to be rebuilt did not
+			// affect this window (the usual case when another window moved),
+			// everything that was derived from its visible region is still
+			// valid.
+			return;
+		}
+	} else {
+		GetFullRegion(&fVisibleRegion);
+		fVisibleRegion.IntersectWith(stillAvailableOnScreen);
+	}
 
 	fVisibleContentRegionValid = false;
 	fEffectiveDrawingRegionValid = false;
+
+	// only hidden parts are retained, the visible ones will be redrawn
+	// (unless a move is pending, RestoreExposedContents() takes care of
+	// them then)
+	BAutolock _(fRetainedLock);
+	if (!fRetainPending && fRetainedRegion.CountRects() > 0) {
+		BRegion* visible = fRegionPool.GetRegion(fVisibleRegion);
+		if (visible != NULL) {
+			visible->OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+			fRetainedRegion.Exclude(visible);
+			fRegionPool.Recycle(visible);
+		}
+	}
 }
 
 
@@ -248,9 +291,10 @@ Window::VisibleContentRegion()
 	// the outside, the clipping needs to be readlocked!
 
 	// regions expected to be locked
-	if (!fVisibleContentRegionValid) {
+	if (!fVisibleContentRegionValid || !fContentRegionValid) {
 		GetContentRegion(&fVisibleContentRegion);
 		fVisibleContentRegion.IntersectWith(&fVisibleRegion);
+		fVisibleContentRegionValid = true;
 	}
 	return fVisibleContentRegion;
 }
@@ -288,6 +332,7 @@ Window::MoveBy(int32 x, int32 y)
 
 	if (fContentRegionValid)
 		fContentRegion.OffsetBy(x, y);
+	fVisibleContentRegionValid = false;
 
 	if (fCurrentUpdateSession->IsUsed())
 		fCurrentUpdateSession->MoveBy(x, y);
@@ -342,6 +387,9 @@ Window::ResizeBy(int32 x, int32 y, BRegion* dirtyRegion)
 	fFrame.right += x;
 	fFrame.bottom += y;
 
+	// the retained contents don't fit the new size anymore
+	DiscardRetainedContents();
+
 	fContentRegionValid = false;
 	fEffectiveDrawingRegionValid = false;
 
@@ -384,6 +432,15 @@ Window::ScrollViewBy(View* view, int32 dx, int32 dy)
 	if (!dirty)
 		return;
 
+	if (HasRetainedContents()) {
+		// the hidden parts of the view are scrolled, too
+		IntRect frame = view->Bounds();
+		view->ConvertToScreen(&frame);
+		dirty->Set((clipping_rect)frame);
+		DiscardRetainedContents(*dirty);
+		dirty->MakeEmpty();
+	}
+
 	view->ScrollBy(dx, dy, dirty);
 
 //fDrawingEngine->FillRegion(*dirty, (rgb_color){ 255, 0, 255, 255 });
@@ -403,6 +460,15 @@ void
 Window::CopyContents(BRegion* region, int32 xOffset, int32 yOffset)
 {
 	// executed in ServerWindow thread with the read lock held
+	if (HasRetainedContents()) {
+		BRegion* target = fRegionPool.GetRegion(*region);
+		if (target != NULL) {
+			target->OffsetBy(xOffset, yOffset);
+			DiscardRetainedContents(*target);
+			fRegionPool.Recycle(target);
+		}
+	}
+
 	if (!IsVisible())
 		return;
 
@@ -567,6 +633,7 @@ Window::ReloadDecor()
 
 	delete fDecorator;
 	fDecorator = decorator;
+	DiscardRetainedContents();
 
 	delete fWindowBehaviour;
 	fWindowBehaviour = windowBehaviour;
@@ -714,6 +781,7 @@ Window::MarkContentDirty(BRegion& regionOnScreen)
 	// since this won't affect other windows, read locking
 	// is sufficient. If there was no dirty region before,
 	// an update message is triggered
+	DiscardRetainedContents(regionOnScreen);
 	if (fHidden || IsOffscreenWindow())
 		return;
 
@@ -727,6 +795,7 @@ void
 Window::MarkContentDirtyAsync(BRegion& regionOnScreen)
 {
 	// NOTE: see comments in ProcessDirtyRegion()
+	DiscardRetainedContents(regionOnScreen);
 	if (fHidden || IsOffscreenWindow())
 		return;
 
@@ -744,6 +813,15 @@ Window::MarkContentDirtyAsync(BRegion& regionOnScreen)
 void
 Window::InvalidateView(View* view, BRegion& viewRegion)
 {
+	if (view != NULL && HasRetainedContents()) {
+		BRegion* regionOnScreen = fRegionPool.GetRegion(viewRegion);
+		if (regionOnScreen != NULL) {
+			view->ConvertToScreen(regionOnScreen);
+			DiscardRetainedContents(*regionOnScreen);
+			fRegionPool.Recycle(regionOnScreen);
+		}
+	}
+
 	if (view && IsVisible() && view->IsVisible()) {
 		if (!fContentRegionValid)
 			_UpdateContentRegion();
@@ -762,6 +840,170 @@ Window::InvalidateView(View* view, BRegion& viewRegion)
 	}
 }
 
+// #pragma mark - retained contents
+
+
+void
+Window::PrepareRetainedContents()
+{
+	// this function is only called from the desktop thread,
+	// before the clipping is rebuilt
+
+	fPreviousVisibleRegion = fVisibleRegion;
+	fPreviousPosition = fFrame.LeftTop();
+	fRetainPending = true;
+}
+
+
+void
+Window::RetainHiddenContents(DrawingEngine* engine)
+{
+	// this function is only called from the desktop thread, after the
+	// clipping has been rebuilt, but before anything is drawn with it:
+	// the parts that got hidden are still on screen at the previous
+	// position of the window
+
+	if (!fRetainPending || fHidden || fMinimized || IsOffscreenWindow()
+		|| fWindow->HasDirectFrameBufferAccess()) {
+		return;
+	}
+
+	int32 previousX = (int32)fPreviousPosition.x;
+	int32 previousY = (int32)fPreviousPosition.y;
+	int32 x = (int32)fFrame.left;
+	int32 y = (int32)fFrame.top;
+
+	BAutolock _(fRetainedLock);
+
+	BRegion* hidden = fRegionPool.GetRegion(fPreviousVisibleRegion);
+	BRegion* excluded = fRegionPool.GetRegion(fVisibleRegion);
+	if (hidden == NULL || excluded == NULL) {
+		if (hidden != NULL)
+			fRegionPool.Recycle(hidden);
+		if (excluded != NULL)
+			fRegionPool.Recycle(excluded);
+		return;
+	}
+
+	// never retain what is waiting to be redrawn
+	excluded->Include(&fDirtyRegion);
+	if (fPendingUpdateSession->IsUsed())
+		excluded->Include(&fPendingUpdateSession->DirtyRegion());
+	if (fCurrentUpdateSession->IsUsed())
+		excluded->Include(&fCurrentUpdateSession->DirtyRegion());
+
+	hidden->OffsetBy(-previousX, -previousY);
+	excluded->OffsetBy(-x, -y);
+	hidden->Exclude(excluded);
+
+	if (hidden->CountRects() > 0 && _AllocateRetainedBuffer() == B_OK) {
+		excluded->Set(fRetainedBufferFrame);
+		hidden->IntersectWith(excluded);
+		hidden->OffsetBy(previousX, previousY);
+
+		if (engine->ReadRegion(*hidden, fRetainedBuffer,
+				-previousX - (int32)fRetainedBufferFrame.left,
+				-previousY - (int32)fRetainedBufferFrame.top) == B_OK) {
+			hidden->OffsetBy(-previousX, -previousY);
+			fRetainedRegion.Include(hidden);
+		}
+	}
+
+	fRegionPool.Recycle(hidden);
+	fRegionPool.Recycle(excluded);
+}
+
+
+void
+Window::RestoreExposedContents(DrawingEngine* engine, BRegion& restoredRegion)
+{
+	// this function is only called from the desktop thread, after the
+	// contents that stayed visible have been copied to their new position;
+	// the parts that could be restored are added to the restoredRegion,
+	// and don't need to be redrawn (nothing is restored without an engine)
+
+	if (!fRetainPending)
+		return;
+
+	fRetainPending = false;
+	fPreviousVisibleRegion.MakeEmpty();
+
+	int32 x = (int32)fFrame.left;
+	int32 y = (int32)fFrame.top;
+
+	BAutolock _(fRetainedLock);
+
+	BRegion* visible = fRegionPool.GetRegion(fVisibleRegion);
+	if (visible == NULL) {
+		DiscardRetainedContents();
+		return;
+	}
+	visible->OffsetBy(-x, -y);
+
+	BRegion* exposed = engine != NULL
+		? fRegionPool.GetRegion(fRetainedRegion) : NULL;
+	if (exposed != NULL) {
+		exposed->IntersectWith(visible);
+		if (exposed->CountRects() > 0) {
+			exposed->OffsetBy(x, y);
+			if (engine->WriteRegion(*exposed, fRetainedBuffer,
+					-x - (int32)fRetainedBufferFrame.left,
+					-y - (int32)fRetainedBufferFrame.top) == B_OK) {
+				restoredRegion.Include(exposed);
+			}
+		}
+		fRegionPool.Recycle(exposed);
+	}
+
+	// only hidden parts are retained
+	fRetainedRegion.Exclude(visible);
+	fRegionPool.Recycle(visible);
+}
+
+
+void
+Window::DiscardRetainedContents()
+{
+	BAutolock _(fRetainedLock);
+
+	fRetainedRegion.MakeEmpty();
+
+	delete fRetainedBuffer;
+	fRetainedBuffer = NULL;
+}
+
+
+void
+Window::DiscardRetainedContents(const BRegion& regionOnScreen)
+{
+	// this is also executed in the ServerWindow thread, with the
+	// read lock held, whenever the client changes what's in the region
+
+	BAutolock _(fRetainedLock);
+
+	if (fRetainedRegion.CountRects() == 0)
+		return;
+
+	BRegion* region = fRegionPool.GetRegion(regionOnScreen);
+	if (region == NULL) {
+		fRetainedRegion.MakeEmpty();
+		return;
+	}
+
+	region->OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+	fRetainedRegion.Exclude(region);
+	fRegionPool.Recycle(region);
+}
+
+
+bool
+Window::HasRetainedContents() const
+{
+	BAutolock _(fRetainedLock);
+	return fRetainedRegion.CountRects() > 0;
+}
+
+
 // DisableUpdateRequests
 void
 Window::DisableUpdateRequests()
@@ -961,8 +1203,10 @@ Window::SetTitle(const char* name, BRegion& dirty)
 
 	fTitle = name;
 
-	if (fDecorator)
+	if (fDecorator) {
 		fDecorator->SetTitle(name, &dirty);
+		_DiscardRetainedBorder();
+	}
 }
 
 
@@ -984,8 +1228,10 @@ Window::SetFocus(bool focus)
 	}
 
 	fIsFocus = focus;
-	if (fDecorator)
+	if (fDecorator) {
 		fDecorator->SetFocus(focus);
+		_DiscardRetainedBorder();
+	}
 
 	Activated(focus);
 }
@@ -997,6 +1243,8 @@ Window::SetHidden(bool hidden)
 	// the desktop takes care of dirty regions
 	if (fHidden != hidden) {
 		fHidden = hidden;
+		if (hidden)
+			DiscardRetainedContents();
 
 		fTopView->SetHidden(hidden);
 
@@ -1012,6 +1260,8 @@ Window::SetMinimized(bool minimized)
 		return;
 
 	fMinimized = minimized;
+	if (minimized)
+		DiscardRetainedContents();
 }
 
 
@@ -1089,8 +1339,10 @@ Window::GetSizeLimits(int32* minWidth, int32* maxWidth,
 bool
 Window::SetTabLocation(float location, BRegion& dirty)
 {
-	if (fDecorator)
-		return fDecorator->SetTabLocation(location, &dirty);
+	if (fDecorator && fDecorator->SetTabLocation(location, &dirty)) {
+		_DiscardRetainedBorder();
+		return true;
+	}
 
 	return false;
 }
@@ -1116,8 +1368,10 @@ Window::SetDecoratorSettings(const BMessage& settings, BRegion& dirty)
 		return false;
 	}
 
-	if (fDecorator)
-		return fDecorator->SetSettings(settings, &dirty);
+	if (fDecorator && fDecorator->SetSettings(settings, &dirty)) {
+		DiscardRetainedContents();
+		return true;
+	}
 	return false;
 }
 
@@ -1141,6 +1395,7 @@ Window::FontsChanged(BRegion* updateRegion)
 	if (fDecorator != NULL) {
 		DesktopSettings settings(fDesktop);
 		fDecorator->FontsChanged(settings, updateRegion);
+		DiscardRetainedContents();
 	}
 }
 
@@ -1156,6 +1411,7 @@ Window::SetLook(window_look look, BRegion* updateRegion)
 	}
 
 	fLook = look;
+	DiscardRetainedContents();
 
 	fContentRegionValid = false;
 		// mabye a resize handle was added...
@@ -1220,6 +1476,7 @@ Window::SetFlags(uint32 flags, BRegion* updateRegion)
 		return;
 
 	fDecorator->SetFlags(flags, updateRegion);
+	DiscardRetainedContents();
 
 	// we might need to resize the window!
 	if (fDecorator) {
@@ -1891,6 +2148,59 @@ Window::_UpdateContentRegion()
 		fContentRegion.Exclude(&fDecorator->GetFootprint());
 
 	fContentRegionValid = true;
+	fVisibleContentRegionValid = false;
+}
+
+
+status_t
+Window::_AllocateRetainedBuffer()
+{
+	// the retained lock must be held
+	BRegion* fullRegion = fRegionPool.GetRegion();
+	if (fullRegion == NULL)
+		return B_NO_MEMORY;
+
+	GetFullRegion(fullRegion);
+	BRect frame = fullRegion->Frame();
+	frame.OffsetBy(-fFrame.left, -fFrame.top);
+	fRegionPool.Recycle(fullRegion);
+
+	if (fRetainedBuffer != NULL) {
+		if (frame == fRetainedBufferFrame)
+			return B_OK;
+
+		// the decorator has changed its size
+		DiscardRetainedContents();
+	}
+
+	fRetainedBuffer = new(nothrow) MallocBuffer(frame.IntegerWidth() + 1,
+		frame.IntegerHeight() + 1);
+	if (fRetainedBuffer == NULL || fRetainedBuffer->InitCheck() != B_OK) {
+		delete fRetainedBuffer;
+		fRetainedBuffer = NULL;
+		return B_NO_MEMORY;
+	}
+
+	fRetainedBufferFrame = frame;
+	return B_OK;
+}
+
+
+void
+Window::_DiscardRetainedBorder()
+{
+	// the decorator draws its new look only in the visible parts
+	BAutolock _(fRetainedLock);
+
+	BRegion* border = fRegionPool.GetRegion();
+	if (border == NULL) {
+		fRetainedRegion.MakeEmpty();
+		return;
+	}
+
+	GetBorderRegion(border);
+	DiscardRetainedContents(*border);
+	fRegionPool.Recycle(border);
 }
 
 
@@ -19,6 +19,7 @@
 #include "View.h"
 #include "WindowList.h"
 
+#include <Locker.h>
 #include <ObjectList.h>
 #include <Region.h>
 #include <String.h>
@@ -33,6 +34,7 @@ class Decorator;
 class Desktop;
 class DrawingEngine;
 class EventDispatcher;
+class MallocBuffer;
 class Screen;
 class WindowBehaviour;
 class WorkspacesView;
@@ -117,6 +119,19 @@ public:
 			// shortcut for invalidating just one view
 			void				InvalidateView(View* view, BRegion& viewRegion);
 
+			// keeping the contents of parts that get hidden by other
+			// windows, so that they don't need to be redrawn when they
+			// are exposed again (the first three are only called from
+			// the Desktop thread, around rebuilding the clipping)
+			void				PrepareRetainedContents();
+			void				RetainHiddenContents(DrawingEngine* engine);
+			void				RestoreExposedContents(DrawingEngine* engine,
+									BRegion& restoredRegion);
+			void				DiscardRetainedContents();
+			void				DiscardRetainedContents(
+									const BRegion& regionOnScreen);
+			bool				HasRetainedContents() const;
+
 			void				DisableUpdateRequests();
 			void				EnableUpdateRequests();
 
@@ -270,6 +285,9 @@ protected:
 
 			void				_UpdateContentRegion();
 
+			status_t			_AllocateRetainedBuffer();
+			void				_DiscardRetainedBorder();
+
 			void				_ObeySizeLimits();
 			void				_PropagatePosition();
 
@@ -304,6 +322,20 @@ protected:
 
 			::RegionPool		fRegionPool;
 
+			// the retained contents, the region is relative to the
+			// frame's left top, and so is the frame of the buffer
+			MallocBuffer*		fRetainedBuffer;
+			BRect				fRetainedBufferFrame;
+			BRegion				fRetainedRegion;
+			// the ServerWindow thread discards retained contents with
+			// only the read lock held
+	mutable	BLocker				fRetainedLock;
+			// the visible region and position before the clipping
+			// was rebuilt
+			BRegion				fPreviousVisibleRegion;
+			BPoint				fPreviousPosition;
+			bool				fRetainPending;
+
 			BObjectList<Window> fSubsets;
 
 			WindowBehaviour*	fWindowBehaviour;
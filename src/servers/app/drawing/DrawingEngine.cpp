@@ -574,6 +574,97 @@ DrawingEngine::CopyRegion(/*const*/ BRegion* region, int32 xOffset,
 }
 
 
+/*!	Copies the pixels of the \a region from \a source to \a target. A pixel
+	at (x, y) in the region is at (x + sourceX, y + sourceY) in the source,
+	and at (x + targetX, y + targetY) in the target. The region is clipped to
+	both buffers.
+*/
+static BRegion
+copy_region_bits(const BRegion& region, RenderingBuffer* source,
+	int32 sourceX, int32 sourceY, RenderingBuffer* target, int32 targetX,
+	int32 targetY)
+{
+	// TODO: assumes both buffers are 32 bits (which they currently always are)
+	BRect sourceBounds(-sourceX, -sourceY, source->Width() - 1 - sourceX,
+		source->Height() - 1 - sourceY);
+	BRect targetBounds(-targetX, -targetY, target->Width() - 1 - targetX,
+		target->Height() - 1 - targetY);
+
+	BRegion copied(sourceBounds & targetBounds);
+	copied.IntersectWith(&region);
+
+	uint8* sourceBits = (uint8*)source->Bits();
+	uint8* targetBits = (uint8*)target->Bits();
+	uint32 sourceBPR = source->BytesPerRow();
+	uint32 targetBPR = target->BytesPerRow();
+
+	int32 count = copied.CountRects();
+	for (int32 i = 0; i < count; i++) {
+		clipping_rect rect = copied.RectAtInt(i);
+		int32 width = rect.right - rect.left + 1;
+
+		uint8* src = sourceBits + (rect.top + sourceY) * sourceBPR
+			+ (rect.left + sourceX) * 4;
+		uint8* dst = targetBits + (rect.top + targetY) * targetBPR
+			+ (rect.left + targetX) * 4;
+
+		for (int32 y = rect.top; y <= rect.bottom; y++) {
+			// NOTE: avoid memcpy, either buffer might be graphics card memory
+			gfxcpy32(dst, src, width * 4);
+			src += sourceBPR;
+			dst += targetBPR;
+		}
+	}
+
+	return copied;
+}
+
+
+/*!	Saves the pixels of the \a region into the \a buffer. Returns an error
+	when the pixels cannot be read, for example because the drawing buffer
+	is not local.
+*/
+status_t
+DrawingEngine::ReadRegion(const BRegion& region, RenderingBuffer* buffer,
+	int32 xOffset, int32 yOffset)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	RenderingBuffer* drawingBuffer = fGraphicsCard->DrawingBuffer();
+	if (drawingBuffer == NULL || drawingBuffer->Bits() == NULL
+		|| buffer == NULL || buffer->Bits() == NULL) {
+		return B_ERROR;
+	}
+
+	AutoFloatingOverlaysHider _(fGraphicsCard, region.Frame());
+
+	copy_region_bits(region, drawingBuffer, 0, 0, buffer, xOffset, yOffset);
+	return B_OK;
+}
+
+
+/*!	Puts the pixels saved with ReadRegion() back on screen. */
+status_t
+DrawingEngine::WriteRegion(const BRegion& region, RenderingBuffer* buffer,
+	int32 xOffset, int32 yOffset)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	RenderingBuffer* drawingBuffer = fGraphicsCard->DrawingBuffer();
+	if (drawingBuffer == NULL || drawingBuffer->Bits() == NULL
+		|| buffer == NULL || buffer->Bits() == NULL) {
+		return B_ERROR;
+	}
+
+	AutoFloatingOverlaysHider _(fGraphicsCard, region.Frame());
+
+	BRegion touched = copy_region_bits(region, buffer, xOffset, yOffset,
+		drawingBuffer, 0, 0);
+	fGraphicsCard->InvalidateRegion(touched);
+	return B_OK;
+}
+
+
 void
 DrawingEngine::InvertRect(BRect r)
 {
@@ -92,6 +92,15 @@ public:
 	virtual	void			CopyRegion(/*const*/ BRegion* region,
 								int32 xOffset, int32 yOffset);
 
+	// transfer the pixels within the region from and to a buffer, the
+	// screen pixel (x, y) being at (x + xOffset, y + yOffset) in the buffer
+	virtual	status_t		ReadRegion(const BRegion& region,
+								RenderingBuffer* buffer, int32 xOffset,
+								int32 yOffset);
+	virtual	status_t		WriteRegion(const BRegion& region,
+								RenderingBuffer* buffer, int32 xOffset,
+								int32 yOffset);
+
 	virtual	void			InvertRect(BRect r);
 
 	virtual	void			DrawBitmap(ServerBitmap* bitmap,
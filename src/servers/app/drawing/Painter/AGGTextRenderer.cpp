@@ -29,8 +29,9 @@
 #include "IntRect.h"
 
 
-AGGTextRenderer::AGGTextRenderer(renderer_subpix_type& subpixRenderer,
-		renderer_type& solidRenderer, renderer_bin_type& binRenderer,
+AGGTextRenderer::AGGTextRenderer(renderer_base& baseRenderer,
+		renderer_subpix_type& subpixRenderer, renderer_type& solidRenderer,
+		renderer_bin_type& binRenderer,
 		scanline_unpacked_type& scanline,
 		scanline_unpacked_subpix_type& subpixScanline,
 		rasterizer_subpix_type& subpixRasterizer)
@@ -45,6 +46,7 @@ AGGTextRenderer::AGGTextRenderer(renderer_subpix_type& subpixRenderer,
 	fCurves(fPathAdaptor),
 	fContour(fCurves),
 
+	fBaseRenderer(baseRenderer),
 	fSolidRenderer(solidRenderer),
 	fBinRenderer(binRenderer),
 	fSubpixRenderer(subpixRenderer),
@@ -133,6 +135,8 @@ public:
 		fVector(false),
 		fBounds(LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN),
 		fNextCharPos(nextCharPos),
+		fPendingGlyphCount(0),
+		fPendingBounds(LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN),
 
 		fTransformedGlyph(transformedGlyph),
 		fTransformedContour(transformedContour),
@@ -149,6 +153,8 @@ public:
 
 	void Finish(double x, double y)
 	{
+		_FlushGlyphs();
+
 		if (fVector) {
 			if (fSubpixelAntiAliased) {
 				agg::render_scanlines(fRenderer.fSubpixRasterizer,
@@ -206,12 +212,22 @@ public:
 				// we cannot use the transformation pipeline
 				double transformedX = x + fTransformOffset.x;
 				double transformedY = y + fTransformOffset.y;
+				glyphBounds.OffsetBy(fTransformOffset);
+
+				if (glyph->runs != NULL) {
+					// the glyph is blitted together with the rest of the
+					// string
+					if (fClippingFrame.Intersects(glyphBounds)) {
+						_QueueGlyph(glyph, agg::iround(transformedX),
+							agg::iround(transformedY), glyphBounds);
+					}
+					return true;
+				}
+
 				entry->InitAdaptors(glyph, transformedX, transformedY,
 					fRenderer.fMonoAdaptor,
 					fRenderer.fGray8Adaptor,
 					fRenderer.fPathAdaptor);
-
-				glyphBounds.OffsetBy(fTransformOffset);
 			} else {
 				entry->InitAdaptors(glyph, x, y,
 					fRenderer.fMonoAdaptor,
@@ -227,6 +243,9 @@ public:
 			}
 
 			if (fClippingFrame.Intersects(glyphBounds)) {
+				if (glyph->data_type != glyph_data_outline)
+					_FlushGlyphs();
+
 				switch (glyph->data_type) {
 					case glyph_data_mono:
 						agg::render_scanlines(fRenderer.fMonoAdaptor,
@@ -295,6 +314,105 @@ public:
 	}
 
 private:
+	struct PendingGlyph {
+		const GlyphCache*	glyph;
+		int32				x;
+		int32				y;
+	};
+
+	enum {
+		kMaxPendingGlyphs = 64
+	};
+
+	void _QueueGlyph(const GlyphCache* glyph, int32 x, int32 y,
+		const IntRect& bounds)
+	{
+		if (fPendingGlyphCount == kMaxPendingGlyphs)
+			_FlushGlyphs();
+
+		PendingGlyph& pending = fPendingGlyphs[fPendingGlyphCount++];
+		pending.glyph = glyph;
+		pending.x = x;
+		pending.y = y;
+
+		fPendingBounds = fPendingBounds | bounds;
+	}
+
+	void _FlushGlyphs()
+	{
+		// Blits the queued glyphs clipping rect by clipping rect, instead of
+		// going through all clipping rects for every span of every glyph.
+		if (fPendingGlyphCount == 0)
+			return;
+
+		renderer_base& baseRenderer = fRenderer.fBaseRenderer;
+		baseRenderer.first_clip_box();
+		do {
+			const agg::rect_i& clipBox = baseRenderer.clip_box();
+			if (clipBox.x1 > fPendingBounds.right
+				|| clipBox.x2 < fPendingBounds.left
+				|| clipBox.y1 > fPendingBounds.bottom
+				|| clipBox.y2 < fPendingBounds.top) {
+				continue;
+			}
+
+			for (int32 i = 0; i < fPendingGlyphCount; i++)
+				_BlitGlyph(fPendingGlyphs[i], clipBox);
+		} while (baseRenderer.next_clip_box());
+
+		fPendingGlyphCount = 0;
+		fPendingBounds = IntRect(LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN);
+	}
+
+	void _BlitGlyph(const PendingGlyph& pending, const agg::rect_i& clipBox)
+	{
+		const GlyphCache* glyph = pending.glyph;
+		if (glyph->bounds.x1 + pending.x > clipBox.x2
+			|| glyph->bounds.x2 + pending.x < clipBox.x1
+			|| glyph->bounds.y1 + pending.y > clipBox.y2
+			|| glyph->bounds.y2 + pending.y < clipBox.y1) {
+			return;
+		}
+
+		pixfmt& pixelFormat = fRenderer.fBaseRenderer.ren();
+		bool subpixel = glyph->data_type == glyph_data_subpix;
+		int32 coversPerPixel = subpixel ? 3 : 1;
+		const pixfmt::color_type& color = subpixel
+			? fRenderer.fSubpixRenderer.color()
+			: fRenderer.fSolidRenderer.color();
+
+		const GlyphCoverageRun* run = glyph->runs;
+		const uint8* covers = glyph->covers;
+		for (uint32 i = 0; i < glyph->run_count; i++, run++) {
+			int32 length = run->length;
+			int32 y = run->y + pending.y;
+			int32 x1 = run->x + pending.x;
+			int32 x2 = x1 + length - 1;
+			const uint8* runCovers = covers;
+			covers += length * coversPerPixel;
+
+			if (y < clipBox.y1 || y > clipBox.y2)
+				continue;
+			if (x1 < clipBox.x1) {
+				runCovers += (clipBox.x1 - x1) * coversPerPixel;
+				x1 = clipBox.x1;
+			}
+			if (x2 > clipBox.x2)
+				x2 = clipBox.x2;
+			if (x1 > x2)
+				continue;
+
+			if (subpixel) {
+				pixelFormat.blend_solid_hspan_subpix(x1, y,
+					(x2 - x1 + 1) * 3, color, runCovers);
+			} else {
+				pixelFormat.blend_solid_hspan(x1, y, x2 - x1 + 1, color,
+					runCovers);
+			}
+		}
+	}
+
+
  	const Transformable& fTransform;
 	const BPoint&		fTransformOffset;
 	const IntRect&		fClippingFrame;
@@ -304,6 +422,10 @@ private:
 	IntRect				fBounds;
 	BPoint*				fNextCharPos;
 
+	PendingGlyph		fPendingGlyphs[kMaxPendingGlyphs];
+	int32				fPendingGlyphCount;
+	IntRect				fPendingBounds;
+
 	FontCacheEntry::TransformedOutline& fTransformedGlyph;
 	FontCacheEntry::TransformedContourOutline& fTransformedContour;
 	AGGTextRenderer&	fRenderer;
@@ -13,7 +13,9 @@
 
 #include <new>
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <Bitmap.h>
@@ -26,6 +28,8 @@
 #include <GradientDiamond.h>
 #include <GradientConic.h>
 
+#include <AutoDeleter.h>
+#include <ColorConversion.h>
 #include <ShapePrivate.h>
 
 #include <agg_bezier_arc.h>
@@ -46,12 +50,12 @@
 
 #include "DrawState.h"
 
-#include <AutoDeleter.h>
 #include <View.h>
 
 #include "DrawingMode.h"
 #include "GlobalSubpixelSettings.h"
 #include "PatternHandler.h"
+#include "RenderThreadPool.h"
 #include "RenderingBuffer.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
@@ -81,6 +85,409 @@ using std::nothrow;
 #define CHECK_CLIPPING	if (!fValidClipping) return BRect(0, 0, -1, -1);
 #define CHECK_CLIPPING_NO_RETURN	if (!fValidClipping) return;
 
+// conversion buffers up to this size are kept for the next bitmap
+static const size_t kMaxKeptConversionBufferSize = 4 * 1024 * 1024;
+
+
+// #pragma mark - band jobs
+
+
+// FillRectJob
+//
+// Fills a rectangle with a solid color, or with one color per row.
+class FillRectJob : public RenderThreadPool::Job {
+public:
+	FillRectJob(agg::rendering_buffer& buffer, const BRect& rect,
+			const uint32* rowColors, uint32 color)
+		:
+		fBuffer(buffer),
+		fLeft((int32)rect.left),
+		fTop((int32)rect.top),
+		fRight((int32)rect.right),
+		fBottom((int32)rect.bottom),
+		fRowColors(rowColors),
+		fColor(color)
+	{
+	}
+
+	virtual void Render(const BRegion& clipping)
+	{
+		uint8* dst = fBuffer.row_ptr(0);
+		uint32 bpr = fBuffer.stride();
+
+		for (int32 i = 0; i < clipping.CountRects(); i++) {
+			clipping_rect box = clipping.RectAtInt(i);
+			int32 x1 = max_c(box.left, fLeft);
+			int32 x2 = min_c(box.right, fRight);
+			if (x1 > x2)
+				continue;
+
+			int32 y1 = max_c(box.top, fTop);
+			int32 y2 = min_c(box.bottom, fBottom);
+			uint8* offset = dst + x1 * 4;
+			for (; y1 <= y2; y1++) {
+				uint32 color = fRowColors != NULL
+					? fRowColors[y1 - fTop] : fColor;
+				gfxset32(offset + y1 * bpr, color, (x2 - x1 + 1) * 4);
+			}
+		}
+	}
+
+private:
+	agg::rendering_buffer&	fBuffer;
+	int32					fLeft;
+	int32					fTop;
+	int32					fRight;
+	int32					fBottom;
+	const uint32*			fRowColors;
+	uint32					fColor;
+};
+
+
+struct FilterInfo {
+	uint16 index;	// index into source bitmap row/column
+	uint16 weight;	// weight of the pixel at index [0..255]
+};
+
+// the code paths of BilinearScaleJob
+enum {
+	kOptimizeForLowFilterRatio = 0,
+	kUseDefaultVersion,
+	kUseSIMDVersion
+};
+
+
+// BilinearScaleJob
+//
+// Draws a bitmap scaled with bilinear filtering, using the filter weights
+// computed by Painter::_DrawBitmapBilinearCopy32().
+class BilinearScaleJob : public RenderThreadPool::Job {
+public:
+	BilinearScaleJob(agg::rendering_buffer& dstBuffer,
+			agg::rendering_buffer& srcBuffer, FilterInfo* xWeights,
+			FilterInfo* yWeights, uint32 filterWeightXIndexOffset,
+			uint32 filterWeightYIndexOffset, const BRect& viewRect,
+			int codeSelect)
+		:
+		fDstBuffer(dstBuffer),
+		fSrcBuffer(srcBuffer),
+		fXWeights(xWeights),
+		fYWeights(yWeights),
+		fFilterWeightXIndexOffset(filterWeightXIndexOffset),
+		fFilterWeightYIndexOffset(filterWeightYIndexOffset),
+		fLeft((int32)viewRect.left),
+		fTop((int32)viewRect.top),
+		fRight((int32)viewRect.right),
+		fBottom((int32)viewRect.bottom),
+		fCodeSelect(codeSelect)
+	{
+	}
+
+	virtual void Render(const BRegion& clipping)
+	{
+		for (int32 i = 0; i < clipping.CountRects(); i++) {
+			clipping_rect box = clipping.RectAtInt(i);
+			int32 x1 = max_c(box.left, fLeft);
+			int32 x2 = min_c(box.right, fRight);
+			int32 y1 = max_c(box.top, fTop);
+			int32 y2 = min_c(box.bottom, fBottom);
+			if (x1 <= x2 && y1 <= y2)
+				_DrawBox(x1, x2, y1, y2);
+		}
+	}
+
+private:
+			void			_DrawBox(const int32 x1, const int32 x2, int32 y1,
+								int32 y2) const;
+
+	agg::rendering_buffer&	fDstBuffer;
+	agg::rendering_buffer&	fSrcBuffer;
+	FilterInfo*				fXWeights;
+	FilterInfo*				fYWeights;
+	uint32					fFilterWeightXIndexOffset;
+	uint32					fFilterWeightYIndexOffset;
+	int32					fLeft;
+	int32					fTop;
+	int32					fRight;
+	int32					fBottom;
+	int						fCodeSelect;
+};
+
+
+void
+BilinearScaleJob::_DrawBox(const int32 x1, const int32 x2, int32 y1,
+	int32 y2) const
+{
+	agg::rendering_buffer& srcBuffer = fSrcBuffer;
+	FilterInfo* xWeights = fXWeights;
+	FilterInfo* yWeights = fYWeights;
+	const uint32 filterWeightXIndexOffset = fFilterWeightXIndexOffset;
+	const uint32 filterWeightYIndexOffset = fFilterWeightYIndexOffset;
+	const int32 left = fLeft;
+	const int32 top = fTop;
+
+	const uint32 dstBPR = fDstBuffer.stride();
+	const uint32 srcBPR = srcBuffer.stride();
+
+	// buffer offset into destination
+	uint8* dst = fDstBuffer.row_ptr(y1) + x1 * 4;
+
+	// x and y are needed as indeces into the wheight arrays, so the
+	// offset into the target buffer needs to be compensated
+	const int32 xIndexL = x1 - left - filterWeightXIndexOffset;
+	const int32 xIndexR = x2 - left - filterWeightXIndexOffset;
+	y1 -= top + filterWeightYIndexOffset;
+	y2 -= top + filterWeightYIndexOffset;
+
+//printf("x: %ld - %ld\n", xIndexL, xIndexR);
+//printf("y: %ld - %ld\n", y1, y2);
+
+	switch (fCodeSelect) {
+		case kOptimizeForLowFilterRatio:
+		{
+			// In this mode, we anticipate to hit many destination pixels
+			// that map directly to a source pixel, we have more branches
+			// in the inner loop but save time because of the special
+			// cases. If there are too few direct hit pixels, the branches
+			// only waste time.
+			for (; y1 <= y2; y1++) {
+				// cache the weight of the top and bottom row
+				const uint16 wTop = yWeights[y1].weight;
+				const uint16 wBottom = 255 - yWeights[y1].weight;
+
+				// buffer offset into source (top row)
+				register const uint8* src
+					= srcBuffer.row_ptr(yWeights[y1].index);
+				// buffer handle for destination to be incremented per
+				// pixel
+				register uint8* d = dst;
+
+				if (wTop == 255) {
+					for (int32 x = xIndexL; x <= xIndexR; x++) {
+						const uint8* s = src + xWeights[x].index;
+						// This case is important to prevent out
+						// of bounds access at bottom edge of the source
+						// bitmap. If the scale is low and integer, it will
+						// also help the speed.
+						if (xWeights[x].weight == 255) {
+							// As above, but to prevent out of bounds
+							// on the right edge.
+							*(uint32*)d = *(uint32*)s;
+						} else {
+							// Only the left and right pixels are
+							// interpolated, since the top row has 100%
+							// weight.
+							const uint16 wLeft = xWeights[x].weight;
+							const uint16 wRight = 255 - wLeft;
+							d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
+							d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
+							d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
+						}
+						d += 4;
+					}
+				} else {
+					for (int32 x = xIndexL; x <= xIndexR; x++) {
+						const uint8* s = src + xWeights[x].index;
+						if (xWeights[x].weight == 255) {
+							// Prevent out of bounds access on the right
+							// edge or simply speed up.
+							const uint8* sBottom = s + srcBPR;
+							d[0] = (s[0] * wTop + sBottom[0] * wBottom)
+								>> 8;
+							d[1] = (s[1] * wTop + sBottom[1] * wBottom)
+								>> 8;
+							d[2] = (s[2] * wTop + sBottom[2] * wBottom)
+								>> 8;
+						} else {
+							// calculate the weighted sum of all four
+							// interpolated pixels
+							const uint16 wLeft = xWeights[x].weight;
+							const uint16 wRight = 255 - wLeft;
+							// left and right of top row
+							uint32 t0 = (s[0] * wLeft + s[4] * wRight)
+								* wTop;
+							uint32 t1 = (s[1] * wLeft + s[5] * wRight)
+								* wTop;
+							uint32 t2 = (s[2] * wLeft + s[6] * wRight)
+								* wTop;
+
+							// left and right of bottom row
+							s += srcBPR;
+							t0 += (s[0] * wLeft + s[4] * wRight) * wBottom;
+							t1 += (s[1] * wLeft + s[5] * wRight) * wBottom;
+							t2 += (s[2] * wLeft + s[6] * wRight) * wBottom;
+
+							d[0] = t0 >> 16;
+							d[1] = t1 >> 16;
+							d[2] = t2 >> 16;
+						}
+						d += 4;
+					}
+				}
+				dst += dstBPR;
+			}
+			break;
+		}
+
+		case kUseDefaultVersion:
+		{
+			// In this mode we anticipate many pixels wich need filtering,
+			// there are no special cases for direct hit pixels except for
+			// the last column/row and the right/bottom corner pixel.
+
+			// The last column/row handling does not need to be performed
+			// for all clipping rects!
+			int32 yMax = y2;
+			if (yWeights[yMax].weight == 255)
+				yMax--;
+			int32 xIndexMax = xIndexR;
+			if (xWeights[xIndexMax].weight == 255)
+				xIndexMax--;
+
+			for (; y1 <= yMax; y1++) {
+				// cache the weight of the top and bottom row
+				const uint16 wTop = yWeights[y1].weight;
+				const uint16 wBottom = 255 - yWeights[y1].weight;
+
+				// buffer offset into source (top row)
+				register const uint8* src
+					= srcBuffer.row_ptr(yWeights[y1].index);
+				// buffer handle for destination to be incremented per
+				// pixel
+				register uint8* d = dst;
+
+				for (int32 x = xIndexL; x <= xIndexMax; x++) {
+					const uint8* s = src + xWeights[x].index;
+					// calculate the weighted sum of all four
+					// interpolated pixels
+					const uint16 wLeft = xWeights[x].weight;
+					const uint16 wRight = 255 - wLeft;
+					// left and right of top row
+					uint32 t0 = (s[0] * wLeft + s[4] * wRight) * wTop;
+					uint32 t1 = (s[1] * wLeft + s[5] * wRight) * wTop;
+					uint32 t2 = (s[2] * wLeft + s[6] * wRight) * wTop;
+
+					// left and right of bottom row
+					s += srcBPR;
+					t0 += (s[0] * wLeft + s[4] * wRight) * wBottom;
+					t1 += (s[1] * wLeft + s[5] * wRight) * wBottom;
+					t2 += (s[2] * wLeft + s[6] * wRight) * wBottom;
+					d[0] = t0 >> 16;
+					d[1] = t1 >> 16;
+					d[2] = t2 >> 16;
+					d += 4;
+				}
+				// last column of pixels if necessary
+				if (xIndexMax < xIndexR) {
+					const uint8* s = src + xWeights[xIndexR].index;
+					const uint8* sBottom = s + srcBPR;
+					d[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
+					d[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
+					d[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
+				}
+
+				dst += dstBPR;
+			}
+
+			// last row of pixels if necessary
+			// buffer offset into source (bottom row)
+			register const uint8* src
+				= srcBuffer.row_ptr(yWeights[y2].index);
+			// buffer handle for destination to be incremented per pixel
+			register uint8* d = dst;
+
+			if (yMax < y2) {
+				for (int32 x = xIndexL; x <= xIndexMax; x++) {
+					const uint8* s = src + xWeights[x].index;
+					const uint16 wLeft = xWeights[x].weight;
+					const uint16 wRight = 255 - wLeft;
+					d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
+					d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
+					d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
+					d += 4;
+				}
+			}
+
+			// pixel in bottom right corner if necessary
+			if (yMax < y2 && xIndexMax < xIndexR) {
+				const uint8* s = src + xWeights[xIndexR].index;
+				*(uint32*)d = *(uint32*)s;
+			}
+			break;
+		}
+
+#ifdef __INTEL__
+		case kUseSIMDVersion:
+		{
+			// Basically the same as the "standard" mode, but we use SIMD
+			// routines for the processing of the single display lines.
+
+			// The last column/row handling does not need to be performed
+			// for all clipping rects!
+			int32 yMax = y2;
+			if (yWeights[yMax].weight == 255)
+				yMax--;
+			int32 xIndexMax = xIndexR;
+			if (xWeights[xIndexMax].weight == 255)
+				xIndexMax--;
+
+			for (; y1 <= yMax; y1++) {
+				// cache the weight of the top and bottom row
+				const uint16 wTop = yWeights[y1].weight;
+				const uint16 wBottom = 255 - yWeights[y1].weight;
+
+				// buffer offset into source (top row)
+				const uint8* src = srcBuffer.row_ptr(yWeights[y1].index);
+				// buffer handle for destination to be incremented per
+				// pixel
+				uint8* d = dst;
+				bilinear_scale_xloop_mmxsse(src, dst, xWeights,	xIndexL,
+					xIndexMax, wTop, srcBPR);
+				// increase pointer by processed pixels
+				d += (xIndexMax - xIndexL + 1) * 4;
+
+				// last column of pixels if necessary
+				if (xIndexMax < xIndexR) {
+					const uint8* s = src + xWeights[xIndexR].index;
+					const uint8* sBottom = s + srcBPR;
+					d[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
+					d[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
+					d[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
+				}
+
+				dst += dstBPR;
+			}
+
+			// last row of pixels if necessary
+			// buffer offset into source (bottom row)
+			register const uint8* src
+				= srcBuffer.row_ptr(yWeights[y2].index);
+			// buffer handle for destination to be incremented per pixel
+			register uint8* d = dst;
+
+			if (yMax < y2) {
+				for (int32 x = xIndexL; x <= xIndexMax; x++) {
+					const uint8* s = src + xWeights[x].index;
+					const uint16 wLeft = xWeights[x].weight;
+					const uint16 wRight = 255 - wLeft;
+					d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
+					d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
+					d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
+					d += 4;
+				}
+			}
+
+			// pixel in bottom right corner if necessary
+			if (yMax < y2 && xIndexMax < xIndexR) {
+				const uint8* s = src + xWeights[xIndexR].index;
+				*(uint32*)d = *(uint32*)s;
+			}
+			break;
+		}
+#endif	// __INTEL__
+	}
+}
+
 
 // constructor
 Painter::Painter()
@@ -116,8 +523,10 @@ Painter::Painter()
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
 
 	fPatternHandler(),
-	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
-		fSubpixUnpackedScanline, fSubpixRasterizer)
+	fConversionBuffer(NULL),
+	fConversionBufferSize(0),
+	fTextRenderer(fBaseRenderer, fSubpixRenderer, fRenderer, fRendererBin,
+		fUnpackedScanline, fSubpixUnpackedScanline, fSubpixRasterizer)
 {
 	fPixelFormat.SetDrawingMode(fDrawingMode, fAlphaSrcMode, fAlphaFncMode,
 		false);
@@ -132,6 +541,7 @@ Painter::Painter()
 // destructor
 Painter::~Painter()
 {
+	free(fConversionBuffer);
 }
 
 
@@ -268,6 +678,8 @@ Painter::SetHighColor(const rgb_color& color)
 void
 Painter::SetLowColor(const rgb_color& color)
 {
+	if (fPatternHandler.LowColor() == color)
+		return;
 	fPatternHandler.SetLowColor(color);
 	if (*(fPatternHandler.GetR5Pattern()) == B_SOLID_LOW)
 		_SetRendererColor(color);
@@ -939,36 +1351,16 @@ Painter::FillRect(const BRect& r, const rgb_color& c) const
 	if (!fValidClipping)
 		return;
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
 	// get a 32 bit pixel ready with the color
 	pixel32 color;
 	color.data8[0] = c.blue;
 	color.data8[1] = c.green;
 	color.data8[2] = c.red;
 	color.data8[3] = c.alpha;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = color.data32;
-//					}
-				gfxset32(offset + y1 * bpr, color.data32, (x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+	// fill rects, iterate over clipping boxes, in bands in parallel
+	// if possible
+	FillRectJob job(fBuffer, r, NULL, color.data32);
+	RenderThreadPool::Default().Render(job, *fClippingRegion, r);
 }
 
 
@@ -996,31 +1388,10 @@ Painter::FillRectVerticalGradient(BRect r, const BGradientLinear& gradient) cons
 	_MakeGradient(gradient, colorCount, gradientArray,
 		gradientTop - (int32)r.top, gradientArraySize);
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = gradientArray[y1 - top];
-//					}
-				gfxset32(offset + y1 * bpr, gradientArray[y1 - top],
-					(x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+	// fill rects, iterate over clipping boxes, in bands in parallel
+	// if possible
+	FillRectJob job(fBuffer, r, gradientArray, 0);
+	RenderThreadPool::Default().Render(job, *fClippingRegion, r);
 }
 
 
@@ -1801,11 +2172,11 @@ template<typename sourcePixel>
 void
 Painter::_TransparentMagicToAlpha(sourcePixel* buffer, uint32 width,
 	uint32 height, uint32 sourceBytesPerRow, sourcePixel transparentMagic,
-	BBitmap* output) const
+	uint8* output, uint32 outputBytesPerRow) const
 {
 	uint8* sourceRow = (uint8*)buffer;
-	uint8* destRow = (uint8*)output->Bits();
-	uint32 destBytesPerRow = output->BytesPerRow();
+	uint8* destRow = output;
+	uint32 destBytesPerRow = outputBytesPerRow;
 
 	for (uint32 y = 0; y < height; y++) {
 		sourcePixel* pixel = (sourcePixel*)sourceRow;
@@ -1821,6 +2192,36 @@ Painter::_TransparentMagicToAlpha(sourcePixel* buffer, uint32 width,
 }
 
 
+/*!	Returns a buffer for converting bitmaps to B_RGBA32 that can hold at
+	least \a size bytes. Up to kMaxKeptConversionBufferSize, the buffer is
+	kept between calls, so that bitmaps that are drawn repeatedly (like
+	video frames) do not need to allocate a new one every time. Larger ones
+	are only allocated temporarily, as indicated by \a _temporary, and have
+	to be freed by the caller, so that a window doesn't hold on to the
+	memory after drawing a large bitmap once.
+*/
+uint8*
+Painter::_AllocateConversionBuffer(size_t size, bool& _temporary) const
+{
+	_temporary = size > kMaxKeptConversionBufferSize;
+	if (_temporary)
+		return (uint8*)malloc(size);
+
+	if (size <= fConversionBufferSize)
+		return fConversionBuffer;
+
+	free(fConversionBuffer);
+	fConversionBuffer = (uint8*)malloc(size);
+	if (fConversionBuffer == NULL) {
+		fConversionBufferSize = 0;
+		return NULL;
+	}
+
+	fConversionBufferSize = size;
+	return fConversionBuffer;
+}
+
+
 // _DrawBitmap
 void
 Painter::_DrawBitmap(agg::rendering_buffer& srcBuffer, color_space format,
@@ -1903,8 +2304,8 @@ Painter::_DrawBitmap(agg::rendering_buffer& srcBuffer, color_space format,
 		}
 	}
 
-	BBitmap* temp = NULL;
-	ObjectDeleter<BBitmap> tempDeleter;
+	uint8* conversionBuffer = NULL;
+	MemoryDeleter temporaryBufferDeleter;
 
 	if ((format != B_RGBA32 && format != B_RGB32)
 		|| (format == B_RGB32 && fDrawingMode != B_OP_COPY
@@ -1918,19 +2319,43 @@ Painter::_DrawBitmap(agg::rendering_buffer& srcBuffer, color_space format,
 			&& fDrawingMode != B_OP_ALPHA
 #endif
 		)) {
-		temp = new (nothrow) BBitmap(actualBitmapRect, B_BITMAP_NO_SERVER_LINK,
-			B_RGBA32);
-		if (temp == NULL) {
+		// Only convert the part of the bitmap that ends up on screen; this
+		// is only exact if it is not scaled, and not placed at subpixel
+		// offsets, as otherwise the neighbouring pixels are used as well.
+		int32 left = 0;
+		int32 top = 0;
+		int32 width = actualBitmapRect.IntegerWidth() + 1;
+		int32 height = actualBitmapRect.IntegerHeight() + 1;
+		if (xScale == 1.0 && yScale == 1.0
+			&& xOffset == floor(xOffset) && yOffset == floor(yOffset)) {
+			BRect visible = fClippingRegion->Frame() & viewRect;
+			visible.OffsetBy(-xOffset, -yOffset);
+			visible = visible & bitmapRect;
+			if (!visible.IsValid())
+				return;
+
+			left = (int32)visible.left;
+			top = (int32)visible.top;
+			width = (int32)visible.right - left + 1;
+			height = (int32)visible.bottom - top + 1;
+		}
+
+		uint32 bytesPerRow = width * 4;
+		bool temporary;
+		conversionBuffer = _AllocateConversionBuffer(bytesPerRow * height,
+			temporary);
+		if (conversionBuffer == NULL) {
 			fprintf(stderr, "Painter::_DrawBitmap() - "
 				"out of memory for creating temporary conversion bitmap\n");
 			return;
 		}
+		if (temporary)
+			temporaryBufferDeleter.SetTo(conversionBuffer);
 
-		tempDeleter.SetTo(temp);
-
-		status_t err = temp->ImportBits(srcBuffer.buf(),
-			srcBuffer.height() * srcBuffer.stride(),
-			srcBuffer.stride(), 0, format);
+		status_t err = BPrivate::ConvertBits(srcBuffer.buf(),
+			conversionBuffer, srcBuffer.height() * srcBuffer.stride(),
+			bytesPerRow * height, srcBuffer.stride(), bytesPerRow, format,
+			B_RGBA32, BPoint(left, top), BPoint(0, 0), width, height);
 		if (err < B_OK) {
 			fprintf(stderr, "Painter::_DrawBitmap() - "
 				"colorspace conversion failed: %s\n", strerror(err));
@@ -1942,10 +2367,10 @@ Painter::_DrawBitmap(agg::rendering_buffer& srcBuffer, color_space format,
 		// make transparent in our RGBA32 bitmap again.
 		switch (format) {
 			case B_RGB32:
-				_TransparentMagicToAlpha((uint32 *)srcBuffer.buf(),
-					srcBuffer.width(), srcBuffer.height(),
-					srcBuffer.stride(), B_TRANSPARENT_MAGIC_RGBA32,
-					temp);
+				_TransparentMagicToAlpha((uint32*)srcBuffer.row_ptr(top)
+						+ left, width, height, srcBuffer.stride(),
+					B_TRANSPARENT_MAGIC_RGBA32, conversionBuffer,
+					bytesPerRow);
 				break;
 
 			// TODO: not sure if this applies to B_RGBA15 too. It
@@ -1954,20 +2379,19 @@ Painter::_DrawBitmap(agg::rendering_buffer& srcBuffer, color_space format,
 			// when importing the bitmap. Maybe it applies to
 			// B_RGB16 though?
 			case B_RGB15:
-				_TransparentMagicToAlpha((uint16 *)srcBuffer.buf(),
-					srcBuffer.width(), srcBuffer.height(),
-					srcBuffer.stride(), B_TRANSPARENT_MAGIC_RGBA15,
-					temp);
+				_TransparentMagicToAlpha((uint16*)srcBuffer.row_ptr(top)
+						+ left, width, height, srcBuffer.stride(),
+					B_TRANSPARENT_MAGIC_RGBA15, conversionBuffer,
+					bytesPerRow);
 				break;
 
 			default:
 				break;
 		}
 
-		srcBuffer.attach((uint8*)temp->Bits(),
-			(uint32)actualBitmapRect.IntegerWidth() + 1,
-			(uint32)actualBitmapRect.IntegerHeight() + 1,
-			temp->BytesPerRow());
+		srcBuffer.attach(conversionBuffer, width, height, bytesPerRow);
+		xOffset += left;
+		yOffset += top;
 	}
 
 	// maybe we can use an optimized version if there is no scale
@@ -2222,11 +2646,6 @@ Painter::_DrawBitmapBilinearCopy32(agg::rendering_buffer& srcBuffer,
 			- viewRect.top);
 	}
 
-	struct FilterInfo {
-		uint16 index;	// index into source bitmap row/column
-		uint16 weight;	// weight of the pixel at index [0..255]
-	};
-
 //#define FILTER_INFOS_ON_HEAP
 #ifdef FILTER_INFOS_ON_HEAP
 	FilterInfo* xWeights = new (nothrow) FilterInfo[dstWidth];
@@ -2296,21 +2715,7 @@ Painter::_DrawBitmapBilinearCopy32(agg::rendering_buffer& srcBuffer,
 //	yWeights[dstHeight - 1].index, yWeights[dstHeight - 1].weight,
 //	dstHeight);
 
-	const int32 left = (int32)viewRect.left;
-	const int32 top = (int32)viewRect.top;
-	const int32 right = (int32)viewRect.right;
-	const int32 bottom = (int32)viewRect.bottom;
-
-	const uint32 dstBPR = fBuffer.stride();
-	const uint32 srcBPR = srcBuffer.stride();
-
 	// Figure out which version of the code we want to use...
-	enum {
-		kOptimizeForLowFilterRatio = 0,
-		kUseDefaultVersion,
-		kUseSIMDVersion
-	};
-
 	int codeSelect = kUseDefaultVersion;
 
 	uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
@@ -2323,277 +2728,11 @@ Painter::_DrawBitmapBilinearCopy32(agg::rendering_buffer& srcBuffer,
 		}
 	}
 
-	// iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		const int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		const int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 > x2)
-			continue;
-
-		int32 y1 = max_c(fBaseRenderer.ymin(), top);
-		int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-		if (y1 > y2)
-			continue;
-
-		// buffer offset into destination
-		uint8* dst = fBuffer.row_ptr(y1) + x1 * 4;
-
-		// x and y are needed as indeces into the wheight arrays, so the
-		// offset into the target buffer needs to be compensated
-		const int32 xIndexL = x1 - left - filterWeightXIndexOffset;
-		const int32 xIndexR = x2 - left - filterWeightXIndexOffset;
-		y1 -= top + filterWeightYIndexOffset;
-		y2 -= top + filterWeightYIndexOffset;
-
-//printf("x: %ld - %ld\n", xIndexL, xIndexR);
-//printf("y: %ld - %ld\n", y1, y2);
-
-		switch (codeSelect) {
-			case kOptimizeForLowFilterRatio:
-			{
-				// In this mode, we anticipate to hit many destination pixels
-				// that map directly to a source pixel, we have more branches
-				// in the inner loop but save time because of the special
-				// cases. If there are too few direct hit pixels, the branches
-				// only waste time.
-				for (; y1 <= y2; y1++) {
-					// cache the weight of the top and bottom row
-					const uint16 wTop = yWeights[y1].weight;
-					const uint16 wBottom = 255 - yWeights[y1].weight;
-
-					// buffer offset into source (top row)
-					register const uint8* src
-						= srcBuffer.row_ptr(yWeights[y1].index);
-					// buffer handle for destination to be incremented per
-					// pixel
-					register uint8* d = dst;
-
-					if (wTop == 255) {
-						for (int32 x = xIndexL; x <= xIndexR; x++) {
-							const uint8* s = src + xWeights[x].index;
-							// This case is important to prevent out
-							// of bounds access at bottom edge of the source
-							// bitmap. If the scale is low and integer, it will
-							// also help the speed.
-							if (xWeights[x].weight == 255) {
-								// As above, but to prevent out of bounds
-								// on the right edge.
-								*(uint32*)d = *(uint32*)s;
-							} else {
-								// Only the left and right pixels are
-								// interpolated, since the top row has 100%
-								// weight.
-								const uint16 wLeft = xWeights[x].weight;
-								const uint16 wRight = 255 - wLeft;
-								d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
-								d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
-								d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
-							}
-							d += 4;
-						}
-					} else {
-						for (int32 x = xIndexL; x <= xIndexR; x++) {
-							const uint8* s = src + xWeights[x].index;
-							if (xWeights[x].weight == 255) {
-								// Prevent out of bounds access on the right
-								// edge or simply speed up.
-								const uint8* sBottom = s + srcBPR;
-								d[0] = (s[0] * wTop + sBottom[0] * wBottom)
-									>> 8;
-								d[1] = (s[1] * wTop + sBottom[1] * wBottom)
-									>> 8;
-								d[2] = (s[2] * wTop + sBottom[2] * wBottom)
-									>> 8;
-							} else {
-								// calculate the weighted sum of all four
-								// interpolated pixels
-								const uint16 wLeft = xWeights[x].weight;
-								const uint16 wRight = 255 - wLeft;
-								// left and right of top row
-								uint32 t0 = (s[0] * wLeft + s[4] * wRight)
-									* wTop;
-								uint32 t1 = (s[1] * wLeft + s[5] * wRight)
-									* wTop;
-								uint32 t2 = (s[2] * wLeft + s[6] * wRight)
-									* wTop;
-
-								// left and right of bottom row
-								s += srcBPR;
-								t0 += (s[0] * wLeft + s[4] * wRight) * wBottom;
-								t1 += (s[1] * wLeft + s[5] * wRight) * wBottom;
-								t2 += (s[2] * wLeft + s[6] * wRight) * wBottom;
-
-								d[0] = t0 >> 16;
-								d[1] = t1 >> 16;
-								d[2] = t2 >> 16;
-							}
-							d += 4;
-						}
-					}
-					dst += dstBPR;
-				}
-				break;
-			}
-
-			case kUseDefaultVersion:
-			{
-				// In this mode we anticipate many pixels wich need filtering,
-				// there are no special cases for direct hit pixels except for
-				// the last column/row and the right/bottom corner pixel.
-
-				// The last column/row handling does not need to be performed
-				// for all clipping rects!
-				int32 yMax = y2;
-				if (yWeights[yMax].weight == 255)
-					yMax--;
-				int32 xIndexMax = xIndexR;
-				if (xWeights[xIndexMax].weight == 255)
-					xIndexMax--;
-
-				for (; y1 <= yMax; y1++) {
-					// cache the weight of the top and bottom row
-					const uint16 wTop = yWeights[y1].weight;
-					const uint16 wBottom = 255 - yWeights[y1].weight;
-
-					// buffer offset into source (top row)
-					register const uint8* src
-						= srcBuffer.row_ptr(yWeights[y1].index);
-					// buffer handle for destination to be incremented per
-					// pixel
-					register uint8* d = dst;
-
-					for (int32 x = xIndexL; x <= xIndexMax; x++) {
-						const uint8* s = src + xWeights[x].index;
-						// calculate the weighted sum of all four
-						// interpolated pixels
-						const uint16 wLeft = xWeights[x].weight;
-						const uint16 wRight = 255 - wLeft;
-						// left and right of top row
-						uint32 t0 = (s[0] * wLeft + s[4] * wRight) * wTop;
-						uint32 t1 = (s[1] * wLeft + s[5] * wRight) * wTop;
-						uint32 t2 = (s[2] * wLeft + s[6] * wRight) * wTop;
-
-						// left and right of bottom row
-						s += srcBPR;
-						t0 += (s[0] * wLeft + s[4] * wRight) * wBottom;
-						t1 += (s[1] * wLeft + s[5] * wRight) * wBottom;
-						t2 += (s[2] * wLeft + s[6] * wRight) * wBottom;
-						d[0] = t0 >> 16;
-						d[1] = t1 >> 16;
-						d[2] = t2 >> 16;
-						d += 4;
-					}
-					// last column of pixels if necessary
-					if (xIndexMax < xIndexR) {
-						const uint8* s = src + xWeights[xIndexR].index;
-						const uint8* sBottom = s + srcBPR;
-						d[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
-						d[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
-						d[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
-					}
-
-					dst += dstBPR;
-				}
-
-				// last row of pixels if necessary
-				// buffer offset into source (bottom row)
-				register const uint8* src
-					= srcBuffer.row_ptr(yWeights[y2].index);
-				// buffer handle for destination to be incremented per pixel
-				register uint8* d = dst;
-
-				if (yMax < y2) {
-					for (int32 x = xIndexL; x <= xIndexMax; x++) {
-						const uint8* s = src + xWeights[x].index;
-						const uint16 wLeft = xWeights[x].weight;
-						const uint16 wRight = 255 - wLeft;
-						d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
-						d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
-						d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
-						d += 4;
-					}
-				}
-
-				// pixel in bottom right corner if necessary
-				if (yMax < y2 && xIndexMax < xIndexR) {
-					const uint8* s = src + xWeights[xIndexR].index;
-					*(uint32*)d = *(uint32*)s;
-				}
-				break;
-			}
-
-#ifdef __INTEL__
-			case kUseSIMDVersion:
-			{
-				// Basically the same as the "standard" mode, but we use SIMD
-				// routines for the processing of the single display lines.
-
-				// The last column/row handling does not need to be performed
-				// for all clipping rects!
-				int32 yMax = y2;
-				if (yWeights[yMax].weight == 255)
-					yMax--;
-				int32 xIndexMax = xIndexR;
-				if (xWeights[xIndexMax].weight == 255)
-					xIndexMax--;
-
-				for (; y1 <= yMax; y1++) {
-					// cache the weight of the top and bottom row
-					const uint16 wTop = yWeights[y1].weight;
-					const uint16 wBottom = 255 - yWeights[y1].weight;
-
-					// buffer offset into source (top row)
-					const uint8* src = srcBuffer.row_ptr(yWeights[y1].index);
-					// buffer handle for destination to be incremented per
-					// pixel
-					uint8* d = dst;
-					bilinear_scale_xloop_mmxsse(src, dst, xWeights,	xIndexL,
-						xIndexMax, wTop, srcBPR);
-					// increase pointer by processed pixels
-					d += (xIndexMax - xIndexL + 1) * 4;
-
-					// last column of pixels if necessary
-					if (xIndexMax < xIndexR) {
-						const uint8* s = src + xWeights[xIndexR].index;
-						const uint8* sBottom = s + srcBPR;
-						d[0] = (s[0] * wTop + sBottom[0] * wBottom) >> 8;
-						d[1] = (s[1] * wTop + sBottom[1] * wBottom) >> 8;
-						d[2] = (s[2] * wTop + sBottom[2] * wBottom) >> 8;
-					}
-
-					dst += dstBPR;
-				}
-
-				// last row of pixels if necessary
-				// buffer offset into source (bottom row)
-				register const uint8* src
-					= srcBuffer.row_ptr(yWeights[y2].index);
-				// buffer handle for destination to be incremented per pixel
-				register uint8* d = dst;
-
-				if (yMax < y2) {
-					for (int32 x = xIndexL; x <= xIndexMax; x++) {
-						const uint8* s = src + xWeights[x].index;
-						const uint16 wLeft = xWeights[x].weight;
-						const uint16 wRight = 255 - wLeft;
-						d[0] = (s[0] * wLeft + s[4] * wRight) >> 8;
-						d[1] = (s[1] * wLeft + s[5] * wRight) >> 8;
-						d[2] = (s[2] * wLeft + s[6] * wRight) >> 8;
-						d += 4;
-					}
-				}
-
-				// pixel in bottom right corner if necessary
-				if (yMax < y2 && xIndexMax < xIndexR) {
-					const uint8* s = src + xWeights[xIndexR].index;
-					*(uint32*)d = *(uint32*)s;
-				}
-				break;
-			}
-#endif	// __INTEL__
-		}
-	} while (fBaseRenderer.next_clip_box());
+	// iterate over clipping boxes, in bands in parallel if possible
+	BilinearScaleJob job(fBuffer, srcBuffer, xWeights, yWeights,
+		filterWeightXIndexOffset, filterWeightYIndexOffset, viewRect,
+		codeSelect);
+	RenderThreadPool::Default().Render(job, *fClippingRegion, viewRect);
 
 #ifdef FILTER_INFOS_ON_HEAP
 	delete[] xWeights;
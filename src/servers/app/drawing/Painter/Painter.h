@@ -261,7 +261,10 @@ private:
 									uint32 width, uint32 height,
 									uint32 sourceBytesPerRow,
 									sourcePixel transparentMagic,
-									BBitmap *output) const;
+									uint8* output,
+									uint32 outputBytesPerRow) const;
+			uint8*				_AllocateConversionBuffer(size_t size,
+									bool& _temporary) const;
 
 			void				_DrawBitmap(agg::rendering_buffer& srcBuffer,
 									color_space format,
@@ -369,6 +372,11 @@ private:
 
 			PatternHandler		fPatternHandler;
 
+	// bitmaps in other color spaces are converted to B_RGBA32 in here,
+	// unless they are too large to keep the buffer around
+	mutable	uint8*				fConversionBuffer;
+	mutable	size_t				fConversionBufferSize;
+
 	// a class handling rendering and caching of glyphs
 	// it is setup to load from a specific Freetype supported
 	// font file which it gets from ServerFont
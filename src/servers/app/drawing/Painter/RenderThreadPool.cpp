@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * A pool of worker threads shared by all Painters. Large drawing operations
+ * are split into horizontal bands, each of which is drawn with its own part
+ * of the clipping region, so that the bands can be drawn in parallel.
+ *
+ */
+
+#include "RenderThreadPool.h"
+
+#include <new>
+
+#include <Autolock.h>
+#include <Region.h>
+
+using std::nothrow;
+
+
+static const int32 kMaxThreadCount = 16;
+
+// Operations are only split into bands of at least this many rows and
+// pixels, so that smaller ones don't pay for the synchronization.
+static const int32 kMinBandHeight = 32;
+static const int32 kMinBandPixels = 32 * 1024;
+
+static RenderThreadPool sDefaultPool;
+
+
+RenderThreadPool::Job::~Job()
+{
+}
+
+
+// #pragma mark -
+
+
+// constructor
+RenderThreadPool::RenderThreadPool()
+	: fLock("render thread pool"),
+	  fStartSemaphore(-1),
+	  fDoneSemaphore(-1),
+	  fThreads(NULL),
+	  fThreadCount(1),
+
+	  fJob(NULL),
+	  fClipping(NULL),
+	  fArea(),
+	  fBandCount(0),
+	  fNextBand(0)
+{
+}
+
+// destructor
+RenderThreadPool::~RenderThreadPool()
+{
+	BAutolock _(fLock);
+	_StopThreads();
+}
+
+// Default
+RenderThreadPool&
+RenderThreadPool::Default()
+{
+	return sDefaultPool;
+}
+
+// SetThreadCount
+status_t
+RenderThreadPool::SetThreadCount(int32 count)
+{
+	if (count < 1)
+		count = 1;
+	else if (count > kMaxThreadCount)
+		count = kMaxThreadCount;
+
+	// waits until a job that is still being drawn is done
+	BAutolock _(fLock);
+
+	if (count == fThreadCount)
+		return B_OK;
+
+	_StopThreads();
+	if (count == 1)
+		return B_OK;
+
+	fThreads = new (nothrow) thread_id[count - 1];
+	fStartSemaphore = create_sem(0, "render start");
+	fDoneSemaphore = create_sem(0, "render done");
+	if (fThreads == NULL || fStartSemaphore < B_OK || fDoneSemaphore < B_OK) {
+		_StopThreads();
+		return B_NO_MEMORY;
+	}
+
+	for (int32 i = 0; i < count - 1; i++) {
+		fThreads[i] = spawn_thread(&_WorkerThread, "render worker",
+			B_DISPLAY_PRIORITY, this);
+		if (fThreads[i] < B_OK) {
+			status_t status = fThreads[i];
+			_StopThreads();
+			return status;
+		}
+
+		fThreadCount++;
+		resume_thread(fThreads[i]);
+	}
+
+	return B_OK;
+}
+
+// Render
+void
+RenderThreadPool::Render(Job& job, const BRegion& clipping, const BRect& area)
+{
+	BRect bounds = area & clipping.Frame();
+
+	// When another Painter is using the workers, we don't wait for them, but
+	// draw everything ourselves.
+	if (fLock.LockWithTimeout(0) == B_OK) {
+		int32 bandCount = _CountBands(bounds);
+		int32 helperCount = min_c(fThreadCount, bandCount) - 1;
+		if (helperCount > 0) {
+			fJob = &job;
+			fClipping = &clipping;
+			fArea = bounds;
+			fBandCount = bandCount;
+			fNextBand = 0;
+
+			release_sem_etc(fStartSemaphore, helperCount, 0);
+			_RenderBands();
+			acquire_sem_etc(fDoneSemaphore, helperCount, 0, 0);
+
+			fJob = NULL;
+			fClipping = NULL;
+			fLock.Unlock();
+			return;
+		}
+		fLock.Unlock();
+	}
+
+	job.Render(clipping);
+}
+
+// _CountBands
+int32
+RenderThreadPool::_CountBands(const BRect& area) const
+{
+	// the lock must be held, as the pool might be growing meanwhile
+	if (fThreadCount < 2 || !area.IsValid())
+		return 1;
+
+	int32 width = area.IntegerWidth() + 1;
+	int32 height = area.IntegerHeight() + 1;
+
+	// use more bands than threads, as the clipping region might not be
+	// spread evenly over them
+	int32 count = min_c(height / kMinBandHeight, fThreadCount * 2);
+	count = min_c(count, (int32)((int64)width * height / kMinBandPixels));
+
+	return max_c(count, 1);
+}
+
+// _RenderBands
+void
+RenderThreadPool::_RenderBands()
+{
+	int32 top = (int32)fArea.top;
+	int32 height = fArea.IntegerHeight() + 1;
+
+	while (true) {
+		int32 band = atomic_add(&fNextBand, 1);
+		if (band >= fBandCount)
+			break;
+
+		BRect bandRect(fArea.left, top + height * band / fBandCount,
+			fArea.right, top + height * (band + 1) / fBandCount - 1);
+
+		BRegion clipping(bandRect);
+		clipping.IntersectWith(fClipping);
+		if (clipping.CountRects() > 0)
+			fJob->Render(clipping);
+	}
+}
+
+// _StopThreads
+void
+RenderThreadPool::_StopThreads()
+{
+	// deleting the semaphore makes the workers quit
+	if (fStartSemaphore >= B_OK)
+		delete_sem(fStartSemaphore);
+
+	for (int32 i = 0; i < fThreadCount - 1; i++) {
+		status_t status;
+		wait_for_thread(fThreads[i], &status);
+	}
+
+	if (fDoneSemaphore >= B_OK)
+		delete_sem(fDoneSemaphore);
+
+	delete[] fThreads;
+	fThreads = NULL;
+	fStartSemaphore = -1;
+	fDoneSemaphore = -1;
+	fThreadCount = 1;
+}
+
+// _WorkerThread
+status_t
+RenderThreadPool::_WorkerThread(void* data)
+{
+	RenderThreadPool* pool = (RenderThreadPool*)data;
+
+	while (acquire_sem(pool->fStartSemaphore) == B_OK) {
+		pool->_RenderBands();
+		release_sem(pool->fDoneSemaphore);
+	}
+
+	return B_OK;
+}
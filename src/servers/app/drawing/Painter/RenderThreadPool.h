@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * A pool of worker threads shared by all Painters. Large drawing operations
+ * are split into horizontal bands, each of which is drawn with its own part
+ * of the clipping region, so that the bands can be drawn in parallel.
+ *
+ */
+
+#ifndef RENDER_THREAD_POOL_H
+#define RENDER_THREAD_POOL_H
+
+#include <Locker.h>
+#include <OS.h>
+#include <Rect.h>
+
+class BRegion;
+
+
+class RenderThreadPool {
+ public:
+	class Job {
+	 public:
+		virtual					~Job();
+
+								// Draws the part of the operation within
+								// the clipping region of one band. Can be
+								// called from several threads at once.
+		virtual	void			Render(const BRegion& clipping) = 0;
+	};
+
+								RenderThreadPool();
+								~RenderThreadPool();
+
+	static	RenderThreadPool&	Default();
+
+								// The number of threads drawing in parallel,
+								// including the one of the caller. With a
+								// count of 1, everything is drawn directly.
+			status_t			SetThreadCount(int32 count);
+			int32				ThreadCount() const
+									{ return fThreadCount; }
+
+								// Draws the job within the area. Returns
+								// when all bands have been drawn.
+			void				Render(Job& job, const BRegion& clipping,
+									const BRect& area);
+
+ private:
+			int32				_CountBands(const BRect& area) const;
+			void				_RenderBands();
+			void				_StopThreads();
+
+	static	status_t			_WorkerThread(void* data);
+
+			BLocker				fLock;
+			sem_id				fStartSemaphore;
+			sem_id				fDoneSemaphore;
+			thread_id*			fThreads;
+			int32				fThreadCount;
+
+			// the current job
+			Job*				fJob;
+			const BRegion*		fClipping;
+			BRect				fArea;
+			int32				fBandCount;
+			vint32				fNextBand;
+};
+
+#endif // RENDER_THREAD_POOL_H
@@ -0,0 +1,525 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the span blending functions of the most frequently used
+ * drawing modes on B_RGBA32. This file has to be compiled with -msse2.
+ *
+ * The blending is done for four pixels at once, using 16 bit arithmetic.
+ * BLEND and BLEND16 compute d + floor((s - d) * a), which is done here by
+ * adding the rounded down positive, and subtracting the rounded up negative
+ * part of the difference, so that the results are exactly the same.
+ *
+ */
+
+#include "DrawingModeSSE2.h"
+
+#include <string.h>
+
+#include <emmintrin.h>
+
+#include "DrawingMode.h"
+#include "PatternHandler.h"
+
+
+// select_pixels
+static inline __m128i
+select_pixels(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// blend_channels
+//
+// Computes d + floor((s - d) * a / 65536) for eight channels, where the
+// positive and negative parts of (s - d) are given separately.
+static inline __m128i
+blend_channels(__m128i dest, __m128i positive, __m128i negative, __m128i alpha)
+{
+	__m128i up = _mm_mulhi_epu16(positive, alpha);
+	__m128i down = _mm_mulhi_epu16(negative, alpha);
+
+	// round the negative part up, if anything was cut off
+	__m128i remainder = _mm_mullo_epi16(negative, alpha);
+	__m128i carry = _mm_andnot_si128(
+		_mm_cmpeq_epi16(remainder, _mm_setzero_si128()), _mm_set1_epi16(1));
+
+	return _mm_sub_epi16(_mm_sub_epi16(_mm_add_epi16(dest, up), down), carry);
+}
+
+// blend_pixels
+//
+// Blends four BGRA source pixels over four destination pixels, using the
+// alpha value in the lower 16 bits of each 32 bit lane of \a alpha, in the
+// range of BLEND16 (for BLEND, it must be shifted left by 8 bits).
+// Pixels with an alpha of zero are left untouched, the ones whose alpha
+// equals \a fullAlpha are replaced by the source. Like the scalar versions,
+// this sets the alpha channel of the changed pixels to 255.
+static inline __m128i
+blend_pixels(__m128i dest, __m128i source, __m128i alpha, __m128i fullAlpha)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+
+	__m128i isZero = _mm_cmpeq_epi32(alpha, zero);
+	__m128i isFull = _mm_cmpeq_epi32(alpha, fullAlpha);
+	if (_mm_movemask_epi8(isZero) == 0xffff)
+		return dest;
+	if (_mm_movemask_epi8(isFull) == 0xffff)
+		return _mm_or_si128(source, alphaMask);
+
+	__m128i positive = _mm_subs_epu8(source, dest);
+	__m128i negative = _mm_subs_epu8(dest, source);
+
+	// spread the alpha of each pixel over its channels
+	__m128i alphaLow = _mm_shuffle_epi32(_mm_unpacklo_epi16(alpha, alpha),
+		_MM_SHUFFLE(2, 2, 0, 0));
+	__m128i alphaHigh = _mm_shuffle_epi32(_mm_unpackhi_epi16(alpha, alpha),
+		_MM_SHUFFLE(2, 2, 0, 0));
+
+	__m128i low = blend_channels(_mm_unpacklo_epi8(dest, zero),
+		_mm_unpacklo_epi8(positive, zero), _mm_unpacklo_epi8(negative, zero),
+		alphaLow);
+	__m128i high = blend_channels(_mm_unpackhi_epi8(dest, zero),
+		_mm_unpackhi_epi8(positive, zero), _mm_unpackhi_epi8(negative, zero),
+		alphaHigh);
+
+	__m128i result = _mm_or_si128(_mm_packus_epi16(low, high), alphaMask);
+	result = select_pixels(isFull, _mm_or_si128(source, alphaMask), result);
+	return select_pixels(isZero, dest, result);
+}
+
+// load_covers
+//
+// Returns the four covers as 32 bit values.
+static inline __m128i
+load_covers(const uint8* covers)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 value;
+	memcpy(&value, covers, sizeof(value));
+
+	__m128i result = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+	return _mm_unpacklo_epi16(result, zero);
+}
+
+// load_colors
+//
+// Returns the four RGBA colors as BGRA pixels.
+static inline __m128i
+load_colors(const color_type* colors)
+{
+	const __m128i alphaGreenMask = _mm_set1_epi32((int)0xff00ff00);
+
+	__m128i rgba = _mm_loadu_si128((const __m128i*)colors);
+	__m128i redBlue = _mm_andnot_si128(alphaGreenMask, rgba);
+	redBlue = _mm_shufflelo_epi16(redBlue, _MM_SHUFFLE(2, 3, 0, 1));
+	redBlue = _mm_shufflehi_epi16(redBlue, _MM_SHUFFLE(2, 3, 0, 1));
+
+	return _mm_or_si128(_mm_and_si128(rgba, alphaGreenMask), redBlue);
+}
+
+// color_alphas
+static inline __m128i
+color_alphas(__m128i pixels)
+{
+	return _mm_srli_epi32(pixels, 24);
+}
+
+// solid_pixel
+static inline __m128i
+solid_pixel(const color_type& c)
+{
+	return _mm_set1_epi32((255 << 24) | (c.r << 16) | (c.g << 8) | c.b);
+}
+
+// divide_by_255
+//
+// Exact for values up to 255 * 255.
+static inline __m128i
+divide_by_255(__m128i value)
+{
+	__m128i sum = _mm_add_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)),
+		_mm_set1_epi16(1));
+	return _mm_srli_epi16(sum, 8);
+}
+
+
+// #pragma mark - blenders
+
+
+// All blenders return the result of blending four pixels. They get passed
+// the current four covers, and colors, if the span has any.
+
+
+// solid_blender
+//
+// Blends a single color with the covers multiplied by a constant factor.
+struct solid_blender {
+	solid_blender(const color_type& c, uint16 factor, uint16 fullAlpha)
+		:
+		color(solid_pixel(c)),
+		factor(_mm_set1_epi32(factor)),
+		fullAlpha(_mm_set1_epi32(fullAlpha))
+	{
+	}
+
+	inline __m128i Blend(__m128i dest, const uint8* covers,
+		const color_type* colors) const
+	{
+		__m128i alpha = _mm_mullo_epi16(load_covers(covers), factor);
+		return blend_pixels(dest, color, alpha, fullAlpha);
+	}
+
+	__m128i	color;
+	__m128i	factor;
+	__m128i	fullAlpha;
+};
+
+// color_alpha_blender
+//
+// Blends colors with their alpha multiplied by the covers.
+struct color_alpha_blender {
+	inline __m128i Blend(__m128i dest, const uint8* covers,
+		const color_type* colors) const
+	{
+		__m128i source = load_colors(colors);
+		__m128i alpha = _mm_mullo_epi16(color_alphas(source),
+			load_covers(covers));
+		return blend_pixels(dest, source, alpha, _mm_set1_epi32(255 * 255));
+	}
+};
+
+// color_scaled_alpha_blender
+//
+// Blends colors with their alpha multiplied by the covers, and the alpha
+// of the high color (as in B_CONSTANT_ALPHA).
+struct color_scaled_alpha_blender {
+	color_scaled_alpha_blender(uint8 highAlpha)
+		:
+		highAlpha(highAlpha)
+	{
+	}
+
+	inline __m128i Blend(__m128i dest, const uint8* covers,
+		const color_type* colors) const
+	{
+		__m128i alpha = _mm_set_epi32(
+			highAlpha * colors[3].a * covers[3] / 255,
+			highAlpha * colors[2].a * covers[2] / 255,
+			highAlpha * colors[1].a * covers[1] / 255,
+			highAlpha * colors[0].a * covers[0] / 255);
+		return blend_pixels(dest, load_colors(colors), alpha,
+			_mm_set1_epi32(255 * 255));
+	}
+
+	uint8	highAlpha;
+};
+
+// color_constant_blender
+//
+// Blends colors with a constant alpha.
+struct color_constant_blender {
+	color_constant_blender(uint16 alpha)
+		:
+		alpha(_mm_set1_epi32(alpha))
+	{
+	}
+
+	inline __m128i Blend(__m128i dest, const uint8* covers,
+		const color_type* colors) const
+	{
+		return blend_pixels(dest, load_colors(colors), alpha,
+			_mm_set1_epi32(255 * 255));
+	}
+
+	__m128i	alpha;
+};
+
+// composite_blender
+//
+// Composes colors over the destination as BLEND_COMPOSITE16 does. This is only
+// vectorized for opaque destination pixels, which are the usual case when
+// drawing on screen.
+struct composite_blender {
+	composite_blender(const uint8* covers, uint16 constantAlpha)
+		:
+		hasCovers(covers != NULL),
+		constantAlpha(constantAlpha)
+	{
+	}
+
+	inline __m128i Blend(__m128i dest, const uint8* covers,
+		const color_type* colors) const
+	{
+		const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+
+		__m128i source = load_colors(colors);
+		__m128i alpha = hasCovers
+			? _mm_mullo_epi16(color_alphas(source), load_covers(covers))
+			: _mm_set1_epi32(constantAlpha);
+
+		__m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(dest, alphaMask),
+			alphaMask);
+		if (_mm_movemask_epi8(opaque) == 0xffff) {
+			// BLEND_COMPOSITE16 reduces to BLEND with alpha / 255
+			return blend_pixels(dest, source,
+				_mm_slli_epi32(divide_by_255(alpha), 8),
+				_mm_set1_epi32(255 << 8));
+		}
+
+		uint16 alphas[8];
+		uint8 pixels[16];
+		_mm_storeu_si128((__m128i*)alphas, alpha);
+		_mm_storeu_si128((__m128i*)pixels, dest);
+
+		for (int i = 0; i < 4; i++) {
+			uint16 a = alphas[i * 2];
+			uint8* d = pixels + i * 4;
+			if (a == 255 * 255) {
+				d[0] = colors[i].b;
+				d[1] = colors[i].g;
+				d[2] = colors[i].r;
+				d[3] = 255;
+			} else if (a != 0)
+				BLEND_COMPOSITE16(d, colors[i].r, colors[i].g, colors[i].b, a);
+		}
+
+		return _mm_loadu_si128((const __m128i*)pixels);
+	}
+
+	bool	hasCovers;
+	uint16	constantAlpha;
+};
+
+
+// blend_span
+//
+// Runs the blender over the span, four pixels at a time. The remaining
+// pixels are blended in a copy padded to four pixels.
+template<typename Blender>
+static inline void
+blend_span(uint8* p, unsigned len, const uint8* covers,
+	const color_type* colors, const Blender& blender)
+{
+	for (; len >= 4; len -= 4) {
+		__m128i dest = _mm_loadu_si128((const __m128i*)p);
+		_mm_storeu_si128((__m128i*)p, blender.Blend(dest, covers, colors));
+
+		p += 16;
+		if (covers != NULL)
+			covers += 4;
+		if (colors != NULL)
+			colors += 4;
+	}
+
+	if (len == 0)
+		return;
+
+	uint8 dest[16] = {0};
+	uint8 tailCovers[4] = {0};
+	color_type tailColors[4];
+	memcpy(dest, p, len * 4);
+	if (covers != NULL)
+		memcpy(tailCovers, covers, len);
+	if (colors != NULL) {
+		for (unsigned i = 0; i < len; i++)
+			tailColors[i] = colors[i];
+	}
+
+	__m128i result = blender.Blend(_mm_loadu_si128((const __m128i*)dest),
+		covers != NULL ? tailCovers : NULL,
+		colors != NULL ? tailColors : NULL);
+	_mm_storeu_si128((__m128i*)dest, result);
+	memcpy(p, dest, len * 4);
+}
+
+// fill_span
+static inline void
+fill_span(uint8* p, unsigned len, const color_type& c)
+{
+	__m128i color = solid_pixel(c);
+	for (; len >= 4; len -= 4) {
+		_mm_storeu_si128((__m128i*)p, color);
+		p += 16;
+	}
+
+	uint32 value = _mm_cvtsi128_si32(color);
+	for (; len > 0; len--) {
+		memcpy(p, &value, 4);
+		p += 4;
+	}
+}
+
+// blend_hline_solid
+//
+// The equivalent of the scalar blend_hline_alpha_*_solid() versions, that
+// use blend_line32() for longer spans.
+static inline void
+blend_hline_solid(uint8* p, unsigned len, const color_type& c, uint16 alpha)
+{
+	if (alpha == 255 * 255) {
+		fill_span(p, len, c);
+		return;
+	}
+
+	if (len < 4) {
+		do {
+			BLEND16(p, c.r, c.g, c.b, alpha);
+			p += 4;
+		} while (--len);
+		return;
+	}
+
+	// like blend_line32(), premultiply the color, and scale the destination
+	uint8 a = alpha >> 8;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+	__m128i color = _mm_set_epi16(0, (c.r * a) >> 8, (c.g * a) >> 8,
+		(c.b * a) >> 8, 0, (c.r * a) >> 8, (c.g * a) >> 8, (c.b * a) >> 8);
+	__m128i rest = _mm_set1_epi16(255 - a);
+
+	uint8 tail[16] = {0};
+	while (len > 0) {
+		unsigned count = len < 4 ? len : 4;
+		uint8* target = p;
+		if (count < 4) {
+			memcpy(tail, p, count * 4);
+			target = tail;
+		}
+
+		__m128i dest = _mm_loadu_si128((const __m128i*)target);
+		__m128i low = _mm_add_epi16(_mm_srli_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(dest, zero), rest), 8), color);
+		__m128i high = _mm_add_epi16(_mm_srli_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(dest, zero), rest), 8), color);
+		_mm_storeu_si128((__m128i*)target,
+			_mm_or_si128(_mm_packus_epi16(low, high), alphaMask));
+
+		if (count < 4)
+			memcpy(p, tail, count * 4);
+
+		p += count * 4;
+		len -= count;
+	}
+}
+
+
+// #pragma mark - drawing modes
+
+
+// blend_hline_alpha_co_solid_sse2
+void
+blend_hline_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_solid(buffer->row_ptr(y) + (x << 2), len, c,
+		pattern->HighColor().alpha * cover);
+}
+
+// blend_hline_alpha_po_solid_sse2
+void
+blend_hline_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_solid(buffer->row_ptr(y) + (x << 2), len, c, c.a * cover);
+}
+
+// blend_solid_hspan_copy_solid_sse2
+void
+blend_solid_hspan_copy_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_span(buffer->row_ptr(y) + (x << 2), len, covers, NULL,
+		solid_blender(c, 256, 255 << 8));
+}
+
+// blend_solid_hspan_over_solid_sse2
+void
+blend_solid_hspan_over_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	blend_span(buffer->row_ptr(y) + (x << 2), len, covers, NULL,
+		solid_blender(c, 256, 255 << 8));
+}
+
+// blend_solid_hspan_alpha_co_solid_sse2
+void
+blend_solid_hspan_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_span(buffer->row_ptr(y) + (x << 2), len, covers, NULL,
+		solid_blender(c, pattern->HighColor().alpha, 255 * 255));
+}
+
+// blend_solid_hspan_alpha_po_solid_sse2
+void
+blend_solid_hspan_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_span(buffer->row_ptr(y) + (x << 2), len, covers, NULL,
+		solid_blender(c, c.a, 255 * 255));
+}
+
+// blend_color_hspan_alpha_co_sse2
+void
+blend_color_hspan_alpha_co_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	uint8 hAlpha = pattern->HighColor().alpha;
+
+	if (covers == NULL) {
+		// like the scalar version, use the alpha of the first color only
+		uint16 alpha = hAlpha * colors->a * cover / 255;
+		if (alpha != 0)
+			blend_span(p, len, NULL, colors, color_constant_blender(alpha));
+	} else if (hAlpha == 255)
+		blend_span(p, len, covers, colors, color_alpha_blender());
+	else {
+		blend_span(p, len, covers, colors,
+			color_scaled_alpha_blender(hAlpha));
+	}
+}
+
+// blend_color_hspan_alpha_po_sse2
+void
+blend_color_hspan_alpha_po_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+
+	if (covers == NULL) {
+		// like the scalar version, use the alpha of the first color only
+		uint16 alpha = colors->a * cover;
+		if (alpha != 0)
+			blend_span(p, len, NULL, colors, color_constant_blender(alpha));
+	} else
+		blend_span(p, len, covers, colors, color_alpha_blender());
+}
+
+// blend_color_hspan_alpha_pc_sse2
+void
+blend_color_hspan_alpha_pc_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint16 alpha = covers == NULL ? colors->a * cover : 0;
+	if (covers == NULL && alpha == 0)
+		return;
+
+	blend_span(buffer->row_ptr(y) + (x << 2), len, covers, colors,
+		composite_blender(covers, alpha));
+}
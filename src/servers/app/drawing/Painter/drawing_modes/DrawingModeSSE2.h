@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the span blending functions of the most frequently used
+ * drawing modes on B_RGBA32. PixelFormat uses them instead of the scalar
+ * versions when the CPU supports SSE2. They produce the same results.
+ *
+ */
+
+#ifndef DRAWING_MODE_SSE2_H
+#define DRAWING_MODE_SSE2_H
+
+#include "PixelFormat.h"
+
+typedef PixelFormat::color_type		color_type;
+typedef PixelFormat::agg_buffer		agg_buffer;
+
+
+void blend_hline_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_hline_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+
+void blend_solid_hspan_copy_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_over_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+
+void blend_color_hspan_alpha_co_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern);
+void blend_color_hspan_alpha_po_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern);
+void blend_color_hspan_alpha_pc_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern);
+
+#endif // DRAWING_MODE_SSE2_H
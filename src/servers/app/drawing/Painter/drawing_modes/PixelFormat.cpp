@@ -55,6 +55,11 @@
 #include "DrawingModeSelectSUBPIX.h"
 #include "DrawingModeSubtractSUBPIX.h"
 
+#ifdef PAINTER_SSE2_BLENDERS
+#	include "DrawingModeSSE2.h"
+#endif
+
+#include "AppServer.h"
 #include "PatternHandler.h"
 
 // blend_pixel_empty
@@ -342,4 +347,40 @@ fprintf(stderr, "PixelFormat::SetDrawingMode() - drawing_mode not implemented\n"
 //			return fDrawingModeBGRA32Copy;
 			break;
 	}
+
+	_UseSIMDBlenders();
+}
+
+// _UseSIMDBlenders
+//
+// Replaces the blending functions chosen above by SIMD versions, if there are
+// any for them, and the CPU supports them. They produce the same results.
+void
+PixelFormat::_UseSIMDBlenders()
+{
+#ifdef PAINTER_SSE2_BLENDERS
+	if ((gAppServerSIMDFlags & APPSERVER_SIMD_SSE2) == 0)
+		return;
+
+	if (fBlendHLine == blend_hline_alpha_co_solid)
+		fBlendHLine = blend_hline_alpha_co_solid_sse2;
+	else if (fBlendHLine == blend_hline_alpha_po_solid)
+		fBlendHLine = blend_hline_alpha_po_solid_sse2;
+
+	if (fBlendSolidHSpan == blend_solid_hspan_copy_solid)
+		fBlendSolidHSpan = blend_solid_hspan_copy_solid_sse2;
+	else if (fBlendSolidHSpan == blend_solid_hspan_over_solid)
+		fBlendSolidHSpan = blend_solid_hspan_over_solid_sse2;
+	else if (fBlendSolidHSpan == blend_solid_hspan_alpha_co_solid)
+		fBlendSolidHSpan = blend_solid_hspan_alpha_co_solid_sse2;
+	else if (fBlendSolidHSpan == blend_solid_hspan_alpha_po_solid)
+		fBlendSolidHSpan = blend_solid_hspan_alpha_po_solid_sse2;
+
+	if (fBlendColorHSpan == blend_color_hspan_alpha_co)
+		fBlendColorHSpan = blend_color_hspan_alpha_co_sse2;
+	else if (fBlendColorHSpan == blend_color_hspan_alpha_po)
+		fBlendColorHSpan = blend_color_hspan_alpha_po_sse2;
+	else if (fBlendColorHSpan == blend_color_hspan_alpha_pc)
+		fBlendColorHSpan = blend_color_hspan_alpha_pc_sse2;
+#endif
 }
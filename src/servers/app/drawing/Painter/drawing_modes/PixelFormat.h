@@ -138,6 +138,8 @@ class PixelFormat {
 												  uint8 cover);
 
  private:
+			void				_UseSIMDBlenders();
+
 	agg::rendering_buffer*		fBuffer;
 	const PatternHandler*		fPatternHandler;
 	bool						fUsesOpCopyForText;
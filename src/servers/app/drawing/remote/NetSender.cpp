@@ -20,6 +20,11 @@
 #define TRACE_ERROR(x...)	debug_printf("NetSender: "x)
 
 
+// Everything that has been queued up since the last send goes out at once,
+// so that the many small drawing messages are not sent one by one.
+static const size_t kSendBufferSize = 64 * 1024;
+
+
 NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source)
 	:
 	fEndpoint(endpoint),
@@ -51,25 +56,38 @@ NetSender::_NetworkSenderEntry(void *data)
 status_t
 NetSender::_NetworkSender()
 {
+	uint8* buffer = (uint8*)malloc(kSendBufferSize);
+	if (buffer == NULL) {
+		TRACE_ERROR("no memory for the send buffer\n");
+		return B_NO_MEMORY;
+	}
+
+	status_t result = B_OK;
 	while (!fStopThread) {
-		uint8 buffer[4096];
-		int32 readSize = fSource->Read(buffer, sizeof(buffer), true);
+		int32 readSize = fSource->Read(buffer, kSendBufferSize, true);
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, stopping sender thread: %s\n",
 				strerror(readSize));
-			return readSize;
+			result = readSize;
+			break;
 		}
 
-		while (readSize > 0) {
-			int32 sendSize = fEndpoint->Send(buffer, readSize);
+		int32 sent = 0;
+		while (sent < readSize) {
+			int32 sendSize = fEndpoint->Send(buffer + sent, readSize - sent);
 			if (sendSize < 0) {
 				TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
-				return sendSize;
+				result = sendSize;
+				break;
 			}
 
-			readSize -= sendSize;
+			sent += sendSize;
 		}
+
+		if (result != B_OK)
+			break;
 	}
 
-	return B_OK;
+	free(buffer);
+	return result;
 }
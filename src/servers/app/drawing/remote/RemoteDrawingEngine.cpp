@@ -8,6 +8,7 @@
 
 #include "RemoteDrawingEngine.h"
 #include "RemoteMessage.h"
+#include "RemoteTileCache.h"
 
 #include "BitmapDrawingEngine.h"
 #include "DrawState.h"
@@ -339,6 +340,11 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 			return;
 		}
 
+		// the tile slots must reach the remote side in the order in which
+		// they were assigned, so the cache stays locked until the flush
+		RemoteTileCache* tileCache = fHWInterface->TileCache();
+		tileCache->Lock();
+
 		RemoteMessage message(NULL, fHWInterface->SendBuffer());
 		message.Start(RP_DRAW_BITMAP_RECTS);
 		message.Add(fToken);
@@ -349,22 +355,30 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 
 		for (int32 i = 0; i < rectCount; i++) {
 			message.Add(clippedRegion.RectAt(i));
-			message.AddBitmap(*bitmaps[i], true);
+			message.AddBitmap(*bitmaps[i], true, tileCache);
 			delete bitmaps[i];
 		}
 
+		message.Flush();
+		tileCache->Unlock();
+
 		free(bitmaps);
 		return;
 	}
 
-	// TODO: we may want to cache/checksum bitmaps
+	RemoteTileCache* tileCache = fHWInterface->TileCache();
+	tileCache->Lock();
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_DRAW_BITMAP);
 	message.Add(fToken);
 	message.Add(bitmapRect);
 	message.Add(viewRect);
 	message.Add(options);
-	message.AddBitmap(*bitmap);
+	message.AddBitmap(*bitmap, false, tileCache);
+	message.Flush();
+
+	tileCache->Unlock();
 }
 
 
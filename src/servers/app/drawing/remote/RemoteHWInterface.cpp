@@ -10,6 +10,7 @@
 #include "RemoteDrawingEngine.h"
 #include "RemoteEventStream.h"
 #include "RemoteMessage.h"
+#include "RemoteTileCache.h"
 
 #include "NetReceiver.h"
 #include "NetSender.h"
@@ -41,7 +42,7 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	fRemoteHost(NULL),
 	fRemotePort(10900),
 	fIsConnected(false),
-	fProtocolVersion(100),
+	fProtocolVersion(kRemoteProtocolVersion),
 	fConnectionSpeed(0),
 	fListenPort(10901),
 	fSendEndpoint(NULL),
@@ -50,6 +51,7 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	fReceiveBuffer(NULL),
 	fSender(NULL),
 	fReceiver(NULL),
+	fTileCache(NULL),
 	fEventThread(-1),
 	fEventStream(NULL),
 	fCallbackLocker("callback locker")
@@ -87,7 +89,7 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	if (fInitStatus != B_OK)
 		return;
 
-	fSendBuffer = new(std::nothrow) StreamingRingBuffer(16 * 1024);
+	fSendBuffer = new(std::nothrow) StreamingRingBuffer(128 * 1024);
 	if (fSendBuffer == NULL) {
 		fInitStatus = B_NO_MEMORY;
 		return;
@@ -119,6 +121,12 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 		return;
 	}
 
+	fTileCache = new(std::nothrow) RemoteTileCache();
+	if (fTileCache == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		return;
+	}
+
 	fEventStream = new(std::nothrow) RemoteEventStream();
 	if (fEventStream == NULL) {
 		fInitStatus = B_NO_MEMORY;
@@ -148,6 +156,7 @@ RemoteHWInterface::~RemoteHWInterface()
 
 	delete fSendBuffer;
 	delete fSender;
+	delete fTileCache;
 
 	delete fReceiveEndpoint;
 	delete fSendEndpoint;
@@ -311,6 +320,7 @@ RemoteHWInterface::_Connect()
 	RemoteMessage message(fReceiveBuffer, fSendBuffer);
 	message.Start(RP_INIT_CONNECTION);
 	message.Add(fListenPort);
+	message.Add(fProtocolVersion);
 	result = message.Flush();
 	if (result != B_OK) {
 		TRACE_ERROR("failed to send init connection message\n");
@@ -19,6 +19,7 @@ class NetSender;
 class NetReceiver;
 class RemoteEventStream;
 class RemoteMessage;
+class RemoteTileCache;
 
 struct callback_info;
 
@@ -80,6 +81,7 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 		// drawing engine interface
 		StreamingRingBuffer*		ReceiveBuffer() { return fReceiveBuffer; }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer; }
+		RemoteTileCache*			TileCache() { return fTileCache; }
 
 		status_t					AddCallback(uint32 token,
 										CallbackFunction callback,
@@ -117,6 +119,8 @@ static	int32						_EventThreadEntry(void* data);
 		NetSender*					fSender;
 		NetReceiver*				fReceiver;
 
+		RemoteTileCache*			fTileCache;
+
 		thread_id					fEventThread;
 		RemoteEventStream*			fEventStream;
 
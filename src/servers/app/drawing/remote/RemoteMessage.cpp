@@ -7,6 +7,7 @@
  */
 
 #include "RemoteMessage.h"
+#include "RemoteTileCache.h"
 
 #ifndef CLIENT_COMPILE
 #include "DrawState.h"
@@ -64,9 +65,93 @@ RemoteMessage::Cancel()
 }
 
 
+/*!	Adds the bits of a bitmap, either as they are, or split into tiles when
+	a \a tileCache is given and the bitmap is large enough for that to pay off.
+	The tile cache must stay locked until the message has been flushed.
+*/
+void
+RemoteMessage::_AddBitmapBits(const uint8* bits, int32 width, int32 height,
+	int32 bytesPerRow, color_space colorSpace, uint32 bitsLength,
+	RemoteTileCache* tileCache)
+{
+	bool useTiles = tileCache != NULL && bitsLength >= kRemoteTileMinBitsLength
+		&& (colorSpace == B_RGB32 || colorSpace == B_RGBA32
+			|| colorSpace == B_RGB32_BIG || colorSpace == B_RGBA32_BIG)
+		&& bytesPerRow >= width * 4;
+
+	if (!useTiles) {
+		Add((uint8)RP_BITMAP_RAW);
+		Add(bitsLength);
+
+		if (!_MakeSpace(bitsLength))
+			return;
+
+		memcpy(fBuffer + fWriteIndex, bits, bitsLength);
+		fWriteIndex += bitsLength;
+		fAvailable -= bitsLength;
+		return;
+	}
+
+	Add((uint8)RP_BITMAP_TILES);
+
+	for (int32 y = 0; y < height; y += kRemoteTileSize) {
+		int32 tileHeight = min_c(kRemoteTileSize, height - y);
+		for (int32 x = 0; x < width; x += kRemoteTileSize) {
+			_AddTile(bits + y * bytesPerRow + x * 4, bytesPerRow,
+				min_c(kRemoteTileSize, width - x), tileHeight, *tileCache);
+		}
+	}
+}
+
+
+void
+RemoteMessage::_AddTile(const uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height, RemoteTileCache& tileCache)
+{
+	uint64 hash = remote_tile_hash(bits, bytesPerRow, width, height);
+
+	uint16 slot;
+	if (tileCache.Lookup(hash, slot)) {
+		Add((uint8)RP_TILE_CACHED);
+		Add(slot);
+		return;
+	}
+
+	static const size_t kTileHeaderSize
+		= sizeof(uint8) + sizeof(uint16) + sizeof(uint32);
+	if (!_MakeSpace(kTileHeaderSize + kRemoteTileMaxCompressedSize))
+		return;
+
+	// only claim a slot once the tile is certain to be sent
+	slot = tileCache.Allocate(hash);
+
+	uint8* header = fBuffer + fWriteIndex;
+	uint8* data = header + kTileHeaderSize;
+	uint32 rawLength = width * height * 4;
+	uint32 length = remote_tile_compress(bits, bytesPerRow, width, height,
+		data);
+
+	uint8 type = RP_TILE_RLE;
+	if (length >= rawLength) {
+		type = RP_TILE_RAW;
+		length = rawLength;
+		for (int32 y = 0; y < height; y++)
+			memcpy(data + y * width * 4, bits + y * bytesPerRow, width * 4);
+	}
+
+	header[0] = type;
+	memcpy(header + sizeof(uint8), &slot, sizeof(uint16));
+	memcpy(header + sizeof(uint8) + sizeof(uint16), &length, sizeof(uint32));
+
+	fWriteIndex += kTileHeaderSize + length;
+	fAvailable -= kTileHeaderSize + length;
+}
+
+
 #ifndef CLIENT_COMPILE
 void
-RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
+RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal,
+	RemoteTileCache* tileCache)
 {
 	Add(bitmap.Width());
 	Add(bitmap.Height());
@@ -77,15 +162,9 @@ RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
 		Add(bitmap.Flags());
 	}
 
-	uint32 bitsLength = bitmap.BitsLength();
-	Add(bitsLength);
-
-	if (!_MakeSpace(bitsLength))
-		return;
-
-	memcpy(fBuffer + fWriteIndex, bitmap.Bits(), bitsLength);
-	fWriteIndex += bitsLength;
-	fAvailable -= bitsLength;
+	_AddBitmapBits(bitmap.Bits(), bitmap.Width(), bitmap.Height(),
+		bitmap.BytesPerRow(), bitmap.ColorSpace(), bitmap.BitsLength(),
+		tileCache);
 }
 
 
@@ -148,7 +227,7 @@ RemoteMessage::AddPattern(const Pattern& pattern)
 #else // !CLIENT_COMPILE
 
 void
-RemoteMessage::AddBitmap(const BBitmap& bitmap)
+RemoteMessage::AddBitmap(const BBitmap& bitmap, RemoteTileCache* tileCache)
 {
 	BRect bounds = bitmap.Bounds();
 	Add(bounds.IntegerWidth() + 1);
@@ -157,15 +236,9 @@ RemoteMessage::AddBitmap(const BBitmap& bitmap)
 	Add(bitmap.ColorSpace());
 	Add(bitmap.Flags());
 
-	uint32 bitsLength = bitmap.BitsLength();
-	Add(bitsLength);
-
-	if (!_MakeSpace(bitsLength))
-		return;
-
-	memcpy(fBuffer + fWriteIndex, bitmap.Bits(), bitsLength);
-	fWriteIndex += bitsLength;
-	fAvailable -= bitsLength;
+	_AddBitmapBits((const uint8*)bitmap.Bits(), bounds.IntegerWidth() + 1,
+		bounds.IntegerHeight() + 1, bitmap.BytesPerRow(), bitmap.ColorSpace(),
+		bitmap.BitsLength(), tileCache);
 }
 #endif // !CLIENT_COMPILE
 
@@ -291,10 +364,11 @@ RemoteMessage::ReadString(char** _string, size_t& _length)
 
 status_t
 RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
-	color_space colorSpace, uint32 flags)
+	color_space colorSpace, uint32 flags, RemoteTileStore* tileStore)
 {
-	uint32 bitsLength;
+	uint32 bitsLength = 0;
 	int32 width, height, bytesPerRow;
+	uint8 encoding;
 
 	Read(width);
 	Read(height);
@@ -305,9 +379,16 @@ RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
 		Read(flags);
 	}
 
-	Read(bitsLength);
+	status_t result = Read(encoding);
+	if (result != B_OK)
+		return result;
 
-	if (bitsLength > fDataLeft)
+	if (encoding == RP_BITMAP_RAW) {
+		Read(bitsLength);
+		if (bitsLength > fDataLeft)
+			return B_ERROR;
+	} else if (encoding != RP_BITMAP_TILES || tileStore == NULL
+		|| bytesPerRow < width * 4)
 		return B_ERROR;
 
 #ifndef CLIENT_COMPILE
@@ -319,12 +400,23 @@ RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
 	if (bitmap == NULL)
 		return B_NO_MEMORY;
 
-	status_t result = bitmap->InitCheck();
+	result = bitmap->InitCheck();
 	if (result != B_OK) {
 		delete bitmap;
 		return result;
 	}
 
+	if (encoding == RP_BITMAP_TILES) {
+		result = _ReadTiles(bitmap, *tileStore);
+		if (result != B_OK) {
+			delete bitmap;
+			return result;
+		}
+
+		*_bitmap = bitmap;
+		return B_OK;
+	}
+
 	if (bitmap->BitsLength() < (int32)bitsLength) {
 		delete bitmap;
 		return B_ERROR;
@@ -342,6 +434,107 @@ RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
 }
 
 
+status_t
+RemoteMessage::_ReadData(void* buffer, size_t size)
+{
+	if (size > fDataLeft)
+		return B_ERROR;
+
+	int32 readSize = fSource->Read(buffer, size);
+	if ((size_t)readSize != size)
+		return readSize < 0 ? readSize : B_ERROR;
+
+	fDataLeft -= readSize;
+	return B_OK;
+}
+
+
+/*!	Reads the tiles of a bitmap, and updates the \a tileStore with the tiles
+	that were sent along.
+*/
+status_t
+RemoteMessage::_ReadTiles(BBitmap* bitmap, RemoteTileStore& tileStore)
+{
+	BRect bounds = bitmap->Bounds();
+	int32 width = bounds.IntegerWidth() + 1;
+	int32 height = bounds.IntegerHeight() + 1;
+	int32 bytesPerRow = bitmap->BytesPerRow();
+	uint8* bits = (uint8*)bitmap->Bits();
+
+	static const int32 kTileBytesPerRow = kRemoteTileSize * 4;
+	uint8* compressed = NULL;
+
+	status_t result = B_OK;
+	for (int32 y = 0; y < height && result == B_OK; y += kRemoteTileSize) {
+		int32 tileHeight = min_c(kRemoteTileSize, height - y);
+		for (int32 x = 0; x < width; x += kRemoteTileSize) {
+			int32 tileWidth = min_c(kRemoteTileSize, width - x);
+
+			uint8 type;
+			uint16 slot;
+			Read(type);
+			result = Read(slot);
+			if (result != B_OK)
+				break;
+
+			uint8* tile = tileStore.TileAt(slot);
+			if (tile == NULL) {
+				result = B_NO_MEMORY;
+				break;
+			}
+
+			if (type != RP_TILE_CACHED) {
+				uint32 length;
+				result = Read(length);
+				if (result != B_OK)
+					break;
+
+				if (type == RP_TILE_RAW) {
+					if (length != (uint32)tileWidth * tileHeight * 4) {
+						result = B_BAD_DATA;
+						break;
+					}
+
+					for (int32 row = 0; row < tileHeight
+							&& result == B_OK; row++) {
+						result = _ReadData(tile + row * kTileBytesPerRow,
+							tileWidth * 4);
+					}
+				} else if (type == RP_TILE_RLE
+					&& length <= kRemoteTileMaxCompressedSize) {
+					if (compressed == NULL) {
+						compressed
+							= (uint8*)malloc(kRemoteTileMaxCompressedSize);
+						if (compressed == NULL) {
+							result = B_NO_MEMORY;
+							break;
+						}
+					}
+
+					result = _ReadData(compressed, length);
+					if (result == B_OK) {
+						result = remote_tile_decompress(compressed, length,
+							tile, kTileBytesPerRow, tileWidth, tileHeight);
+					}
+				} else
+					result = B_BAD_DATA;
+
+				if (result != B_OK)
+					break;
+			}
+
+			for (int32 row = 0; row < tileHeight; row++) {
+				memcpy(bits + (y + row) * bytesPerRow + x * 4,
+					tile + row * kTileBytesPerRow, tileWidth * 4);
+			}
+		}
+	}
+
+	free(compressed);
+	return result;
+}
+
+
 status_t
 RemoteMessage::ReadFontState(BFont& font)
 {
@@ -29,11 +29,16 @@ class BView;
 class DrawState;
 class Pattern;
 class RemotePainter;
+class RemoteTileCache;
+class RemoteTileStore;
 class ServerBitmap;
 class ServerCursor;
 class ServerFont;
 class ViewLineArrayInfo;
 
+// sent with RP_INIT_CONNECTION, both sides must use the same version
+static const uint32 kRemoteProtocolVersion = 101;
+
 enum {
 	RP_INIT_CONNECTION = 1,
 	RP_UPDATE_DISPLAY_MODE,
@@ -148,14 +153,16 @@ public:
 
 #ifndef CLIENT_COMPILE
 		void					AddBitmap(const ServerBitmap& bitmap,
-									bool minimal = false);
+									bool minimal = false,
+									RemoteTileCache* tileCache = NULL);
 		void					AddFont(const ServerFont& font);
 		void					AddPattern(const Pattern& pattern);
 		void					AddDrawState(const DrawState& drawState);
 		void					AddArrayLine(const ViewLineArrayInfo& line);
 		void					AddCursor(const ServerCursor& cursor);
 #else
-		void					AddBitmap(const BBitmap& bitmap);
+		void					AddBitmap(const BBitmap& bitmap,
+									RemoteTileCache* tileCache = NULL);
 #endif
 
 		template<typename T>
@@ -174,7 +181,8 @@ public:
 		status_t				ReadBitmap(BBitmap** _bitmap,
 									bool minimal = false,
 									color_space colorSpace = B_RGB32,
-									uint32 flags = 0);
+									uint32 flags = 0,
+									RemoteTileStore* tileStore = NULL);
 		status_t				ReadGradient(BGradient** _gradient);
 		status_t				ReadArrayLine(BPoint& startPoint,
 									BPoint& endPoint, rgb_color& color);
@@ -185,6 +193,18 @@ public:
 private:
 		bool					_MakeSpace(size_t size);
 
+		void					_AddBitmapBits(const uint8* bits,
+									int32 width, int32 height,
+									int32 bytesPerRow, color_space colorSpace,
+									uint32 bitsLength,
+									RemoteTileCache* tileCache);
+		void					_AddTile(const uint8* bits,
+									int32 bytesPerRow, int32 width,
+									int32 height, RemoteTileCache& tileCache);
+		status_t				_ReadData(void* buffer, size_t size);
+		status_t				_ReadTiles(BBitmap* bitmap,
+									RemoteTileStore& tileStore);
+
 		StreamingRingBuffer*	fSource;
 		StreamingRingBuffer*	fTarget;
 
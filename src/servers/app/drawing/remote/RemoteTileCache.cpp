@@ -0,0 +1,319 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "RemoteTileCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// The tiles are compressed as a sequence of operations, each starting with a
+// byte that holds the operation in the upper two bits, and the number of
+// pixels it produces minus one in the lower six bits.
+enum {
+	TILE_OP_LITERAL = 0,	// the pixels follow
+	TILE_OP_RUN,			// one pixel follows, and is repeated
+	TILE_OP_ABOVE,			// the pixels are the same as in the row above
+	TILE_OP_REPEAT			// the previous pixel is repeated
+};
+
+static const int32 kMaxOpLength = 64;
+
+
+static inline uint8*
+add_op(uint8* output, int32 op, int32 length)
+{
+	*output++ = (uint8)((op << 6) | (length - 1));
+	return output;
+}
+
+
+static inline uint8*
+add_literals(uint8* output, const uint32* pixels, int32 length)
+{
+	if (length == 0)
+		return output;
+
+	output = add_op(output, TILE_OP_LITERAL, length);
+	memcpy(output, pixels, length * 4);
+	return output + length * 4;
+}
+
+
+uint64
+remote_tile_hash(const uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height)
+{
+	// FNV-1a, on whole pixels
+	uint64 hash = 14695981039346656037ULL;
+	hash = (hash ^ (uint32)((width << 16) | height)) * 1099511628211ULL;
+
+	for (int32 y = 0; y < height; y++) {
+		const uint32* row = (const uint32*)(bits + y * bytesPerRow);
+		for (int32 x = 0; x < width; x++)
+			hash = (hash ^ row[x]) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+
+/*!	Compresses the tile into \a output, which must be able to hold
+	kRemoteTileMaxCompressedSize bytes. Returns the compressed size.
+*/
+size_t
+remote_tile_compress(const uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height, uint8* output)
+{
+	uint32 pixels[kRemoteTileSize * kRemoteTileSize];
+	for (int32 y = 0; y < height; y++)
+		memcpy(pixels + y * width, bits + y * bytesPerRow, width * 4);
+
+	uint8* start = output;
+	int32 count = width * height;
+	int32 literalStart = 0;
+	int32 i = 0;
+
+	while (i < count) {
+		int32 maxLength = min_c(count - i, kMaxOpLength);
+
+		int32 repeat = 0;
+		if (i > 0) {
+			while (repeat < maxLength && pixels[i + repeat] == pixels[i - 1])
+				repeat++;
+		}
+
+		int32 above = 0;
+		if (i >= width) {
+			while (above < maxLength
+				&& pixels[i + above] == pixels[i + above - width])
+				above++;
+		}
+
+		int32 run = 1;
+		while (run < maxLength && pixels[i + run] == pixels[i])
+			run++;
+
+		// prefer the operations without any pixel data
+		int32 op = TILE_OP_REPEAT;
+		int32 length = repeat;
+		if (above > length) {
+			op = TILE_OP_ABOVE;
+			length = above;
+		}
+		if (run > length) {
+			op = TILE_OP_RUN;
+			length = run;
+		}
+
+		if (length < 2) {
+			// not worth an operation of its own
+			i++;
+			if (i - literalStart == kMaxOpLength) {
+				output = add_literals(output, pixels + literalStart,
+					kMaxOpLength);
+				literalStart = i;
+			}
+			continue;
+		}
+
+		output = add_literals(output, pixels + literalStart, i - literalStart);
+		output = add_op(output, op, length);
+		if (op == TILE_OP_RUN) {
+			memcpy(output, &pixels[i], 4);
+			output += 4;
+		}
+
+		i += length;
+		literalStart = i;
+	}
+
+	output = add_literals(output, pixels + literalStart, i - literalStart);
+	return output - start;
+}
+
+
+status_t
+remote_tile_decompress(const uint8* data, size_t size, uint8* bits,
+	int32 bytesPerRow, int32 width, int32 height)
+{
+	uint32 pixels[kRemoteTileSize * kRemoteTileSize];
+	const uint8* end = data + size;
+	int32 count = width * height;
+	int32 i = 0;
+
+	while (i < count) {
+		if (data >= end)
+			return B_BAD_DATA;
+
+		int32 op = *data >> 6;
+		int32 length = (*data & 0x3f) + 1;
+		data++;
+
+		if (i + length > count)
+			return B_BAD_DATA;
+
+		switch (op) {
+			case TILE_OP_LITERAL:
+				if (end - data < length * 4)
+					return B_BAD_DATA;
+				memcpy(&pixels[i], data, length * 4);
+				data += length * 4;
+				break;
+
+			case TILE_OP_RUN:
+			{
+				if (end - data < 4)
+					return B_BAD_DATA;
+				uint32 pixel;
+				memcpy(&pixel, data, 4);
+				data += 4;
+				for (int32 k = 0; k < length; k++)
+					pixels[i + k] = pixel;
+				break;
+			}
+
+			case TILE_OP_ABOVE:
+				if (i < width)
+					return B_BAD_DATA;
+				for (int32 k = 0; k < length; k++)
+					pixels[i + k] = pixels[i + k - width];
+				break;
+
+			case TILE_OP_REPEAT:
+				if (i == 0)
+					return B_BAD_DATA;
+				for (int32 k = 0; k < length; k++)
+					pixels[i + k] = pixels[i - 1];
+				break;
+		}
+
+		i += length;
+	}
+
+	for (int32 y = 0; y < height; y++)
+		memcpy(bits + y * bytesPerRow, pixels + y * width, width * 4);
+
+	return B_OK;
+}
+
+
+// #pragma mark - RemoteTileCache
+
+
+RemoteTileCache::RemoteTileCache()
+	:
+	fLock("remote tile cache"),
+	fClockHand(0)
+{
+	for (int32 i = 0; i < kRemoteTileSlotCount; i++) {
+		fSlots[i].used = false;
+		fSlots[i].referenced = false;
+		fSlots[i].next = -1;
+		fBuckets[i] = -1;
+	}
+}
+
+
+RemoteTileCache::~RemoteTileCache()
+{
+}
+
+
+bool
+RemoteTileCache::Lookup(uint64 hash, uint16& slot)
+{
+	int32 index = fBuckets[hash % kRemoteTileSlotCount];
+	while (index >= 0) {
+		if (fSlots[index].hash == hash) {
+			fSlots[index].referenced = true;
+			slot = (uint16)index;
+			return true;
+		}
+		index = fSlots[index].next;
+	}
+
+	return false;
+}
+
+
+/*!	Chooses the slot the remote side has to store a new tile in. Tiles that
+	have not been used since the clock hand passed them last are replaced.
+*/
+uint16
+RemoteTileCache::Allocate(uint64 hash)
+{
+	int32 slot;
+	while (true) {
+		slot = fClockHand;
+		fClockHand = (fClockHand + 1) % kRemoteTileSlotCount;
+
+		if (!fSlots[slot].used)
+			break;
+
+		if (fSlots[slot].referenced) {
+			fSlots[slot].referenced = false;
+			continue;
+		}
+
+		_Unlink(slot);
+		break;
+	}
+
+	int32 bucket = hash % kRemoteTileSlotCount;
+	fSlots[slot].hash = hash;
+	fSlots[slot].used = true;
+	fSlots[slot].referenced = true;
+	fSlots[slot].next = fBuckets[bucket];
+	fBuckets[bucket] = slot;
+
+	return (uint16)slot;
+}
+
+
+void
+RemoteTileCache::_Unlink(uint16 slot)
+{
+	int32* link = &fBuckets[fSlots[slot].hash % kRemoteTileSlotCount];
+	while (*link >= 0) {
+		if (*link == slot) {
+			*link = fSlots[slot].next;
+			break;
+		}
+		link = &fSlots[*link].next;
+	}
+
+	fSlots[slot].used = false;
+	fSlots[slot].next = -1;
+}
+
+
+// #pragma mark - RemoteTileStore
+
+
+RemoteTileStore::RemoteTileStore()
+{
+	memset(fTiles, 0, sizeof(fTiles));
+}
+
+
+RemoteTileStore::~RemoteTileStore()
+{
+	for (int32 i = 0; i < kRemoteTileSlotCount; i++)
+		free(fTiles[i]);
+}
+
+
+uint8*
+RemoteTileStore::TileAt(uint16 slot)
+{
+	if (slot >= kRemoteTileSlotCount)
+		return NULL;
+
+	if (fTiles[slot] == NULL)
+		fTiles[slot] = (uint8*)malloc(kRemoteTileSize * kRemoteTileSize * 4);
+
+	return fTiles[slot];
+}
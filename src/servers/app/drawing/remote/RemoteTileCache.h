@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Large bitmaps are sent to the remote side in tiles. Tiles the remote side
+ * already has are only referred to by their slot in its tile store, new ones
+ * are sent run length encoded, and put into a slot chosen by the server.
+ */
+#ifndef REMOTE_TILE_CACHE_H
+#define REMOTE_TILE_CACHE_H
+
+#include <Locker.h>
+#include <SupportDefs.h>
+
+
+static const int32 kRemoteTileSize = 64;
+static const int32 kRemoteTileSlotCount = 1024;
+
+// bitmaps with less bits than this are always sent as they are
+static const uint32 kRemoteTileMinBitsLength = 16 * 1024;
+
+enum {
+	RP_BITMAP_RAW = 0,
+	RP_BITMAP_TILES
+};
+
+enum {
+	RP_TILE_CACHED = 0,
+	RP_TILE_RAW,
+	RP_TILE_RLE
+};
+
+
+// The size of the buffer remote_tile_compress() needs at most.
+static const size_t kRemoteTileMaxCompressedSize
+	= kRemoteTileSize * kRemoteTileSize * 4
+		+ kRemoteTileSize * kRemoteTileSize / 64 + 1;
+
+uint64		remote_tile_hash(const uint8* bits, int32 bytesPerRow,
+				int32 width, int32 height);
+size_t		remote_tile_compress(const uint8* bits, int32 bytesPerRow,
+				int32 width, int32 height, uint8* output);
+status_t	remote_tile_decompress(const uint8* data, size_t size,
+				uint8* bits, int32 bytesPerRow, int32 width, int32 height);
+
+
+// Server side: which tiles the remote side has in which slot. It must be
+// locked from looking up the tiles of a bitmap until the message has been
+// flushed, so that the remote side sees the slots change in the same order.
+class RemoteTileCache {
+public:
+								RemoteTileCache();
+								~RemoteTileCache();
+
+			bool				Lock() { return fLock.Lock(); }
+			void				Unlock() { fLock.Unlock(); }
+
+			bool				Lookup(uint64 hash, uint16& slot);
+			uint16				Allocate(uint64 hash);
+
+private:
+			void				_Unlink(uint16 slot);
+
+	struct tile_slot {
+		uint64					hash;
+		int32					next;
+		bool					used;
+		bool					referenced;
+	};
+
+			BLocker				fLock;
+			tile_slot			fSlots[kRemoteTileSlotCount];
+			int32				fBuckets[kRemoteTileSlotCount];
+			int32				fClockHand;
+};
+
+
+// Client side: the contents of the tile slots.
+class RemoteTileStore {
+public:
+								RemoteTileStore();
+								~RemoteTileStore();
+
+			// the tile bits, with a row length of kRemoteTileSize pixels
+			uint8*				TileAt(uint16 slot);
+
+private:
+			uint8*				fTiles[kRemoteTileSlotCount];
+};
+
+#endif // REMOTE_TILE_CACHE_H
@@ -0,0 +1,751 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Event queues are kernel-resident sets of objects (FDs, semaphores, ports,
+	and threads) a thread can wait on. In contrast to wait_for_objects(),
+	select() and poll(), the objects stay selected between waits, and waiting
+	only costs time proportional to the number of objects that are actually
+	ready.
+
+	Notifications of the objects are routed to the queue via the
+	select_sync::notify hook, which puts the respective entry into the queue's
+	ready list.
+
+	FDs are selected via select_fd(), so the I/O context notifies the queue
+	with B_EVENT_INVALID when an FD is closed. Since the I/O context holds on
+	to the entry until then, entries and the queue itself are reference
+	counted.
+*/
+
+
+#include <event_queue.h>
+
+#include <new>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <AutoDeleter.h>
+
+#include <fs/fd.h>
+#include <kernel.h>
+#include <port.h>
+#include <sem.h>
+#include <syscall_restart.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+#include <wait_for_objects.h>
+
+
+static const int32 kMaxEventsPerWait = 1024;
+
+
+struct EventQueue;
+
+
+struct EventQueueEntry {
+	select_info				info;
+		// must be the first member, see event_queue_notify()
+	EventQueue*				queue;
+	int32					ref_count;
+		// one reference for the queue's table, and one as long as the I/O
+		// context knows the entry
+	int32					object;
+	uint16					type;
+	uint16					events;
+	uint32					flags;
+	void*					user_data;
+	int32					fd_linked;
+		// whether the entry is in the I/O context's select_infos (FDs only)
+	bool					selected;
+	bool					removed;
+		// the entry is no longer in the table, and must not become ready
+	bool					ready;
+	DoublyLinkedListLink<EventQueueEntry> readyLink;
+	bool					reselect;
+	EventQueueEntry*		reselectNext;
+	EventQueueEntry*		hashNext;
+};
+
+typedef DoublyLinkedList<EventQueueEntry,
+	DoublyLinkedListMemberGetLink<EventQueueEntry,
+		&EventQueueEntry::readyLink> > EventQueueEntryList;
+
+
+struct EventQueueEntryKey {
+	int32	object;
+	uint16	type;
+};
+
+
+struct EventQueueEntryHashDefinition {
+	typedef EventQueueEntryKey	KeyType;
+	typedef EventQueueEntry		ValueType;
+
+	size_t HashKey(const EventQueueEntryKey& key) const
+	{
+		return (size_t)key.object ^ ((size_t)key.type << 24);
+	}
+
+	size_t Hash(const EventQueueEntry* value) const
+	{
+		EventQueueEntryKey key = { value->object, value->type };
+		return HashKey(key);
+	}
+
+	bool Compare(const EventQueueEntryKey& key,
+		const EventQueueEntry* value) const
+	{
+		return value->object == key.object && value->type == key.type;
+	}
+
+	EventQueueEntry*& GetLink(EventQueueEntry* value) const
+	{
+		return value->hashNext;
+	}
+};
+
+typedef BOpenHashTable<EventQueueEntryHashDefinition> EventQueueEntryTable;
+
+
+struct EventQueue {
+	int32					ref_count;
+		// one reference for the descriptor, and one for each entry
+	mutex					lock;
+		// protects everything but the ready list
+	spinlock				ready_lock;
+		// protects ready_list, EventQueueEntry::ready, and
+		// EventQueueEntry::removed
+	EventQueueEntryTable	entries;
+	EventQueueEntryList		ready_list;
+	EventQueueEntry*		reselect_list;
+		// level-triggered entries reported by the last wait
+	select_sync*			sync;
+	bool					closed;
+};
+
+
+static void
+put_event_queue(EventQueue* queue)
+{
+	if (atomic_add(&queue->ref_count, -1) == 1) {
+		put_select_sync(queue->sync);
+		mutex_destroy(&queue->lock);
+		delete queue;
+	}
+}
+
+
+static void
+release_entry(EventQueueEntry* entry)
+{
+	if (atomic_add(&entry->ref_count, -1) == 1) {
+		EventQueue* queue = entry->queue;
+		delete entry;
+		put_event_queue(queue);
+	}
+}
+
+
+/*!	Drops the I/O context's reference to the entry, if it still has one.
+*/
+static void
+unlink_entry(EventQueueEntry* entry)
+{
+	if (atomic_test_and_set(&entry->fd_linked, 0, 1) == 1)
+		release_entry(entry);
+}
+
+
+static void
+queue_entry(EventQueueEntry* entry)
+{
+	EventQueue* queue = entry->queue;
+
+	InterruptsSpinLocker locker(queue->ready_lock);
+	if (entry->ready || entry->removed)
+		return;
+
+	entry->ready = true;
+	queue->ready_list.Add(entry);
+
+	// Wake up a waiter while still holding the lock -- as soon as it is
+	// released, the entry may be collected and dropped.
+	release_sem_etc(queue->sync->sem, 1, B_DO_NOT_RESCHEDULE);
+}
+
+
+static void
+event_queue_notify(select_info* info)
+{
+	EventQueueEntry* entry = (EventQueueEntry*)info;
+
+	queue_entry(entry);
+
+	// B_EVENT_INVALID on an FD means that the I/O context has dropped the
+	// entry, and doesn't touch it anymore after this notification.
+	if (entry->type == B_OBJECT_TYPE_FD
+		&& (atomic_get(&info->events) & B_EVENT_INVALID) != 0) {
+		unlink_entry(entry);
+	}
+}
+
+
+static status_t
+select_entry(EventQueueEntry* entry)
+{
+	entry->info.next = NULL;
+	entry->info.sync = entry->queue->sync;
+	entry->info.events = 0;
+	entry->info.selected_events = entry->events
+		| B_EVENT_INVALID | B_EVENT_ERROR | B_EVENT_DISCONNECTED;
+
+	status_t error = B_OK;
+
+	switch (entry->type) {
+		case B_OBJECT_TYPE_FD:
+			// The I/O context keeps the entry until it is deselected, or
+			// until the FD is closed.
+			atomic_add(&entry->ref_count, 1);
+			entry->fd_linked = 1;
+
+			error = select_fd(entry->object, &entry->info, false);
+			if (error != B_OK)
+				unlink_entry(entry);
+			break;
+
+		case B_OBJECT_TYPE_SEMAPHORE:
+			error = select_sem(entry->object, &entry->info, false);
+			break;
+
+		case B_OBJECT_TYPE_PORT:
+			error = select_port(entry->object, &entry->info, false);
+			break;
+
+		case B_OBJECT_TYPE_THREAD:
+			error = select_thread(entry->object, &entry->info, false);
+			break;
+
+		default:
+			error = B_BAD_VALUE;
+			break;
+	}
+
+	entry->selected = error == B_OK;
+	return error;
+}
+
+
+/*!	Deselects the given entry.
+	Returns \c false if the entry's FD has been closed in the meantime. In this
+	case, B_EVENT_INVALID is or will be reported for the entry, and it must not
+	be selected again.
+*/
+static bool
+deselect_entry(EventQueueEntry* entry)
+{
+	if (!entry->selected)
+		return true;
+
+	entry->selected = false;
+
+	switch (entry->type) {
+		case B_OBJECT_TYPE_FD:
+			// If the I/O context has already dropped the entry, the FD is
+			// gone, and there is nothing to deselect. Note, the FD number
+			// might refer to another file by now.
+			if (atomic_get(&entry->fd_linked) == 0
+				|| deselect_fd(entry->object, &entry->info, false) != B_OK) {
+				return false;
+			}
+
+			unlink_entry(entry);
+			break;
+
+		case B_OBJECT_TYPE_SEMAPHORE:
+			deselect_sem(entry->object, &entry->info, false);
+			break;
+
+		case B_OBJECT_TYPE_PORT:
+			deselect_port(entry->object, &entry->info, false);
+			break;
+
+		case B_OBJECT_TYPE_THREAD:
+			deselect_thread(entry->object, &entry->info, false);
+			break;
+	}
+
+	return true;
+}
+
+
+/*!	Deselects the given entry, and releases the table's reference to it.
+	The entry must already have been removed from the table and the reselect
+	list, and the queue's lock must be held.
+*/
+static void
+drop_entry(EventQueue* queue, EventQueueEntry* entry)
+{
+	deselect_entry(entry);
+
+	InterruptsSpinLocker readyLocker(queue->ready_lock);
+	entry->removed = true;
+	if (entry->ready) {
+		queue->ready_list.Remove(entry);
+		entry->ready = false;
+	}
+	readyLocker.Unlock();
+
+	release_entry(entry);
+}
+
+
+/*!	Removes the given entry from the queue.
+	The queue's lock must be held.
+*/
+static void
+remove_entry(EventQueue* queue, EventQueueEntry* entry)
+{
+	if (entry->reselect) {
+		EventQueueEntry** link = &queue->reselect_list;
+		while (*link != entry)
+			link = &(*link)->reselectNext;
+		*link = entry->reselectNext;
+	}
+
+	queue->entries.Remove(entry);
+	drop_entry(queue, entry);
+}
+
+
+static status_t
+event_queue_select(EventQueue* queue, const event_wait_info& info)
+{
+	MutexLocker locker(queue->lock);
+
+	if (queue->closed)
+		return B_FILE_ERROR;
+
+	EventQueueEntryKey key = { info.object, info.type };
+	EventQueueEntry* entry = queue->entries.Lookup(key);
+
+	uint16 events = info.events & ~B_EVENT_QUEUE_MODE_FLAGS;
+	if (events == 0) {
+		// remove the object
+		if (entry == NULL)
+			return B_ENTRY_NOT_FOUND;
+
+		remove_entry(queue, entry);
+		return B_OK;
+	}
+
+	if (entry != NULL && !deselect_entry(entry)) {
+		// The FD has been closed since it was added, and its number may
+		// refer to another file now -- start over with a new entry.
+		remove_entry(queue, entry);
+		entry = NULL;
+	}
+
+	if (entry == NULL) {
+		if (info.type > B_OBJECT_TYPE_THREAD)
+			return B_BAD_VALUE;
+
+		if (info.type == B_OBJECT_TYPE_FD) {
+			file_descriptor* descriptor
+				= get_fd(get_current_io_context(false), info.object);
+			if (descriptor == NULL)
+				return B_FILE_ERROR;
+
+			bool isEventQueue = descriptor->type == FDTYPE_EVENT_QUEUE;
+			put_fd(descriptor);
+
+			if (isEventQueue) {
+				// we don't support nesting event queues
+				return B_BAD_VALUE;
+			}
+		}
+
+		entry = new(std::nothrow) EventQueueEntry;
+		if (entry == NULL)
+			return B_NO_MEMORY;
+
+		entry->queue = queue;
+		entry->ref_count = 1;
+		entry->object = info.object;
+		entry->type = info.type;
+		entry->fd_linked = 0;
+		entry->selected = false;
+		entry->removed = false;
+		entry->ready = false;
+		entry->reselect = false;
+		entry->reselectNext = NULL;
+
+		atomic_add(&queue->ref_count, 1);
+		queue->entries.Insert(entry);
+	}
+
+	entry->events = events;
+	entry->flags = info.events & B_EVENT_QUEUE_MODE_FLAGS;
+	entry->user_data = info.user_data;
+
+	status_t error = select_entry(entry);
+	if (error != B_OK)
+		remove_entry(queue, entry);
+
+	return error;
+}
+
+
+/*!	Moves up to \a numInfos events from the queue's ready list to \a infos.
+	The queue's lock must be held.
+*/
+static int
+event_queue_collect(EventQueue* queue, event_wait_info* infos, int numInfos)
+{
+	// Select the level-triggered objects we reported last time again. If
+	// their condition still holds, they will be added to the ready list right
+	// away.
+	while (EventQueueEntry* entry = queue->reselect_list) {
+		queue->reselect_list = entry->reselectNext;
+		entry->reselectNext = NULL;
+		entry->reselect = false;
+
+		if (!deselect_entry(entry)) {
+			// the FD has been closed, B_EVENT_INVALID will be reported
+			continue;
+		}
+
+		if (select_entry(entry) != B_OK) {
+			// report it as invalid
+			atomic_or(&entry->info.events, B_EVENT_INVALID);
+			queue_entry(entry);
+		}
+	}
+
+	int count = 0;
+
+	while (count < numInfos) {
+		InterruptsSpinLocker readyLocker(queue->ready_lock);
+		EventQueueEntry* entry = queue->ready_list.RemoveHead();
+		if (entry == NULL)
+			break;
+		entry->ready = false;
+		readyLocker.Unlock();
+
+		int32 events = atomic_and(&entry->info.events, 0)
+			& (entry->info.selected_events | B_EVENT_INVALID);
+		if (events == 0
+			|| (!entry->selected && (events & B_EVENT_INVALID) == 0)) {
+			continue;
+		}
+
+		infos[count].object = entry->object;
+		infos[count].type = entry->type;
+		infos[count].events = events;
+		infos[count].user_data = entry->user_data;
+		count++;
+
+		if ((events & B_EVENT_INVALID) != 0) {
+			// the object is gone
+			remove_entry(queue, entry);
+		} else if ((entry->flags & B_EVENT_ONE_SHOT) != 0) {
+			deselect_entry(entry);
+		} else if ((entry->flags & B_EVENT_EDGE_TRIGGERED) == 0
+			&& !entry->reselect) {
+			entry->reselect = true;
+			entry->reselectNext = queue->reselect_list;
+			queue->reselect_list = entry;
+		}
+	}
+
+	return count;
+}
+
+
+static ssize_t
+event_queue_wait(EventQueue* queue, event_wait_info* infos, int numInfos,
+	uint32 flags, bigtime_t timeout)
+{
+	if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout > 0
+		&& timeout != B_INFINITE_TIMEOUT) {
+		// We might have to wait more than once, so we need an absolute
+		// timeout.
+		timeout += system_time();
+		flags = (flags & ~B_RELATIVE_TIMEOUT) | B_ABSOLUTE_TIMEOUT;
+	}
+
+	while (true) {
+		MutexLocker locker(queue->lock);
+
+		if (queue->closed)
+			return B_FILE_ERROR;
+
+		int count = event_queue_collect(queue, infos, numInfos);
+		if (count > 0)
+			return count;
+
+		locker.Unlock();
+
+		// The semaphore is released once for each entry added to the ready
+		// list, so we may wake up spuriously, if we have already collected
+		// the entry in the meantime.
+		status_t error = acquire_sem_etc(queue->sync->sem, 1,
+			B_CAN_INTERRUPT | flags, timeout);
+		if (error != B_OK)
+			return error;
+	}
+}
+
+
+// #pragma mark - event queue file descriptor
+
+
+static status_t
+event_queue_close(struct file_descriptor* descriptor)
+{
+	EventQueue* queue = (EventQueue*)descriptor->cookie;
+
+	MutexLocker locker(queue->lock);
+
+	// If the queue is closed by another team than the one that selected the
+	// FDs, the entries cannot be deselected. They stay around then, until the
+	// FDs are closed, or the team goes away.
+	queue->reselect_list = NULL;
+
+	EventQueueEntry* entry = queue->entries.Clear(true);
+	while (entry != NULL) {
+		EventQueueEntry* next = entry->hashNext;
+		drop_entry(queue, entry);
+		entry = next;
+	}
+
+	// wake up waiting threads
+	queue->closed = true;
+	release_sem_etc(queue->sync->sem, 1, B_RELEASE_ALL);
+
+	return B_OK;
+}
+
+
+static void
+event_queue_free(struct file_descriptor* descriptor)
+{
+	put_event_queue((EventQueue*)descriptor->cookie);
+}
+
+
+static status_t
+event_queue_read_stat(struct file_descriptor* descriptor, struct stat* st)
+{
+	memset(st, 0, sizeof(struct stat));
+	st->st_ino = (addr_t)descriptor->cookie;
+	st->st_mode = S_IFIFO | 0600;
+	st->st_nlink = 1;
+	return B_OK;
+}
+
+
+static struct fd_ops sEventQueueFDOps = {
+	NULL,	// fd_read
+	NULL,	// fd_write
+	NULL,	// fd_seek
+	NULL,	// fd_ioctl
+	NULL,	// fd_set_flags
+	NULL,	// fd_select
+	NULL,	// fd_deselect
+	NULL,	// fd_read_dir
+	NULL,	// fd_rewind_dir
+	&event_queue_read_stat,
+	NULL,	// fd_write_stat
+	&event_queue_close,
+	&event_queue_free
+};
+
+
+struct EventQueueDescriptorPutter {
+	EventQueueDescriptorPutter(file_descriptor* descriptor)
+		:
+		fDescriptor(descriptor)
+	{
+	}
+
+	~EventQueueDescriptorPutter()
+	{
+		put_fd(fDescriptor);
+	}
+
+private:
+	file_descriptor*	fDescriptor;
+};
+
+
+static status_t
+get_event_queue(int fd, file_descriptor*& _descriptor)
+{
+	file_descriptor* descriptor = get_fd(get_current_io_context(false), fd);
+	if (descriptor == NULL)
+		return B_FILE_ERROR;
+
+	if (descriptor->type != FDTYPE_EVENT_QUEUE) {
+		put_fd(descriptor);
+		return B_BAD_VALUE;
+	}
+
+	_descriptor = descriptor;
+	return B_OK;
+}
+
+
+// #pragma mark - syscalls
+
+
+int
+_user_event_queue_create(int openFlags)
+{
+	EventQueue* queue = new(std::nothrow) EventQueue;
+	if (queue == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<EventQueue> queueDeleter(queue);
+
+	status_t error = queue->entries.Init();
+	if (error != B_OK)
+		return error;
+
+	select_sync* sync = new(std::nothrow) select_sync;
+	if (sync == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<select_sync> syncDeleter(sync);
+
+	sync->sem = create_sem(0, "event queue");
+	if (sync->sem < 0)
+		return sync->sem;
+
+	sync->ref_count = 1;
+	sync->count = 0;
+	sync->set = NULL;
+	sync->notify = &event_queue_notify;
+
+	queue->ref_count = 1;
+	mutex_init(&queue->lock, "event queue");
+	B_INITIALIZE_SPINLOCK(&queue->ready_lock);
+	queue->reselect_list = NULL;
+	queue->sync = sync;
+	queue->closed = false;
+
+	file_descriptor* descriptor = alloc_fd();
+	if (descriptor == NULL) {
+		mutex_destroy(&queue->lock);
+		delete_sem(sync->sem);
+		return B_NO_MEMORY;
+	}
+
+	descriptor->type = FDTYPE_EVENT_QUEUE;
+	descriptor->ops = &sEventQueueFDOps;
+	descriptor->cookie = queue;
+	descriptor->open_mode = O_RDWR;
+
+	io_context* context = get_current_io_context(false);
+	int fd = new_fd(context, descriptor);
+	if (fd < 0) {
+		free(descriptor);
+		mutex_destroy(&queue->lock);
+		delete_sem(sync->sem);
+		return fd;
+	}
+
+	mutex_lock(&context->io_mutex);
+	fd_set_close_on_exec(context, fd, (openFlags & O_CLOEXEC) != 0);
+	mutex_unlock(&context->io_mutex);
+
+	syncDeleter.Detach();
+	queueDeleter.Detach();
+
+	return fd;
+}
+
+
+status_t
+_user_event_queue_select(int fd, event_wait_info* userInfos, int numInfos)
+{
+	if (numInfos <= 0)
+		return B_BAD_VALUE;
+	if (userInfos == NULL || !IS_USER_ADDRESS(userInfos))
+		return B_BAD_ADDRESS;
+
+	file_descriptor* descriptor;
+	status_t error = get_event_queue(fd, descriptor);
+	if (error != B_OK)
+		return error;
+	EventQueueDescriptorPutter descriptorPutter(descriptor);
+
+	EventQueue* queue = (EventQueue*)descriptor->cookie;
+
+	// Apply all infos. Those that fail are marked with B_EVENT_INVALID and
+	// the error of the first one is returned.
+	status_t result = B_OK;
+	for (int i = 0; i < numInfos; i++) {
+		event_wait_info info;
+		if (user_memcpy(&info, userInfos + i, sizeof(info)) != B_OK)
+			return B_BAD_ADDRESS;
+
+		error = event_queue_select(queue, info);
+		if (error != B_OK) {
+			info.events = B_EVENT_INVALID;
+			if (user_memcpy(userInfos + i, &info, sizeof(info)) != B_OK)
+				return B_BAD_ADDRESS;
+
+			if (result == B_OK)
+				result = error;
+		}
+	}
+
+	return result;
+}
+
+
+ssize_t
+_user_event_queue_wait(int fd, event_wait_info* userInfos, int numInfos,
+	uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (numInfos <= 0)
+		return B_BAD_VALUE;
+	if (userInfos == NULL || !IS_USER_ADDRESS(userInfos))
+		return B_BAD_ADDRESS;
+
+	if (numInfos > kMaxEventsPerWait)
+		numInfos = kMaxEventsPerWait;
+
+	file_descriptor* descriptor;
+	status_t error = get_event_queue(fd, descriptor);
+	if (error != B_OK)
+		return error;
+	EventQueueDescriptorPutter descriptorPutter(descriptor);
+
+	event_wait_info* infos
+		= (event_wait_info*)malloc(sizeof(event_wait_info) * numInfos);
+	if (infos == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter infosDeleter(infos);
+
+	ssize_t result = event_queue_wait((EventQueue*)descriptor->cookie, infos,
+		numInfos, flags, timeout);
+
+	if (result > 0) {
+		if (user_memcpy(userInfos, infos, sizeof(event_wait_info) * result)
+				!= B_OK) {
+			return B_BAD_ADDRESS;
+		}
+	} else
+		syscall_restart_handle_timeout_post(result, timeout);
+
+	return result;
+}
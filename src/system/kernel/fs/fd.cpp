@@ -40,8 +40,6 @@ static const size_t kMaxReadDirBufferSize = 64 * 1024;
 static struct file_descriptor* get_fd_locked(struct io_context* context,
 	int fd);
 static struct file_descriptor* remove_fd(struct io_context* context, int fd);
-static void deselect_select_infos(file_descriptor* descriptor,
-	select_info* infos);
 
 
 struct FDGetterLocking {
@@ -523,7 +521,12 @@ fd_ioctl(bool kernelFD, int fd, uint32 op, void* buffer, size_t length)
 }
 
 
-static void
+/*!	Deselects and notifies with B_EVENT_INVALID all of the given select_infos,
+	which must already have been removed from their I/O context. Each of them
+	releases its reference to its select_sync.
+	The I/O context's mutex must not be held.
+*/
+void
 deselect_select_infos(file_descriptor* descriptor, select_info* infos)
 {
 	TRACE(("deselect_select_infos(%p, %p)\n", descriptor, infos));
@@ -543,8 +546,11 @@ deselect_select_infos(file_descriptor* descriptor, select_info* infos)
 			}
 		}
 
+		// The notification may be the last time the selector looks at the
+		// info, and it may free it right away.
+		select_info* next = info->next;
 		notify_select_events(info, B_EVENT_INVALID);
-		info = info->next;
+		info = next;
 		put_select_sync(sync);
 	}
 }
@@ -570,8 +576,15 @@ select_fd(int32 fd, struct select_info* info, bool kernel)
 
 	if (descriptor->ops->fd_select == NULL && eventsToSelect != 0) {
 		// if the I/O subsystem doesn't support select(), we will
-		// immediately notify the select call
-		return notify_select_events(info, eventsToSelect);
+		// immediately notify the select call -- the info is still added to
+		// the table, so that it will get B_EVENT_INVALID when the FD is
+		// closed
+		info->next = context->select_infos[fd];
+		context->select_infos[fd] = info;
+		atomic_add(&info->sync->ref_count, 1);
+
+		notify_select_events(info, eventsToSelect);
+		return B_OK;
 	}
 
 	// We need the FD to stay open while we're doing this, so no select()/
@@ -598,8 +611,12 @@ select_fd(int32 fd, struct select_info* info, bool kernel)
 	locker.Lock();
 	if (context->fds[fd] != descriptor) {
 		// Someone close()d the index in the meantime. deselect() all
-		// events.
+		// events. deselect_select_infos() releases a sync reference, so we
+		// need to acquire one first.
+		locker.Unlock();
+
 		info->next = NULL;
+		atomic_add(&info->sync->ref_count, 1);
 		deselect_select_infos(descriptor, info);
 
 		// Release our open reference of the descriptor.
@@ -649,7 +666,7 @@ deselect_fd(int32 fd, struct select_info* info, bool kernel)
 
 	// If not found, someone else beat us to it.
 	if (*infoLocation != info)
-		return B_OK;
+		return B_ENTRY_NOT_FOUND;
 
 	*infoLocation = info->next;
 
@@ -0,0 +1,501 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	I/O rings allow userland to keep many reads and writes in flight without
+	using a thread per request.
+
+	A ring consists of a submission and a completion queue living in an area
+	shared between the kernel and the team. Userland fills in submissions and
+	passes them to the kernel in batches via _kern_io_ring_enter(), which can
+	also wait for completions. Completions can be consumed without entering
+	the kernel at all.
+
+	Requests on devices and on files opened with O_NOCACHE are turned into
+	asynchronous IORequests and passed to the node's io() hook directly.
+	Everything else would bypass the file cache that way, so those requests
+	are executed synchronously on submission, just like vfs_vnode_io() falls
+	back to synchronous I/O for nodes without io() hook.
+*/
+
+
+#include <fs/io_ring.h>
+
+#include <new>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <AutoDeleter.h>
+
+#include <arch/cpu.h>
+#include <condition_variable.h>
+#include <fs/fd.h>
+#include <kernel.h>
+#include <lock.h>
+#include <syscall_restart.h>
+#include <team.h>
+#include <util/AutoLock.h>
+#include <vfs.h>
+#include <vm/vm.h>
+
+#include "IORequest.h"
+
+
+static const uint32 kMaxIORingEntries = 4096;
+
+
+struct IORing {
+	mutex					lock;
+		// serializes taking entries from the submission queue
+	spinlock				completion_lock;
+	ConditionVariable		completion_condition;
+	int32					ref_count;
+		// one for the FD, one per asynchronous request in flight
+	area_id					area;
+	area_id					user_area;
+	team_id					team;
+	io_ring_header*			header;
+	io_ring_submission*		submissions;
+	io_ring_completion*		completions;
+	uint32					entry_count;
+	uint32					submission_head;
+	uint32					completion_tail;
+	uint32					in_flight;
+		// guarded by completion_lock
+	bool					closed;
+};
+
+
+struct IORingOperation {
+	IORing*					ring;
+	file_descriptor*		descriptor;
+	void*					user_data;
+};
+
+
+static void
+acquire_io_ring(IORing* ring)
+{
+	atomic_add(&ring->ref_count, 1);
+}
+
+
+static void
+release_io_ring(IORing* ring)
+{
+	if (atomic_add(&ring->ref_count, -1) != 1)
+		return;
+
+	// The team might have deleted its mapping already, or might be gone
+	// altogether, so we ignore errors here.
+	vm_delete_area(ring->team, ring->user_area, true);
+	delete_area(ring->area);
+	mutex_destroy(&ring->lock);
+	delete ring;
+}
+
+
+static void
+io_ring_complete(IORing* ring, void* userData, ssize_t result)
+{
+	InterruptsSpinLocker locker(ring->completion_lock);
+
+	io_ring_completion& completion
+		= ring->completions[ring->completion_tail & (ring->entry_count - 1)];
+	completion.user_data = userData;
+	completion.result = result;
+
+	// make the entry visible before the new tail
+	arch_cpu_memory_write_barrier();
+	ring->header->completion_tail = ++ring->completion_tail;
+
+	ring->in_flight--;
+	ring->completion_condition.NotifyAll();
+}
+
+
+static status_t
+io_ring_request_finished(void* data, io_request* request, status_t status,
+	bool partialTransfer, generic_size_t transferEndOffset)
+{
+	IORingOperation* operation = (IORingOperation*)data;
+	IORing* ring = operation->ring;
+
+	io_ring_complete(ring, operation->user_data,
+		status == B_OK ? (ssize_t)transferEndOffset : status);
+
+	put_fd(operation->descriptor);
+	delete operation;
+
+	release_io_ring(ring);
+	return B_OK;
+}
+
+
+/*!	Starts the I/O described by \a submission. Every call results in exactly
+	one completion, possibly before this function returns.
+*/
+static void
+io_ring_start(IORing* ring, const io_ring_submission& submission)
+{
+	bool write = submission.op == B_IO_RING_WRITE;
+	if ((!write && submission.op != B_IO_RING_READ) || submission.offset < 0) {
+		io_ring_complete(ring, submission.user_data, B_BAD_VALUE);
+		return;
+	}
+
+	addr_t buffer = (addr_t)submission.buffer;
+	if (!IS_USER_ADDRESS(buffer) || buffer + submission.length < buffer
+		|| !IS_USER_ADDRESS(buffer + submission.length)) {
+		io_ring_complete(ring, submission.user_data, B_BAD_ADDRESS);
+		return;
+	}
+
+	file_descriptor* descriptor = get_fd(get_current_io_context(false),
+		submission.fd);
+	if (descriptor == NULL) {
+		io_ring_complete(ring, submission.user_data, B_FILE_ERROR);
+		return;
+	}
+
+	if (write ? (descriptor->open_mode & O_RWMASK) == O_RDONLY
+			: (descriptor->open_mode & O_RWMASK) == O_WRONLY) {
+		put_fd(descriptor);
+		io_ring_complete(ring, submission.user_data, B_FILE_ERROR);
+		return;
+	}
+
+	// submissions always have an offset, which pipes and the like would
+	// silently ignore
+	if (!vfs_is_seekable(descriptor)) {
+		put_fd(descriptor);
+		io_ring_complete(ring, submission.user_data, ESPIPE);
+		return;
+	}
+
+	if (submission.length > 0 && vfs_can_do_uncached_io(descriptor)) {
+		IORingOperation* operation = new(std::nothrow) IORingOperation;
+		IORequest* request = IORequest::Create(false);
+		status_t status = operation != NULL && request != NULL
+			? request->Init(submission.offset, buffer, submission.length,
+				write, B_DELETE_IO_REQUEST)
+			: B_NO_MEMORY;
+		if (status != B_OK) {
+			delete operation;
+			delete request;
+			put_fd(descriptor);
+			io_ring_complete(ring, submission.user_data, status);
+			return;
+		}
+
+		operation->ring = ring;
+		operation->descriptor = descriptor;
+		operation->user_data = submission.user_data;
+		acquire_io_ring(ring);
+
+		// The request is always notified, even if scheduling it fails.
+		request->SetFinishedCallback(&io_ring_request_finished, operation);
+		vfs_vnode_io(descriptor->u.vnode, descriptor->cookie, request);
+		return;
+	}
+
+	// synchronous fallback
+	size_t length = submission.length;
+	status_t status;
+	if (write) {
+		status = descriptor->ops->fd_write != NULL
+			? descriptor->ops->fd_write(descriptor, submission.offset,
+				submission.buffer, &length)
+			: B_BAD_VALUE;
+	} else {
+		status = descriptor->ops->fd_read != NULL
+			? descriptor->ops->fd_read(descriptor, submission.offset,
+				submission.buffer, &length)
+			: B_BAD_VALUE;
+	}
+
+	put_fd(descriptor);
+
+	io_ring_complete(ring, submission.user_data,
+		status == B_OK ? (ssize_t)min_c(length, SSIZE_MAX) : status);
+}
+
+
+/*!	Starts up to \a count of the queued submissions. Submissions are only
+	accepted as long as there is room in the completion queue for their
+	completions.
+	\return The number of submissions started, or an error code.
+*/
+static ssize_t
+io_ring_submit(IORing* ring, uint32 count)
+{
+	MutexLocker locker(ring->lock);
+
+	uint32 tail = ring->header->submission_tail;
+	if (tail - ring->submission_head > ring->entry_count)
+		return B_BAD_DATA;
+
+	// read the entries only after the tail
+	arch_cpu_memory_read_barrier();
+
+	uint32 submitted = 0;
+	for (; submitted < count; submitted++) {
+		// other submitters may have taken entries while we were unlocked
+		if ((int32)(tail - ring->submission_head) <= 0)
+			break;
+
+		InterruptsSpinLocker completionLocker(ring->completion_lock);
+		uint32 used = ring->completion_tail - ring->header->completion_head
+			+ ring->in_flight;
+		if (used >= ring->entry_count)
+			break;
+		ring->in_flight++;
+		completionLocker.Unlock();
+
+		io_ring_submission submission = ring->submissions[
+			ring->submission_head & (ring->entry_count - 1)];
+		ring->header->submission_head = ++ring->submission_head;
+
+		// The synchronous fallback may block for an arbitrary time (think of
+		// pipes and sockets), so other submitters must not wait for it.
+		locker.Unlock();
+		io_ring_start(ring, submission);
+		locker.Lock();
+	}
+
+	return submitted;
+}
+
+
+/*!	Waits until at least \a count completions are queued.
+*/
+static status_t
+io_ring_wait(IORing* ring, uint32 count, uint32 flags, bigtime_t timeout)
+{
+	if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout > 0
+		&& timeout != B_INFINITE_TIMEOUT) {
+		// We might have to wait more than once, so we need an absolute
+		// timeout.
+		timeout += system_time();
+		flags = (flags & ~B_RELATIVE_TIMEOUT) | B_ABSOLUTE_TIMEOUT;
+	}
+
+	if (count > ring->entry_count)
+		count = ring->entry_count;
+
+	InterruptsSpinLocker locker(ring->completion_lock);
+
+	while (ring->completion_tail - ring->header->completion_head < count) {
+		if (ring->closed)
+			return B_FILE_ERROR;
+
+		ConditionVariableEntry entry;
+		ring->completion_condition.Add(&entry);
+		locker.Unlock();
+
+		status_t error = entry.Wait(B_CAN_INTERRUPT | flags, timeout);
+		if (error != B_OK)
+			return error;
+
+		locker.Lock();
+	}
+
+	return B_OK;
+}
+
+
+// #pragma mark - I/O ring file descriptor
+
+
+static status_t
+io_ring_close(struct file_descriptor* descriptor)
+{
+	IORing* ring = (IORing*)descriptor->cookie;
+
+	InterruptsSpinLocker locker(ring->completion_lock);
+	ring->closed = true;
+	ring->completion_condition.NotifyAll();
+
+	return B_OK;
+}
+
+
+static void
+io_ring_free(struct file_descriptor* descriptor)
+{
+	IORing* ring = (IORing*)descriptor->cookie;
+
+	// Requests still in flight keep the ring alive until they complete.
+	release_io_ring(ring);
+}
+
+
+static status_t
+io_ring_read_stat(struct file_descriptor* descriptor, struct stat* st)
+{
+	memset(st, 0, sizeof(struct stat));
+	st->st_ino = (addr_t)descriptor->cookie;
+	st->st_mode = S_IFIFO | 0600;
+	st->st_nlink = 1;
+	return B_OK;
+}
+
+
+static struct fd_ops sIORingFDOps = {
+	NULL,	// fd_read
+	NULL,	// fd_write
+	NULL,	// fd_seek
+	NULL,	// fd_ioctl
+	NULL,	// fd_set_flags
+	NULL,	// fd_select
+	NULL,	// fd_deselect
+	NULL,	// fd_read_dir
+	NULL,	// fd_rewind_dir
+	&io_ring_read_stat,
+	NULL,	// fd_write_stat
+	&io_ring_close,
+	&io_ring_free
+};
+
+
+// #pragma mark - syscalls
+
+
+int
+_user_io_ring_create(uint32 entryCount, int openFlags,
+	io_ring_header** _userHeader)
+{
+	if (entryCount == 0 || entryCount > kMaxIORingEntries
+		|| (entryCount & (entryCount - 1)) != 0) {
+		return B_BAD_VALUE;
+	}
+
+	if (_userHeader == NULL || !IS_USER_ADDRESS(_userHeader))
+		return B_BAD_ADDRESS;
+
+	IORing* ring = new(std::nothrow) IORing;
+	if (ring == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<IORing> ringDeleter(ring);
+
+	uint32 submissionsOffset = ROUNDUP(sizeof(io_ring_header), 8);
+	uint32 completionsOffset = submissionsOffset
+		+ entryCount * sizeof(io_ring_submission);
+	size_t size = PAGE_ALIGN(completionsOffset
+		+ entryCount * sizeof(io_ring_completion));
+
+	ring->area = create_area("io ring", (void**)&ring->header,
+		B_ANY_KERNEL_ADDRESS, size, B_FULL_LOCK,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (ring->area < 0)
+		return ring->area;
+
+	ring->header->entry_count = entryCount;
+	ring->header->submissions_offset = submissionsOffset;
+	ring->header->completions_offset = completionsOffset;
+	ring->header->submission_head = 0;
+	ring->header->submission_tail = 0;
+	ring->header->completion_head = 0;
+	ring->header->completion_tail = 0;
+
+	// map the ring into the team as well
+	void* userAddress = NULL;
+	ring->team = team_get_current_team_id();
+	ring->user_area = vm_clone_area(ring->team, "io ring", &userAddress,
+		B_ANY_ADDRESS, B_READ_AREA | B_WRITE_AREA, REGION_NO_PRIVATE_MAP,
+		ring->area, true);
+	if (ring->user_area < 0) {
+		delete_area(ring->area);
+		return ring->user_area;
+	}
+
+	if (user_memcpy(_userHeader, &userAddress, sizeof(userAddress)) != B_OK) {
+		vm_delete_area(ring->team, ring->user_area, true);
+		delete_area(ring->area);
+		return B_BAD_ADDRESS;
+	}
+
+	mutex_init(&ring->lock, "io ring");
+	B_INITIALIZE_SPINLOCK(&ring->completion_lock);
+	ring->completion_condition.Init(ring, "io ring completion");
+	ring->ref_count = 1;
+	ring->submissions = (io_ring_submission*)
+		((uint8*)ring->header + submissionsOffset);
+	ring->completions = (io_ring_completion*)
+		((uint8*)ring->header + completionsOffset);
+	ring->entry_count = entryCount;
+	ring->submission_head = 0;
+	ring->completion_tail = 0;
+	ring->in_flight = 0;
+	ring->closed = false;
+
+	file_descriptor* descriptor = alloc_fd();
+	if (descriptor == NULL) {
+		ringDeleter.Detach();
+		release_io_ring(ring);
+		return B_NO_MEMORY;
+	}
+
+	descriptor->type = FDTYPE_IO_RING;
+	descriptor->ops = &sIORingFDOps;
+	descriptor->cookie = ring;
+	descriptor->open_mode = O_RDWR;
+
+	io_context* context = get_current_io_context(false);
+	int fd = new_fd(context, descriptor);
+	if (fd < 0) {
+		free(descriptor);
+		ringDeleter.Detach();
+		release_io_ring(ring);
+		return fd;
+	}
+
+	mutex_lock(&context->io_mutex);
+	fd_set_close_on_exec(context, fd, (openFlags & O_CLOEXEC) != 0);
+	mutex_unlock(&context->io_mutex);
+
+	ringDeleter.Detach();
+	return fd;
+}
+
+
+ssize_t
+_user_io_ring_enter(int fd, uint32 submitCount, uint32 waitCount,
+	uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	file_descriptor* descriptor = get_fd(get_current_io_context(false), fd);
+	if (descriptor == NULL)
+		return B_FILE_ERROR;
+	CObjectDeleter<file_descriptor> descriptorPutter(descriptor, put_fd);
+
+	if (descriptor->type != FDTYPE_IO_RING)
+		return B_BAD_VALUE;
+
+	IORing* ring = (IORing*)descriptor->cookie;
+
+	ssize_t submitted = 0;
+	if (submitCount > 0) {
+		submitted = io_ring_submit(ring, submitCount);
+		if (submitted < 0)
+			return submitted;
+	}
+
+	if (waitCount > 0) {
+		status_t error = io_ring_wait(ring, waitCount, flags, timeout);
+		if (error != B_OK && submitted == 0) {
+			// Only fail (and maybe restart), if we haven't submitted
+			// anything; otherwise the submissions would be lost.
+			syscall_restart_handle_timeout_post(error, timeout);
+			return error;
+		}
+	}
+
+	return submitted;
+}
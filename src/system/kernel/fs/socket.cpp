@@ -9,7 +9,11 @@
 #include <sys/socket.h>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <stdlib.h>
+
+#include <new>
 
 #include <module.h>
 
@@ -21,17 +25,29 @@
 #include <kernel.h>
 #include <lock.h>
 #include <syscall_restart.h>
+#include <team.h>
 #include <util/AutoLock.h>
 #include <vfs.h>
+#include <vm/vm.h>
+#include <vm/VMAddressSpace.h>
 
 #include <net_stack_interface.h>
 #include <net_stat.h>
 
+#include "dma_resources.h"
+
 
 #define MAX_SOCKET_ADDRESS_LENGTH	(sizeof(sockaddr_storage))
 #define MAX_SOCKET_OPTION_LENGTH	128
 #define MAX_ANCILLARY_DATA_LENGTH	1024
 
+// smaller MSG_ZEROCOPY sends are cheaper to copy than to map
+#define MIN_ZERO_COPY_SIZE			(16 * 1024)
+#define SEND_FILE_CHUNK_SIZE		(64 * 1024)
+
+// the number of messages recvmmsg() and sendmmsg() pass to the stack at once
+#define MESSAGE_BATCH_SIZE			64
+
 #define GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor)	\
 	do {												\
 		status_t getError = get_socket_descriptor(fd, kernel, descriptor); \
@@ -61,6 +77,28 @@ struct FDPutter {
 };
 
 
+/*!	The kernel copies of a batch of userland message headers, as used by
+	recvmmsg() and sendmmsg().
+*/
+struct userland_message_batch {
+	mmsghdr			messages[MESSAGE_BATCH_SIZE];
+	iovec*			user_vecs[MESSAGE_BATCH_SIZE];
+	void*			user_addresses[MESSAGE_BATCH_SIZE];
+	void*			user_ancillary[MESSAGE_BATCH_SIZE];
+	MemoryDeleter	vecs_deleters[MESSAGE_BATCH_SIZE];
+	MemoryDeleter	ancillary_deleters[MESSAGE_BATCH_SIZE];
+	char			addresses[MESSAGE_BATCH_SIZE][MAX_SOCKET_ADDRESS_LENGTH];
+};
+
+
+struct zero_copy_mapping {
+	team_id		team;
+	void*		address;
+	size_t		size;
+	area_id		area;
+};
+
+
 static net_stack_interface_module_info*
 get_stack_interface_module()
 {
@@ -198,6 +236,138 @@ prepare_userland_msghdr(const msghdr* userMessage, msghdr& message,
 }
 
 
+/*!	Replaces the userland ancillary data buffer of the \a message with a
+	kernel buffer that receives the ancillary data.
+*/
+static status_t
+prepare_userland_ancillary_buffer(msghdr& message, void*& userAncillary,
+	MemoryDeleter& ancillaryDeleter)
+{
+	userAncillary = message.msg_control;
+	if (userAncillary == NULL)
+		return B_OK;
+
+	if (!IS_USER_ADDRESS(userAncillary))
+		return B_BAD_ADDRESS;
+	if (message.msg_controllen < 0)
+		return B_BAD_VALUE;
+	if (message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH)
+		message.msg_controllen = MAX_ANCILLARY_DATA_LENGTH;
+
+	message.msg_control = malloc(message.msg_controllen);
+	if (message.msg_control == NULL)
+		return B_NO_MEMORY;
+
+	ancillaryDeleter.SetTo(message.msg_control);
+	return B_OK;
+}
+
+
+/*!	Replaces the userland ancillary data of the \a message with a kernel
+	copy of it.
+*/
+static status_t
+copy_ancillary_data_from_userland(msghdr& message,
+	MemoryDeleter& ancillaryDeleter)
+{
+	void* userAncillary = message.msg_control;
+	if (userAncillary == NULL)
+		return B_OK;
+
+	if (!IS_USER_ADDRESS(userAncillary))
+		return B_BAD_ADDRESS;
+	if (message.msg_controllen < 0
+			|| message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH) {
+		return B_BAD_VALUE;
+	}
+
+	message.msg_control = malloc(message.msg_controllen);
+	if (message.msg_control == NULL)
+		return B_NO_MEMORY;
+	ancillaryDeleter.SetTo(message.msg_control);
+
+	if (user_memcpy(message.msg_control, userAncillary,
+			message.msg_controllen) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Prepares kernel copies of the first \a count of the \a userMessages,
+	including their addresses, and ancillary data when sending.
+*/
+static status_t
+prepare_userland_message_batch(userland_message_batch& batch,
+	mmsghdr* userMessages, uint32 count, bool send)
+{
+	for (uint32 i = 0; i < count; i++) {
+		msghdr& message = batch.messages[i].msg_hdr;
+		batch.messages[i].msg_len = 0;
+		batch.vecs_deleters[i].SetTo(NULL);
+		batch.ancillary_deleters[i].SetTo(NULL);
+
+		status_t error = prepare_userland_msghdr(&userMessages[i].msg_hdr,
+			message, batch.user_vecs[i], batch.vecs_deleters[i],
+			batch.user_addresses[i], batch.addresses[i]);
+		if (error != B_OK)
+			return error;
+
+		if (send) {
+			if (batch.user_addresses[i] != NULL
+				&& user_memcpy(batch.addresses[i], batch.user_addresses[i],
+					message.msg_namelen) != B_OK) {
+				return B_BAD_ADDRESS;
+			}
+
+			error = copy_ancillary_data_from_userland(message,
+				batch.ancillary_deleters[i]);
+		} else {
+			error = prepare_userland_ancillary_buffer(message,
+				batch.user_ancillary[i], batch.ancillary_deleters[i]);
+		}
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Copies the addresses, the ancillary data, and the headers of the first
+	\a count received messages of the \a batch back to userland.
+	Returns the number of messages that have been copied completely.
+*/
+static uint32
+copy_received_message_batch(userland_message_batch& batch,
+	mmsghdr* userMessages, uint32 count)
+{
+	for (uint32 i = 0; i < count; i++) {
+		msghdr& message = batch.messages[i].msg_hdr;
+		void* userAddress = batch.user_addresses[i];
+		void* userAncillary = batch.user_ancillary[i];
+
+		if ((userAddress != NULL && user_memcpy(userAddress,
+					batch.addresses[i], message.msg_namelen) != B_OK)
+			|| (userAncillary != NULL && user_memcpy(userAncillary,
+					message.msg_control, message.msg_controllen) != B_OK)) {
+			return i;
+		}
+
+		message.msg_name = userAddress;
+		message.msg_iov = batch.user_vecs[i];
+		message.msg_control = userAncillary;
+		if (user_memcpy(&userMessages[i], &batch.messages[i], sizeof(mmsghdr))
+				!= B_OK) {
+			return i;
+		}
+	}
+
+	return count;
+}
+
+
 static status_t
 get_socket_descriptor(int fd, bool kernel, file_descriptor*& descriptor)
 {
@@ -217,6 +387,112 @@ get_socket_descriptor(int fd, bool kernel, file_descriptor*& descriptor)
 }
 
 
+// #pragma mark - zero copy
+
+
+static void
+release_zero_copy_mapping(void* _mapping)
+{
+	zero_copy_mapping* mapping = (zero_copy_mapping*)_mapping;
+
+	delete_area(mapping->area);
+	unlock_memory_etc(mapping->team, mapping->address, mapping->size,
+		B_READ_DEVICE);
+	delete mapping;
+}
+
+
+/*!	Wires the pages of the current team's memory at \a data, and maps them
+	into the kernel address space, so that the networking stack can refer to
+	them from any context.
+	On success, \a _kernelData is set to the kernel address of \a data.
+*/
+static status_t
+map_user_memory(const void* data, size_t length, zero_copy_mapping*& _mapping,
+	void*& _kernelData)
+{
+	addr_t start = ROUNDDOWN((addr_t)data, B_PAGE_SIZE);
+	size_t size = ROUNDUP((addr_t)data + length, B_PAGE_SIZE) - start;
+	uint32 pageCount = size / B_PAGE_SIZE;
+
+	zero_copy_mapping* mapping = new(std::nothrow) zero_copy_mapping;
+	if (mapping == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<zero_copy_mapping> mappingDeleter(mapping);
+
+	mapping->team = team_get_current_team_id();
+	mapping->address = (void*)start;
+	mapping->size = size;
+
+	// The device only reads from the memory, so it doesn't need to be
+	// writable.
+	status_t status = lock_memory_etc(mapping->team, mapping->address, size,
+		B_READ_DEVICE);
+	if (status != B_OK)
+		return status;
+
+	physical_entry* table = new(std::nothrow) physical_entry[pageCount];
+	generic_io_vec* vecs = new(std::nothrow) generic_io_vec[pageCount];
+	ArrayDeleter<physical_entry> tableDeleter(table);
+	ArrayDeleter<generic_io_vec> vecsDeleter(vecs);
+
+	uint32 count = pageCount;
+	if (table == NULL || vecs == NULL)
+		status = B_NO_MEMORY;
+	else {
+		status = get_memory_map_etc(mapping->team, mapping->address, size,
+			table, &count);
+	}
+
+	if (status == B_OK) {
+		for (uint32 i = 0; i < count; i++) {
+			vecs[i].base = table[i].address;
+			vecs[i].length = table[i].size;
+		}
+
+		void* address;
+		addr_t mappedSize;
+		mapping->area = vm_map_physical_memory_vecs(
+			VMAddressSpace::KernelID(), "zero copy send", &address,
+			B_ANY_KERNEL_ADDRESS, &mappedSize, B_KERNEL_READ_AREA, vecs,
+			count);
+		if (mapping->area >= 0)
+			_kernelData = (uint8*)address + ((addr_t)data - start);
+		else
+			status = mapping->area;
+	}
+
+	if (status != B_OK) {
+		unlock_memory_etc(mapping->team, mapping->address, size,
+			B_READ_DEVICE);
+		return status;
+	}
+
+	_mapping = mappingDeleter.Detach();
+	return B_OK;
+}
+
+
+/*!	Sends the user memory at \a data without copying it, if it is large
+	enough to make that worthwhile, and it can be mapped.
+	Returns \c B_UNSUPPORTED if the data has to be sent the usual way.
+*/
+static ssize_t
+send_zero_copy(net_socket* socket, const void* data, size_t length, int flags)
+{
+	if (length < MIN_ZERO_COPY_SIZE)
+		return B_UNSUPPORTED;
+
+	zero_copy_mapping* mapping;
+	void* kernelData;
+	if (map_user_memory(data, length, mapping, kernelData) != B_OK)
+		return B_UNSUPPORTED;
+
+	return sStackInterface->send_external(socket, kernelData, length, flags,
+		&release_zero_copy_mapping, mapping);
+}
+
+
 // #pragma mark - socket file descriptor
 
 
@@ -507,6 +783,19 @@ common_recvmsg(int fd, struct msghdr *message, int flags, bool kernel)
 }
 
 
+static ssize_t
+common_recvmmsg(int fd, struct mmsghdr *messages, uint32 count, int flags,
+	bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
+	FDPutter _(descriptor);
+
+	return sStackInterface->recvmmsg(descriptor->u.socket, messages, count,
+		flags);
+}
+
+
 static ssize_t
 common_send(int fd, const void *data, size_t length, int flags, bool kernel)
 {
@@ -514,6 +803,13 @@ common_send(int fd, const void *data, size_t length, int flags, bool kernel)
 	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
 	FDPutter _(descriptor);
 
+	if ((flags & MSG_ZEROCOPY) != 0 && !kernel) {
+		ssize_t bytesSent = send_zero_copy(descriptor->u.socket, data, length,
+			flags);
+		if (bytesSent != B_UNSUPPORTED)
+			return bytesSent;
+	}
+
 	return sStackInterface->send(descriptor->u.socket, data, length, flags);
 }
 
@@ -542,6 +838,91 @@ common_sendmsg(int fd, const struct msghdr *message, int flags, bool kernel)
 }
 
 
+static ssize_t
+common_sendmmsg(int fd, struct mmsghdr *messages, uint32 count, int flags,
+	bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
+	FDPutter _(descriptor);
+
+	return sStackInterface->sendmmsg(descriptor->u.socket, messages, count,
+		flags);
+}
+
+
+/*!	Sends \a count bytes of the file \a fd, starting at \a _offset, or
+	at the file position if that is \c NULL, over the \a socket.
+	The file is read in chunks that are then handed over to the stack as a
+	whole, without another copy.
+*/
+static ssize_t
+common_send_file(int socket, int fd, off_t* _offset, size_t count,
+	bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(socket, kernel, descriptor);
+	FDPutter _(descriptor);
+
+	file_descriptor* file = get_fd(get_current_io_context(kernel), fd);
+	if (file == NULL)
+		return EBADF;
+	FDPutter filePutter(file);
+
+	if ((file->open_mode & O_RWMASK) == O_WRONLY || file->ops->fd_read == NULL)
+		return EBADF;
+
+	off_t offset = _offset != NULL ? *_offset : file->pos;
+	if (offset < 0)
+		return B_BAD_VALUE;
+
+	ssize_t bytesSent = 0;
+	status_t status = B_OK;
+
+	while (count > 0) {
+		size_t length = min_c(count, SEND_FILE_CHUNK_SIZE);
+		void* chunk = malloc(length);
+		if (chunk == NULL) {
+			status = B_NO_MEMORY;
+			break;
+		}
+
+		status = file->ops->fd_read(file, offset, chunk, &length);
+		if (status != B_OK || length == 0) {
+			free(chunk);
+			break;
+		}
+
+		ssize_t chunkSent = sStackInterface->send_external(
+			descriptor->u.socket, chunk, length, 0, &free, chunk);
+		if (chunkSent < 0) {
+			status = chunkSent;
+			break;
+		}
+
+		offset += chunkSent;
+		bytesSent += chunkSent;
+		count -= chunkSent;
+
+		// Like a series of read() calls, advance the file position with
+		// every chunk, and only by what has actually been sent.
+		if (_offset == NULL)
+			file->pos = offset;
+
+		if ((size_t)chunkSent < length)
+			break;
+	}
+
+	if (_offset != NULL)
+		*_offset = offset;
+
+	if (bytesSent == 0 && status != B_OK)
+		return status;
+
+	return bytesSent;
+}
+
+
 static status_t
 common_getsockopt(int fd, int level, int option, void *value,
 	socklen_t *_length, bool kernel)
@@ -973,22 +1354,12 @@ _user_recvmsg(int socket, struct msghdr *userMessage, int flags)
 
 	// prepare a buffer for ancillary data
 	MemoryDeleter ancillaryDeleter;
-	void* ancillary = NULL;
-	void* userAncillary = message.msg_control;
-	if (userAncillary != NULL) {
-		if (!IS_USER_ADDRESS(userAncillary))
-			return B_BAD_ADDRESS;
-		if (message.msg_controllen < 0)
-			return B_BAD_VALUE;
-		if (message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH)
-			message.msg_controllen = MAX_ANCILLARY_DATA_LENGTH;
-
-		message.msg_control = ancillary = malloc(message.msg_controllen);
-		if (message.msg_control == NULL)
-			return B_NO_MEMORY;
-
-		ancillaryDeleter.SetTo(ancillary);
-	}
+	void* userAncillary;
+	error = prepare_userland_ancillary_buffer(message, userAncillary,
+		ancillaryDeleter);
+	if (error != B_OK)
+		return error;
+	void* ancillary = message.msg_control;
 
 	// recvmsg()
 	SyscallRestartWrapper<ssize_t> result;
@@ -1014,6 +1385,63 @@ _user_recvmsg(int socket, struct msghdr *userMessage, int flags)
 }
 
 
+/*!	Receives up to \a count messages. Unless \c MSG_WAITFORONE, or
+	\c MSG_DONTWAIT is given, this waits until all of them have been received,
+	or the \a timeout has passed; like with Linux, the timeout is only checked
+	after a message has been received.
+*/
+ssize_t
+_user_recvmmsg(int socket, struct mmsghdr *userMessages, unsigned int count,
+	int flags, bigtime_t timeout)
+{
+	if (userMessages == NULL || !IS_USER_ADDRESS(userMessages))
+		return B_BAD_ADDRESS;
+
+	if (count > IOV_MAX)
+		count = IOV_MAX;
+	if (timeout != B_INFINITE_TIMEOUT)
+		timeout += system_time();
+
+	userland_message_batch* batch
+		= new(std::nothrow) userland_message_batch;
+	if (batch == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<userland_message_batch> batchDeleter(batch);
+
+	SyscallRestartWrapper<ssize_t> result;
+	uint32 received = 0;
+
+	while (received < count) {
+		uint32 batchCount = min_c(count - received, MESSAGE_BATCH_SIZE);
+		status_t error = prepare_userland_message_batch(*batch,
+			userMessages + received, batchCount, false);
+		if (error != B_OK)
+			return result = received > 0 ? (ssize_t)received : error;
+
+		ssize_t batchReceived = common_recvmmsg(socket, batch->messages,
+			batchCount, flags, false);
+		if (batchReceived < 0)
+			return result = received > 0 ? (ssize_t)received : batchReceived;
+
+		// The messages have already been dequeued, so report the ones that
+		// made it to userland, like after any other error.
+		uint32 copied = copy_received_message_batch(*batch,
+			userMessages + received, batchReceived);
+		received += copied;
+		if (copied < (uint32)batchReceived)
+			return result = received > 0 ? (ssize_t)received : B_BAD_ADDRESS;
+
+		if ((flags & MSG_WAITFORONE) != 0)
+			flags |= MSG_DONTWAIT;
+		if (((flags & MSG_DONTWAIT) != 0 && (uint32)batchReceived < batchCount)
+			|| (timeout != B_INFINITE_TIMEOUT && system_time() >= timeout))
+			break;
+	}
+
+	return result = received;
+}
+
+
 ssize_t
 _user_send(int socket, const void *data, size_t length, int flags)
 {
@@ -1054,6 +1482,30 @@ _user_sendto(int socket, const void *data, size_t length, int flags,
 }
 
 
+ssize_t
+_user_send_file(int socket, int fd, off_t *userOffset, size_t count)
+{
+	off_t offset;
+	if (userOffset != NULL) {
+		if (!IS_USER_ADDRESS(userOffset)
+			|| user_memcpy(&offset, userOffset, sizeof(off_t)) != B_OK) {
+			return B_BAD_ADDRESS;
+		}
+	}
+
+	SyscallRestartWrapper<ssize_t> result;
+	result = common_send_file(socket, fd, userOffset != NULL ? &offset : NULL,
+		count, false);
+
+	if (userOffset != NULL
+		&& user_memcpy(userOffset, &offset, sizeof(off_t)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return result;
+}
+
+
 ssize_t
 _user_sendmsg(int socket, const struct msghdr *userMessage, int flags)
 {
@@ -1077,25 +1529,9 @@ _user_sendmsg(int socket, const struct msghdr *userMessage, int flags)
 
 	// copy ancillary data from userland
 	MemoryDeleter ancillaryDeleter;
-	void* userAncillary = message.msg_control;
-	if (userAncillary != NULL) {
-		if (!IS_USER_ADDRESS(userAncillary))
-			return B_BAD_ADDRESS;
-		if (message.msg_controllen < 0
-				|| message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH) {
-			return B_BAD_VALUE;
-		}
-
-		message.msg_control = malloc(message.msg_controllen);
-		if (message.msg_control == NULL)
-			return B_NO_MEMORY;
-		ancillaryDeleter.SetTo(message.msg_control);
-
-		if (user_memcpy(message.msg_control, userAncillary,
-				message.msg_controllen) != B_OK) {
-			return B_BAD_ADDRESS;
-		}
-	}
+	error = copy_ancillary_data_from_userland(message, ancillaryDeleter);
+	if (error != B_OK)
+		return error;
 
 	// sendmsg()
 	SyscallRestartWrapper<ssize_t> result;
@@ -1104,6 +1540,54 @@ _user_sendmsg(int socket, const struct msghdr *userMessage, int flags)
 }
 
 
+ssize_t
+_user_sendmmsg(int socket, struct mmsghdr *userMessages, unsigned int count,
+	int flags)
+{
+	if (userMessages == NULL || !IS_USER_ADDRESS(userMessages))
+		return B_BAD_ADDRESS;
+
+	if (count > IOV_MAX)
+		count = IOV_MAX;
+
+	userland_message_batch* batch
+		= new(std::nothrow) userland_message_batch;
+	if (batch == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<userland_message_batch> batchDeleter(batch);
+
+	SyscallRestartWrapper<ssize_t> result;
+	uint32 sent = 0;
+
+	while (sent < count) {
+		uint32 batchCount = min_c(count - sent, MESSAGE_BATCH_SIZE);
+		status_t error = prepare_userland_message_batch(*batch,
+			userMessages + sent, batchCount, true);
+		if (error != B_OK)
+			return result = sent > 0 ? (ssize_t)sent : error;
+
+		ssize_t batchSent = common_sendmmsg(socket, batch->messages,
+			batchCount, flags, false);
+		if (batchSent < 0)
+			return result = sent > 0 ? (ssize_t)sent : batchSent;
+
+		for (ssize_t i = 0; i < batchSent; i++) {
+			if (user_memcpy(&userMessages[sent + i].msg_len,
+					&batch->messages[i].msg_len, sizeof(unsigned int))
+						!= B_OK) {
+				return B_BAD_ADDRESS;
+			}
+		}
+
+		sent += batchSent;
+		if ((uint32)batchSent < batchCount)
+			break;
+	}
+
+	return result = sent;
+}
+
+
 status_t
 _user_getsockopt(int socket, int level, int option, void *userValue,
 	socklen_t *_length)
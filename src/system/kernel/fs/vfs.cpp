@@ -111,6 +111,10 @@ const static size_t kMaxPathLength = 65536;
 	// The absolute maximum path length (for getcwd() - this is not depending
 	// on PATH_MAX
 
+const static size_t kMaxReadDirStatBufferSize = 64 * 1024;
+const static uint32 kMaxReadDirStatCount = 256;
+	// limits for the kernel buffers used by _user_read_dir_stat()
+
 
 struct vnode_hash_key {
 	dev_t	device;
@@ -4689,18 +4693,24 @@ vfs_exec_io_context(io_context* context)
 		mutex_lock(&context->io_mutex);
 
 		struct file_descriptor* descriptor = context->fds[i];
+		select_info* selectInfos = NULL;
 		bool remove = false;
 
 		if (descriptor != NULL && fd_close_on_exec(context, i)) {
 			context->fds[i] = NULL;
 			context->num_used_fds--;
 
+			selectInfos = context->select_infos[i];
+			context->select_infos[i] = NULL;
+
 			remove = true;
 		}
 
 		mutex_unlock(&context->io_mutex);
 
 		if (remove) {
+			if (selectInfos != NULL)
+				deselect_select_infos(descriptor, selectInfos);
 			close_fd(descriptor);
 			put_fd(descriptor);
 		}
@@ -4820,6 +4830,17 @@ vfs_free_io_context(io_context* context)
 	if (context->cwd)
 		put_vnode(context->cwd);
 
+	// Selectors that outlive the context (like event queues) must learn that
+	// their FDs are gone, before any of the FDs is closed. Nobody else can
+	// use the context anymore, so we don't need to lock it for this.
+	for (i = 0; i < context->table_size; i++) {
+		select_info* selectInfos = context->select_infos[i];
+		if (selectInfos != NULL) {
+			context->select_infos[i] = NULL;
+			deselect_select_infos(context->fds[i], selectInfos);
+		}
+	}
+
 	mutex_lock(&context->io_mutex);
 
 	for (i = 0; i < context->table_size; i++) {
@@ -6286,6 +6307,80 @@ common_path_read_stat(int fd, char* path, bool traverseLeafLink,
 }
 
 
+/*!	Reads the next entries of the directory \a fd and the stat data of the
+	nodes they refer to in one go. Symlinks are not traversed.
+
+	The stat data are written to \a stats, \a statSize bytes per entry. If
+	the stat data of an entry cannot be read (e.g. since it has been removed
+	in the meantime), its \c st_ino field is set to -1 and the remainder of
+	the stat data is undefined. The same goes for all entries when the caller
+	is not allowed to search the directory.
+
+	\return The number of entries read, or an error code.
+*/
+static ssize_t
+common_read_dir_stat(int fd, struct dirent* buffer, size_t bufferSize,
+	uint32 maxCount, void* stats, size_t statSize, bool kernel)
+{
+	FUNCTION(("common_read_dir_stat: fd: %d, buffer %p, count %lu\n", fd,
+		buffer, maxCount));
+
+	struct io_context* ioContext = get_current_io_context(kernel);
+	struct file_descriptor* descriptor = get_fd(ioContext, fd);
+	if (descriptor == NULL)
+		return B_FILE_ERROR;
+
+	if (descriptor->type != FDTYPE_DIR) {
+		put_fd(descriptor);
+		return B_NOT_A_DIRECTORY;
+	}
+
+	// Looking up the entries by path would require the right to search the
+	// directory; reading their stat data by ID must not bypass that.
+	status_t searchStatus = B_OK;
+	struct vnode* directory = descriptor->u.vnode;
+	if (!kernel && HAS_FS_CALL(directory, access))
+		searchStatus = FS_CALL(directory, access, X_OK);
+
+	uint32 count = maxCount;
+	status_t status = dir_read(ioContext, descriptor, buffer, bufferSize,
+		&count);
+	put_fd(descriptor);
+	if (status != B_OK)
+		return status;
+
+	// Get the nodes by ID -- fix_dirent() has already resolved mount points,
+	// so we don't have to resolve any paths here.
+	struct dirent* entry = buffer;
+	for (uint32 i = 0; i < count; i++) {
+		struct stat stat;
+		struct vnode* vnode;
+		status = searchStatus;
+		if (status == B_OK) {
+			status = get_vnode(entry->d_dev, entry->d_ino, &vnode, true,
+				false);
+		}
+		if (status == B_OK) {
+			status = FS_CALL(vnode, read_stat, &stat);
+			put_vnode(vnode);
+		}
+
+		if (status == B_OK) {
+			stat.st_dev = entry->d_dev;
+			stat.st_ino = entry->d_ino;
+			stat.st_rdev = -1;
+		} else
+			stat.st_ino = -1;
+
+		memcpy((uint8*)stats + i * statSize, &stat, statSize);
+
+		entry = (struct dirent*)((uint8*)entry + entry->d_reclen);
+	}
+
+	return count;
+}
+
+
 static status_t
 common_path_write_stat(int fd, char* path, bool traverseLeafLink,
 	const struct stat* stat, int statMask, bool kernel)
@@ -8172,6 +8267,33 @@ _kern_read_stat(int fd, const char* path, bool traverseLeafLink,
 }
 
 
+/*!	\brief Reads directory entries and the stat data of their nodes.
+
+	Works like _kern_read_dir() followed by a _kern_read_stat() (not
+	traversing symlinks) for each of the returned entries, but saves the path
+	lookups and the additional calls.
+
+	\param fd The directory FD.
+	\param buffer The buffer the dirents shall be written into.
+	\param bufferSize The size of \a buffer.
+	\param maxCount The maximum number of entries to be read.
+	\param stats An array of at least \a maxCount stat buffers.
+	\param statSize The size of each of the supplied stat buffers.
+	\return The number of entries read, or an error code. An entry whose
+			stat data could not be read has its \c st_ino set to -1.
+*/
+ssize_t
+_kern_read_dir_stat(int fd, struct dirent* buffer, size_t bufferSize,
+	uint32 maxCount, struct stat* stats, size_t statSize)
+{
+	if (statSize > sizeof(struct stat))
+		return B_BAD_VALUE;
+
+	return common_read_dir_stat(fd, buffer, bufferSize, maxCount, stats,
+		statSize, true);
+}
+
+
 /*!	\brief Writes stat data of an entity specified by a FD + path pair.
 
 	If only \a fd is given, the stat operation associated with the type
@@ -9154,6 +9276,58 @@ _user_read_stat(int fd, const char* userPath, bool traverseLink,
 }
 
 
+ssize_t
+_user_read_dir_stat(int fd, struct dirent* userBuffer, size_t bufferSize,
+	uint32 maxCount, struct stat* userStats, size_t statSize)
+{
+	if (statSize > sizeof(struct stat))
+		return B_BAD_VALUE;
+
+	if (maxCount == 0)
+		return 0;
+
+	if (userBuffer == NULL || !IS_USER_ADDRESS(userBuffer)
+		|| userStats == NULL || !IS_USER_ADDRESS(userStats))
+		return B_BAD_ADDRESS;
+
+	// restrict the request and allocate heap buffers
+	if (bufferSize > kMaxReadDirStatBufferSize)
+		bufferSize = kMaxReadDirStatBufferSize;
+	if (maxCount > kMaxReadDirStatCount)
+		maxCount = kMaxReadDirStatCount;
+
+	struct dirent* buffer = (struct dirent*)malloc(bufferSize);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter bufferDeleter(buffer);
+
+	void* stats = malloc(maxCount * statSize);
+	if (stats == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter statsDeleter(stats);
+
+	ssize_t count = common_read_dir_stat(fd, buffer, bufferSize, maxCount,
+		stats, statSize, false);
+	if (count <= 0)
+		return count;
+
+	// copy the buffers back -- determine the total dirent size first
+	size_t sizeToCopy = 0;
+	struct dirent* entry = buffer;
+	for (ssize_t i = 0; i < count; i++) {
+		size_t length = entry->d_reclen;
+		sizeToCopy += length;
+		entry = (struct dirent*)((uint8*)entry + length);
+	}
+
+	if (user_memcpy(userBuffer, buffer, sizeToCopy) != B_OK
+		|| user_memcpy(userStats, stats, count * statSize) != B_OK)
+		return B_BAD_ADDRESS;
+
+	return count;
+}
+
+
 status_t
 _user_write_stat(int fd, const char* userPath, bool traverseLeafLink,
 	const struct stat* userStat, size_t statSize, int statMask)
@@ -371,6 +371,44 @@ vfs_vnode_io(struct vnode* vnode, void* cookie, io_request* request)
 }
 
 
+/*!	Returns whether asynchronous I/O requests for the node of \a descriptor
+	can be passed to vfs_vnode_io() without bypassing a file cache. That is
+	the case for devices and for files that have been opened with
+	\c O_NOCACHE, if their file system implements the io() hook.
+*/
+bool
+vfs_can_do_uncached_io(file_descriptor* descriptor)
+{
+	if (descriptor->type != FDTYPE_FILE)
+		return false;
+
+	struct vnode* vnode = descriptor->u.vnode;
+	if (!HAS_FS_CALL(vnode, io))
+		return false;
+
+	return (descriptor->open_mode & O_NOCACHE) != 0
+		|| S_ISCHR(vnode->Type()) || S_ISBLK(vnode->Type());
+}
+
+
+/*!	Returns whether I/O on \a descriptor can be done at a given offset,
+	that is, whether lseek() would accept it. Pipes, FIFOs and sockets
+	ignore the offset of their read and write hooks.
+*/
+bool
+vfs_is_seekable(file_descriptor* descriptor)
+{
+	if (descriptor->ops->fd_seek == NULL)
+		return false;
+
+	if (descriptor->type != FDTYPE_FILE)
+		return true;
+
+	struct vnode* vnode = descriptor->u.vnode;
+	return !S_ISFIFO(vnode->Type()) && !S_ISSOCK(vnode->Type());
+}
+
+
 status_t
 vfs_synchronous_io(io_request* request,
 	status_t (*doIO)(void* cookie, off_t offset, void* buffer, size_t* length),
@@ -25,6 +25,9 @@ struct UserMutexEntry : public DoublyLinkedListLinkImpl<UserMutexEntry> {
 	addr_t				address;
 	ConditionVariable	condition;
 	bool				locked;
+	bool				requeued;
+	int32*				requeueMutex;
+	addr_t				requeueAddress;
 	UserMutexEntryList	otherEntries;
 	UserMutexEntry*		hashNext;
 };
@@ -98,9 +101,18 @@ remove_user_mutex_entry(UserMutexEntry* entry)
 }
 
 
+/*!	Locks the user mutex \a mutex, waiting if necessary.
+
+	If \a requeueMutex is given, the caller must have wired its page as well.
+	A _user_mutex_requeue() call may then move the waiting thread from \a mutex
+	to \a requeueMutex. In that case, when the function succeeds, the thread
+	owns \a requeueMutex, not \a mutex, and \c B_USER_MUTEX_REQUEUED is
+	returned.
+*/
 static status_t
 user_mutex_lock_locked(vint32* mutex, addr_t physicalAddress, const char* name,
-	uint32 flags, bigtime_t timeout, MutexLocker& locker)
+	uint32 flags, bigtime_t timeout, MutexLocker& locker,
+	int32* requeueMutex = NULL, addr_t requeueAddress = 0)
 {
 	// mark the mutex locked + waiting
 	int32 oldValue = atomic_or(mutex,
@@ -120,6 +132,9 @@ user_mutex_lock_locked(vint32* mutex, addr_t physicalAddress, const char* name,
 	UserMutexEntry entry;
 	entry.address = physicalAddress;
 	entry.locked = false;
+	entry.requeued = false;
+	entry.requeueMutex = requeueMutex;
+	entry.requeueAddress = requeueAddress;
 	add_user_mutex_entry(&entry);
 
 	// wait
@@ -131,6 +146,11 @@ user_mutex_lock_locked(vint32* mutex, addr_t physicalAddress, const char* name,
 	status_t error = waitEntry.Wait(flags, timeout);
 	locker.Lock();
 
+	// If we have been requeued in the meantime, we're waiting for the other
+	// mutex now.
+	if (entry.requeued)
+		mutex = entry.requeueMutex;
+
 	// dequeue
 	if (!remove_user_mutex_entry(&entry)) {
 		// no one is waiting anymore -- clear the waiting flag
@@ -143,6 +163,9 @@ user_mutex_lock_locked(vint32* mutex, addr_t physicalAddress, const char* name,
 		error = B_OK;
 	}
 
+	if (error == B_OK && entry.requeued)
+		return B_USER_MUTEX_REQUEUED;
+
 	return error;
 }
 
@@ -177,6 +200,63 @@ user_mutex_unlock_locked(vint32* mutex, addr_t physicalAddress, uint32 flags)
 }
 
 
+/*!	Unblocks the first thread waiting on \a fromMutex and moves all other
+	waiting threads that are prepared to be requeued to \a toMutex (cf.
+	user_mutex_lock_locked()), without waking them up. Threads that cannot be
+	requeued are unblocked. This avoids the thundering herd a condition
+	variable broadcast would otherwise cause on the associated mutex.
+*/
+static void
+user_mutex_requeue_locked(vint32* fromMutex, addr_t fromAddress,
+	vint32* toMutex, addr_t toAddress)
+{
+	UserMutexEntry* entry = sUserMutexTable.Lookup(fromAddress);
+	if (entry == NULL) {
+		// no one is waiting -- clear locked flag
+		atomic_and(fromMutex, ~(int32)B_USER_MUTEX_LOCKED);
+		return;
+	}
+
+	// unblock the first thread
+	int32 oldValue = atomic_or(fromMutex, B_USER_MUTEX_LOCKED);
+	entry->locked = true;
+	entry->condition.NotifyOne();
+
+	UserMutexEntry* firstRequeued = NULL;
+	for (UserMutexEntryList::Iterator it = entry->otherEntries.GetIterator();
+			UserMutexEntry* otherEntry = it.Next();) {
+		if ((oldValue & B_USER_MUTEX_DISABLED) != 0
+			|| otherEntry->requeueMutex == NULL
+			|| otherEntry->requeueAddress != toAddress) {
+			// can't requeue this one -- just unblock it
+			otherEntry->locked = true;
+			otherEntry->condition.NotifyOne();
+			continue;
+		}
+
+		it.Remove();
+		otherEntry->address = toAddress;
+		otherEntry->requeued = true;
+		add_user_mutex_entry(otherEntry);
+		if (firstRequeued == NULL)
+			firstRequeued = otherEntry;
+	}
+
+	if (firstRequeued == NULL)
+		return;
+
+	// mark the target mutex locked + waiting
+	oldValue = atomic_or(toMutex, B_USER_MUTEX_LOCKED | B_USER_MUTEX_WAITING);
+	if ((oldValue & (B_USER_MUTEX_LOCKED | B_USER_MUTEX_WAITING)) == 0
+		|| (oldValue & B_USER_MUTEX_DISABLED) != 0) {
+		// The mutex wasn't locked, so no one would ever unlock it. We have just
+		// locked it on behalf of the first requeued thread.
+		firstRequeued->locked = true;
+		firstRequeued->condition.NotifyOne();
+	}
+}
+
+
 static status_t
 user_mutex_lock(int32* mutex, const char* name, uint32 flags, bigtime_t timeout)
 {
@@ -226,7 +306,8 @@ user_mutex_switch_lock(int32* fromMutex, int32* toMutex, const char* name,
 			flags);
 
 		error = user_mutex_lock_locked(toMutex, toWiringInfo.physicalAddress,
-			name, flags, timeout, locker);
+			name, flags, timeout, locker, fromMutex,
+			fromWiringInfo.physicalAddress);
 	}
 
 	// unwire the pages
@@ -237,6 +318,37 @@ user_mutex_switch_lock(int32* fromMutex, int32* toMutex, const char* name,
 }
 
 
+static status_t
+user_mutex_requeue(int32* fromMutex, int32* toMutex)
+{
+	// wire the pages and get the physical addresses
+	VMPageWiringInfo fromWiringInfo;
+	status_t error = vm_wire_page(B_CURRENT_TEAM, (addr_t)fromMutex, true,
+		&fromWiringInfo);
+	if (error != B_OK)
+		return error;
+
+	VMPageWiringInfo toWiringInfo;
+	error = vm_wire_page(B_CURRENT_TEAM, (addr_t)toMutex, true, &toWiringInfo);
+	if (error != B_OK) {
+		vm_unwire_page(&fromWiringInfo);
+		return error;
+	}
+
+	{
+		MutexLocker locker(sUserMutexTableLock);
+		user_mutex_requeue_locked(fromMutex, fromWiringInfo.physicalAddress,
+			toMutex, toWiringInfo.physicalAddress);
+	}
+
+	// unwire the pages
+	vm_unwire_page(&toWiringInfo);
+	vm_unwire_page(&fromWiringInfo);
+
+	return B_OK;
+}
+
+
 // #pragma mark - kernel private
 
 
@@ -304,3 +416,19 @@ _user_mutex_switch_lock(int32* fromMutex, int32* toMutex, const char* name,
 	return user_mutex_switch_lock(fromMutex, toMutex, name,
 		flags | B_CAN_INTERRUPT, timeout);
 }
+
+
+status_t
+_user_mutex_requeue(int32* fromMutex, int32* toMutex)
+{
+	if (fromMutex == NULL || !IS_USER_ADDRESS(fromMutex)
+			|| (addr_t)fromMutex % 4 != 0 || toMutex == NULL
+			|| !IS_USER_ADDRESS(toMutex) || (addr_t)toMutex % 4 != 0) {
+		return B_BAD_ADDRESS;
+	}
+
+	if (fromMutex == toMutex)
+		return B_BAD_VALUE;
+
+	return user_mutex_requeue(fromMutex, toMutex);
+}
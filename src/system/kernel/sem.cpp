@@ -64,6 +64,9 @@
 //   additional need sSemsSpinlock for write access.
 //   lock itself doesn't need protection -- sem_entry objects are never deleted.
 //
+// Acquiring and releasing a semaphore only requires the sem_entry::lock; the
+// scheduler lock is only needed, if threads have to be blocked or unblocked.
+//
 // The locking order is sSemsSpinlock -> sem_entry::lock -> scheduler lock. All
 // semaphores are in the sSems array (sem_entry[]). Access by sem_id requires
 // computing the object index (id % sMaxSems), locking the respective
@@ -970,10 +973,25 @@ release_sem_etc(sem_id id, int32 count, uint32 flags)
 		flags |= B_RELEASE_IF_WAITING_ONLY;
 	}
 
+	// Fast path: if no one is waiting, we don't need to touch the global
+	// scheduler lock at all.
+	if (sSems[slot].queue.IsEmpty()) {
+		if ((flags & B_RELEASE_IF_WAITING_ONLY) == 0) {
+			sSems[slot].u.used.count += count;
+			sSems[slot].u.used.net_count += count;
+		}
+
+		if (sSems[slot].u.used.count > 0)
+			notify_sem_select_events(&sSems[slot], B_EVENT_ACQUIRE_SEMAPHORE);
+
+		return B_OK;
+	}
+
 	// Grab the scheduler lock, so thread_is_blocked() is reliable (due to
 	// possible interruptions or timeouts, it wouldn't be otherwise).
 	SpinLocker schedulerLocker(gSchedulerLock);
 
+	bool unblockedThreads = false;
 	while (count > 0) {
 		queued_thread* entry = sSems[slot].queue.Head();
 		if (entry == NULL) {
@@ -994,6 +1012,7 @@ release_sem_etc(sem_id id, int32 count, uint32 flags)
 			}
 
 			thread_unblock_locked(entry->thread, B_OK);
+			unblockedThreads = true;
 
 			int delta = min_c(count, entry->count);
 			sSems[slot].u.used.count += delta;
@@ -1016,7 +1035,7 @@ release_sem_etc(sem_id id, int32 count, uint32 flags)
 
 	// If we've unblocked another thread reschedule, if we've not explicitly
 	// been told not to.
-	if ((flags & B_DO_NOT_RESCHEDULE) == 0) {
+	if (unblockedThreads && (flags & B_DO_NOT_RESCHEDULE) == 0) {
 		semLocker.Unlock();
 		schedulerLocker.Lock();
 		scheduler_reschedule_if_necessary_locked();
@@ -398,6 +398,7 @@ create_select_sync(int numFDs, select_sync*& _sync)
 
 	sync->count = numFDs;
 	sync->ref_count = 1;
+	sync->notify = NULL;
 
 	for (int i = 0; i < numFDs; i++) {
 		sync->set[i].next = NULL;
@@ -705,8 +706,14 @@ notify_select_events(select_info* info, uint16 events)
 
 	// only wake up the waiting select()/poll() call if the events
 	// match one of the selected ones
-	if (info->selected_events & events)
+	if (info->selected_events & events) {
+		if (info->sync->notify != NULL) {
+			info->sync->notify(info);
+			return B_OK;
+		}
+
 		return release_sem_etc(info->sync->sem, 1, B_DO_NOT_RESCHEDULE);
+	}
 
 	return B_OK;
 }
@@ -79,14 +79,22 @@ cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, bigtime_t timeout)
 		timeout == B_INFINITE_TIMEOUT ? 0 : B_ABSOLUTE_REAL_TIME_TIMEOUT,
 		timeout);
 
-	if (status == B_INTERRUPTED) {
-		// EINTR is not an allowed return value. We either have to restart
-		// waiting -- which we can't atomically -- or return a spurious 0.
+	if (status == B_USER_MUTEX_REQUEUED) {
+		// A broadcast has moved us over to the mutex and we have been handed
+		// its lock already.
+		mutex->owner = find_thread(NULL);
+		mutex->owner_count = 1;
 		status = 0;
+	} else {
+		if (status == B_INTERRUPTED) {
+			// EINTR is not an allowed return value. We either have to restart
+			// waiting -- which we can't atomically -- or return a spurious 0.
+			status = 0;
+		}
+
+		pthread_mutex_lock(mutex);
 	}
 
-	pthread_mutex_lock(mutex);
-
 	cond->waiter_count--;
 	// If there are no more waiters, we can change mutexes.
 	if (cond->waiter_count == 0)
@@ -102,6 +110,17 @@ cond_signal(pthread_cond_t* cond, bool broadcast)
 	if (cond->waiter_count == 0)
 		return;
 
+	pthread_mutex_t* mutex = cond->mutex;
+	if (broadcast && mutex != NULL) {
+		// Wake up only one waiter and move the others directly to the mutex,
+		// so they don't all compete for it at once. If that fails, we fall
+		// back to waking up everyone.
+		if (_kern_mutex_requeue((int32*)&cond->lock, (int32*)&mutex->lock)
+				== B_OK) {
+			return;
+		}
+	}
+
 	// release the condition lock
 	_kern_mutex_unlock((int32*)&cond->lock,
 		broadcast ? B_USER_MUTEX_UNBLOCK_ALL : 0);
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <smp.h>
+
+#include <KernelExport.h>
+#include <TLS.h>
+
+
+/*!	Every thread is assigned one of the CPUs of the machine. Disabling
+	interrupts acquires that CPU exclusively, so that per-CPU data is
+	protected the same way as in the kernel.
+*/
+struct EmulatedCPU {
+	EmulatedCPU()
+		:
+		fCount(1),
+		fSemaphore(create_sem(0, "emulated cpu"))
+	{
+		if (fSemaphore < 0)
+			panic("Failed to create emulated CPU semaphore!");
+	}
+
+	~EmulatedCPU()
+	{
+		if (fSemaphore >= 0)
+			delete_sem(fSemaphore);
+	}
+
+	void Lock()
+	{
+		if (atomic_add(&fCount, -1) > 0)
+			return;
+
+		status_t error;
+		do {
+			error = acquire_sem(fSemaphore);
+		} while (error == B_INTERRUPTED);
+	}
+
+	void Unlock()
+	{
+		if (atomic_add(&fCount, 1) < 0)
+			release_sem(fSemaphore);
+	}
+
+private:
+	vint32	fCount;
+	sem_id	fSemaphore;
+};
+
+static EmulatedCPU sCPUs[B_MAX_CPU_COUNT];
+static int32 sCPUCount = 0;
+static int32 sLockedCPUSlot = tls_allocate();
+	// contains the index of the CPU + 1 while interrupts are disabled
+
+
+static inline int32
+cpu_for_thread()
+{
+	return find_thread(NULL) % smp_get_num_cpus();
+}
+
+
+int32
+smp_get_num_cpus(void)
+{
+	if (sCPUCount == 0) {
+		system_info info;
+		get_system_info(&info);
+		sCPUCount = info.cpu_count > B_MAX_CPU_COUNT
+			? B_MAX_CPU_COUNT : info.cpu_count;
+	}
+
+	return sCPUCount;
+}
+
+
+int32
+smp_get_current_cpu(void)
+{
+	int32 locked = (int32)(addr_t)tls_get(sLockedCPUSlot);
+	if (locked != 0)
+		return locked - 1;
+
+	return cpu_for_thread();
+}
+
+
+cpu_status
+disable_interrupts(void)
+{
+	if (tls_get(sLockedCPUSlot) != NULL)
+		return 0;
+
+	int32 cpu = cpu_for_thread();
+	sCPUs[cpu].Lock();
+	tls_set(sLockedCPUSlot, (void*)(addr_t)(cpu + 1));
+	return 1;
+}
+
+
+void
+restore_interrupts(cpu_status status)
+{
+	if (status == 0)
+		return;
+
+	int32 cpu = (int32)(addr_t)tls_get(sLockedCPUSlot) - 1;
+	tls_set(sLockedCPUSlot, NULL);
+	sCPUs[cpu].Unlock();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how fast BMessage adds, finds, flattens and unflattens messages
+	with a growing number of fields, and checks that the messages survive
+	the round trip unchanged.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Message.h>
+#include <OS.h>
+#include <Point.h>
+#include <String.h>
+
+
+static const int32 kFieldCounts[] = { 10, 100, 500, 2000 };
+static const bigtime_t kTestDuration = 500000;
+
+
+static void
+fill_message(BMessage& message, int32 fieldCount, const BString* names)
+{
+	message.MakeEmpty();
+
+	for (int32 i = 0; i < fieldCount; i++) {
+		switch (i % 3) {
+			case 0:
+				message.AddInt32(names[i].String(), i);
+				break;
+			case 1:
+				message.AddPoint(names[i].String(), BPoint(i, i));
+				break;
+			case 2:
+				message.AddString(names[i].String(), names[i]);
+				break;
+		}
+	}
+}
+
+
+static bool
+check_message(const BMessage& message, int32 fieldCount,
+	const BString* names)
+{
+	if (message.CountNames(B_ANY_TYPE) != fieldCount)
+		return false;
+
+	for (int32 i = 0; i < fieldCount; i++) {
+		switch (i % 3) {
+			case 0:
+				if (message.FindInt32(names[i].String()) != i)
+					return false;
+				break;
+			case 1:
+				if (message.FindPoint(names[i].String()) != BPoint(i, i))
+					return false;
+				break;
+			case 2:
+			{
+				const char* string = message.FindString(names[i].String());
+				if (string == NULL || names[i] != string)
+					return false;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+static void
+print_result(const char* test, int32 iterations, int32 fieldCount,
+	bigtime_t duration)
+{
+	printf("  %-10s %10.1f fields/ms\n", test,
+		1000.0 * iterations * fieldCount / duration);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 failures = 0;
+	int32 testCount = sizeof(kFieldCounts) / sizeof(kFieldCounts[0]);
+	for (int32 i = 0; i < testCount; i++) {
+		int32 fieldCount = kFieldCounts[i];
+		BString* names = new BString[fieldCount];
+		for (int32 j = 0; j < fieldCount; j++)
+			names[j] << "field " << j;
+
+		printf("%ld fields:\n", fieldCount);
+
+		BMessage message('test');
+		int32 iterations = 0;
+		bigtime_t start = system_time();
+		bigtime_t duration;
+		do {
+			fill_message(message, fieldCount, names);
+			iterations++;
+			duration = system_time() - start;
+		} while (duration < kTestDuration);
+		print_result("Add", iterations, fieldCount, duration);
+
+		iterations = 0;
+		start = system_time();
+		do {
+			if (!check_message(message, fieldCount, names))
+				failures++;
+			iterations++;
+			duration = system_time() - start;
+		} while (duration < kTestDuration);
+		print_result("Find", iterations, fieldCount, duration);
+
+		ssize_t size = message.FlattenedSize();
+		char* buffer = (char*)malloc(size);
+		if (buffer == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+
+		iterations = 0;
+		start = system_time();
+		do {
+			if (message.Flatten(buffer, size) != B_OK)
+				failures++;
+			iterations++;
+			duration = system_time() - start;
+		} while (duration < kTestDuration);
+		print_result("Flatten", iterations, fieldCount, duration);
+
+		BMessage copy;
+		iterations = 0;
+		start = system_time();
+		do {
+			if (copy.Unflatten(buffer) != B_OK)
+				failures++;
+			iterations++;
+			duration = system_time() - start;
+		} while (duration < kTestDuration);
+		print_result("Unflatten", iterations, fieldCount, duration);
+
+		if (copy.what != message.what
+			|| !check_message(copy, fieldCount, names)) {
+			printf("  unflattened message does not match!\n");
+			failures++;
+		}
+
+		free(buffer);
+		delete[] names;
+	}
+
+	return failures > 0 ? 1 : 0;
+}
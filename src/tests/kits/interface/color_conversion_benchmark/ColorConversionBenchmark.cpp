@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how many pixels per second ConvertBits() converts between the
+	most common color spaces, with the generic conversion, with the SIMD
+	versions the CPU supports, and with those spread over all CPUs. It also
+	checks that all of them produce the same results.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+#include <Point.h>
+
+#include <ColorConversion.h>
+
+
+using BPrivate::ConvertBits;
+
+static const int32 kWidth = 1920;
+static const int32 kHeight = 1080;
+static const bigtime_t kTestDuration = 500000;
+
+
+struct test_case {
+	color_space	source;
+	color_space	dest;
+	const char*	name;
+};
+
+static const test_case kTestCases[] = {
+	{ B_RGB32, B_RGBA32, "B_RGB32 -> B_RGBA32" },
+	{ B_RGB32, B_RGB16, "B_RGB32 -> B_RGB16" },
+	{ B_RGB32, B_RGB15, "B_RGB32 -> B_RGB15" },
+	{ B_RGBA32, B_RGBA15, "B_RGBA32 -> B_RGBA15" },
+	{ B_RGB32, B_RGB24, "B_RGB32 -> B_RGB24" },
+	{ B_RGB32, B_GRAY8, "B_RGB32 -> B_GRAY8" },
+	{ B_RGB24, B_RGB32, "B_RGB24 -> B_RGB32" },
+	{ B_RGB16, B_RGB32, "B_RGB16 -> B_RGB32" },
+	{ B_RGB15, B_RGB32, "B_RGB15 -> B_RGB32" },
+	{ B_RGBA15, B_RGBA32, "B_RGBA15 -> B_RGBA32" },
+	{ B_CMAP8, B_RGB32, "B_CMAP8 -> B_RGB32" },
+	{ B_RGB32, B_CMAP8, "B_RGB32 -> B_CMAP8" }
+};
+
+struct mode {
+	const char*	name;
+	uint32		flags;
+};
+
+static const mode kModes[] = {
+	{ "generic", 0 },
+	{ "SIMD", BPrivate::COLOR_CONVERSION_SSE2
+		| BPrivate::COLOR_CONVERSION_SSSE3 },
+	{ "SIMD + threads", BPrivate::COLOR_CONVERSION_SSE2
+		| BPrivate::COLOR_CONVERSION_SSSE3
+		| BPrivate::COLOR_CONVERSION_THREADS }
+};
+static const int32 kModeCount = sizeof(kModes) / sizeof(kModes[0]);
+
+
+static int32
+bytes_per_row(color_space space)
+{
+	size_t pixelChunk;
+	size_t rowAlignment;
+	size_t pixelsPerChunk;
+	if (get_pixel_size_for(space, &pixelChunk, &rowAlignment,
+			&pixelsPerChunk) != B_OK)
+		return 0;
+
+	int32 bytesPerRow = kWidth * pixelChunk / pixelsPerChunk;
+	return (bytesPerRow + rowAlignment - 1) / rowAlignment * rowAlignment;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	srand(42);
+
+	printf("Converting %ldx%ld pixels, optimizations supported: %s%s%s\n\n",
+		kWidth, kHeight,
+		(BPrivate::SetColorConversionFlags(~0UL)
+			& BPrivate::COLOR_CONVERSION_SSE2) != 0 ? "SSE2 " : "",
+		(BPrivate::ColorConversionFlags()
+			& BPrivate::COLOR_CONVERSION_SSSE3) != 0 ? "SSSE3 " : "",
+		(BPrivate::ColorConversionFlags()
+			& BPrivate::COLOR_CONVERSION_THREADS) != 0 ? "threads" : "");
+
+	int32 failures = 0;
+	int32 testCount = sizeof(kTestCases) / sizeof(kTestCases[0]);
+	for (int32 i = 0; i < testCount; i++) {
+		const test_case& test = kTestCases[i];
+		int32 sourceBytesPerRow = bytes_per_row(test.source);
+		int32 destBytesPerRow = bytes_per_row(test.dest);
+		int32 sourceLength = sourceBytesPerRow * kHeight;
+		int32 destLength = destBytesPerRow * kHeight;
+
+		uint8* source = (uint8*)malloc(sourceLength);
+		uint8* reference = (uint8*)malloc(destLength);
+		uint8* dest = (uint8*)malloc(destLength);
+		if (source == NULL || reference == NULL || dest == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+
+		for (int32 j = 0; j < sourceLength; j++)
+			source[j] = rand();
+
+		printf("%s:\n", test.name);
+
+		float genericRate = 0;
+		for (int32 j = 0; j < kModeCount; j++) {
+			BPrivate::SetColorConversionFlags(kModes[j].flags);
+			uint8* target = j == 0 ? reference : dest;
+			memset(target, 0, destLength);
+
+			int32 iterations = 0;
+			bigtime_t start = system_time();
+			bigtime_t duration;
+			do {
+				ConvertBits(source, target, sourceLength, destLength,
+					sourceBytesPerRow, destBytesPerRow, test.source,
+					test.dest, kWidth, kHeight);
+				iterations++;
+				duration = system_time() - start;
+			} while (duration < kTestDuration);
+
+			float rate = (float)kWidth * kHeight * iterations / duration;
+			if (j == 0)
+				genericRate = rate;
+
+			bool matches = j == 0 || memcmp(reference, dest, destLength) == 0;
+			if (!matches)
+				failures++;
+
+			printf("  %-16s %8.1f Mpixels/s (%.2fx)%s\n", kModes[j].name,
+				rate, rate / genericRate, matches ? "" : " - MISMATCH!");
+		}
+
+		free(source);
+		free(reference);
+		free(dest);
+	}
+
+	BPrivate::SetColorConversionFlags(~0UL);
+
+	if (failures > 0) {
+		printf("\n%ld conversions did not match the generic version!\n",
+			failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures the region operations the app_server uses for its clipping,
+	with regions shaped like those of a crowded desktop.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+#include <Region.h>
+
+
+static const BRect kScreen(0, 0, 1919, 1079);
+static const int32 kWindowCount = 40;
+static const float kTabHeight = 21;
+static const bigtime_t kTestDuration = 500000;
+
+
+struct window_frame {
+	BRect	frame;
+	BRect	tab;
+};
+
+
+class Test {
+public:
+	Test(const char* name)
+		:
+		fName(name)
+	{
+	}
+
+	virtual ~Test()
+	{
+	}
+
+	const char* Name() const
+	{
+		return fName;
+	}
+
+	virtual void Prepare()
+	{
+	}
+
+	virtual void Cleanup()
+	{
+	}
+
+	// Returns the number of region operations that have been done.
+	virtual int32 RunIteration() = 0;
+
+	// Used to make sure the results of the operations are not optimized
+	// away, and to compare different implementations.
+	virtual int32 Checksum() const = 0;
+
+private:
+	const char*	fName;
+};
+
+
+static window_frame sWindows[kWindowCount];
+
+
+static void
+init_windows()
+{
+	srand(42);
+
+	for (int32 i = 0; i < kWindowCount; i++) {
+		float width = 200 + rand() % 800;
+		float height = 150 + rand() % 600;
+		float left = rand() % (int32)(kScreen.Width() - width);
+		float top = kTabHeight + rand() % (int32)(kScreen.Height() - height
+			- kTabHeight);
+
+		window_frame& window = sWindows[i];
+		window.frame.Set(left - 5, top - 5, left + width + 5,
+			top + height + 5);
+		window.tab.Set(left - 5, top - kTabHeight - 5,
+			left - 5 + 80 + rand() % 120, top - 6);
+	}
+}
+
+
+//! Rebuilds the clipping of all windows, like Desktop does after a change.
+static int32
+rebuild_window_clipping(BRegion* visibleRegions, BRegion& stillAvailable)
+{
+	stillAvailable.Set(kScreen);
+	int32 operations = 0;
+
+	for (int32 i = kWindowCount - 1; i >= 0; i--) {
+		BRegion& visible = visibleRegions[i];
+		visible.Set(sWindows[i].tab);
+		visible.Include(sWindows[i].frame);
+		visible.IntersectWith(&stillAvailable);
+
+		stillAvailable.Exclude(&visible);
+		operations += 4;
+	}
+
+	return operations;
+}
+
+
+// #pragma mark -
+
+
+class WindowClippingTest : public Test {
+public:
+	WindowClippingTest()
+		: Test("Window clipping")
+	{
+	}
+
+	virtual int32 RunIteration()
+	{
+		return rebuild_window_clipping(fVisible, fStillAvailable);
+	}
+
+	virtual int32 Checksum() const
+	{
+		int32 checksum = fStillAvailable.CountRects();
+		for (int32 i = 0; i < kWindowCount; i++)
+			checksum += fVisible[i].CountRects();
+		return checksum;
+	}
+
+private:
+	BRegion		fVisible[kWindowCount];
+	BRegion		fStillAvailable;
+};
+
+
+class WindowMoveTest : public Test {
+public:
+	WindowMoveTest()
+		: Test("Moving a window")
+	{
+	}
+
+	virtual void Prepare()
+	{
+		fOriginal = sWindows[kWindowCount / 2];
+		fStep = 4;
+		fMoves = 0;
+	}
+
+	virtual void Cleanup()
+	{
+		sWindows[kWindowCount / 2] = fOriginal;
+	}
+
+	virtual int32 RunIteration()
+	{
+		// move the window in the middle of the stack back and forth,
+		// and find out what became dirty
+		window_frame& window = sWindows[kWindowCount / 2];
+		if (++fMoves % 50 == 0)
+			fStep = -fStep;
+
+		BRegion dirty(fVisible[kWindowCount / 2]);
+
+		window.frame.OffsetBy(fStep, 0);
+		window.tab.OffsetBy(fStep, 0);
+
+		int32 operations = rebuild_window_clipping(fVisible, fStillAvailable);
+
+		dirty.Include(&fVisible[kWindowCount / 2]);
+		for (int32 i = 0; i < kWindowCount; i++) {
+			BRegion exposed(dirty);
+			exposed.IntersectWith(&fVisible[i]);
+			operations += 2;
+		}
+
+		return operations + 2;
+	}
+
+	virtual int32 Checksum() const
+	{
+		return fStillAvailable.CountRects();
+	}
+
+private:
+	BRegion		fVisible[kWindowCount];
+	BRegion		fStillAvailable;
+	window_frame	fOriginal;
+	int32		fStep;
+	int32		fMoves;
+};
+
+
+class ViewClippingTest : public Test {
+public:
+	ViewClippingTest()
+		: Test("View clipping")
+	{
+	}
+
+	virtual int32 RunIteration()
+	{
+		// a window with a grid of child views, that are excluded from the
+		// clipping of their parent, and intersected with an update region
+		BRect bounds(0, 0, 799, 599);
+		fClipping.Set(bounds);
+
+		int32 operations = 1;
+		for (float y = 4; y < bounds.bottom - 20; y += 30) {
+			for (float x = 4; x < bounds.right - 60; x += 80) {
+				BRect child(x, y, x + 71, y + 23);
+				fClipping.Exclude(child);
+
+				BRegion childClipping(child);
+				childClipping.IntersectWith(&fClipping);
+				operations += 2;
+			}
+		}
+
+		BRegion update(BRect(100, 100, 499, 299));
+		update.Include(BRect(600, 400, 700, 500));
+		fClipping.IntersectWith(&update);
+
+		return operations + 2;
+	}
+
+	virtual int32 Checksum() const
+	{
+		return fClipping.CountRects();
+	}
+
+private:
+	BRegion		fClipping;
+};
+
+
+class RowBuildingTest : public Test {
+public:
+	RowBuildingTest()
+		: Test("Building regions row by row")
+	{
+	}
+
+	virtual int32 RunIteration()
+	{
+		// like converting a shape or a mask into a region
+		fRegion.MakeEmpty();
+
+		for (int32 y = 0; y < 512; y++) {
+			int32 width = 100 + (y * 7) % 300;
+			fRegion.Include(BRect(256 - width / 2, y, 256 + width / 2, y));
+		}
+		for (int32 y = 512; y < 768; y++)
+			fRegion.Include(BRect(56, y, 455, y));
+
+		return 768;
+	}
+
+	virtual int32 Checksum() const
+	{
+		return fRegion.CountRects();
+	}
+
+private:
+	BRegion		fRegion;
+};
+
+
+class PointLookupTest : public Test {
+public:
+	PointLookupTest()
+		: Test("Point lookups")
+	{
+	}
+
+	virtual void Prepare()
+	{
+		rebuild_window_clipping(fVisible, fStillAvailable);
+		fHits = 0;
+	}
+
+	virtual int32 RunIteration()
+	{
+		int32 hits = 0;
+		for (int32 i = 0; i < 1000; i++) {
+			int32 x = (i * 7919) % 1920;
+			int32 y = (i * 104729) % 1080;
+			if (fStillAvailable.Contains(x, y))
+				hits++;
+			if (fStillAvailable.Intersects(BRect(x, y, x + 15, y + 15)))
+				hits++;
+		}
+
+		fHits = hits;
+		return 2000;
+	}
+
+	virtual int32 Checksum() const
+	{
+		return fHits;
+	}
+
+private:
+	BRegion		fVisible[kWindowCount];
+	BRegion		fStillAvailable;
+	int32		fHits;
+};
+
+
+class DisjointTest : public Test {
+public:
+	DisjointTest()
+		: Test("Disjoint operations")
+	{
+	}
+
+	virtual void Prepare()
+	{
+		rebuild_window_clipping(fVisible, fStillAvailable);
+	}
+
+	virtual int32 RunIteration()
+	{
+		// most windows are not affected by a change in a small area
+		BRect changed(900, 500, 963, 563);
+		BRegion changedRegion(changed);
+
+		int32 operations = 0;
+		for (int32 i = 0; i < kWindowCount; i++) {
+			BRegion dirty(fVisible[i]);
+			dirty.IntersectWith(&changedRegion);
+			fVisible[i].Exclude(changed.OffsetByCopy(3000, 0));
+			operations += 2;
+		}
+
+		return operations;
+	}
+
+	virtual int32 Checksum() const
+	{
+		int32 checksum = 0;
+		for (int32 i = 0; i < kWindowCount; i++)
+			checksum += fVisible[i].CountRects();
+		return checksum;
+	}
+
+private:
+	BRegion		fVisible[kWindowCount];
+	BRegion		fStillAvailable;
+};
+
+
+// #pragma mark -
+
+
+static void
+run_test(Test& test)
+{
+	test.Prepare();
+
+	int64 operations = 0;
+	int32 iterations = 0;
+	bigtime_t start = system_time();
+	bigtime_t elapsed;
+
+	do {
+		operations += test.RunIteration();
+		iterations++;
+		elapsed = system_time() - start;
+	} while (elapsed < kTestDuration);
+
+	test.Cleanup();
+
+	printf("%-30s %9.2f us per iteration, %7.3f us per operation "
+		"(checksum %" B_PRId32 ")\n", test.Name(), (double)elapsed / iterations,
+		(double)elapsed / operations, test.Checksum());
+}
+
+
+int
+main(int argc, char** argv)
+{
+	init_windows();
+
+	Test* tests[] = {
+		new WindowClippingTest(),
+		new WindowMoveTest(),
+		new ViewClippingTest(),
+		new RowBuildingTest(),
+		new PointLookupTest(),
+		new DisjointTest()
+	};
+	int32 testCount = sizeof(tests) / sizeof(tests[0]);
+
+	for (int32 i = 0; i < testCount; i++) {
+		if (argc < 2 || strstr(tests[i]->Name(), argv[1]) != NULL)
+			run_test(*tests[i]);
+		delete tests[i];
+	}
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how many UDP packets per second the stack can receive over
+	the loopback device with a given number of flows, and CPUs enabled.
+	Each flow has its own sender, and receiver thread.
+*/
+
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+static const int kMaxFlows = 64;
+static const size_t kPacketSize = 64;
+
+struct flow {
+	int				sender;
+	int				receiver;
+	pthread_t		sender_thread;
+	pthread_t		receiver_thread;
+	int64			received;
+};
+
+static volatile bool sQuit;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: receive_scaling [-f <flows>] [-c <cpus>] "
+		"[-t <seconds>]\n"
+		"Sends UDP packets over the loopback device, and prints how many "
+		"were received\nper second. -c temporarily disables all but the "
+		"given number of CPUs.\n");
+	exit(1);
+}
+
+
+static void*
+sender(void* _flow)
+{
+	flow* current = (flow*)_flow;
+	char buffer[kPacketSize];
+	memset(buffer, 0, sizeof(buffer));
+
+	while (!sQuit)
+		send(current->sender, buffer, sizeof(buffer), 0);
+
+	return NULL;
+}
+
+
+static void*
+receiver(void* _flow)
+{
+	flow* current = (flow*)_flow;
+	char buffer[kPacketSize];
+
+	while (true) {
+		ssize_t bytes = recv(current->receiver, buffer, sizeof(buffer), 0);
+		if (sQuit)
+			break;
+		if (bytes > 0)
+			current->received++;
+	}
+
+	return NULL;
+}
+
+
+static void
+create_flow(flow& current)
+{
+	current.sender = socket(AF_INET, SOCK_DGRAM, 0);
+	current.receiver = socket(AF_INET, SOCK_DGRAM, 0);
+	current.received = 0;
+	if (current.sender < 0 || current.receiver < 0) {
+		fprintf(stderr, "failed to create socket: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addressLength = sizeof(address);
+
+	// the receive timeout lets the receivers notice when we're done
+	struct timeval timeout = {0, 100000};
+	setsockopt(current.receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+		sizeof(timeout));
+
+	if (bind(current.receiver, (sockaddr*)&address, addressLength) != 0
+		|| getsockname(current.receiver, (sockaddr*)&address,
+			&addressLength) != 0
+		|| connect(current.sender, (sockaddr*)&address, addressLength) != 0) {
+		fprintf(stderr, "failed to connect: %s\n", strerror(errno));
+		exit(1);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int flowCount = 1;
+	int cpuCount = 0;
+	int seconds = 5;
+
+	int option;
+	while ((option = getopt(argc, argv, "f:c:t:h")) != -1) {
+		switch (option) {
+			case 'f':
+				flowCount = atoi(optarg);
+				break;
+			case 'c':
+				cpuCount = atoi(optarg);
+				break;
+			case 't':
+				seconds = atoi(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (flowCount < 1 || flowCount > kMaxFlows || seconds < 1)
+		usage();
+
+	system_info info;
+	get_system_info(&info);
+
+	bool wasEnabled[B_MAX_CPU_COUNT];
+	for (int32 i = 0; i < info.cpu_count; i++) {
+		wasEnabled[i] = _kern_cpu_enabled(i);
+		if (cpuCount > 0 && i >= cpuCount && wasEnabled[i])
+			_kern_set_cpu_enabled(i, false);
+	}
+
+	flow flows[kMaxFlows];
+	for (int i = 0; i < flowCount; i++)
+		create_flow(flows[i]);
+
+	for (int i = 0; i < flowCount; i++) {
+		pthread_create(&flows[i].receiver_thread, NULL, &receiver, &flows[i]);
+		pthread_create(&flows[i].sender_thread, NULL, &sender, &flows[i]);
+	}
+
+	bigtime_t startTime = system_time();
+	snooze(seconds * 1000000LL);
+	sQuit = true;
+	bigtime_t time = system_time() - startTime;
+
+	int64 received = 0;
+	for (int i = 0; i < flowCount; i++) {
+		pthread_join(flows[i].sender_thread, NULL);
+		pthread_join(flows[i].receiver_thread, NULL);
+		received += flows[i].received;
+
+		close(flows[i].sender);
+		close(flows[i].receiver);
+	}
+
+	for (int32 i = 0; i < info.cpu_count; i++) {
+		if (wasEnabled[i] && !_kern_cpu_enabled(i))
+			_kern_set_cpu_enabled(i, true);
+	}
+
+	int32 enabled = 0;
+	for (int32 i = 0; i < info.cpu_count; i++) {
+		if (cpuCount <= 0 || i < cpuCount)
+			enabled += wasEnabled[i] ? 1 : 0;
+	}
+
+	printf("%d flows, %" B_PRId32 " CPUs: %" B_PRId64 " packets in %g s, "
+		"%g packets/s\n", flowCount, enabled, received, time / 1000000.0,
+		received / (time / 1000000.0));
+	return 0;
+}
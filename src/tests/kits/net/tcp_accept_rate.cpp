@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how many TCP connections per second a number of accepting
+	threads can take over the loopback device, either all accepting from
+	one shared listening socket, or each from its own one using SO_REUSEPORT.
+*/
+
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const int kMaxThreads = 64;
+
+struct acceptor {
+	int			socket;
+	pthread_t	thread;
+	int64		accepted;
+};
+
+static sockaddr_in sAddress;
+static volatile bool sQuit;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: tcp_accept_rate shared|reuseport [-a <acceptors>] "
+		"[-c <connectors>] [-t <seconds>]\n"
+		"Connects to the acceptors over the loopback device, and prints how "
+		"many\nconnections were accepted per second.\n");
+	exit(1);
+}
+
+
+static int
+create_listener(bool reusePort)
+{
+	int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (socket < 0) {
+		fprintf(stderr, "failed to create socket: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	int enable = 1;
+	if (reusePort && setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable,
+			sizeof(enable)) != 0) {
+		fprintf(stderr, "failed to set SO_REUSEPORT: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	if (bind(socket, (sockaddr*)&sAddress, sizeof(sAddress)) != 0
+		|| listen(socket, 128) != 0) {
+		fprintf(stderr, "failed to listen: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	if (sAddress.sin_port == 0) {
+		socklen_t length = sizeof(sAddress);
+		getsockname(socket, (sockaddr*)&sAddress, &length);
+	}
+
+	return socket;
+}
+
+
+static void*
+accept_connections(void* _acceptor)
+{
+	acceptor* current = (acceptor*)_acceptor;
+
+	while (!sQuit) {
+		int connection = accept(current->socket, NULL, NULL);
+		if (connection < 0)
+			continue;
+
+		if (!sQuit)
+			current->accepted++;
+		close(connection);
+	}
+
+	return NULL;
+}
+
+
+static void*
+connect_repeatedly(void*)
+{
+	while (!sQuit) {
+		int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (socket < 0)
+			continue;
+
+		connect(socket, (sockaddr*)&sAddress, sizeof(sAddress));
+		close(socket);
+	}
+
+	return NULL;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc < 2)
+		usage();
+
+	bool reusePort = !strcmp(argv[1], "reuseport");
+	if (!reusePort && strcmp(argv[1], "shared"))
+		usage();
+
+	int acceptorCount = 4;
+	int connectorCount = 4;
+	int seconds = 5;
+
+	optind = 2;
+	int option;
+	while ((option = getopt(argc, argv, "a:c:t:h")) != -1) {
+		switch (option) {
+			case 'a':
+				acceptorCount = atoi(optarg);
+				break;
+			case 'c':
+				connectorCount = atoi(optarg);
+				break;
+			case 't':
+				seconds = atoi(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (acceptorCount < 1 || acceptorCount > kMaxThreads
+		|| connectorCount < 1 || connectorCount > kMaxThreads || seconds < 1)
+		usage();
+
+	memset(&sAddress, 0, sizeof(sAddress));
+	sAddress.sin_len = sizeof(sAddress);
+	sAddress.sin_family = AF_INET;
+	sAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	acceptor acceptors[kMaxThreads];
+	for (int i = 0; i < acceptorCount; i++) {
+		acceptors[i].socket = reusePort || i == 0
+			? create_listener(reusePort) : acceptors[0].socket;
+		acceptors[i].accepted = 0;
+	}
+
+	for (int i = 0; i < acceptorCount; i++) {
+		pthread_create(&acceptors[i].thread, NULL, &accept_connections,
+			&acceptors[i]);
+	}
+
+	pthread_t connectors[kMaxThreads];
+	for (int i = 0; i < connectorCount; i++)
+		pthread_create(&connectors[i], NULL, &connect_repeatedly, NULL);
+
+	bigtime_t startTime = system_time();
+	snooze(seconds * 1000000LL);
+	sQuit = true;
+	bigtime_t time = system_time() - startTime;
+
+	for (int i = 0; i < connectorCount; i++)
+		pthread_join(connectors[i], NULL);
+
+	// wake up the acceptors that are still waiting
+	for (int i = 0; i < acceptorCount; i++) {
+		int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		connect(socket, (sockaddr*)&sAddress, sizeof(sAddress));
+		close(socket);
+	}
+
+	int64 accepted = 0;
+	for (int i = 0; i < acceptorCount; i++) {
+		pthread_join(acceptors[i].thread, NULL);
+		accepted += acceptors[i].accepted;
+
+		printf("  acceptor %d: %" B_PRId64 " connections\n", i,
+			acceptors[i].accepted);
+	}
+
+	for (int i = 0; i < acceptorCount; i++) {
+		if (reusePort || i == 0)
+			close(acceptors[i].socket);
+	}
+
+	printf("%s, %d acceptors, %d connectors: %" B_PRId64 " connections in "
+		"%g s, %g connections/s\n", argv[1], acceptorCount, connectorCount,
+		accepted, time / 1000000.0, accepted / (time / 1000000.0));
+	return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the CPU time spent per gigabyte sent over a loopback TCP
+	connection, either with plain send(), MSG_ZEROCOPY sends, or sendfile().
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const size_t kChunkSize = 256 * 1024;
+static const int kChunkCount = 8;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: tcp_send_cost copy|zerocopy|sendfile "
+		"[<megabytes>] [<file>]\n"
+		"Sends data over a loopback connection, and prints the CPU time it "
+		"took.\nsendfile needs a file to send (repeatedly).\n");
+	exit(1);
+}
+
+
+static bigtime_t
+active_time()
+{
+	system_info info;
+	get_system_info(&info);
+
+	bigtime_t time = 0;
+	for (int32 i = 0; i < info.cpu_count; i++)
+		time += info.cpu_infos[i].active_time;
+	return time;
+}
+
+
+static void*
+receiver(void* _socket)
+{
+	int socket = (int)(addr_t)_socket;
+	char* buffer = (char*)malloc(kChunkSize);
+
+	while (recv(socket, buffer, kChunkSize, 0) > 0)
+		;
+
+	free(buffer);
+	return NULL;
+}
+
+
+static void
+connect_sockets(int& sender, int& receiver)
+{
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	sender = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0 || sender < 0) {
+		fprintf(stderr, "failed to create socket: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addressLength = sizeof(address);
+
+	if (bind(listener, (sockaddr*)&address, addressLength) != 0
+		|| listen(listener, 1) != 0
+		|| getsockname(listener, (sockaddr*)&address, &addressLength) != 0
+		|| connect(sender, (sockaddr*)&address, addressLength) != 0) {
+		fprintf(stderr, "failed to connect: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	receiver = accept(listener, NULL, NULL);
+	if (receiver < 0) {
+		fprintf(stderr, "failed to accept: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	close(listener);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc < 2)
+		usage();
+
+	bool zeroCopy = !strcmp(argv[1], "zerocopy");
+	bool useSendFile = !strcmp(argv[1], "sendfile");
+	if (!zeroCopy && !useSendFile && strcmp(argv[1], "copy"))
+		usage();
+
+	off_t total = (argc > 2 ? atoll(argv[2]) : 1024) * 1024 * 1024;
+
+	int file = -1;
+	off_t fileSize = 0;
+	if (useSendFile) {
+		if (argc < 4)
+			usage();
+
+		file = open(argv[3], O_RDONLY);
+		fileSize = file >= 0 ? lseek(file, 0, SEEK_END) : -1;
+		if (fileSize <= 0) {
+			fprintf(stderr, "cannot use \"%s\": %s\n", argv[3],
+				strerror(errno));
+			return 1;
+		}
+	}
+
+	// with MSG_ZEROCOPY, a buffer may only be reused once its send has
+	// completed, so we cycle through a few of them
+	char* buffers[kChunkCount];
+	for (int i = 0; i < kChunkCount; i++) {
+		buffers[i] = (char*)malloc(kChunkSize);
+		if (buffers[i] == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		memset(buffers[i], i, kChunkSize);
+	}
+
+	int sender;
+	int receiverSocket;
+	connect_sockets(sender, receiverSocket);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, &receiver, (void*)(addr_t)receiverSocket);
+
+	bigtime_t startTime = system_time();
+	bigtime_t startActive = active_time();
+
+	off_t sent = 0;
+	uint32 sendCount = 0;
+	off_t fileOffset = 0;
+
+	while (sent < total) {
+		ssize_t bytes;
+		if (useSendFile) {
+			if (fileOffset >= fileSize)
+				fileOffset = 0;
+			bytes = sendfile(sender, file, &fileOffset,
+				min_c(fileSize - fileOffset, (off_t)kChunkSize));
+		} else if (zeroCopy) {
+			int index = sendCount % kChunkCount;
+			if (sendCount >= (uint32)kChunkCount) {
+				// wait until the send that used this buffer is done
+				while (true) {
+					uint32 completed = 0;
+					socklen_t length = sizeof(completed);
+					getsockopt(sender, SOL_SOCKET, SO_ZEROCOPY, &completed,
+						&length);
+					if (completed > sendCount - kChunkCount)
+						break;
+					snooze(100);
+				}
+			}
+			bytes = send(sender, buffers[index], kChunkSize, MSG_ZEROCOPY);
+			sendCount++;
+		} else
+			bytes = send(sender, buffers[sendCount++ % kChunkCount],
+				kChunkSize, 0);
+
+		if (bytes < 0) {
+			fprintf(stderr, "sending failed: %s\n", strerror(errno));
+			return 1;
+		}
+		sent += bytes;
+	}
+
+	shutdown(sender, SHUT_WR);
+	pthread_join(thread, NULL);
+
+	bigtime_t time = system_time() - startTime;
+	bigtime_t active = active_time() - startActive;
+	double gigabytes = sent / (1024.0 * 1024 * 1024);
+
+	printf("%s: sent %lld MB in %g s (%g MB/s)\n", argv[1],
+		sent / (1024 * 1024), time / 1000000.0,
+		sent / (1024.0 * 1024) / (time / 1000000.0));
+	printf("CPU time: %g s, %g s per GB\n", active / 1000000.0,
+		active / 1000000.0 / gigabytes);
+
+	close(sender);
+	close(receiverSocket);
+	return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Checks that automatically grown TCP buffers are limited by the global
+	budget, and that they return to their initial size under memory pressure
+	as soon as they are empty.
+*/
+
+
+#include "BufferBudget.h"
+#include "BufferQueue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <low_resource_manager.h>
+
+
+extern "C" status_t _add_builtin_module(module_info *info);
+
+extern struct net_buffer_module_info gNetBufferModule;
+	// from net_buffer.cpp
+
+struct net_socket_module_info gNetSocketModule;
+struct net_buffer_module_info* gBufferModule;
+
+static const size_t kInitialSize = 65536;
+static const size_t kGrownSize = 4 * 1024 * 1024;
+
+static low_resource_func sLowResourceHandler;
+static void* sLowResourceData;
+static int32 sFailures;
+
+
+// Overrides the one in libkernelland_emu.so, so that the test can simulate
+// memory pressure.
+extern "C" status_t
+register_low_resource_handler(low_resource_func function, void* data,
+	uint32 resources, int32 priority)
+{
+	sLowResourceHandler = function;
+	sLowResourceData = data;
+	return B_OK;
+}
+
+
+static void
+set_pressure(int32 level)
+{
+	sLowResourceHandler(sLowResourceData, B_KERNEL_RESOURCE_MEMORY, level);
+}
+
+
+static void
+check(bool condition, const char* what)
+{
+	if (condition)
+		return;
+
+	printf("FAILED: %s\n", what);
+	sFailures++;
+}
+
+
+static void
+fill(BufferQueue& queue, size_t bytes)
+{
+	const static uint8 data[4096] = {0};
+
+	net_buffer* buffer = gBufferModule->create(256);
+	if (buffer == NULL || gBufferModule->append(buffer, data, bytes) != B_OK) {
+		printf("creating a buffer failed!\n");
+		exit(1);
+	}
+
+	queue.Add(buffer);
+}
+
+
+static void
+drain(BufferQueue& queue)
+{
+	net_buffer* buffer = NULL;
+	if (queue.Get(queue.Available(), true, &buffer) == B_OK)
+		gBufferModule->free(buffer);
+}
+
+
+int
+main()
+{
+	_add_builtin_module((module_info*)&gNetBufferModule);
+	get_module(NET_BUFFER_MODULE_NAME, (module_info**)&gBufferModule);
+
+	if (init_buffer_budget() != B_OK || sLowResourceHandler == NULL) {
+		printf("could not initialize the buffer budget\n");
+		return 1;
+	}
+
+	BufferQueue busy(kInitialSize);
+	BufferQueue idle(kInitialSize);
+	busy.SetInitialSequence(0);
+	idle.SetInitialSequence(0);
+	size_t busyReserved = 0;
+	size_t idleReserved = 0;
+
+	// without pressure, buffers may grow, and nothing is shrunk
+	check(!shrink_buffer_on_pressure(busy, busyReserved),
+		"no pressure reported initially");
+	check(grow_buffer(busy, busyReserved, kGrownSize), "busy buffer grows");
+	check(grow_buffer(idle, idleReserved, kGrownSize), "idle buffer grows");
+	check(busy.Size() == kGrownSize
+			&& busyReserved == kGrownSize - kInitialSize,
+		"grown buffer size and reservation");
+	check(buffer_budget_reserved() == busyReserved + idleReserved,
+		"budget accounts for both buffers");
+
+	fill(busy, 1000);
+
+	// at the warning level, only empty buffers give their space back
+	set_pressure(B_LOW_RESOURCE_WARNING);
+
+	check(shrink_buffer_on_pressure(busy, busyReserved),
+		"pressure reported for the busy buffer");
+	check(busy.Size() == kGrownSize && busyReserved > 0,
+		"buffer holding data is not shrunk");
+
+	check(shrink_buffer_on_pressure(idle, idleReserved),
+		"pressure reported for the idle buffer");
+	check(idle.Size() == kInitialSize && idleReserved == 0,
+		"empty buffer returns to its initial size");
+	check(buffer_budget_reserved() == busyReserved,
+		"budget of the idle buffer is given back");
+
+	check(!grow_buffer(idle, idleReserved, kGrownSize),
+		"no growth under pressure");
+	check(idle.Size() == kInitialSize, "failed growth leaves size alone");
+
+	drain(busy);
+	check(shrink_buffer_on_pressure(busy, busyReserved)
+			&& busy.Size() == kInitialSize && busyReserved == 0,
+		"drained buffer is shrunk");
+	check(buffer_budget_reserved() == 0, "whole budget is given back");
+
+	// a milder pressure level still prevents growth, but doesn't shrink
+	set_pressure(B_LOW_RESOURCE_NOTE);
+	check(!shrink_buffer_on_pressure(busy, busyReserved),
+		"no shrinking below the warning level");
+	check(!grow_buffer(busy, busyReserved, kGrownSize),
+		"no growth below the warning level");
+
+	// once the pressure is gone, buffers may grow again
+	set_pressure(B_NO_LOW_RESOURCE);
+	check(grow_buffer(busy, busyReserved, kGrownSize),
+		"growth after the pressure is gone");
+
+	// the budget itself is limited
+	size_t reserved = buffer_budget_reserved();
+	check(!reserve_buffer_budget((size_t)-1 / 2),
+		"reservations larger than the budget fail");
+	check(buffer_budget_reserved() == reserved,
+		"failed reservation is not accounted");
+
+	unreserve_buffer_budget(busyReserved);
+	uninit_buffer_budget();
+	put_module(NET_BUFFER_MODULE_NAME);
+
+	if (sFailures > 0) {
+		printf("%ld checks failed!\n", sFailures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how fast buffers can be created, filled, and freed again from
+	a number of concurrent threads.
+*/
+
+
+#include <net_buffer.h>
+#include <net_socket.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+extern "C" status_t _add_builtin_module(module_info *info);
+
+extern struct net_buffer_module_info gNetBufferModule;
+	// from net_buffer.cpp
+
+struct net_socket_module_info gNetSocketModule;
+struct net_buffer_module_info* gBufferModule;
+
+static const int32 kMaxThreads = 64;
+static const size_t kPayloadSize = 1460;
+static const int32 kBuffersPerRound = 8;
+
+static int32 sIterations = 1000000;
+
+
+static status_t
+benchmark_thread(void* /*cookie*/)
+{
+	static const uint8 payload[kPayloadSize] = {0};
+	net_buffer* buffers[kBuffersPerRound];
+
+	for (int32 i = 0; i < sIterations; i += kBuffersPerRound) {
+		// keep a few buffers alive at once, as a protocol would
+		for (int32 j = 0; j < kBuffersPerRound; j++) {
+			buffers[j] = gBufferModule->create(256);
+			if (buffers[j] == NULL
+				|| gBufferModule->append(buffers[j], payload, kPayloadSize)
+					!= B_OK) {
+				fprintf(stderr, "creating a buffer failed!\n");
+				exit(1);
+			}
+		}
+
+		for (int32 j = 0; j < kBuffersPerRound; j++)
+			gBufferModule->free(buffers[j]);
+	}
+
+	return B_OK;
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: NetBufferBenchmark [-t <max threads>] "
+		"[-i <buffers per thread>]\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 maxThreads = 8;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:i:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atoi(optarg);
+				break;
+			case 'i':
+				sIterations = atoi(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (maxThreads < 1 || maxThreads > kMaxThreads || sIterations < 1)
+		usage();
+
+	_add_builtin_module((module_info*)&gNetBufferModule);
+	if (get_module(NET_BUFFER_MODULE_NAME, (module_info**)&gBufferModule)
+			!= B_OK) {
+		fprintf(stderr, "could not initialize the buffer module!\n");
+		return 1;
+	}
+
+	for (int32 threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+		thread_id threads[kMaxThreads];
+
+		bigtime_t startTime = system_time();
+
+		for (int32 i = 0; i < threadCount; i++) {
+			threads[i] = spawn_thread(&benchmark_thread, "benchmark",
+				B_NORMAL_PRIORITY, NULL);
+			resume_thread(threads[i]);
+		}
+
+		for (int32 i = 0; i < threadCount; i++) {
+			status_t result;
+			wait_for_thread(threads[i], &result);
+		}
+
+		bigtime_t time = system_time() - startTime;
+		double buffers = (double)threadCount * sIterations;
+
+		printf("%2" B_PRId32 " threads: %g buffers in %g s, %g buffers/s, "
+			"%g ns per buffer\n", threadCount, buffers, time / 1000000.0,
+			buffers / (time / 1000000.0), time * 1000.0 / buffers);
+	}
+
+	put_module(NET_BUFFER_MODULE_NAME);
+	return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the IPv4 route lookups per second of the stack's route trie for
+	differently sized routing tables.
+*/
+
+
+#include "route_trie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <OS.h>
+
+
+static const int32 kLookupCount = 10000000;
+static const int32 kTableSizes[] = {1000, 100000, 1000000};
+
+static uint32 sRandomState = 0x12345678;
+
+
+static uint32
+random_value()
+{
+	// xorshift, to get the same tables on every run
+	sRandomState ^= sRandomState << 13;
+	sRandomState ^= sRandomState >> 17;
+	sRandomState ^= sRandomState << 5;
+	return sRandomState;
+}
+
+
+static void
+to_key(uint32 address, uint8* key)
+{
+	key[0] = address >> 24;
+	key[1] = address >> 16;
+	key[2] = address >> 8;
+	key[3] = address;
+}
+
+
+static uint32*
+fill_table(RouteTrie& trie, int32 count)
+{
+	uint32* addresses = (uint32*)malloc(count * sizeof(uint32));
+	if (addresses == NULL)
+		return NULL;
+
+	static int route;
+	uint8 key[4];
+
+	// a default route, and mostly /16 to /24 networks, like a full table
+	to_key(0, key);
+	trie.Add(key, 0)->routes = &route;
+
+	for (int32 i = 0; i < count; i++) {
+		uint32 prefixLength = 16 + random_value() % 9;
+		uint32 address = random_value() & (~0UL << (32 - prefixLength));
+		addresses[i] = address;
+
+		to_key(address, key);
+		RouteTrieNode* node = trie.Add(key, prefixLength);
+		if (node == NULL) {
+			free(addresses);
+			return NULL;
+		}
+		node->routes = &route;
+	}
+
+	return addresses;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	for (size_t i = 0; i < sizeof(kTableSizes) / sizeof(kTableSizes[0]); i++) {
+		int32 tableSize = kTableSizes[i];
+		RouteTrie trie;
+
+		bigtime_t startTime = system_time();
+		uint32* addresses = fill_table(trie, tableSize);
+		if (addresses == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		bigtime_t fillTime = system_time() - startTime;
+
+		// look up hosts in the networks of the table, and random ones
+		uint8 key[4];
+		int32 found = 0;
+
+		startTime = system_time();
+		for (int32 j = 0; j < kLookupCount; j++) {
+			uint32 value = random_value();
+			uint32 address = (value & 1) != 0
+				? addresses[value % tableSize] | (value >> 24) : value;
+
+			to_key(address, key);
+			if (trie.Lookup(key, 32) != NULL)
+				found++;
+		}
+		bigtime_t time = system_time() - startTime;
+
+		printf("%7" B_PRId32 " routes (%lu nodes, added in %g s): %g lookups/s, "
+			"%g ns per lookup\n", tableSize, trie.CountNodes(),
+			fillTime / 1000000.0, kLookupCount / (time / 1000000.0),
+			time * 1000.0 / kLookupCount);
+
+		if (found != kLookupCount)
+			fprintf(stderr, "the default route was not found!\n");
+
+		free(addresses);
+	}
+
+	return 0;
+}
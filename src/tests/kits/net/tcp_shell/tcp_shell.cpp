@@ -29,7 +29,9 @@
 #include <Locker.h>
 
 #include <ctype.h>
+#include <deque>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <new>
 #include <set>
 #include <stdio.h>
@@ -41,6 +43,7 @@ struct context {
 	BLocker		lock;
 	sem_id		wait_sem;
 	struct list list;
+	deque<bigtime_t> delivery_times;
 	net_route	route;
 	bool		server;
 	thread_id	thread;
@@ -98,6 +101,9 @@ static set<uint32> sReorderList;
 static bool sSimultaneousConnect = false;
 static bool sSimultaneousClose = false;
 static bool sServerActiveClose = false;
+static bigtime_t sSendStartTime;
+static bigtime_t sLastReceiveTime;
+static vint64 sBytesReceived;
 
 static struct net_domain sDomain = {
 	"ipv4",
@@ -670,7 +676,9 @@ net_socket_module_info gNetSocketModule = {
 	NULL, // getsockopt,
 	NULL, // listen,
 	NULL, // receive,
+	NULL, // receive_multiple,
 	NULL, // send,
+	NULL, // send_external,
 	NULL, // setsockopt,
 	NULL, // shutdown,
 	NULL, // socketpair
@@ -713,6 +721,29 @@ close_protocol(net_protocol* protocol)
 //	#pragma mark - datalink
 
 
+/*!	Returns when a packet sent now should arrive at the other end; the
+	packets are then delivered in order, but do not hold up each other like
+	a simple delay on the receiving end would.
+*/
+static bigtime_t
+delivery_time()
+{
+	bigtime_t delay = 0;
+	if (sRoundTripTime > 0 || sRandomRoundTrip || sIncreasingRoundTrip) {
+		if (sRandomRoundTrip)
+			delay = (bigtime_t)(1.0 * rand() / RAND_MAX * 500000) - 250000;
+		if (sIncreasingRoundTrip)
+			sRoundTripTime += (bigtime_t)(1.0 * rand() / RAND_MAX * 150000);
+
+		delay += sRoundTripTime / 2;
+		if (delay < 0)
+			delay = 0;
+	}
+
+	return system_time() + delay;
+}
+
+
 status_t
 datalink_send_data(struct net_route *route, net_buffer *buffer)
 {
@@ -722,6 +753,7 @@ datalink_send_data(struct net_route *route, net_buffer *buffer)
 
 	context->lock.Lock();
 	list_add_item(&context->list, buffer);
+	context->delivery_times.push_back(delivery_time());
 	context->lock.Unlock();
 
 	release_sem(context->wait_sem);
@@ -919,19 +951,9 @@ domain_receive_data(net_buffer *buffer)
 
 	bool drop = false;
 	if (sDropList.find(packetNumber) != sDropList.end()
-		|| (sRandomDrop > 0.0 && (1.0 * rand() / RAND_MAX) > sRandomDrop))
+		|| (sRandomDrop > 0.0 && (1.0 * rand() / RAND_MAX) < sRandomDrop))
 		drop = true;
 
-	if (!drop && (sRoundTripTime > 0 || sRandomRoundTrip || sIncreasingRoundTrip)) {
-		bigtime_t add = 0;
-		if (sRandomRoundTrip)
-			add = (bigtime_t)(1.0 * rand() / RAND_MAX * 500000) - 250000;
-		if (sIncreasingRoundTrip)
-			sRoundTripTime += (bigtime_t)(1.0 * rand() / RAND_MAX * 150000);
-
-		snooze(sRoundTripTime / 2 + add);
-	}
-
 	if (sTCPDump) {
 		NetBufferHeaderReader<tcp_header> bufferHeader(buffer);
 		if (bufferHeader.Status() < B_OK)
@@ -1006,6 +1028,25 @@ domain_receive_data(net_buffer *buffer)
 						printf(" <ts %lu:%lu>", option->timestamp.value, option->timestamp.reply);
 						length = 10;
 						break;
+					case TCP_OPTION_SACK_PERMITTED:
+						printf(" <sackOK>");
+						length = 2;
+						break;
+					case TCP_OPTION_SACK:
+						length = option->length;
+						if (length < 2) {
+							size = 0;
+							break;
+						}
+
+						printf(" <sack");
+						for (uint32 i = 0; i < (length - 2) / sizeof(tcp_sack);
+								i++) {
+							printf(" %lu:%lu", ntohl(option->sack[i].left_edge),
+								ntohl(option->sack[i].right_edge));
+						}
+						putchar('>');
+						break;
 
 					default:
 						length = option->length;
@@ -1110,11 +1151,19 @@ receiving_thread(void* _data)
 			context->lock.Lock();
 			net_buffer* buffer = (net_buffer*)list_remove_head_item(
 				&context->list);
+			bigtime_t deliveryTime = 0;
+			if (buffer != NULL) {
+				deliveryTime = context->delivery_times.front();
+				context->delivery_times.pop_front();
+			}
 			context->lock.Unlock();
 
 			if (buffer == NULL)
 				break;
 
+			if (deliveryTime > system_time())
+				snooze_until(deliveryTime, B_SYSTEM_TIMEBASE);
+
 			if (sSimultaneousConnect && context->server && is_syn(buffer)) {
 				// delay getting the SYN request, and connect as well
 				sockaddr_in address;
@@ -1177,7 +1226,11 @@ server_thread(void*)
 		ssize_t bytesRead;
 		while ((bytesRead = socket_recv(connectionSocket, buffer,
 				sizeof(buffer), 0)) > 0) {
-			printf("server: received %ld bytes\n", bytesRead);
+			atomic_add64(&sBytesReceived, bytesRead);
+			sLastReceiveTime = system_time();
+
+			if (sTCPDump)
+				printf("server: received %ld bytes\n", bytesRead);
 
 			if (sServerActiveClose) {
 				printf("server: active close\n");
@@ -1338,9 +1391,9 @@ do_send(int argc, char** argv)
 		return;
 	}
 
-	if (size > 4 * 1024 * 1024) {
-		printf("amount to send will be limited to 4 MB\n");
-		size = 4 * 1024 * 1024;
+	if (size > 64 * 1024 * 1024) {
+		printf("amount to send will be limited to 64 MB\n");
+		size = 64 * 1024 * 1024;
 	}
 
 	char *buffer = (char *)malloc(size);
@@ -1354,6 +1407,9 @@ do_send(int argc, char** argv)
 		buffer[i] = (char)(i & 0xff);
 	}
 
+	sBytesReceived = 0;
+	sSendStartTime = system_time();
+
 	ssize_t bytesWritten = socket_send(gClientSocket, buffer, size, 0);
 	if (bytesWritten < B_OK) {
 		fprintf(stderr, "failed sending buffer: %s\n", strerror(bytesWritten));
@@ -1529,6 +1585,72 @@ do_round_trip_time(int argc, char** argv)
 }
 
 
+static void
+do_goodput(int argc, char** argv)
+{
+	int64 bytes = atomic_get64(&sBytesReceived);
+	if (bytes == 0) {
+		printf("Nothing received since the last send.\n");
+		return;
+	}
+
+	bigtime_t time = sLastReceiveTime - sSendStartTime;
+	if (time <= 0)
+		time = 1;
+
+	printf("%lld bytes received in %g s: %g KB/s\n", bytes, time / 1000000.0,
+		bytes * 1000000.0 / 1024 / time);
+}
+
+
+static void
+do_congestion_control(int argc, char** argv)
+{
+	net_protocol* protocol = gClientSocket->first_protocol;
+
+	if (argc > 1) {
+		status_t status = gTCPModule->setsockopt(protocol, IPPROTO_TCP,
+			TCP_CONGESTION, argv[1], strlen(argv[1]));
+		if (status != B_OK) {
+			fprintf(stderr, "could not set congestion control: %s\n",
+				strerror(status));
+			return;
+		}
+	}
+
+	char name[TCP_CA_NAME_MAX];
+	int length = sizeof(name);
+	if (gTCPModule->getsockopt(protocol, IPPROTO_TCP, TCP_CONGESTION, name,
+			&length) == B_OK)
+		printf("client uses %s congestion control.\n", name);
+}
+
+
+static void
+do_offload(int argc, char** argv)
+{
+	if (argc > 1)
+		gSegmentationOffload = !strcmp(argv[1], "on");
+	else
+		gSegmentationOffload = !gSegmentationOffload;
+
+	printf("segmentation offload turned %s.\n",
+		gSegmentationOffload ? "on" : "off");
+}
+
+
+static void
+do_tcp_dump(int argc, char** argv)
+{
+	if (argc > 1)
+		sTCPDump = !strcmp(argv[1], "on");
+	else
+		sTCPDump = !sTCPDump;
+
+	printf("packet dump turned %s.\n", sTCPDump ? "on" : "off");
+}
+
+
 static void
 do_dprintf(int argc, char** argv)
 {
@@ -1542,14 +1664,19 @@ do_dprintf(int argc, char** argv)
 
 
 static cmd_entry sBuiltinCommands[] = {
+	{"cc", do_congestion_control,
+		"Sets the congestion control algorithm of the client"},
 	{"connect", do_connect, "Connects the client"},
 	{"send", do_send, "Sends data from the client to the server"},
 	{"close", do_close, "Performs an active or simultaneous close"},
 	{"dprintf", do_dprintf, "Toggles debug output"},
 	{"drop", do_drop, "Lets you drop packets during transfer"},
+	{"goodput", do_goodput, "Reports the goodput of the last send"},
+	{"offload", do_offload, "Toggles TCP segmentation offload"},
 	{"reorder", do_reorder, "Lets you reorder packets during transfer"},
 	{"help", do_help, "prints this help text"},
 	{"rtt", do_round_trip_time, "Specifies the round trip time"},
+	{"tcpdump", do_tcp_dump, "Toggles the packet dump"},
 	{"quit", NULL, "exits the application"},
 	{NULL, NULL, NULL},
 };
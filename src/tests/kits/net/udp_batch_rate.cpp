@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how many 64 and 1400 byte UDP datagrams per second can be sent
+	and received over the loopback device, either one per call, or in batches
+	using sendmmsg() and recvmmsg().
+*/
+
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const int kMaxBatchSize = 1024;
+static const size_t kDatagramSizes[] = {64, 1400};
+
+struct benchmark {
+	int			socket;
+	size_t		size;
+	int			batch_size;
+	int64		count;
+	uint8*		data;
+};
+
+static volatile bool sQuit;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: udp_batch_rate [-b <batch size>] [-t <seconds>]\n"
+		"Sends datagrams to itself over the loopback device, and prints how "
+		"many\nper second were received, both with single, and batched calls."
+		"\n");
+	exit(1);
+}
+
+
+static void
+prepare_messages(benchmark& bench, mmsghdr* messages, iovec* vecs)
+{
+	for (int i = 0; i < bench.batch_size; i++) {
+		vecs[i].iov_base = bench.data + i * bench.size;
+		vecs[i].iov_len = bench.size;
+
+		memset(&messages[i], 0, sizeof(mmsghdr));
+		messages[i].msg_hdr.msg_iov = &vecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+
+static void*
+send_datagrams(void* _bench)
+{
+	benchmark& bench = *(benchmark*)_bench;
+	mmsghdr messages[kMaxBatchSize];
+	iovec vecs[kMaxBatchSize];
+	prepare_messages(bench, messages, vecs);
+
+	while (!sQuit) {
+		if (bench.batch_size == 1)
+			send(bench.socket, bench.data, bench.size, 0);
+		else
+			sendmmsg(bench.socket, messages, bench.batch_size, 0);
+	}
+
+	return NULL;
+}
+
+
+static void*
+receive_datagrams(void* _bench)
+{
+	benchmark& bench = *(benchmark*)_bench;
+	mmsghdr messages[kMaxBatchSize];
+	iovec vecs[kMaxBatchSize];
+	prepare_messages(bench, messages, vecs);
+
+	while (!sQuit) {
+		if (bench.batch_size == 1) {
+			if (recv(bench.socket, bench.data, bench.size, 0) >= 0)
+				bench.count++;
+		} else {
+			int received = recvmmsg(bench.socket, messages, bench.batch_size,
+				MSG_WAITFORONE, NULL);
+			if (received > 0)
+				bench.count += received;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void
+create_sockets(int& sender, int& receiver)
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	receiver = socket(AF_INET, SOCK_DGRAM, 0);
+	sender = socket(AF_INET, SOCK_DGRAM, 0);
+	if (receiver < 0 || sender < 0) {
+		fprintf(stderr, "failed to create sockets: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	// don't wait forever on the last datagram
+	struct timeval timeout = {0, 100000};
+	setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	socklen_t length = sizeof(address);
+	if (bind(receiver, (sockaddr*)&address, sizeof(address)) != 0
+		|| getsockname(receiver, (sockaddr*)&address, &length) != 0
+		|| connect(sender, (sockaddr*)&address, sizeof(address)) != 0) {
+		fprintf(stderr, "failed to connect sockets: %s\n", strerror(errno));
+		exit(1);
+	}
+}
+
+
+static void
+run(size_t size, int batchSize, int seconds)
+{
+	int sender, receiver;
+	create_sockets(sender, receiver);
+
+	benchmark sending = {sender, size, batchSize, 0,
+		(uint8*)calloc(batchSize, size)};
+	benchmark receiving = {receiver, size, batchSize, 0,
+		(uint8*)calloc(batchSize, size)};
+	if (sending.data == NULL || receiving.data == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	sQuit = false;
+
+	pthread_t senderThread, receiverThread;
+	pthread_create(&receiverThread, NULL, &receive_datagrams, &receiving);
+	pthread_create(&senderThread, NULL, &send_datagrams, &sending);
+
+	bigtime_t startTime = system_time();
+	snooze(seconds * 1000000LL);
+	sQuit = true;
+	bigtime_t time = system_time() - startTime;
+
+	pthread_join(senderThread, NULL);
+	pthread_join(receiverThread, NULL);
+
+	printf("%4zu bytes, %s: %g datagrams/s, %g MB/s\n", size,
+		batchSize == 1 ? "single " : "batched", receiving.count
+			/ (time / 1000000.0),
+		receiving.count * size / (time / 1000000.0) / (1024 * 1024));
+
+	free(sending.data);
+	free(receiving.data);
+	close(sender);
+	close(receiver);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int batchSize = 32;
+	int seconds = 3;
+
+	int option;
+	while ((option = getopt(argc, argv, "b:t:h")) != -1) {
+		switch (option) {
+			case 'b':
+				batchSize = atoi(optarg);
+				break;
+			case 't':
+				seconds = atoi(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (batchSize < 2 || batchSize > kMaxBatchSize || seconds < 1)
+		usage();
+
+	for (size_t i = 0; i < sizeof(kDatagramSizes) / sizeof(kDatagramSizes[0]);
+			i++) {
+		run(kDatagramSizes[i], 1, seconds);
+		run(kDatagramSizes[i], batchSize, seconds);
+	}
+
+	return 0;
+}
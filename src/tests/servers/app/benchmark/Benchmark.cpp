@@ -15,10 +15,15 @@
 #include "TestWindow.h"
 
 // tests
+#include "BitmapPresentTest.h"
 #include "HorizontalLineTest.h"
+#include "PrimitivesTest.h"
 #include "RandomLineTest.h"
+#include "StringOffsetsTest.h"
 #include "StringTest.h"
+#include "TiledRenderTest.h"
 #include "VerticalLineTest.h"
+#include "WindowMoveTest.h"
 
 
 struct test_info {
@@ -27,10 +32,15 @@ struct test_info {
 };
 
 const test_info kTestInfos[] = {
+	{ "BitmapPresent",	BitmapPresentTest::CreateTest },
 	{ "HorizontalLines",	HorizontalLineTest::CreateTest },
+	{ "Primitives",		PrimitivesTest::CreateTest },
 	{ "RandomLines",		RandomLineTest::CreateTest },
+	{ "StringOffsets",		StringOffsetsTest::CreateTest },
 	{ "Strings",			StringTest::CreateTest },
+	{ "TiledRendering",		TiledRenderTest::CreateTest },
 	{ "VerticalLines",		VerticalLineTest::CreateTest },
+	{ "WindowMoves",		WindowMoveTest::CreateTest },
 	{ NULL, NULL }
 };
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "BitmapPresentTest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Bitmap.h>
+#include <View.h>
+
+#include <BitmapPresenter.h>
+
+
+struct phase_info {
+	const char*	name;
+	color_space	colorSpace;
+	bool		presenter;
+};
+
+// Frames in B_RGB32 can be drawn as they are, those in B_RGB16 need to be
+// converted by the app_server.
+static const phase_info kPhases[] = {
+	{ "B_RGB32, Sync() per frame", B_RGB32, false },
+	{ "B_RGB32, triple buffered", B_RGB32, true },
+	{ "B_RGB16, Sync() per frame", B_RGB16, false },
+	{ "B_RGB16, triple buffered", B_RGB16, true }
+};
+
+
+BitmapPresentTest::BitmapPresentTest()
+	: Test(),
+	  fBitmap(NULL),
+	  fPresenter(NULL),
+
+	  fPhase(0),
+	  fIterations(0),
+	  fMaxIterations(300),
+	  fFrame(0),
+
+	  fViewBounds(0, 0, -1, -1)
+{
+	for (int32 i = 0; i < kPhaseCount; i++)
+		fPhaseDuration[i] = 0;
+}
+
+
+BitmapPresentTest::~BitmapPresentTest()
+{
+	delete fBitmap;
+	delete fPresenter;
+}
+
+
+void
+BitmapPresentTest::Prepare(BView* view)
+{
+	fViewBounds = view->Bounds();
+
+	fPhase = 0;
+	fIterations = 0;
+	_StartPhase(view);
+}
+
+
+bool
+BitmapPresentTest::RunIteration(BView* view)
+{
+	bigtime_t now = system_time();
+
+	if (fPresenter != NULL) {
+		// render into the next free buffer, and let the app_server draw it
+		// while the following frame is being rendered
+		BBitmap* buffer = fPresenter->NextBuffer();
+		if (buffer != NULL) {
+			_RenderFrame(buffer);
+			fPresenter->Present(fViewBounds.LeftTop());
+		}
+	} else {
+		// the bitmap must not be changed before the app_server is done
+		// with it
+		_RenderFrame(fBitmap);
+		view->DrawBitmap(fBitmap, fViewBounds.LeftTop());
+		view->Sync();
+	}
+
+	fPhaseDuration[fPhase] += system_time() - now;
+	fIterations++;
+
+	if (fIterations < fMaxIterations)
+		return true;
+
+	_EndPhase();
+
+	fIterations = 0;
+	fPhase++;
+	if (fPhase < kPhaseCount) {
+		_StartPhase(view);
+		return true;
+	}
+
+	return false;
+}
+
+
+void
+BitmapPresentTest::PrintResults(BView* view)
+{
+	if (fPhaseDuration[0] == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+
+	Test::PrintResults(view);
+
+	printf("Frame size: %ldx%ld\n", fViewBounds.IntegerWidth() + 1,
+		fViewBounds.IntegerHeight() + 1);
+	printf("Frames per phase: %lu\n", fMaxIterations);
+	for (int32 i = 0; i < fPhase && i < kPhaseCount; i++) {
+		float frameTime = (float)fPhaseDuration[i] / fMaxIterations / 1000;
+		printf("%s: %.3f ms per frame, %.1f fps\n", kPhases[i].name,
+			frameTime, 1000 / frameTime);
+	}
+}
+
+
+Test*
+BitmapPresentTest::CreateTest()
+{
+	return new BitmapPresentTest();
+}
+
+
+void
+BitmapPresentTest::_StartPhase(BView* view)
+{
+	const phase_info& phase = kPhases[fPhase];
+	BRect bounds(0, 0, fViewBounds.Width(), fViewBounds.Height());
+
+	if (phase.presenter)
+		fPresenter = new BitmapPresenter(view, bounds, phase.colorSpace);
+	else
+		fBitmap = new BBitmap(bounds, phase.colorSpace);
+}
+
+
+void
+BitmapPresentTest::_EndPhase()
+{
+	if (fPresenter != NULL) {
+		// the last frames have not necessarily been drawn yet
+		bigtime_t now = system_time();
+		fPresenter->WaitForAll();
+		fPhaseDuration[fPhase] += system_time() - now;
+	}
+
+	delete fPresenter;
+	fPresenter = NULL;
+	delete fBitmap;
+	fBitmap = NULL;
+}
+
+
+/*!	Fills the \a bitmap with a pattern that changes with every frame, like
+	a video would.
+*/
+void
+BitmapPresentTest::_RenderFrame(BBitmap* bitmap)
+{
+	uint8* bits = (uint8*)bitmap->Bits();
+	int32 bytesPerRow = bitmap->BytesPerRow();
+	int32 height = bitmap->Bounds().IntegerHeight() + 1;
+
+	for (int32 y = 0; y < height; y++)
+		memset(bits + y * bytesPerRow, (y + fFrame) & 0xff, bytesPerRow);
+
+	fFrame++;
+}
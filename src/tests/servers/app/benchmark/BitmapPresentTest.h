@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BITMAP_PRESENT_TEST_H
+#define BITMAP_PRESENT_TEST_H
+
+#include <GraphicsDefs.h>
+#include <Rect.h>
+
+#include "Test.h"
+
+class BBitmap;
+
+namespace BPrivate {
+	class BitmapPresenter;
+}
+
+class BitmapPresentTest : public Test {
+public:
+								BitmapPresentTest();
+	virtual						~BitmapPresentTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+			void				_StartPhase(BView* view);
+			void				_EndPhase();
+			void				_RenderFrame(BBitmap* bitmap);
+
+	enum {
+		kPhaseCount = 4
+	};
+
+			BBitmap*			fBitmap;
+			BPrivate::BitmapPresenter* fPresenter;
+
+			int32				fPhase;
+			uint32				fIterations;
+			uint32				fMaxIterations;
+			uint32				fFrame;
+			bigtime_t			fPhaseDuration[kPhaseCount];
+
+			BRect				fViewBounds;
+};
+
+#endif // BITMAP_PRESENT_TEST_H
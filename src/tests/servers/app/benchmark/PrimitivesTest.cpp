@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "PrimitivesTest.h"
+
+#include <stdio.h>
+
+#include <View.h>
+#include <Window.h>
+
+
+static const int32 kPrimitivesPerIteration = 100000;
+
+
+PrimitivesTest::PrimitivesTest()
+	: Test(),
+	  fPhase(0),
+	  fIterations(0),
+	  fMaxIterations(5),
+	  fViewBounds(0, 0, -1, -1)
+{
+	for (int32 i = 0; i < kPhaseCount; i++)
+		fPhaseDuration[i] = 0;
+}
+
+
+PrimitivesTest::~PrimitivesTest()
+{
+}
+
+
+void
+PrimitivesTest::Prepare(BView* view)
+{
+	fViewBounds = view->Bounds();
+
+	fPhase = 0;
+	fIterations = 0;
+	for (int32 i = 0; i < kPhaseCount; i++)
+		fPhaseDuration[i] = 0;
+}
+
+
+bool
+PrimitivesTest::RunIteration(BView* view)
+{
+	// The first phase sends every call to the app_server on its own, like
+	// it happens for any drawing outside of Draw(). The second one lets the
+	// calls pile up in the link in a view transaction, and the app_server
+	// draw them in a row.
+	bool flushEach = fPhase == 0;
+
+	int32 width = fViewBounds.IntegerWidth() - 20;
+	int32 height = fViewBounds.IntegerHeight() - 20;
+
+	bigtime_t now = system_time();
+
+	if (!flushEach)
+		view->Window()->BeginViewTransaction();
+
+	for (int32 i = 0; i < kPrimitivesPerIteration; i++) {
+		float x = fViewBounds.left + 10 + (i * 7) % width;
+		float y = fViewBounds.top + 10 + (i * 13) % height;
+
+		if (i % 4 == 0) {
+			rgb_color color = { (uint8)(i * 3), (uint8)(i * 5),
+				(uint8)(i * 7), 255 };
+			view->SetHighColor(color);
+		}
+
+		switch (i % 3) {
+			case 0:
+				view->FillRect(BRect(x, y, x + 9, y + 9));
+				break;
+			case 1:
+				view->StrokeLine(BPoint(x, y), BPoint(x + 9, y + 5));
+				break;
+			case 2:
+				view->StrokeRect(BRect(x, y, x + 5, y + 9));
+				break;
+		}
+
+		if (flushEach)
+			view->Flush();
+	}
+
+	if (!flushEach)
+		view->Window()->EndViewTransaction();
+
+	view->Sync();
+
+	fPhaseDuration[fPhase] += system_time() - now;
+	fIterations++;
+
+	if (fIterations < fMaxIterations)
+		return true;
+
+	fIterations = 0;
+	fPhase++;
+	return fPhase < kPhaseCount;
+}
+
+
+void
+PrimitivesTest::PrintResults(BView* view)
+{
+	if (fPhaseDuration[0] == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+
+	Test::PrintResults(view);
+
+	printf("Primitives per iteration: %ld\n", kPrimitivesPerIteration);
+	for (int32 i = 0; i < fPhase && i < kPhaseCount; i++) {
+		printf("%s: %.0f primitives per second (%.2fx)\n",
+			i == 0 ? "Flushing every call" : "Batched",
+			(double)kPrimitivesPerIteration * fMaxIterations * 1000000
+				/ fPhaseDuration[i],
+			(float)fPhaseDuration[0] / fPhaseDuration[i]);
+	}
+}
+
+
+Test*
+PrimitivesTest::CreateTest()
+{
+	return new PrimitivesTest();
+}
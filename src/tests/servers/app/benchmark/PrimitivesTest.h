@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef PRIMITIVES_TEST_H
+#define PRIMITIVES_TEST_H
+
+#include <Rect.h>
+
+#include "Test.h"
+
+class PrimitivesTest : public Test {
+public:
+								PrimitivesTest();
+	virtual						~PrimitivesTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+	enum {
+		kPhaseCount = 2
+	};
+
+			int32				fPhase;
+			uint32				fIterations;
+			uint32				fMaxIterations;
+			bigtime_t			fPhaseDuration[kPhaseCount];
+
+			BRect				fViewBounds;
+};
+
+#endif // PRIMITIVES_TEST_H
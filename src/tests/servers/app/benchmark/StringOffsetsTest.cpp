@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "StringOffsetsTest.h"
+
+#include <stdio.h>
+
+#include <View.h>
+
+#include "TestSupport.h"
+
+
+StringOffsetsTest::StringOffsetsTest()
+	: Test(),
+	  fTestDuration(0),
+	  fTestStart(-1),
+	  fGlyphsRendered(0),
+	  fIterations(0),
+	  fMaxIterations(1500),
+
+	  fStartHeight(11.0),
+	  fLineHeight(15.0),
+	  fGlyphWidth(8.0)
+{
+}
+
+
+StringOffsetsTest::~StringOffsetsTest()
+{
+}
+
+
+void
+StringOffsetsTest::Prepare(BView* view)
+{
+	font_height fh;
+	view->GetFontHeight(&fh);
+	fLineHeight = ceilf(fh.ascent) + ceilf(fh.descent)
+		+ ceilf(fh.leading);
+	fStartHeight = ceilf(fh.ascent) + ceilf(fh.descent);
+	fGlyphWidth = ceilf(view->StringWidth("M"));
+	fViewBounds = view->Bounds();
+
+	fTestDuration = 0;
+	fGlyphsRendered = 0;
+	fIterations = 0;
+	fTestStart = system_time();
+}
+
+bool
+StringOffsetsTest::RunIteration(BView* view)
+{
+	float baseLine = random_number_between(fStartHeight,
+		fStartHeight + fLineHeight / 2);
+
+	char buffer[kGlyphsPerLine + 1];
+	buffer[kGlyphsPerLine] = 0;
+
+	bigtime_t now = system_time();
+
+	while (true) {
+		// fill string with random chars, and place them on a grid, like a
+		// terminal would
+		for (uint32 j = 0; j < kGlyphsPerLine; j++) {
+			buffer[j] = 'A' + rand() % ('z' - 'A');
+			fOffsets[j].x = 5 + j * fGlyphWidth;
+			fOffsets[j].y = baseLine;
+		}
+
+		view->DrawString(buffer, fOffsets, kGlyphsPerLine);
+
+		fGlyphsRendered += kGlyphsPerLine;
+
+		// offset text location
+		baseLine += fLineHeight;
+		if (baseLine > fViewBounds.bottom)
+			break;
+	}
+
+	view->Sync();
+
+	fTestDuration += system_time() - now;
+	fIterations++;
+
+	return fIterations < fMaxIterations;
+}
+
+
+void
+StringOffsetsTest::PrintResults(BView* view)
+{
+	if (fTestDuration == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+	bigtime_t timeLeak = system_time() - fTestStart - fTestDuration;
+
+	Test::PrintResults(view);
+
+	printf("Glyphs per DrawString() call: %d\n", kGlyphsPerLine);
+	printf("Glyphs per second: %.3f\n",
+		fGlyphsRendered * 1000000.0 / fTestDuration);
+	printf("Average time between iterations: %.4f seconds.\n",
+		(float)timeLeak / fIterations / 1000000);
+}
+
+
+Test*
+StringOffsetsTest::CreateTest()
+{
+	return new StringOffsetsTest();
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef STRING_OFFSETS_TEST_H
+#define STRING_OFFSETS_TEST_H
+
+#include <Point.h>
+#include <Rect.h>
+
+#include "Test.h"
+
+class StringOffsetsTest : public Test {
+public:
+								StringOffsetsTest();
+	virtual						~StringOffsetsTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+	enum {
+		kGlyphsPerLine = 60
+	};
+
+	bigtime_t					fTestDuration;
+	bigtime_t					fTestStart;
+	uint64						fGlyphsRendered;
+	uint32						fIterations;
+	uint32						fMaxIterations;
+
+	float						fStartHeight;
+	float						fLineHeight;
+	float						fGlyphWidth;
+	BRect						fViewBounds;
+	BPoint						fOffsets[kGlyphsPerLine];
+};
+
+#endif // STRING_OFFSETS_TEST_H
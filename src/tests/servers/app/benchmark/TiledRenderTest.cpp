@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "TiledRenderTest.h"
+
+#include <stdio.h>
+
+#include <Bitmap.h>
+#include <GradientLinear.h>
+#include <View.h>
+
+
+// private app_server API, see InterfaceDefs.cpp
+extern void set_render_thread_count(int32 count);
+extern status_t get_render_thread_count(int32* count);
+
+static const int32 kThreadCounts[] = { 1, 2, 4, 8 };
+
+
+TiledRenderTest::TiledRenderTest()
+	: Test(),
+	  fBitmap(NULL),
+	  fOriginalThreadCount(1),
+
+	  fPhase(0),
+	  fIterations(0),
+	  fMaxIterations(200),
+
+	  fViewBounds(0, 0, -1, -1)
+{
+	for (int32 i = 0; i < kPhaseCount; i++)
+		fPhaseDuration[i] = 0;
+}
+
+
+TiledRenderTest::~TiledRenderTest()
+{
+	delete fBitmap;
+}
+
+
+void
+TiledRenderTest::Prepare(BView* view)
+{
+	fViewBounds = view->Bounds();
+
+	// a small bitmap, so that it is scaled up a lot
+	fBitmap = new BBitmap(BRect(0, 0, 127, 127), B_RGB32);
+	uint8* bits = (uint8*)fBitmap->Bits();
+	int32 bpr = fBitmap->BytesPerRow();
+	for (int32 y = 0; y < 128; y++) {
+		uint8* p = bits + y * bpr;
+		for (int32 x = 0; x < 128; x++) {
+			p[0] = x * 2;
+			p[1] = y * 2;
+			p[2] = (x ^ y) * 2;
+			p[3] = 255;
+			p += 4;
+		}
+	}
+
+	if (get_render_thread_count(&fOriginalThreadCount) != B_OK)
+		fOriginalThreadCount = 1;
+
+	fPhase = 0;
+	fIterations = 0;
+	set_render_thread_count(kThreadCounts[fPhase]);
+}
+
+
+bool
+TiledRenderTest::RunIteration(BView* view)
+{
+	BGradientLinear gradient(fViewBounds.LeftTop(), fViewBounds.LeftBottom());
+	rgb_color top = { 255, 200, 100, 255 };
+	rgb_color bottom = { 50, 100, 200, 255 };
+	gradient.AddColor(top, 0);
+	gradient.AddColor(bottom, 255);
+
+	bigtime_t now = system_time();
+
+	view->FillRect(fViewBounds, gradient);
+	view->DrawBitmap(fBitmap, fBitmap->Bounds(), fViewBounds,
+		B_FILTER_BITMAP_BILINEAR);
+	view->Sync();
+
+	fPhaseDuration[fPhase] += system_time() - now;
+	fIterations++;
+
+	if (fIterations < fMaxIterations)
+		return true;
+
+	fIterations = 0;
+	fPhase++;
+	if (fPhase < kPhaseCount) {
+		set_render_thread_count(kThreadCounts[fPhase]);
+		return true;
+	}
+
+	set_render_thread_count(fOriginalThreadCount);
+	return false;
+}
+
+
+void
+TiledRenderTest::PrintResults(BView* view)
+{
+	if (fPhaseDuration[0] == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+
+	Test::PrintResults(view);
+
+	printf("Frame size: %ldx%ld\n", fViewBounds.IntegerWidth() + 1,
+		fViewBounds.IntegerHeight() + 1);
+	printf("Frames per thread count: %lu\n", fMaxIterations);
+	for (int32 i = 0; i < fPhase && i < kPhaseCount; i++) {
+		float frameTime = (float)fPhaseDuration[i] / fMaxIterations / 1000;
+		printf("%ld render threads: %.3f ms per frame (%.2fx)\n",
+			kThreadCounts[i], frameTime,
+			(float)fPhaseDuration[0] / fPhaseDuration[i]);
+	}
+}
+
+
+Test*
+TiledRenderTest::CreateTest()
+{
+	return new TiledRenderTest();
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILED_RENDER_TEST_H
+#define TILED_RENDER_TEST_H
+
+#include <Rect.h>
+
+#include "Test.h"
+
+class BBitmap;
+
+class TiledRenderTest : public Test {
+public:
+								TiledRenderTest();
+	virtual						~TiledRenderTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+	enum {
+		kPhaseCount = 4
+	};
+
+			BBitmap*			fBitmap;
+			int32				fOriginalThreadCount;
+
+			int32				fPhase;
+			uint32				fIterations;
+			uint32				fMaxIterations;
+			bigtime_t			fPhaseDuration[kPhaseCount];
+
+			BRect				fViewBounds;
+};
+
+#endif // TILED_RENDER_TEST_H
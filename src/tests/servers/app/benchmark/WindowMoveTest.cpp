@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "WindowMoveTest.h"
+
+#include <stdio.h>
+
+#include <GradientLinear.h>
+#include <Messenger.h>
+#include <View.h>
+#include <Window.h>
+
+
+// private app_server API, see InterfaceDefs.cpp
+extern void set_retain_window_contents(bool retain);
+extern status_t get_retain_window_contents(bool* retain);
+
+static const uint32 kMsgSync = 'sync';
+
+static const BRect kContentFrame(20, 40, 419, 339);
+static const BRect kMovingFrame(20, 120, 179, 239);
+static const int32 kMoveDistance = 240;
+static const int32 kMoveStep = 4;
+
+
+// The window that is uncovered by the moves. Redrawing it is not cheap,
+// like with most real windows.
+class ContentView : public BView {
+public:
+	ContentView(BRect frame)
+		: BView(frame, "content", B_FOLLOW_ALL, B_WILL_DRAW),
+		  fRedraws(0)
+	{
+	}
+
+	virtual void Draw(BRect updateRect)
+	{
+		BRect bounds = Bounds();
+		BGradientLinear gradient(bounds.LeftTop(), bounds.RightBottom());
+		rgb_color start = { 255, 200, 100, 255 };
+		rgb_color end = { 50, 100, 200, 255 };
+		gradient.AddColor(start, 0);
+		gradient.AddColor(end, 255);
+		FillRect(updateRect, gradient);
+
+		for (float x = bounds.left; x <= bounds.right; x += 8) {
+			StrokeLine(BPoint(x, bounds.top),
+				BPoint(bounds.right - x, bounds.bottom));
+		}
+		for (float y = bounds.top; y <= bounds.bottom; y += 16)
+			DrawString("The quick brown fox", BPoint(10, y));
+
+		fRedraws++;
+	}
+
+	int32 Redraws() const
+	{
+		return fRedraws;
+	}
+
+private:
+	int32	fRedraws;
+};
+
+
+class ContentWindow : public BWindow {
+public:
+	ContentWindow(BRect frame)
+		: BWindow(frame, "Uncovered Window", B_TITLED_WINDOW,
+			B_NOT_ZOOMABLE | B_NOT_RESIZABLE | B_AVOID_FOCUS)
+	{
+		fView = new ContentView(Bounds());
+		AddChild(fView);
+	}
+
+	virtual void MessageReceived(BMessage* message)
+	{
+		switch (message->what) {
+			case kMsgSync:
+			{
+				// The update messages triggered by a move arrive before
+				// this message, make sure their drawing is done as well.
+				Sync();
+
+				BMessage reply(B_REPLY);
+				reply.AddInt32("redraws", fView->Redraws());
+				message->SendReply(&reply);
+				break;
+			}
+			default:
+				BWindow::MessageReceived(message);
+				break;
+		}
+	}
+
+private:
+	ContentView*	fView;
+};
+
+
+WindowMoveTest::WindowMoveTest()
+	: Test(),
+	  fContentWindow(NULL),
+	  fMovingWindow(NULL),
+	  fOriginalRetain(false),
+
+	  fPhase(0),
+	  fIterations(0),
+	  fMaxIterations(2 * kMoveDistance / kMoveStep * 2),
+	  fStep(kMoveStep),
+	  fRedrawsAtPhaseStart(0)
+{
+	for (int32 i = 0; i < kPhaseCount; i++) {
+		fPhaseDuration[i] = 0;
+		fPhaseRedraws[i] = 0;
+	}
+}
+
+
+WindowMoveTest::~WindowMoveTest()
+{
+}
+
+
+void
+WindowMoveTest::Prepare(BView* view)
+{
+	fContentWindow = new ContentWindow(kContentFrame);
+	fContentWindow->Show();
+
+	fMovingWindow = new BWindow(kMovingFrame, "Moving Window",
+		B_TITLED_WINDOW, B_NOT_ZOOMABLE | B_NOT_RESIZABLE | B_AVOID_FOCUS);
+	fMovingWindow->Show();
+
+	if (get_retain_window_contents(&fOriginalRetain) != B_OK)
+		fOriginalRetain = false;
+
+	fPhase = 0;
+	fIterations = 0;
+	set_retain_window_contents(false);
+
+	fRedrawsAtPhaseStart = _CountRedraws();
+}
+
+
+bool
+WindowMoveTest::RunIteration(BView* view)
+{
+	if (fContentWindow == NULL)
+		return false;
+
+	// move back and forth over the content window
+	if (fIterations % (kMoveDistance / kMoveStep) == 0 && fIterations > 0)
+		fStep = -fStep;
+
+	bigtime_t now = system_time();
+
+	fMovingWindow->Lock();
+	fMovingWindow->MoveBy(fStep, 0);
+	fMovingWindow->Sync();
+	fMovingWindow->Unlock();
+
+	int32 redraws = _CountRedraws();
+
+	fPhaseDuration[fPhase] += system_time() - now;
+	fIterations++;
+
+	if (fIterations < fMaxIterations)
+		return true;
+
+	fPhaseRedraws[fPhase] = redraws - fRedrawsAtPhaseStart;
+	fRedrawsAtPhaseStart = redraws;
+
+	fIterations = 0;
+	fPhase++;
+	if (fPhase < kPhaseCount) {
+		set_retain_window_contents(true);
+		return true;
+	}
+
+	_Cleanup();
+	return false;
+}
+
+
+void
+WindowMoveTest::PrintResults(BView* view)
+{
+	// in case the test was canceled
+	_Cleanup();
+
+	if (fPhaseDuration[0] == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+
+	Test::PrintResults(view);
+
+	printf("Moves per phase: %lu\n", fMaxIterations);
+	for (int32 i = 0; i < fPhase && i < kPhaseCount; i++) {
+		float moveTime = (float)fPhaseDuration[i] / fMaxIterations / 1000;
+		printf("%s: %.3f ms per move (%.2fx), %ld redraws\n",
+			i == 0 ? "Redrawing exposed parts" : "Retaining window contents",
+			moveTime, (float)fPhaseDuration[0] / fPhaseDuration[i],
+			fPhaseRedraws[i]);
+	}
+}
+
+
+Test*
+WindowMoveTest::CreateTest()
+{
+	return new WindowMoveTest();
+}
+
+
+/*!	Waits until the content window has processed everything the last move
+	caused, and returns how often it has been drawn so far.
+*/
+int32
+WindowMoveTest::_CountRedraws()
+{
+	BMessage reply;
+	if (BMessenger(fContentWindow).SendMessage(kMsgSync, &reply) != B_OK)
+		return 0;
+
+	return reply.FindInt32("redraws");
+}
+
+
+void
+WindowMoveTest::_Cleanup()
+{
+	if (fContentWindow == NULL)
+		return;
+
+	set_retain_window_contents(fOriginalRetain);
+
+	fMovingWindow->Lock();
+	fMovingWindow->Quit();
+	fMovingWindow = NULL;
+
+	fContentWindow->Lock();
+	fContentWindow->Quit();
+	fContentWindow = NULL;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef WINDOW_MOVE_TEST_H
+#define WINDOW_MOVE_TEST_H
+
+#include "Test.h"
+
+class BWindow;
+
+class WindowMoveTest : public Test {
+public:
+								WindowMoveTest();
+	virtual						~WindowMoveTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+			int32				_CountRedraws();
+			void				_Cleanup();
+
+	enum {
+		kPhaseCount = 2
+	};
+
+			BWindow*			fContentWindow;
+			BWindow*			fMovingWindow;
+			bool				fOriginalRetain;
+
+			int32				fPhase;
+			uint32				fIterations;
+			uint32				fMaxIterations;
+			int32				fStep;
+			bigtime_t			fPhaseDuration[kPhaseCount];
+			int32				fPhaseRedraws[kPhaseCount];
+			int32				fRedrawsAtPhaseStart;
+};
+
+#endif // WINDOW_MOVE_TEST_H
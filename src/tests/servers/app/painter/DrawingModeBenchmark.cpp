@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how many pixels per second the span blending functions of the
+	most common drawing modes process, both with the scalar versions, and
+	with the SIMD ones the CPU supports. It also checks that both produce
+	the same results.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include "AppServer.h"
+#include "PatternHandler.h"
+#include "PixelFormat.h"
+
+
+uint32 gAppServerSIMDFlags = 0;
+
+static const int kWidth = 1024;
+static const int kHeight = 256;
+static const bigtime_t kRunTime = 1000000;
+
+enum span_type {
+	HLINE,
+	SOLID_HSPAN,
+	COLOR_HSPAN
+};
+
+struct test_case {
+	const char*		name;
+	drawing_mode	mode;
+	source_alpha	alphaSource;
+	alpha_function	alphaFunction;
+	uint8			highAlpha;
+	span_type		type;
+};
+
+static const test_case kTestCases[] = {
+	{"B_OP_COPY, solid span", B_OP_COPY, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255,
+		SOLID_HSPAN},
+	{"B_OP_OVER, solid span", B_OP_OVER, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255,
+		SOLID_HSPAN},
+	{"B_OP_ALPHA constant, hline", B_OP_ALPHA, B_CONSTANT_ALPHA,
+		B_ALPHA_OVERLAY, 128, HLINE},
+	{"B_OP_ALPHA constant, solid span", B_OP_ALPHA, B_CONSTANT_ALPHA,
+		B_ALPHA_OVERLAY, 128, SOLID_HSPAN},
+	{"B_OP_ALPHA constant, color span", B_OP_ALPHA, B_CONSTANT_ALPHA,
+		B_ALPHA_OVERLAY, 128, COLOR_HSPAN},
+	{"B_OP_ALPHA pixel, hline", B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_OVERLAY,
+		255, HLINE},
+	{"B_OP_ALPHA pixel, solid span", B_OP_ALPHA, B_PIXEL_ALPHA,
+		B_ALPHA_OVERLAY, 255, SOLID_HSPAN},
+	{"B_OP_ALPHA pixel, color span", B_OP_ALPHA, B_PIXEL_ALPHA,
+		B_ALPHA_OVERLAY, 255, COLOR_HSPAN},
+	{"B_OP_ALPHA composite, color span", B_OP_ALPHA, B_PIXEL_ALPHA,
+		B_ALPHA_COMPOSITE, 255, COLOR_HSPAN},
+};
+
+static uint8 sCovers[kWidth];
+static PixelFormat::color_type sColors[kWidth];
+
+
+static uint32
+detect_simd_flags()
+{
+	uint32 flags = 0;
+#if __INTEL__
+	cpuid_info info;
+	if (get_cpuid(&info, 1, 0) == B_OK) {
+		if ((info.regs.edx & (1 << 26)) != 0)
+			flags |= APPSERVER_SIMD_SSE2;
+	}
+#endif
+	return flags;
+}
+
+
+static void
+fill_background(uint8* bits)
+{
+	srand(0);
+	for (int i = 0; i < kWidth * kHeight * 4; i++)
+		bits[i] = (i & 3) == 3 ? 255 : rand() & 0xff;
+}
+
+
+static void
+render(PixelFormat& format, const test_case& test)
+{
+	PixelFormat::color_type color(200, 100, 50, 128);
+
+	for (int y = 0; y < kHeight; y++) {
+		switch (test.type) {
+			case HLINE:
+				format.blend_hline(0, y, kWidth, color, 255);
+				break;
+			case SOLID_HSPAN:
+				format.blend_solid_hspan(0, y, kWidth, color, sCovers);
+				break;
+			case COLOR_HSPAN:
+				format.blend_color_hspan(0, y, kWidth, sColors, sCovers, 255);
+				break;
+		}
+	}
+}
+
+
+static double
+measure(const test_case& test, uint32 simdFlags, uint8* bits,
+	uint8* firstPass)
+{
+	agg::rendering_buffer buffer(bits, kWidth, kHeight, kWidth * 4);
+
+	PatternHandler pattern;
+	rgb_color highColor = {200, 100, 50, test.highAlpha};
+	pattern.SetHighColor(highColor);
+
+	gAppServerSIMDFlags = simdFlags;
+	PixelFormat format(buffer, &pattern);
+	format.SetDrawingMode(test.mode, test.alphaSource, test.alphaFunction,
+		false);
+
+	fill_background(bits);
+	render(format, test);
+	memcpy(firstPass, bits, kWidth * kHeight * 4);
+
+	int64 pixels = 0;
+	bigtime_t startTime = system_time();
+	bigtime_t time;
+	do {
+		render(format, test);
+		pixels += kWidth * kHeight;
+		time = system_time() - startTime;
+	} while (time < kRunTime);
+
+	return pixels / (double)time;
+}
+
+
+static bool
+compare(const uint8* a, const uint8* b, bool ignoreAlpha)
+{
+	for (int i = 0; i < kWidth * kHeight * 4; i++) {
+		if (ignoreAlpha && (i & 3) == 3)
+			continue;
+		if (a[i] != b[i])
+			return false;
+	}
+	return true;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	uint32 simdFlags = detect_simd_flags();
+
+	// anti-aliased edges, and a gradient with varying alpha
+	srand(1);
+	for (int i = 0; i < kWidth; i++) {
+		int random = rand();
+		sCovers[i] = random % 3 == 0 ? 255 : random & 0xff;
+		sColors[i] = PixelFormat::color_type(i & 0xff, (i >> 2) & 0xff,
+			255 - (i & 0xff), (random >> 8) & 0xff);
+	}
+
+	uint8* bits = (uint8*)malloc(kWidth * kHeight * 4);
+	uint8* scalarPass = (uint8*)malloc(kWidth * kHeight * 4);
+	uint8* simdPass = (uint8*)malloc(kWidth * kHeight * 4);
+	if (bits == NULL || scalarPass == NULL || simdPass == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	if (simdFlags == 0)
+		printf("no supported SIMD instructions found\n");
+
+	bool failed = false;
+	for (size_t i = 0; i < sizeof(kTestCases) / sizeof(kTestCases[0]); i++) {
+		const test_case& test = kTestCases[i];
+
+		double scalar = measure(test, 0, bits, scalarPass);
+		if (simdFlags == 0) {
+			printf("%-34s %8.1f Mpixels/s\n", test.name, scalar);
+			continue;
+		}
+
+		double simd = measure(test, simdFlags, bits, simdPass);
+
+		// the scalar hline versions leave the alpha channel undefined
+		bool equal = compare(scalarPass, simdPass, test.type == HLINE);
+		if (!equal)
+			failed = true;
+
+		printf("%-34s %8.1f Mpixels/s, SIMD %8.1f Mpixels/s (%.2fx)%s\n",
+			test.name, scalar, simd, simd / scalar,
+			equal ? "" : ", RESULTS DIFFER");
+	}
+
+	free(bits);
+	free(scalarPass);
+	free(simdPass);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Replays a recorded session through the bitmap encoding of the remote
+	desktop protocol, and compares the bytes that are sent with and without
+	the tile cache. Every frame is decoded again, and checked against the
+	original.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <Application.h>
+#include <Bitmap.h>
+#include <ObjectList.h>
+#include <OS.h>
+#include <View.h>
+
+#include "RemoteMessage.h"
+#include "RemoteTileCache.h"
+#include "StreamingRingBuffer.h"
+
+
+static const BRect kFrame(0, 0, 639, 479);
+static const int32 kFramesPerScenario = 60;
+static const float kLineHeight = 16;
+
+
+typedef BObjectList<BBitmap> FrameList;
+
+
+class Scenario {
+public:
+	Scenario(const char* name)
+		:
+		fName(name),
+		fFrames(20, true)
+	{
+	}
+
+	virtual ~Scenario()
+	{
+	}
+
+	const char* Name() const
+	{
+		return fName;
+	}
+
+	FrameList& Frames()
+	{
+		return fFrames;
+	}
+
+	void Record()
+	{
+		for (int32 i = 0; i < kFramesPerScenario; i++) {
+			BBitmap* frame = new BBitmap(kFrame, B_BITMAP_ACCEPTS_VIEWS,
+				B_RGB32);
+			BView* view = new BView(kFrame, "recorder", B_FOLLOW_NONE, 0);
+			frame->AddChild(view);
+
+			frame->Lock();
+			DrawFrame(view, i);
+			view->Sync();
+			frame->RemoveChild(view);
+			frame->Unlock();
+
+			delete view;
+			fFrames.AddItem(frame);
+		}
+	}
+
+	virtual void DrawFrame(BView* view, int32 index) = 0;
+
+protected:
+	void DrawDocument(BView* view, float scrollOffset, int32 document)
+	{
+		view->SetHighColor(255, 255, 255);
+		view->FillRect(kFrame);
+
+		view->SetHighColor(0, 0, 0);
+		int32 firstLine = (int32)(scrollOffset / kLineHeight);
+		for (int32 line = firstLine; ; line++) {
+			float y = line * kLineHeight - scrollOffset + kLineHeight;
+			if (y > kFrame.bottom + kLineHeight)
+				break;
+
+			char text[128];
+			snprintf(text, sizeof(text), "%ld: Document %ld, line %ld of the "
+				"recorded session, with some more text to fill it.",
+				line + 1, document, line + 1);
+			view->DrawString(text, BPoint(10 + (line % 5) * 8, y));
+		}
+
+		// scroll bar
+		view->SetHighColor(216, 216, 216);
+		view->FillRect(BRect(kFrame.right - 14, 0, kFrame.right,
+			kFrame.bottom));
+		view->SetHighColor(152, 152, 152);
+		float thumb = fmodf(scrollOffset, kFrame.Height() - 60);
+		view->FillRect(BRect(kFrame.right - 13, thumb, kFrame.right - 1,
+			thumb + 60));
+	}
+
+private:
+	const char*	fName;
+	FrameList	fFrames;
+};
+
+
+// A desktop that does not change much, besides a clock
+class IdleScenario : public Scenario {
+public:
+	IdleScenario()
+		: Scenario("Idle desktop")
+	{
+	}
+
+	virtual void DrawFrame(BView* view, int32 index)
+	{
+		DrawDocument(view, 0, 0);
+
+		view->SetHighColor(240, 240, 240);
+		view->FillRect(BRect(540, 450, 639, 479));
+		view->SetHighColor(0, 0, 0);
+
+		char clock[32];
+		snprintf(clock, sizeof(clock), "12:%02ld:%02ld", index / 60,
+			index % 60);
+		view->DrawString(clock, BPoint(560, 470));
+	}
+};
+
+
+// The user switches back and forth between a few documents
+class SwitchingScenario : public Scenario {
+public:
+	SwitchingScenario()
+		: Scenario("Switching documents")
+	{
+	}
+
+	virtual void DrawFrame(BView* view, int32 index)
+	{
+		DrawDocument(view, 0, (index / 4) % 3);
+	}
+};
+
+
+// A document is scrolled down and up again
+class ScrollingScenario : public Scenario {
+public:
+	ScrollingScenario()
+		: Scenario("Scrolling document")
+	{
+	}
+
+	virtual void DrawFrame(BView* view, int32 index)
+	{
+		int32 step = index < kFramesPerScenario / 2
+			? index : kFramesPerScenario - index;
+		DrawDocument(view, step * kLineHeight, 0);
+	}
+};
+
+
+/*!	Sends all frames of the \a scenario through a ring buffer, and reads them
+	back. Returns the number of bytes that were sent.
+*/
+static uint64
+replay(Scenario& scenario, bool useTileCache, bigtime_t& encodeTime,
+	bigtime_t& decodeTime, int32& mismatches)
+{
+	StreamingRingBuffer buffer(4 * 1024 * 1024);
+	RemoteTileCache tileCache;
+	RemoteTileStore tileStore;
+
+	RemoteMessage sender(NULL, &buffer);
+	RemoteMessage receiver(&buffer, NULL);
+
+	uint64 bytesSent = 0;
+	encodeTime = 0;
+	decodeTime = 0;
+	mismatches = 0;
+
+	FrameList& frames = scenario.Frames();
+	for (int32 i = 0; i < frames.CountItems(); i++) {
+		BBitmap* frame = frames.ItemAt(i);
+
+		bigtime_t start = system_time();
+		sender.Start(RP_DRAW_BITMAP);
+		sender.AddBitmap(*frame, useTileCache ? &tileCache : NULL);
+		sender.Flush();
+		encodeTime += system_time() - start;
+
+		start = system_time();
+		uint16 code;
+		BBitmap* copy = NULL;
+		if (receiver.NextMessage(code) != B_OK) {
+			printf("  frame %ld could not be read\n", i);
+			mismatches++;
+			continue;
+		}
+
+		// the message header, and its contents
+		bytesSent += sizeof(uint16) + sizeof(uint32) + receiver.DataLeft();
+
+		if (receiver.ReadBitmap(&copy, false, B_RGB32, 0, &tileStore)
+				!= B_OK) {
+			printf("  frame %ld could not be decoded\n", i);
+			mismatches++;
+			continue;
+		}
+		decodeTime += system_time() - start;
+
+		if (copy->BitsLength() != frame->BitsLength()
+			|| memcmp(copy->Bits(), frame->Bits(), frame->BitsLength()) != 0)
+			mismatches++;
+
+		delete copy;
+	}
+
+	return bytesSent;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BApplication app("application/x-vnd.Haiku-RemoteBitmapReplay");
+
+	Scenario* scenarios[] = {
+		new IdleScenario(),
+		new SwitchingScenario(),
+		new ScrollingScenario()
+	};
+	int32 scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+	printf("Replaying %ld frames of %ldx%ld per scenario\n\n",
+		kFramesPerScenario, kFrame.IntegerWidth() + 1,
+		kFrame.IntegerHeight() + 1);
+
+	for (int32 i = 0; i < scenarioCount; i++) {
+		Scenario& scenario = *scenarios[i];
+		scenario.Record();
+
+		bigtime_t rawEncode, rawDecode, tileEncode, tileDecode;
+		int32 rawMismatches, tileMismatches;
+		uint64 rawBytes = replay(scenario, false, rawEncode, rawDecode,
+			rawMismatches);
+		uint64 tileBytes = replay(scenario, true, tileEncode, tileDecode,
+			tileMismatches);
+
+		printf("%s:\n", scenario.Name());
+		printf("  raw:   %10llu bytes, encode %6.2f ms, decode %6.2f ms "
+			"per frame\n", rawBytes, rawEncode / 1000.0 / kFramesPerScenario,
+			rawDecode / 1000.0 / kFramesPerScenario);
+		printf("  tiles: %10llu bytes, encode %6.2f ms, decode %6.2f ms "
+			"per frame (%.1f%% of raw)\n", tileBytes,
+			tileEncode / 1000.0 / kFramesPerScenario,
+			tileDecode / 1000.0 / kFramesPerScenario,
+			100.0 * tileBytes / rawBytes);
+		if (rawMismatches + tileMismatches > 0) {
+			printf("  %ld frames did not survive the round trip!\n",
+				rawMismatches + tileMismatches);
+		}
+
+		delete scenarios[i];
+	}
+
+	return 0;
+}
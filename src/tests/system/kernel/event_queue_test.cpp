@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the cost of waiting for one ready FD out of many with poll() and
+	with an event queue.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <event_queue_defs.h>
+#include <syscalls.h>
+
+
+static const int32 kIterations = 10000;
+
+
+static int* sReadFDs;
+static int* sWriteFDs;
+
+
+static bool
+create_pipes(int32 count)
+{
+	sReadFDs = (int*)malloc(sizeof(int) * count);
+	sWriteFDs = (int*)malloc(sizeof(int) * count);
+	if (sReadFDs == NULL || sWriteFDs == NULL)
+		return false;
+
+	for (int32 i = 0; i < count; i++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			fprintf(stderr, "Failed to create pipe %ld: %s\n", i,
+				strerror(errno));
+			return false;
+		}
+
+		sReadFDs[i] = fds[0];
+		sWriteFDs[i] = fds[1];
+	}
+
+	return true;
+}
+
+
+static void
+delete_pipes(int32 count)
+{
+	for (int32 i = 0; i < count; i++) {
+		close(sReadFDs[i]);
+		close(sWriteFDs[i]);
+	}
+
+	free(sReadFDs);
+	free(sWriteFDs);
+}
+
+
+static bigtime_t
+test_poll(int32 count)
+{
+	struct pollfd* fds = (struct pollfd*)malloc(sizeof(pollfd) * count);
+	if (fds == NULL)
+		return -1;
+
+	for (int32 i = 0; i < count; i++) {
+		fds[i].fd = sReadFDs[i];
+		fds[i].events = POLLIN;
+	}
+
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < kIterations; i++) {
+		int32 index = rand() % count;
+		char buffer = 'a';
+		write(sWriteFDs[index], &buffer, 1);
+
+		if (poll(fds, count, -1) != 1 || (fds[index].revents & POLLIN) == 0) {
+			fprintf(stderr, "poll() failed\n");
+			break;
+		}
+
+		read(sReadFDs[index], &buffer, 1);
+	}
+
+	bigtime_t runTime = system_time() - startTime;
+
+	free(fds);
+	return runTime;
+}
+
+
+static bigtime_t
+test_event_queue(int32 count)
+{
+	int queue = _kern_event_queue_create(O_CLOEXEC);
+	if (queue < 0) {
+		fprintf(stderr, "Failed to create event queue: %s\n",
+			strerror(queue));
+		return -1;
+	}
+
+	for (int32 i = 0; i < count; i++) {
+		event_wait_info info;
+		info.object = sReadFDs[i];
+		info.type = B_OBJECT_TYPE_FD;
+		info.events = B_EVENT_READ;
+		info.user_data = (void*)(addr_t)i;
+
+		status_t error = _kern_event_queue_select(queue, &info, 1);
+		if (error != B_OK) {
+			fprintf(stderr, "Failed to select FD %d: %s\n", sReadFDs[i],
+				strerror(error));
+			close(queue);
+			return -1;
+		}
+	}
+
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < kIterations; i++) {
+		int32 index = rand() % count;
+		char buffer = 'a';
+		write(sWriteFDs[index], &buffer, 1);
+
+		event_wait_info info;
+		ssize_t result = _kern_event_queue_wait(queue, &info, 1, 0, 0);
+		if (result != 1 || (addr_t)info.user_data != (addr_t)index
+			|| (info.events & B_EVENT_READ) == 0) {
+			fprintf(stderr, "_kern_event_queue_wait() failed: %s\n",
+				strerror(result));
+			break;
+		}
+
+		read(sReadFDs[index], &buffer, 1);
+	}
+
+	bigtime_t runTime = system_time() - startTime;
+
+	close(queue);
+	return runTime;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	// make sure we can open enough FDs
+	struct rlimit limit;
+	limit.rlim_cur = 2 * 10000 + 100;
+	limit.rlim_max = limit.rlim_cur;
+	setrlimit(RLIMIT_NOFILE, &limit);
+
+	static const int32 kCounts[] = { 10, 1000, 10000 };
+
+	for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+		int32 count = kCounts[i];
+		if (!create_pipes(count)) {
+			delete_pipes(0);
+			return 1;
+		}
+
+		bigtime_t pollTime = test_poll(count);
+		bigtime_t queueTime = test_event_queue(count);
+
+		printf("%6ld FDs: poll(): %8.2f usecs/wait, event queue: %8.2f "
+			"usecs/wait\n", count, 1.0 * pollTime / kIterations,
+			1.0 * queueTime / kIterations);
+
+		delete_pipes(count);
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Walks a directory tree like "du" does and compares reading the entries
+	with _kern_read_dir() plus one _kern_read_stat() per entry against reading
+	them in batches with _kern_read_dir_stat().
+*/
+
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+static const int32 kBatchCount = 64;
+
+
+struct walk_stats {
+	off_t	size;
+	int32	entries;
+};
+
+
+static bool
+is_dot_entry(const char* name)
+{
+	return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+}
+
+
+static void
+walk_per_entry(int dirFD, walk_stats& stats)
+{
+	char buffer[sizeof(dirent) + B_FILE_NAME_LENGTH];
+	dirent* entry = (dirent*)buffer;
+
+	while (_kern_read_dir(dirFD, entry, sizeof(buffer), 1) == 1) {
+		if (is_dot_entry(entry->d_name))
+			continue;
+
+		struct stat st;
+		if (_kern_read_stat(dirFD, entry->d_name, false, &st, sizeof(st))
+				!= B_OK) {
+			continue;
+		}
+
+		stats.size += st.st_size;
+		stats.entries++;
+
+		if (S_ISDIR(st.st_mode)) {
+			int fd = _kern_open_dir(dirFD, entry->d_name);
+			if (fd >= 0) {
+				walk_per_entry(fd, stats);
+				_kern_close(fd);
+			}
+		}
+	}
+}
+
+
+static void
+walk_batched(int dirFD, walk_stats& stats)
+{
+	char buffer[kBatchCount * (sizeof(dirent) + 32)];
+	struct stat statBuffer[kBatchCount];
+
+	while (true) {
+		ssize_t count = _kern_read_dir_stat(dirFD, (dirent*)buffer,
+			sizeof(buffer), kBatchCount, statBuffer, sizeof(struct stat));
+		if (count <= 0)
+			break;
+
+		dirent* entry = (dirent*)buffer;
+		for (ssize_t i = 0; i < count; i++,
+				entry = (dirent*)((uint8*)entry + entry->d_reclen)) {
+			const struct stat& st = statBuffer[i];
+			if (is_dot_entry(entry->d_name) || st.st_ino < 0)
+				continue;
+
+			stats.size += st.st_size;
+			stats.entries++;
+
+			if (S_ISDIR(st.st_mode)) {
+				int fd = _kern_open_dir(dirFD, entry->d_name);
+				if (fd >= 0) {
+					walk_batched(fd, stats);
+					_kern_close(fd);
+				}
+			}
+		}
+	}
+}
+
+
+static void
+run_test(const char* name, const char* path,
+	void (*walk)(int dirFD, walk_stats& stats))
+{
+	int fd = _kern_open_dir(-1, path);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open \"%s\": %s\n", path, strerror(fd));
+		return;
+	}
+
+	walk_stats stats = { 0, 0 };
+
+	bigtime_t startTime = system_time();
+	walk(fd, stats);
+	bigtime_t runTime = system_time() - startTime;
+
+	_kern_close(fd);
+
+	printf("%-12s %ld entries, %lld bytes: %lld usecs (%g usecs/entry)\n",
+		name, stats.entries, stats.size, runTime,
+		stats.entries > 0 ? 1.0 * runTime / stats.entries : 0.0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : ".";
+
+	// do one pass first, so that both runs work with a warm cache
+	walk_stats stats = { 0, 0 };
+	int fd = _kern_open_dir(-1, path);
+	if (fd >= 0) {
+		walk_batched(fd, stats);
+		_kern_close(fd);
+	}
+
+	run_test("per entry:", path, &walk_per_entry);
+	run_test("batched:", path, &walk_batched);
+
+	return 0;
+}
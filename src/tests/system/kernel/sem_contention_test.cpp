@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures semaphore acquire/release pairs per second with a number of
+	threads, either all using the same semaphore or each using its own one.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxThreads = 64;
+
+static int32 sIterations = 100000;
+static sem_id sSharedSem = -1;
+static sem_id sStartSem = -1;
+
+
+static status_t
+sem_thread(void* data)
+{
+	sem_id sem = (sem_id)(addr_t)data;
+
+	acquire_sem(sStartSem);
+
+	for (int32 i = 0; i < sIterations; i++) {
+		if (acquire_sem(sem) != B_OK)
+			return B_ERROR;
+		release_sem(sem);
+	}
+
+	return B_OK;
+}
+
+
+static void
+run_test(int32 threadCount, bool shared)
+{
+	thread_id threads[kMaxThreads];
+	sem_id sems[kMaxThreads];
+
+	sStartSem = create_sem(0, "start");
+
+	for (int32 i = 0; i < threadCount; i++) {
+		sems[i] = shared ? sSharedSem : create_sem(1, "private");
+		threads[i] = spawn_thread(&sem_thread, "sem thread", B_NORMAL_PRIORITY,
+			(void*)(addr_t)sems[i]);
+		resume_thread(threads[i]);
+	}
+
+	snooze(100000);
+
+	bigtime_t startTime = system_time();
+	release_sem_etc(sStartSem, threadCount, 0);
+
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+
+	bigtime_t runTime = system_time() - startTime;
+
+	delete_sem(sStartSem);
+	if (!shared) {
+		for (int32 i = 0; i < threadCount; i++)
+			delete_sem(sems[i]);
+	}
+
+	printf("%2ld threads, %s semaphore: %10.0f pairs/s\n", threadCount,
+		shared ? "shared " : "private",
+		1000000.0 * sIterations * threadCount / runTime);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 maxThreads = 8;
+	if (argc > 1)
+		maxThreads = atoi(argv[1]);
+	if (argc > 2)
+		sIterations = atoi(argv[2]);
+
+	if (maxThreads <= 0 || maxThreads > kMaxThreads || sIterations <= 0) {
+		fprintf(stderr, "usage: %s [threads [iterations]]\n", argv[0]);
+		return 1;
+	}
+
+	sSharedSem = create_sem(1, "shared");
+
+	for (int32 threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+		run_test(threadCount, false);
+		run_test(threadCount, true);
+	}
+
+	delete_sem(sSharedSem);
+	return 0;
+}
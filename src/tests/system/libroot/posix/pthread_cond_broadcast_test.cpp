@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how long it takes until all threads waiting on a condition
+	variable have run through the associated mutex after a
+	pthread_cond_broadcast(). Without requeueing, all woken threads immediately
+	compete for the mutex.
+*/
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <OS.h>
+
+
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sDoneCondition = PTHREAD_COND_INITIALIZER;
+static int32 sGeneration = 0;
+static int32 sWaiting = 0;
+static int32 sDone = 0;
+static bool sQuit = false;
+
+
+static void*
+waiter_thread(void*)
+{
+	pthread_mutex_lock(&sMutex);
+
+	int32 generation = sGeneration;
+	while (!sQuit) {
+		sWaiting++;
+		pthread_cond_signal(&sDoneCondition);
+
+		while (generation == sGeneration && !sQuit)
+			pthread_cond_wait(&sCondition, &sMutex);
+		generation = sGeneration;
+
+		// simulate a bit of work done while holding the lock
+		for (volatile int i = 0; i < 100; i++)
+			;
+
+		sDone++;
+		pthread_cond_signal(&sDoneCondition);
+	}
+
+	pthread_mutex_unlock(&sMutex);
+	return NULL;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 threadCount = 16;
+	int32 rounds = 10000;
+	if (argc > 1)
+		threadCount = atoi(argv[1]);
+	if (argc > 2)
+		rounds = atoi(argv[2]);
+
+	if (threadCount <= 0 || rounds <= 0) {
+		fprintf(stderr, "usage: %s [threads [rounds]]\n", argv[0]);
+		return 1;
+	}
+
+	pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * threadCount);
+	if (threads == NULL)
+		return 1;
+
+	for (int32 i = 0; i < threadCount; i++)
+		pthread_create(&threads[i], NULL, &waiter_thread, NULL);
+
+	bigtime_t totalTime = 0;
+
+	pthread_mutex_lock(&sMutex);
+	for (int32 round = 0; round < rounds; round++) {
+		// wait until all threads are blocking on the condition variable
+		while (sWaiting < threadCount)
+			pthread_cond_wait(&sDoneCondition, &sMutex);
+
+		sWaiting = 0;
+		sDone = 0;
+		sGeneration++;
+
+		bigtime_t startTime = system_time();
+		pthread_cond_broadcast(&sCondition);
+
+		while (sDone < threadCount)
+			pthread_cond_wait(&sDoneCondition, &sMutex);
+		totalTime += system_time() - startTime;
+	}
+
+	sQuit = true;
+	pthread_cond_broadcast(&sCondition);
+	pthread_mutex_unlock(&sMutex);
+
+	for (int32 i = 0; i < threadCount; i++)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+
+	printf("%ld threads, %ld rounds: %g usecs/broadcast, %g usecs/wakeup\n",
+		threadCount, rounds, 1.0 * totalTime / rounds,
+		1.0 * totalTime / rounds / threadCount);
+
+	return 0;
+}